@@ -58,6 +58,20 @@ void AliasUnit::compileAll()
     }
 }
 
+// See TriggerUnit::compileRegexes():
+void AliasUnit::compileRegexes()
+{
+    QList<QByteArray> regexes;
+    for (auto alias : std::as_const(mAliasMap)) {
+        regexes.append(alias->getRegexCode().toUtf8());
+    }
+
+    const auto precompiled = TRegex::compileAll(regexes, mpHost->mUsePcreJit);
+    for (auto alias : std::as_const(mAliasMap)) {
+        alias->compileRegex(precompiled);
+    }
+}
+
 void AliasUnit::resetStats()
 {
     statsItemsTotal = 0;
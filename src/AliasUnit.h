@@ -48,6 +48,7 @@ public:
     std::list<TAlias*> getAliasRootNodeList() { return mAliasRootNodeList; }
     TAlias* getAlias(int id);
     void compileAll();
+    void compileRegexes();
     TAlias* findFirstAlias(const QString& name);
     std::vector<int> findItems(const QString& name, const bool exactMatch, const bool caseSensitive);
     bool enableAlias(const QString&);
@@ -40,6 +40,8 @@ EAction::EAction(Host* pHost, const QIcon& icon, const QString& name, const int
 
 void EAction::slot_execute(bool checked)
 {
-    mpHost->getActionUnit()->getAction(mID)->mButtonState = checked;
-    mpHost->getActionUnit()->getAction(mID)->execute();
+    auto pA = mpHost->getActionUnit()->getAction(mID);
+    pA->mButtonState = checked;
+    pA->setUnsaved();
+    pA->execute();
 }
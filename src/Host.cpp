@@ -576,10 +576,15 @@ void Host::closeChildren()
     }
 }
 
+// The map is read on another thread so that the profile can connect and be
+// used while a large one loads - the mapper is set up once it is in place:
 void Host::loadMap()
 {
     qDebug() << "Host::loadMap() - restore map case 4.";
-    if (mpMap->restore(QString(), false)) {
+    mpMap->restoreInBackground([this](const bool isOk) {
+        if (!isOk) {
+            return;
+        }
         mpMap->audit();
         if (mpMap->mpMapper) {
             mpMap->mpMapper->mp2dMap->init();
@@ -587,7 +592,7 @@ void Host::loadMap()
             mpMap->mpMapper->resetAreaComboBoxToPlayerRoomArea();
             mpMap->mpMapper->show();
         }
-    }
+    });
 }
 
 void Host::startMapAutosave(const int interval)
@@ -692,6 +697,64 @@ void Host::saveModules(bool backup)
     modulesToWrite.clear();
 }
 
+namespace {
+// Appends the ids of the top level items in the module to the signature and
+// returns true if any of them, or anything below them, has changed since it
+// was last saved - and then, if asked to, flags them as saved:
+template <class T>
+bool moduleRootsUnsaved(const std::list<T*>& roots, const QString& moduleName, QList<int>& signature, const bool markSaved)
+{
+    bool unsaved = false;
+    for (auto pT : roots) {
+        if (!pT || !pT->mModuleMember || pT->mPackageName != moduleName) {
+            continue;
+        }
+        signature.append(pT->getID());
+        unsaved = unsaved || pT->isUnsaved();
+        if (markSaved) {
+            pT->setSaved();
+        }
+    }
+    // Keeps the ids of the different types of item apart:
+    signature.append(-1);
+    return unsaved;
+}
+} // namespace
+
+// Removes the modules that have not changed since they were last written out
+// from those that saveModules() is about to write (and sync to other
+// profiles). Must be run on the main thread, after the profile XML has been
+// put together as that is what fills in modulesToWrite:
+void Host::skipUnchangedModules()
+{
+    QMutableMapIterator<QString, QStringList> itModule(modulesToWrite);
+    while (itModule.hasNext()) {
+        itModule.next();
+        const QString moduleName = itModule.key();
+        auto checkRoots = [&](QList<int>& signature, const bool markSaved) {
+            bool unsaved = moduleRootsUnsaved(mTriggerUnit.getTriggerRootNodeList(), moduleName, signature, markSaved);
+            unsaved = moduleRootsUnsaved(mTimerUnit.getTimerRootNodeList(), moduleName, signature, markSaved) || unsaved;
+            unsaved = moduleRootsUnsaved(mAliasUnit.getAliasRootNodeList(), moduleName, signature, markSaved) || unsaved;
+            unsaved = moduleRootsUnsaved(mActionUnit.getActionRootNodeList(), moduleName, signature, markSaved) || unsaved;
+            unsaved = moduleRootsUnsaved(mScriptUnit.getScriptRootNodeList(), moduleName, signature, markSaved) || unsaved;
+            unsaved = moduleRootsUnsaved(mKeyUnit.getKeyRootNodeList(), moduleName, signature, markSaved) || unsaved;
+            return unsaved;
+        };
+
+        QList<int> signature;
+        const bool unsaved = checkRoots(signature, false);
+        const QPair<QList<int>, QString> moduleSignature{signature, moduleHelp.value(moduleName).value(qsl("helpURL"))};
+        if (!unsaved && mModuleSaveSignatures.value(moduleName) == moduleSignature && QFileInfo::exists(itModule.value().at(0))) {
+            itModule.remove();
+            continue;
+        }
+
+        signature.clear();
+        checkRoots(signature, true);
+        mModuleSaveSignatures.insert(moduleName, moduleSignature);
+    }
+}
+
 void Host::reloadModules()
 {
     //synchronize modules across sessions
@@ -943,9 +1006,17 @@ std::tuple<bool, QString, QString> Host::saveProfile(const QString& saveFolder,
     emit profileSaveStarted();
     qApp->processEvents();
 
+    if (saveFolder.isEmpty() && saveName.isEmpty()) {
+        // Write everything out afresh at the end of the session, rather than
+        // relying on every change having been flagged as unsaved:
+        mSaveCache.clear();
+        mModuleSaveSignatures.clear();
+    }
+
     auto writer = new XMLexport(this);
     writers.insert(qsl("profile"), writer);
     writer->exportHost(filename_xml);
+    skipUnchangedModules();
     mWritingHostAndModules = true;
     auto watcher = new QFutureWatcher<void>;
     mModuleFuture = QtConcurrent::run([=]() {
@@ -1686,6 +1757,7 @@ void Host::unregisterEventHandler(const QString& name, TScript* pScript)
     if (mEventHandlerMap.contains(name)) {
         mEventHandlerMap[name].removeAll(pScript);
     }
+    mLuaInterpreter.forgetEventHandler(pScript->getName());
 }
 
 // If a handler matches the event, the Lua stack will be cleared after this function
@@ -2905,7 +2977,6 @@ void Host::setName(const QString& name)
         mpConsole->setProperty("HostName", name);
         mpConsole->setProfileName(name);
     }
-    mTimerUnit.changeHostName(name);
 }
 
 void Host::removeAllNonPersistentStopWatches()
@@ -4281,6 +4352,16 @@ void Host::setEditorShowBidi(const bool state)
     }
 }
 
+void Host::setUsePcreJit(const bool state)
+{
+    if (mUsePcreJit != state) {
+        mUsePcreJit = state;
+        // Recompile the existing regexes so that they pick up the change:
+        mTriggerUnit.compileRegexes();
+        mAliasUnit.compileRegexes();
+    }
+}
+
 bool Host::caretEnabled() const {
     return mCaretEnabled;
 }
@@ -32,9 +32,11 @@
 #include "ScriptUnit.h"
 #include "GifTracker.h"
 #include "TCommandLine.h"
+#include "TInboundStats.h"
 #include "TLuaInterpreter.h"
 #include "TimerUnit.h"
 #include "TMainConsole.h"
+#include "TProfiler.h"
 #include "TriggerUnit.h"
 #include "XMLexport.h"
 #include "ctelnet.h"
@@ -408,6 +410,7 @@ public:
     std::optional<QString> windowType(const QString& name) const;
     bool getEditorShowBidi() const { return mEditorShowBidi; }
     void setEditorShowBidi(const bool);
+    void setUsePcreJit(const bool);
     bool caretEnabled() const;
     void setCaretEnabled(bool enabled);
     void setFocusOnHostActiveCommandLine();
@@ -452,6 +455,11 @@ public:
     bool mEnableMNES = false;
     bool mServerMXPenabled = true;
     bool mAskTlsAvailable = true;
+    // Whether trigger and alias Perl regexes are JIT compiled by PCRE, there
+    // is an option to turn this off in case it misbehaves on a particular
+    // platform - change it with setUsePcreJit(...) so that existing patterns
+    // get recompiled:
+    bool mUsePcreJit = true;
     int mMSSPTlsPort = 0;
     QString mMSSPHostName;
 
@@ -461,6 +469,10 @@ public:
     QString mMediaLocationMSP;
     QTextStream mErrorLogStream;
     QMap<QString, QList<TScript*>> mEventHandlerMap;
+    // Only gathers anything during a replay benchmark:
+    TInboundStats mInboundStats;
+    // Only gathers anything after startProfiling() has been called:
+    TProfiler mProfiler;
     bool mFORCE_GA_OFF;
     bool mFORCE_NO_COMPRESSION;
     bool mFORCE_SAVE_ON_EXIT;
@@ -654,6 +666,9 @@ public:
     QColor mCommandLineBgColor;
     bool mMapperUseAntiAlias;
     bool mMapperShowRoomBorders;
+    // Find speedwalk routes by way of the rooms that connect areas rather
+    // than by searching every room in the map, see TMapGraph::findAreaRoute(...):
+    bool mMapperAreaRouting = false;
     bool mFORCE_MXP_NEGOTIATION_OFF;
     bool mFORCE_CHARSET_NEGOTIATION_OFF;
     bool mForceNewEnvironNegotiationOff = false;
@@ -739,6 +754,7 @@ private:
     void writeModule(const QString &moduleName, const QString &filename);
     void waitForAsyncXmlSave();
     void saveModules(bool backup = true);
+    void skipUnchangedModules();
     void updateModuleZips(const QString &zipName, const QString &moduleName);
     void reloadModules();
     void startMapAutosave(const int interval);
@@ -806,6 +822,12 @@ private:
 
     // keeps track of all of the array writers we're currently operating with
     QHash<QString, XMLexport*> writers;
+    // The XML of the items from the last profile save, so the next one only
+    // has to write out again those that have changed:
+    XMLexportCache mSaveCache;
+    // module name = ids of the top level items in it (and the help URL) when
+    // it was last written out, so that unchanged modules can be skipped:
+    QHash<QString, QPair<QList<int>, QString>> mModuleSaveSignatures;
 
     QFuture<void> mModuleFuture;
 
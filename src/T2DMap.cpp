@@ -3282,7 +3282,6 @@ void T2DMap::slot_createRoom()
     mpMap->setRoomArea(roomID, mAreaID, false);
     mpMap->setRoomCoordinates(roomID, mContextMenuClickPosition.x, mContextMenuClickPosition.y, mMapCenterZ);
 
-    mpMap->mMapGraphNeedsUpdate = true;
 #if defined(INCLUDE_3DMAPPER)
     if (mpMap->mpM) {
         mpMap->mpM->update();
@@ -3899,11 +3898,9 @@ void T2DMap::slot_setRoomProperties(
         }
         if (changeLockStatus) {
             room->isLocked = newLockStatus;
+            mpMap->markRoomChanged(room->getId());
         }
     }
-    if (changeWeight || changeLockStatus) {
-        mpMap->mMapGraphNeedsUpdate = true;
-    }
     repaint();
     update();
     mpMap->setUnsaved(__func__);
@@ -4102,7 +4099,6 @@ void T2DMap::slot_newMap()
 
     mpMap->setRoomArea(roomID, -1, false);
     mpMap->setRoomCoordinates(roomID, 0, 0, 0);
-    mpMap->mMapGraphNeedsUpdate = true;
 
     mpMap->mRoomIdHash[mpMap->mProfileName] = roomID;
     mpMap->mNewMove = true;
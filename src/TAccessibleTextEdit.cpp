@@ -273,9 +273,8 @@ int TAccessibleTextEdit::characterCount() const
 bool TAccessibleTextEdit::lineIsVisible(int line) const
 {
     TTextEdit* edit = textEdit();
-    int topLine = edit->imageTopLine();
 
-    return line >= topLine && line < topLine + edit->mScreenHeight;
+    return edit->isLineOnScreen(line);
 }
 
 /*
@@ -291,16 +290,17 @@ QRect TAccessibleTextEdit::characterRect(int offset) const
     int row = lineForOffset(offset);
     int col = columnForOffset(offset);
     TTextEdit* edit = textEdit();
-    int topLine = edit->imageTopLine();
 
-    // Check whether the character is visible.
-    if (!lineIsVisible(row)) {
+    // Check whether the character is visible - and where, as the line may be
+    // wrapped over several rows:
+    const QPoint screenPosition = edit->screenPosition(row, col);
+    if (screenPosition.y() < 0) {
         return QRect();
     }
 
     int fontWidth = edit->mFontWidth;
     int fontHeight = edit->mFontHeight;
-    QPoint position = edit->mapToGlobal(QPoint(col * fontWidth, (row - topLine) * fontHeight));
+    QPoint position = edit->mapToGlobal(QPoint(screenPosition.x() * fontWidth, screenPosition.y() * fontHeight));
 
     return QRect(position, QSize(fontWidth, fontHeight));
 }
@@ -312,8 +312,10 @@ int TAccessibleTextEdit::offsetAtPoint(const QPoint& point) const
 {
     TTextEdit* edit = textEdit();
     QPoint local = edit->mapFromGlobal(point);
-    int line = edit->imageTopLine() + local.y() / edit->mFontHeight;
-    int column = local.x() / edit->mFontWidth;
+    const TTextEdit::ScreenRow screenRow = edit->screenRowAt(local.y());
+    int line = screenRow.mLine;
+    bool isOutOfBounds = false;
+    int column = edit->convertMouseXToBufferX(local.x(), line, screenRow.mRow, &isOutOfBounds);
 
     return offsetForPosition(line, column);
 }
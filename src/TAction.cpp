@@ -109,6 +109,7 @@ void TAction::compile()
 
 bool TAction::setScript(const QString& script)
 {
+    setUnsaved();
     if (script != mScript) {
         setDataChanged();
     }
@@ -382,6 +383,7 @@ void TAction::insertActions(TEasyButtonBar* pT, QMenu* menu)
 
 void TAction::setName(const QString& name)
 {
+    setUnsaved();
     if (name != mName) {
         setDataChanged();
         mName = name;
@@ -74,7 +74,7 @@ public:
     bool compileScript();
     void execute();
     QString getIcon() const { return mIcon; }
-    void setIcon(const QString& icon) { if (icon != mIcon) { mIcon = icon; } }
+    void setIcon(const QString& icon) { if (icon != mIcon) { setUnsaved(); mIcon = icon; } }
     QString getScript() const { return mScript; }
     bool setScript(const QString& script);
     QString getCommandButtonUp() const { return mCommandButtonUp; }
@@ -92,7 +92,7 @@ public:
     void insertActions(TEasyButtonBar* pT, QMenu* menu);
     void expandToolbar(TEasyButtonBar* pT);
     void setDataSaved() { if (mpParent) { mpParent->setDataSaved(); } mDataChanged = false; }
-    void setDataChanged() { if (mpParent) { mpParent->setDataChanged(); } mDataChanged = true; }
+    void setDataChanged() { if (mpParent) { mpParent->setDataChanged(); } mDataChanged = true; setUnsaved(); }
     bool isDataChanged() { return mDataChanged; }
 
     QPointer<TToolBar> mpToolBar;
@@ -0,0 +1,97 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include "TAhoCorasick.h"
+
+#include <algorithm>
+#include <queue>
+
+void TAhoCorasick::clear()
+{
+    mNodes.clear();
+    mNodes.emplace_back();
+    mPatternCount = 0;
+    mIsBuilt = false;
+}
+
+int TAhoCorasick::transition(const int state, const unsigned char byte) const
+{
+    const auto& edges = mNodes[state].edges;
+    const auto it = std::lower_bound(edges.cbegin(), edges.cend(), byte, [](const std::pair<unsigned char, int>& edge, const unsigned char value) {
+        return edge.first < value;
+    });
+    if (it != edges.cend() && it->first == byte) {
+        return it->second;
+    }
+    return -1;
+}
+
+void TAhoCorasick::addPattern(const QByteArray& pattern, const int id)
+{
+    if (pattern.isEmpty()) {
+        return;
+    }
+
+    mIsBuilt = false;
+    int state = 0;
+    for (const char character : pattern) {
+        const auto byte = static_cast<unsigned char>(character);
+        int next = transition(state, byte);
+        if (next < 0) {
+            next = static_cast<int>(mNodes.size());
+            mNodes.emplace_back();
+            auto& edges = mNodes[state].edges;
+            edges.insert(std::upper_bound(edges.begin(), edges.end(), std::make_pair(byte, next)), std::make_pair(byte, next));
+        }
+        state = next;
+    }
+    mNodes[state].outputs.push_back(id);
+    ++mPatternCount;
+}
+
+void TAhoCorasick::build()
+{
+    // Breadth first so that the fail link of each node's parent is always
+    // known before the node itself is reached:
+    std::queue<int> pending;
+    for (const auto& [byte, child] : mNodes.front().edges) {
+        Q_UNUSED(byte)
+        mNodes[child].fail = 0;
+        mNodes[child].outputLink = 0;
+        pending.push(child);
+    }
+
+    while (!pending.empty()) {
+        const int state = pending.front();
+        pending.pop();
+        for (const auto& [byte, child] : mNodes[state].edges) {
+            int fallback = mNodes[state].fail;
+            int next;
+            while ((next = transition(fallback, byte)) < 0 && fallback) {
+                fallback = mNodes[fallback].fail;
+            }
+            const int fail = (next < 0 || next == child) ? 0 : next;
+            mNodes[child].fail = fail;
+            mNodes[child].outputLink = mNodes[fail].outputs.empty() ? mNodes[fail].outputLink : fail;
+            pending.push(child);
+        }
+    }
+    mIsBuilt = true;
+}
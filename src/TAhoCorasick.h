@@ -0,0 +1,96 @@
+#ifndef MUDLET_TAHOCORASICK_H
+#define MUDLET_TAHOCORASICK_H
+
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include "pre_guard.h"
+#include <QByteArray>
+#include "post_guard.h"
+
+#include <utility>
+#include <vector>
+
+// A byte oriented Aho-Corasick automaton, it finds all occurrences of any of
+// a set of literal byte strings in a single pass over some text. Patterns are
+// added with addPattern(...) and then build() must be called before scan(...)
+// is used - adding another pattern afterwards requires another build().
+// The transitions of each node are kept as a small sorted vector rather than
+// a 256 entry table so that a few thousand patterns stay cheap in memory.
+class TAhoCorasick
+{
+public:
+    void clear();
+    // The id is reported back for every occurrence of the pattern found, the
+    // same id may be given for more than one pattern, empty patterns are
+    // ignored:
+    void addPattern(const QByteArray& pattern, const int id);
+    void build();
+    bool isEmpty() const { return mNodes.size() <= 1; }
+    bool isBuilt() const { return mIsBuilt; }
+    int patternCount() const { return mPatternCount; }
+
+    // Calls onMatch(id) for each pattern occurrence in the text; it stops
+    // early if onMatch returns false:
+    template <typename Callback>
+    void scan(const char* text, const int length, Callback&& onMatch) const
+    {
+        if (!mIsBuilt || isEmpty()) {
+            return;
+        }
+        int state = 0;
+        for (int i = 0; i < length; ++i) {
+            const auto byte = static_cast<unsigned char>(text[i]);
+            int next;
+            while ((next = transition(state, byte)) < 0 && state) {
+                state = mNodes[state].fail;
+            }
+            state = (next < 0) ? 0 : next;
+            // Walk the chain of nodes that end a pattern - the node itself (if
+            // it is an output) and then the dictionary suffix links:
+            for (int output = mNodes[state].outputs.empty() ? mNodes[state].outputLink : state; output > 0; output = mNodes[output].outputLink) {
+                for (const int id : mNodes[output].outputs) {
+                    if (!onMatch(id)) {
+                        return;
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    struct Node
+    {
+        // Sorted by the byte value:
+        std::vector<std::pair<unsigned char, int>> edges;
+        int fail = 0;
+        // The nearest node along the fail chain that has outputs, 0 if none:
+        int outputLink = 0;
+        std::vector<int> outputs;
+    };
+
+    int transition(const int state, const unsigned char byte) const;
+
+    std::vector<Node> mNodes{1};
+    int mPatternCount = 0;
+    bool mIsBuilt = false;
+};
+
+#endif // MUDLET_TAHOCORASICK_H
@@ -60,6 +60,7 @@ TAlias::~TAlias()
 
 void TAlias::setName(const QString& name)
 {
+    setUnsaved();
     if (!isTemporary()) {
         mpHost->getAliasUnit()->mLookupTable.remove(mName, this);
     }
@@ -69,6 +70,7 @@ void TAlias::setName(const QString& name)
 
 bool TAlias::match(const QString& haystack)
 {
+    const TProfiler::Scope profile(mpHost->mProfiler, TProfiler::AliasMatch, mID, mName);
     bool matchCondition = false;
     if (!isActive()) {
         if (isFolder()) {
@@ -84,7 +86,7 @@ bool TAlias::match(const QString& haystack)
         return false;
     }
 
-    QSharedPointer<pcre> re = mpRegex;
+    QSharedPointer<TRegex> re = mpRegex;
     if (re == nullptr) {
         return false; //regex compile error
     }
@@ -115,7 +117,7 @@ bool TAlias::match(const QString& haystack)
         goto MUD_ERROR;
     }
 
-    rc = pcre_exec(re.data(), nullptr, haystackC, haystackCLength, 0, 0, ovector, MAX_CAPTURE_GROUPS * 3);
+    rc = re->exec(haystackC, haystackCLength, 0, 0, ovector, MAX_CAPTURE_GROUPS * 3);
 
     if (rc < 0) {
         goto MUD_ERROR;
@@ -156,11 +158,11 @@ bool TAlias::match(const QString& haystack)
         }
     }
 
-    pcre_fullinfo(re.data(), nullptr, PCRE_INFO_NAMECOUNT, &namecount);
+    pcre_fullinfo(re->code(), re->extra(), PCRE_INFO_NAMECOUNT, &namecount);
 
     if (namecount > 0) {
-        pcre_fullinfo(re.data(), nullptr, PCRE_INFO_NAMETABLE, &tabptr);
-        pcre_fullinfo(re.data(), nullptr, PCRE_INFO_NAMEENTRYSIZE, &name_entry_size);
+        pcre_fullinfo(re->code(), re->extra(), PCRE_INFO_NAMETABLE, &tabptr);
+        pcre_fullinfo(re->code(), re->extra(), PCRE_INFO_NAMEENTRYSIZE, &name_entry_size);
         for (i = 0; i < namecount; ++i) {
             const int n = (tabptr[0] << 8) | tabptr[1];
             auto name = QString::fromUtf8(&tabptr[2]).trimmed();
@@ -185,7 +187,7 @@ bool TAlias::match(const QString& haystack)
             options = PCRE_NOTEMPTY | PCRE_ANCHORED;
         }
 
-        rc = pcre_exec(re.data(), nullptr, haystackC, haystackCLength, start_offset, options, ovector, MAX_CAPTURE_GROUPS * 3);
+        rc = re->exec(haystackC, haystackCLength, start_offset, options, ovector, MAX_CAPTURE_GROUPS * 3);
         if (rc == PCRE_ERROR_NOMATCH) {
             if (options == 0) {
                 break;
@@ -243,25 +245,23 @@ MUD_ERROR:
     return matchCondition;
 }
 
-static void pcre_deleter(pcre* pointer)
-{
-    pcre_free(pointer);
-}
-
-void TAlias::setRegexCode(const QString& code)
+void TAlias::setRegexCode(const QString& code, const QHash<QByteArray, QSharedPointer<TRegex>>& precompiled)
 {
+    setUnsaved();
     mRegexCode = code;
-    compileRegex();
+    compileRegex(precompiled);
 }
 
-void TAlias::compileRegex()
+void TAlias::compileRegex(const QHash<QByteArray, QSharedPointer<TRegex>>& precompiled)
 {
-    const char* error;
+    QString error;
     int erroffset;
 
-    // PCRE_UTF8 needed to run compile in UTF-8 mode
-    // PCRE_UCP needed for \d, \w etc. to use Unicode properties:
-    QSharedPointer<pcre> re(pcre_compile(mRegexCode.toUtf8().constData(), PCRE_UTF8 | PCRE_UCP, &error, &erroffset, nullptr), pcre_deleter);
+    const QByteArray regexp = mRegexCode.toUtf8();
+    QSharedPointer<TRegex> re = precompiled.value(regexp);
+    if (!re) {
+        re = TRegex::compile(regexp, mpHost->mUsePcreJit, error, erroffset);
+    }
 
     if (re == nullptr) {
         mOK_init = false;
@@ -318,6 +318,7 @@ void TAlias::compile()
 
 bool TAlias::setScript(const QString& script)
 {
+    setUnsaved();
     mScript = script;
     mNeedsToBeCompiled = true;
     mOK_code = compileScript();
@@ -344,6 +345,7 @@ bool TAlias::compileScript()
 
 void TAlias::execute()
 {
+    const TProfiler::Scope profile(mpHost->mProfiler, TProfiler::AliasScript, mID, mName);
     if (!mCommand.isEmpty()) {
         mpHost->send(mCommand);
     }
@@ -23,6 +23,7 @@
  ***************************************************************************/
 
 
+#include "TRegex.h"
 #include "Tree.h"
 
 #include "pre_guard.h"
@@ -32,8 +33,6 @@
 #include <QSharedPointer>
 #include "post_guard.h"
 
-#include <pcre.h>
-
 class Host;
 
 #define MAX_CAPTURE_GROUPS 33
@@ -51,7 +50,7 @@ public:
     TAlias(TAlias* parent, Host* pHost);
     TAlias(const QString& name, Host* pHost);
     void compileAll();
-    void compileRegex();
+    void compileRegex(const QHash<QByteArray, QSharedPointer<TRegex>>& precompiled = {});
     QString getName() const { return mName; }
     void setName(const QString& name);
     void compile();
@@ -60,8 +59,9 @@ public:
     QString getScript() const { return mScript; }
     bool setScript(const QString& script);
     QString getRegexCode() const { return mRegexCode; }
-    void setRegexCode(const QString&);
-    void setCommand(const QString& command) { mCommand = command; }
+    // See TTrigger::setRegexCodeList(...) for precompiled:
+    void setRegexCode(const QString&, const QHash<QByteArray, QSharedPointer<TRegex>>& precompiled = {});
+    void setCommand(const QString& command) { mCommand = command; setUnsaved(); }
     QString getCommand() const { return mCommand; }
 
     bool match(const QString& toMatch);
@@ -72,7 +72,7 @@ public:
     QString mName;
     QString mCommand;
     QString mRegexCode;
-    QSharedPointer<pcre> mpRegex;
+    QSharedPointer<TRegex> mpRegex;
     QString mScript;
     QPointer<Host> mpHost;
     bool mModuleMember = false;
@@ -23,6 +23,7 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
+#include "TMapGraph.h"
 #include "TRoom.h"
 
 #ifndef Q_MOC_RUN
@@ -45,23 +46,6 @@ class TRoom;
 using namespace boost;
 
 
-// auxiliary types
-struct location
-{
-    int id;    // Typically 4 bytes
-    TRoom* pR; // 4 or 8 bytes? - so may have reduced size from 20 to 8 or 12 plus padding...?
-};
-
-typedef float cost;
-
-// Used to record edge details and to deduplicate parallel ones:
-struct route
-{
-    float cost;              // Needed during establishing the best parallel edge
-    quint8 direction;        // Use DIR_xxx values to code exit direction
-    QString specialExitName; // If direction is DIR_OTHER then this is needed
-};
-
 // euclidean distance heuristic
 template <class Graph, class CostType, class LocMap>
 class distance_heuristic : public boost::astar_heuristic<Graph, CostType>
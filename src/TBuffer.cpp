@@ -25,6 +25,7 @@
 
 #include "mudlet.h"
 #include "TEvent.h"
+#include "TRegex.h"
 #include "TStringUtils.h"
 
 #include "pre_guard.h"
@@ -33,88 +34,6 @@
 #include <QRegularExpression>
 #include "post_guard.h"
 
-TChar::TChar(const QColor& foreground, const QColor& background, const TChar::AttributeFlags flags, const int linkIndex)
-: mFgColor(foreground)
-, mBgColor(background)
-, mFlags(flags)
-, mLinkIndex(linkIndex)
-{
-}
-
-TChar::TChar(TConsole* pC)
-: mFgColor(pC ? pC->mFormatCurrent.foreground() : QColorConstants::White)
-, mBgColor(pC ? pC->mFormatCurrent.background() : QColorConstants::Black)
-, mFlags(pC ? pC->mFormatCurrent.allDisplayAttributes() : AttributeFlag::None)
-{
-}
-
-// Note: this operator compares ALL aspects of 'this' against 'other' which may
-// not be wanted in every case:
-bool TChar::operator==(const TChar& other)
-{
-    if (mIsSelected != other.mIsSelected) {
-        return false;
-    }
-    if (mLinkIndex != other.mLinkIndex) {
-        return false;
-    }
-    if (mFgColor != other.mFgColor) {
-        return false;
-    }
-    if (mBgColor != other.mBgColor) {
-        return false;
-    }
-    if (mFlags != other.mFlags) {
-        return false;
-    }
-    return true;
-}
-
-// Copy constructor - because it is resetting the mIsSelected flag it is NOT a
-// default copy constructor:
-TChar::TChar(const TChar& copy)
-: mFgColor(copy.mFgColor)
-, mBgColor(copy.mBgColor)
-, mFlags(copy.mFlags)
-, mIsSelected(false)
-, mLinkIndex(copy.mLinkIndex)
-{
-}
-
-quint8 TChar::alternateFont() const
-{
-    // As this is the most likely case check it first:
-    if (!(mFlags & AltFontMask)) {
-        return 0;
-    }
-
-    if (mFlags & AltFont9) {
-        return 9;
-    }
-    if (mFlags & AltFont8) {
-        return 8;
-    }
-    if (mFlags & AltFont7) {
-        return 7;
-    }
-    if (mFlags & AltFont6) {
-        return 6;
-    }
-    if (mFlags & AltFont5) {
-        return 5;
-    }
-    if (mFlags & AltFont4) {
-        return 4;
-    }
-    if (mFlags & AltFont3) {
-        return 3;
-    }
-    if (mFlags & AltFont2) {
-        return 2;
-    }
-    return 1;
-}
-
 // Store for text and attributes (such as character color) to be drawn on screen
 // Contents are rendered by a TTextEdit
 TBuffer::TBuffer(Host* pH, TConsole* pConsole)
@@ -252,9 +171,9 @@ void TBuffer::addLink(bool trigMode, const QString& text, QStringList& command,
     const int id = mLinkStore.addLinks(command, hint, mpHost, luaReference);
 
     if (!trigMode) {
-        append(text, 0, text.length(), format.mFgColor, format.mBgColor, format.mFlags, id);
+        append(text, 0, text.length(), format.foreground(), format.background(), format.mFlags, id);
     } else {
-        appendLine(text, 0, text.length(), format.mFgColor, format.mBgColor, format.mFlags, id);
+        appendLine(text, 0, text.length(), format.foreground(), format.background(), format.mFlags, id);
     }
 }
 
@@ -419,10 +338,12 @@ void TBuffer::translateToPlainText(std::string& incoming, const bool isFromServe
     }
 
     // If we are resolving/interpolating an MXP entity, the interpolated text
-    // ends at localBuffer[endOfMXPEntity - 1]. This variable used to avoid an
-    // (infinite) recursion like <!EN E "foobar&E;>&E;
-    // Recursively interpolating a predefined entity like <!EN E "foobar&frac12;>&E;
-    // will work though.
+    // ends at localBuffer[endOfMXPEntity - 1] (it is put just before the text
+    // that follows the entity, over the end of what has already been done).
+    // This variable used to avoid an (infinite) recursion like
+    // <!EN E "foobar&E;>&E;
+    // Recursively interpolating a predefined entity like
+    // <!EN E "foobar&frac12;>&E; will work though.
     size_t endOfMXPEntity = 0;
 
     // A similar index which points behind the name of a literal entity name like
@@ -679,6 +600,20 @@ void TBuffer::translateToPlainText(std::string& incoming, const bool isFromServe
 
         // We are outside of a CSI or OSC sequence if we get to here:
 
+        // Most of what comes from the game is runs of printable ASCII
+        // characters between SGR sequences - they are the same in every
+        // encoding we handle and, unless MXP has to see each of them, they can
+        // all be appended in one go with the same format:
+        if (!mGotESC && !(mpHost->mMxpProcessor.isEnabled() && mpHost->mServerMXPenabled)) {
+            const size_t runLength = TStringUtils::plainTextRunLength(localBuffer.data() + localBufferPosition, localBufferLength - localBufferPosition);
+            if (runLength) {
+                mMudLine.append(QLatin1String(localBuffer.data() + localBufferPosition, static_cast<int>(runLength)));
+                mMudBuffer.insert(mMudBuffer.end(), runLength, incomingTextFormat());
+                localBufferPosition += runLength;
+                continue;
+            }
+        }
+
         if (localBufferPosition >= endOfLiteralEntity && mpHost->mMxpProcessor.isEnabled()) {
             if (mpHost->mServerMXPenabled) {
                 if (mpHost->mMxpProcessor.mode() != MXP_MODE_LOCKED) {
@@ -701,32 +636,47 @@ void TBuffer::translateToPlainText(std::string& incoming, const bool isFromServe
                         // Unknown entity name like &unknown; push back into buffer for codeset interpretation,
                         // but no MXP parsing.
 
-                        // We replace the already processed text with the entity value into the buffer and restart
-                        // processing it for charset encoding but with limited MXP handling
-                        size_t valueLength = mpHost->mMxpProcessor.getEntityValue().length();
-                        localBuffer.replace(0, localBufferPosition + 1, mpHost->mMxpProcessor.getEntityValue().toLatin1());
+                        // We put the entity value into the buffer, in place of the end of the already processed
+                        // text, and go back to process it for charset encoding but with limited MXP handling.
+                        // Reusing that space means that the rest of the data does not have to be moved along
+                        // for each entity - which made entity heavy text take time quadratic in its length:
+                        const QByteArray value = mpHost->mMxpProcessor.getEntityValue().toLatin1();
+                        const size_t valueLength = value.size();
+                        const bool isInsideCustomEntity = localBufferPosition < endOfMXPEntity;
+                        // This is also where the entity value will end:
+                        size_t processedLength = localBufferPosition + 1;
+                        if (valueLength > processedLength) {
+                            // Not enough room, so make some - enough for the
+                            // value or as much as there already is (whichever
+                            // is more) so that this is not needed for each
+                            // entity that follows:
+                            const size_t extraLength = std::max(valueLength - processedLength, localBuffer.length());
+                            localBuffer.insert(0, extraLength, '\0');
+                            processedLength += extraLength;
+                            endOfMXPEntity += extraLength;
+                            endOfLiteralEntity += extraLength;
+                            localBufferLength = localBuffer.length();
+                        }
+                        const size_t valueStart = processedLength - valueLength;
+                        localBuffer.replace(valueStart, valueLength, value.constData(), valueLength);
 
                         if (result == HANDLER_INSERT_ENTITY_LIT) {
-                            if (localBufferPosition < endOfMXPEntity) {
-                                // This is a special case, our unknown entity might actually be a custom one
-                                // inside a custom one which we refused to resolve to avoid an endless recursion.
-                                // So we carefully adjust the end marker s.t. custom entities are not reenabled
-                                // too early
-                                endOfMXPEntity -= localBufferPosition + 1 - valueLength;
-                                endOfLiteralEntity = valueLength;
-                            } else {
-                                endOfMXPEntity = valueLength;
+                            // If this is inside a custom entity then our unknown entity might actually be a custom
+                            // one inside a custom one which we refused to resolve to avoid an endless recursion -
+                            // so the end marker of the outer one is left where it is (as nothing after this moves)
+                            // s.t. custom entities are not reenabled too early:
+                            if (!isInsideCustomEntity) {
+                                endOfMXPEntity = processedLength;
                             }
-                            endOfLiteralEntity = valueLength;
+                            endOfLiteralEntity = processedLength;
                         } else {
                             // HANDLER_INSERT_ENTITY_CUST
-                            endOfMXPEntity = valueLength;
+                            endOfMXPEntity = processedLength;
                             endOfLiteralEntity = 0;
                         }
 
-                        // Now restart the loop to parse the newly inserted text
-                        localBufferLength = localBuffer.length();
-                        localBufferPosition = 0;
+                        // Now go back to parse the newly inserted text
+                        localBufferPosition = valueStart;
                         continue;
                     }
                     case HANDLER_INSERT_ENTITY_SYS: {
@@ -811,22 +761,11 @@ COMMIT_LINE:
             }
 
             if (!lineBuffer.back().isEmpty()) {
-                if (!mMudLine.isEmpty()) {
-                    lineBuffer << mMudLine;
-                } else {
-                    if (ch == '\r') {
-                        ++localBufferPosition;
-                        continue; //empty timer posting
-                    }
-                    lineBuffer << QString();
-                }
-                buffer.push_back(mMudBuffer);
-                timeBuffer << QTime::currentTime().toString(csmTimeStampFormat);
-                if (ch == '\xff') {
-                    promptBuffer.append(true);
-                } else {
-                    promptBuffer.append(false);
+                if (mMudLine.isEmpty() && ch == '\r') {
+                    ++localBufferPosition;
+                    continue; //empty timer posting
                 }
+                pushLine(std::move(mMudBuffer), mMudLine, currentTime(), ch == '\xff');
             } else {
                 if (!mMudLine.isEmpty()) {
                     lineBuffer.back().append(mMudLine);
@@ -838,7 +777,7 @@ COMMIT_LINE:
                     lineBuffer.back().append(QString());
                 }
                 buffer.back() = mMudBuffer;
-                timeBuffer.back() = QTime::currentTime().toString(csmTimeStampFormat);
+                timeBuffer.back() = currentTime();
                 if (ch == '\xff') {
                     promptBuffer.back() = true;
                 } else {
@@ -850,17 +789,13 @@ COMMIT_LINE:
             mMudBuffer.clear();
             const int line = lineBuffer.size() - 1;
             mpHost->mpConsole->runTriggers(line);
-            // Only use of TBuffer::wrap(), breaks up new text
-            // NOTE: it MAY have been clobbered by the trigger engine!
-            wrap(lineBuffer.size() - 1);
+            // The line is kept whole, TTextEdit wraps it to fit when it is
+            // shown, but the trigger engine MAY have put line feeds in it:
+            splitLines(lineBuffer.size() - 1);
 
             // Start a new, but empty line in the various buffers
             ++localBufferPosition;
-            std::deque<TChar> const newLine;
-            buffer.push_back(newLine);
-            lineBuffer.push_back(QString());
-            timeBuffer.push_back(QString());
-            promptBuffer << false;
+            pushLine();
             if (static_cast<int>(buffer.size()) > mLinesLimit) {
                 // Whilst we also include a call to TConsole::handleLinesOverflowEvent(...)
                 // in all other methods where the following is used (because
@@ -932,32 +867,7 @@ COMMIT_LINE:
             }
         }
 
-        const TChar::AttributeFlags attributeFlags =
-                ((mIsDefaultColor ? mBold || mpHost->mMxpClient.bold() : false) ? TChar::Bold : TChar::None)
-                | (mItalics || mpHost->mMxpClient.italic() ? TChar::Italic : TChar::None)
-                | (mOverline ? TChar::Overline : TChar::None)
-                | (mReverse ? TChar::Reverse : TChar::None)
-                | (mStrikeOut || mpHost->mMxpClient.strikeOut() ? TChar::StrikeOut : TChar::None)
-                | (mUnderline || mpHost->mMxpClient.underline() ? TChar::Underline : TChar::None)
-                | (mFastBlink ? TChar::FastBlink : (mBlink ? TChar::Blink :TChar::None))
-                | (TChar::alternateFontFlag(mAltFont))
-                | (mConcealed ? TChar::Concealed : TChar::None);
-
-        TChar c((!mIsDefaultColor && mBold) ? mForeGroundColorLight : mForeGroundColor, mBackGroundColor, attributeFlags);
-
-        if (mpHost->mMxpClient.isInLinkMode()) {
-            c.mLinkIndex = mLinkStore.getCurrentLinkID();
-            c.mFlags |= TChar::Underline;
-        }
-
-        if (mpHost->mMxpClient.hasFgColor()) {
-            c.mFgColor = mpHost->mMxpClient.getFgColor();
-        }
-
-        if (mpHost->mMxpClient.hasBgColor()) {
-            c.mBgColor = mpHost->mMxpClient.getBgColor();
-        }
-
+        const TChar c = incomingTextFormat();
         if (isTwoTCharsNeeded) {
             // CHECK: Do we need to duplicate stuff for mMXP_LINK_MODE - yes I think we do:
             mMudBuffer.push_back(c);
@@ -970,6 +880,39 @@ COMMIT_LINE:
     }
 }
 
+// The format for the next character of the text from the game, from the
+// current SGR settings and anything MXP has set:
+TChar TBuffer::incomingTextFormat()
+{
+    const TChar::AttributeFlags attributeFlags =
+            ((mIsDefaultColor ? mBold || mpHost->mMxpClient.bold() : false) ? TChar::Bold : TChar::None)
+            | (mItalics || mpHost->mMxpClient.italic() ? TChar::Italic : TChar::None)
+            | (mOverline ? TChar::Overline : TChar::None)
+            | (mReverse ? TChar::Reverse : TChar::None)
+            | (mStrikeOut || mpHost->mMxpClient.strikeOut() ? TChar::StrikeOut : TChar::None)
+            | (mUnderline || mpHost->mMxpClient.underline() ? TChar::Underline : TChar::None)
+            | (mFastBlink ? TChar::FastBlink : (mBlink ? TChar::Blink :TChar::None))
+            | (TChar::alternateFontFlag(mAltFont))
+            | (mConcealed ? TChar::Concealed : TChar::None);
+
+    TChar c((!mIsDefaultColor && mBold) ? mForeGroundColorLight : mForeGroundColor, mBackGroundColor, attributeFlags);
+
+    if (mpHost->mMxpClient.isInLinkMode()) {
+        c.mLinkIndex = mLinkStore.getCurrentLinkID();
+        c.mFlags |= TChar::Underline;
+    }
+
+    if (mpHost->mMxpClient.hasFgColor()) {
+        c.setForeground(mpHost->mMxpClient.getFgColor());
+    }
+
+    if (mpHost->mMxpClient.hasBgColor()) {
+        c.setBackground(mpHost->mMxpClient.getBgColor());
+    }
+
+    return c;
+}
+
 void TBuffer::decodeSGR38(const QStringList& parameters, bool isColonSeparated)
 {
 #if defined(DEBUG_SGR_PROCESSING)
@@ -2200,9 +2143,6 @@ void TBuffer::resetColors()
 
 void TBuffer::append(const QString& text, int sub_start, int sub_end, TChar format, int linkID)
 {
-    // CHECK: What about other Unicode line breaks, e.g. soft-hyphen:
-    const QString lineBreaks = qsl(",.- ");
-
     if (static_cast<int>(buffer.size()) > mLinesLimit) {
         shrinkBuffer();
     }
@@ -2211,15 +2151,12 @@ void TBuffer::append(const QString& text, int sub_start, int sub_end, TChar form
         // buffer is completely empty
         std::deque<TChar> newLine;
         // The ternary operator is used here to set/reset only the TChar::Echo bit in the flags:
-        const TChar c(format.mFgColor,
-                format.mBgColor,
+        const TChar c(format.foreground(),
+                format.background(),
                 (mEchoingText ? (TChar::Echo | (format.mFlags & TChar::TestMask))
                  : (format.mFlags & TChar::TestMask)));
         newLine.push_back(c);
-        buffer.push_back(newLine);
-        lineBuffer.push_back(QString());
-        timeBuffer << QTime::currentTime().toString(csmTimeStampFormat);
-        promptBuffer << false;
+        pushLine(std::move(newLine), QString(), currentTime());
         last = 0;
     }
     if (text.isEmpty()) {
@@ -2241,61 +2178,20 @@ void TBuffer::append(const QString& text, int sub_start, int sub_end, TChar form
         //FIXME <=substart+sub_end must check whether sub-ranges are still needed
         if (text.at(i) == QChar::LineFeed) {
             log(size() - 1, size() - 1);
-            std::deque<TChar> const newLine;
-            buffer.push_back(newLine);
-            lineBuffer.push_back(QString());
-            timeBuffer << csmBlankTimeStamp;
-            promptBuffer << false;
+            pushLine({}, QString(), csmContinuedTime);
             firstChar = true;
             continue;
         }
 
-        // FIXME: (I18n) Need to measure painted line width and compare that
-        // to "unit" character width (whatever we work THAT out to be)
-        // multiplied by mWrap:
-        if (lineBuffer.back().size() >= mWrapAt) {
-            for (int i = lineBuffer.back().size() - 1; i >= 0; --i) {
-                if (lineBreaks.indexOf(lineBuffer.back().at(i)) > -1) {
-                    const int linebreakPos = (i != 0) ? i + 1 : lineBuffer.back().size();
-                    const QString tmp = lineBuffer.back().mid(0, linebreakPos);
-                    const QString lineRest = lineBuffer.back().mid(linebreakPos);
-                    lineBuffer.back() = tmp;
-                    std::deque<TChar> newLine;
-
-                    int restOfLine = lineRest.size();
-                    if (restOfLine > 0) {
-                        while (restOfLine > 0) {
-                            newLine.push_front(buffer.back().back());
-                            buffer.back().pop_back();
-                            restOfLine--;
-                        }
-                    }
-
-                    buffer.push_back(newLine);
-                    if (lineRest.size() > 0) {
-                        lineBuffer.append(lineRest);
-                    } else {
-                        lineBuffer.append(QString());
-                    }
-                    timeBuffer << csmBlankTimeStamp;
-                    promptBuffer << false;
-                    log(size() - 2, size() - 2);
-                    // Was absent causing loss of all but last line of wrapped
-                    // long lines of user input and some other console displayed
-                    // text from log file.
-                    break;
-                }
-            }
-        }
         lineBuffer.back().append(text.at(i));
-        const TChar c(format.mFgColor,
-                format.mBgColor,
+        const TChar c(format.foreground(),
+                format.background(),
                 (mEchoingText ? (TChar::Echo | (format.mFlags & TChar::TestMask))
                  : (format.mFlags & TChar::TestMask)),
                 linkID);
         buffer.back().push_back(c);
         if (firstChar) {
-            timeBuffer.back() = QTime::currentTime().toString(csmTimeStampFormat);
+            timeBuffer.back() = currentTime();
             firstChar = false;
         }
     }
@@ -2312,9 +2208,6 @@ void TBuffer::append(const QString& text, int sub_start, int sub_end, TChar form
 
 void TBuffer::append(const QString& text, int sub_start, int sub_end, const QColor& fgColor, const QColor& bgColor, TChar::AttributeFlags flags, int linkID)
 {
-    // CHECK: What about other Unicode line breaks, e.g. soft-hyphen:
-    const QString lineBreaks = qsl(",.- ");
-
     if (static_cast<int>(buffer.size()) > mLinesLimit) {
         shrinkBuffer();
     }
@@ -2323,10 +2216,7 @@ void TBuffer::append(const QString& text, int sub_start, int sub_end, const QCol
         std::deque<TChar> newLine;
         const TChar c(fgColor, bgColor, (mEchoingText ? (TChar::Echo | flags) : flags));
         newLine.push_back(c);
-        buffer.push_back(newLine);
-        lineBuffer.push_back(QString());
-        timeBuffer << QTime::currentTime().toString(csmTimeStampFormat);
-        promptBuffer << false;
+        pushLine(std::move(newLine), QString(), currentTime());
         last = 0;
     }
     if (text.isEmpty()) {
@@ -2345,58 +2235,16 @@ void TBuffer::append(const QString& text, int sub_start, int sub_end, const QCol
     for (int i = sub_start; i < length; ++i) {
         if (text.at(i) == '\n') {
             log(size() - 1, size() - 1);
-            std::deque<TChar> const newLine;
-            buffer.push_back(newLine);
-            lineBuffer.push_back(QString());
-            timeBuffer << csmBlankTimeStamp;
-            promptBuffer << false;
+            pushLine({}, QString(), csmContinuedTime);
             firstChar = true;
             continue;
         }
 
-        // FIXME: (I18n) Need to measure painted line width and compare that
-        // to "unit" character width (whatever we work THAT out to be)
-        // multiplied by mWrap:
-        if (lineBuffer.back().size() >= mWrapAt) {
-            for (int i = lineBuffer.back().size() - 1; i >= 0; --i) {
-                // insert linebreak either at linebreaking character location or at last character of line
-                if (lineBreaks.indexOf(lineBuffer.back().at(i)) > -1 || i == 0) {
-                    const int linebreakPos = (i != 0) ? i + 1 : lineBuffer.back().size();
-                    const QString tmp = lineBuffer.back().mid(0, linebreakPos);
-                    const QString lineRest = lineBuffer.back().mid(linebreakPos);
-                    lineBuffer.back() = tmp;
-                    std::deque<TChar> newLine;
-
-                    int restOfLine = lineRest.size();
-                    if (restOfLine > 0) {
-                        while (restOfLine > 0) {
-                            newLine.push_front(buffer.back().back());
-                            buffer.back().pop_back();
-                            restOfLine--;
-                        }
-                    }
-
-                    buffer.push_back(newLine);
-                    if (lineRest.size() > 0) {
-                        lineBuffer.append(lineRest);
-                    } else {
-                        lineBuffer.append(QString());
-                    }
-                    timeBuffer << csmBlankTimeStamp;
-                    promptBuffer << false;
-                    log(size() - 2, size() - 2);
-                    // Was absent causing loss of all but last line of wrapped
-                    // long lines of user input and some other console displayed
-                    // text from log file.
-                    break;
-                }
-            }
-        }
         lineBuffer.back().append(text.at(i));
         const TChar c(fgColor, bgColor, (mEchoingText ? (TChar::Echo | flags) : flags), linkID);
         buffer.back().push_back(c);
         if (firstChar) {
-            timeBuffer.back() = QTime::currentTime().toString(csmTimeStampFormat);
+            timeBuffer.back() = currentTime();
             firstChar = false;
         }
     }
@@ -2423,10 +2271,7 @@ void TBuffer::appendLine(const QString& text, const int sub_start, const int sub
         std::deque<TChar> newLine;
         const TChar c(fgColor, bgColor, (mEchoingText ? (TChar::Echo | flags) : flags));
         newLine.push_back(c);
-        buffer.push_back(newLine);
-        lineBuffer.push_back(QString());
-        timeBuffer << QTime::currentTime().toString(csmTimeStampFormat);
-        promptBuffer << false;
+        pushLine(std::move(newLine), QString(), currentTime());
         lastLine = 0;
     }
 
@@ -2449,7 +2294,7 @@ void TBuffer::appendLine(const QString& text, const int sub_start, const int sub
         const TChar c(fgColor, bgColor, (mEchoingText ? (TChar::Echo | flags) : flags), linkID);
         buffer.back().push_back(c);
         if (firstChar) {
-            timeBuffer.back() = QTime::currentTime().toString(csmTimeStampFormat);
+            timeBuffer.back() = currentTime();
             firstChar = false;
         }
     }
@@ -2484,7 +2329,7 @@ bool TBuffer::insertInLine(QPoint& P, const QString& text, const TChar& format)
             buffer[y].insert(it + x + i, c);
         }
     } else {
-        appendLine(text, 0, text.size(), format.mFgColor, format.mBgColor, format.mFlags);
+        appendLine(text, 0, text.size(), format.foreground(), format.background(), format.mFlags);
     }
     return true;
 }
@@ -2520,7 +2365,7 @@ TBuffer TBuffer::copy(QPoint& P1, QPoint& P2)
             id = 0;
         }
         const QString s(lineBuffer.at(y).at(x));
-        slice.append(s, 0, 1, buffer.at(y).at(x).mFgColor, buffer.at(y).at(x).mBgColor, buffer.at(y).at(x).mFlags, id);
+        slice.append(s, 0, 1, buffer.at(y).at(x).foreground(), buffer.at(y).at(x).background(), buffer.at(y).at(x).mFlags, id);
     }
     return slice;
 }
@@ -2566,7 +2411,7 @@ void TBuffer::paste(QPoint& P, const TBuffer& chunk)
         } else {
             hasAppended = true;
             const QString s(chunk.lineBuffer.at(0).at(cx));
-            append(s, 0, 1, chunk.buffer.at(0).at(cx).mFgColor, chunk.buffer.at(0).at(cx).mBgColor, chunk.buffer.at(0).at(cx).mFlags);
+            append(s, 0, 1, chunk.buffer.at(0).at(cx).foreground(), chunk.buffer.at(0).at(cx).background(), chunk.buffer.at(0).at(cx).mFlags);
         }
     }
 
@@ -2593,7 +2438,7 @@ void TBuffer::appendBuffer(const TBuffer& chunk)
             id = 0;
         }
         const QString s(chunk.lineBuffer.at(0).at(cx));
-        append(s, 0, 1, chunk.buffer.at(0).at(cx).mFgColor, chunk.buffer.at(0).at(cx).mBgColor, chunk.buffer.at(0).at(cx).mFlags, id);
+        append(s, 0, 1, chunk.buffer.at(0).at(cx).foreground(), chunk.buffer.at(0).at(cx).background(), chunk.buffer.at(0).at(cx).mFlags, id);
     }
 
     append(QString(QChar::LineFeed), 0, 1, Qt::black, Qt::black, TChar::None);
@@ -2619,128 +2464,41 @@ int TBuffer::calculateWrapPosition(int lineNumber, int begin, int end)
     return lineSize;
 }
 
-inline int TBuffer::skipSpacesAtBeginOfLine(const int row, const int column)
+// Breaks the line wherever it contains a line feed, which is the only thing
+// that now splits a line up: however long it is it is left whole for TTextEdit
+// to wrap to fit when it is shown. Returns how many new lines have been made:
+int TBuffer::splitLines(const int startLine)
 {
-    int offset = 0;
-    int position = column;
-    const int endOfLinePosition = lineBuffer.at(row).size();
-    while (position < endOfLinePosition) {
-        if (buffer.at(row).at(position).mFlags & TChar::Echo) {
-            break;
-        }
-        if (lineBuffer.at(row).at(position) == QChar::Space) {
-            ++offset;
-        } else {
-            break;
-        }
-        position++;
-    }
-    return offset;
-}
-
-inline int TBuffer::wrap(int startLine)
-{
-    if (static_cast<int>(buffer.size()) < startLine || startLine < 0) {
+    if (static_cast<int>(buffer.size()) <= startLine || startLine < 0) {
         return 0;
     }
-    std::queue<std::deque<TChar>> queue;
-    QStringList tempList;
-    QStringList timeList;
-    QList<bool> promptList;
-    int lineCount = 0;
-    const TChar pSpace(mpConsole);
-    for (int i = startLine, total = static_cast<int>(buffer.size()); i < total; ++i) {
-        const bool isPrompt = promptBuffer[i];
-        std::deque<TChar> newLine;
-        QString lineText = "";
-        const QString time = timeBuffer[i];
-        int indent = 0;
-        if (static_cast<int>(buffer[i].size()) >= mWrapAt) {
-            for (int i3 = 0; i3 < mWrapIndent; ++i3) {
-                newLine.push_back(pSpace);
-                lineText.append(" ");
-            }
-            indent = mWrapIndent;
-        }
-        int lastSpace = 0;
-        int wrapPos = 0;
-        const int length = buffer[i].size();
-        if (length == 0) {
-            tempList.append(QString());
-            std::deque<TChar> const emptyLine;
-            queue.push(emptyLine);
-            timeList.append(time);
-        }
-        for (int i2 = 0, total = static_cast<int>(buffer[i].size()); i2 < total;) {
-            if (length - i2 > mWrapAt - indent) {
-                wrapPos = calculateWrapPosition(i, i2, i2 + mWrapAt - indent);
-                lastSpace = qMax(0, wrapPos);
-            } else {
-                lastSpace = 0;
-            }
-            const int wrapPosition = (lastSpace) ? lastSpace : (mWrapAt - indent);
-            for (int i3 = 0; i3 < wrapPosition; ++i3) {
-                if (lastSpace > 0) {
-                    if (i2 > lastSpace) {
-                        break;
-                    }
-                }
-                if (i2 >= static_cast<int>(buffer[i].size())) {
-                    break;
-                }
-                if (lineBuffer[i].at(i2) == '\n') {
-                    i2++;
-                    break;
-                }
-                newLine.push_back(buffer[i][i2]);
-                lineText.append(lineBuffer[i].at(i2));
-                i2++;
-            }
-            if (newLine.empty()) {
-                tempList.append(QString());
-                std::deque<TChar> const emptyLine;
-                queue.push(emptyLine);
-                timeList.append(QString());
-                promptList.append(false);
-            } else {
-                queue.push(newLine);
-                tempList.append(lineText);
-                timeList.append(time);
-                promptList.append(isPrompt);
+
+    int insertedLines = 0;
+    for (int i = startLine; i <= startLine + insertedLines; ++i) {
+        const int lineFeed = lineBuffer.at(i).indexOf(QChar::LineFeed);
+        if (lineFeed >= 0) {
+            // What follows the line feed, if anything, becomes the next line -
+            // which is then checked in turn:
+            std::deque<TChar> restFormat(buffer[i].begin() + lineFeed + 1, buffer[i].end());
+            const QString rest = lineBuffer.at(i).mid(lineFeed + 1);
+            buffer[i].erase(buffer[i].begin() + lineFeed, buffer[i].end());
+            lineBuffer[i].truncate(lineFeed);
+            if (!rest.isEmpty()) {
+                insertLine(i + 1, std::move(restFormat), rest, csmContinuedTime, promptBuffer.at(i));
+                ++insertedLines;
             }
-            newLine.clear();
-            lineText = "";
-            indent = 0;
-            i2 += skipSpacesAtBeginOfLine(i, i2);
         }
-        lineCount++;
-    }
-    for (int i = 0; i < lineCount; ++i) {
-        buffer.pop_back();
-        lineBuffer.pop_back();
-        timeBuffer.pop_back();
-        promptBuffer.pop_back();
-    }
 
-    const int insertedLines = queue.size() - 1;
-    while (!queue.empty()) {
-        buffer.push_back(queue.front());
-        queue.pop();
-    }
-    for (int i = 0, total = tempList.size(); i < total; ++i) {
-        if (tempList[i].size() < 1) {
-            lineBuffer.append(QString());
-            timeBuffer.append(QString());
-            promptBuffer.push_back(false);
-        } else {
-            lineBuffer.append(tempList[i]);
-            timeBuffer.append(timeList[i]);
-            promptBuffer.push_back(promptList[i]);
+        // The lines that are split off carry on from the first one, except
+        // for empty ones which have no time (and are not prompts):
+        if (i > startLine && lineBuffer.at(i).isEmpty()) {
+            timeBuffer[i] = csmNoTime;
+            promptBuffer[i] = false;
         }
     }
 
-    log(startLine, startLine + tempList.size());
-    return insertedLines > 0 ? insertedLines : 0;
+    log(startLine, startLine + insertedLines);
+    return insertedLines;
 }
 
 // This only works on the Main Console for a profile
@@ -2778,7 +2536,7 @@ void TBuffer::log(int fromLine, int toLine)
             // This only handles a single line of logged text at a time:
             linesToLog << bufferToHtml(mpHost->mIsLoggingTimestamps, i);
         } else {
-            linesToLog << ((mpHost->mIsLoggingTimestamps && !timeBuffer.at(i).isEmpty()) ? timeBuffer.at(i).left(csmTimeStampFormat.length()) : QString()) % lineBuffer.at(i) % QChar::LineFeed;
+            linesToLog << (mpHost->mIsLoggingTimestamps ? timeStamp(i) : QString()) % lineBuffer.at(i) % QChar::LineFeed;
         }
     }
 
@@ -2879,25 +2637,14 @@ int TBuffer::wrapLine(int startLine, int screenWidth, int indentSize, TChar& for
         return 0;
     }
 
-    buffer.erase(buffer.begin() + startLine);
-    lineBuffer.removeAt(startLine);
-    const QString time = timeBuffer.at(startLine);
-    timeBuffer.removeAt(startLine);
+    const qint64 time = timeBuffer.at(startLine);
     const bool isPrompt = promptBuffer.at(startLine);
-    promptBuffer.removeAt(startLine);
+    removeLines(startLine, 1);
 
     const int insertedLines = queue.size() - 1;
-    int i = 0;
-    while (!queue.empty()) {
-        buffer.insert(buffer.begin() + startLine + i, queue.front());
-        queue.pop();
-        i++;
-    }
-
     for (int i = 0, total = tempList.size(); i < total; ++i) {
-        lineBuffer.insert(startLine + i, tempList[i]);
-        timeBuffer.insert(startLine + i, time);
-        promptBuffer.insert(startLine + i, isPrompt);
+        insertLine(startLine + i, std::move(queue.front()), tempList.at(i), time, isPrompt);
+        queue.pop();
     }
     log(startLine, startLine + tempList.size() - 1);
     return insertedLines > 0 ? insertedLines : 0;
@@ -3024,16 +2771,11 @@ bool TBuffer::replaceInLine(QPoint& P_begin, QPoint& P_end, const QString& with,
 
 void TBuffer::clear()
 {
-    while (!buffer.empty()) {
-        if (!deleteLines(0, 0)) {
-            break;
-        }
-    }
-    std::deque<TChar> const newLine;
-    buffer.push_back(newLine);
-    lineBuffer << QString();
-    timeBuffer << QString();
-    promptBuffer.push_back(false);
+    // Treated as evicting all the lines so that the ids of the ones that come
+    // afterwards are never the same as any of them:
+    mLinesEvicted += static_cast<qint64>(buffer.size());
+    removeLines(0, static_cast<int>(buffer.size()));
+    pushLine();
 }
 
 bool TBuffer::deleteLine(int y)
@@ -3043,16 +2785,14 @@ bool TBuffer::deleteLine(int y)
 
 void TBuffer::shrinkBuffer()
 {
-    for (int i = 0; i < mBatchDeleteSize; ++i) {
-        lineBuffer.pop_front();
-        promptBuffer.pop_front();
-        timeBuffer.pop_front();
-        buffer.pop_front();
-        mCursorY--;
-    }
+    // The whole batch goes in one go rather than a line at a time:
+    const int batchSize = qMin(mBatchDeleteSize, static_cast<int>(buffer.size()));
+    removeLines(0, batchSize);
+    mLinesEvicted += batchSize;
+    mCursorY -= batchSize;
     // We need to adjust the search result line as some lines have now gone
     // away:
-    mpConsole->mCurrentSearchResult = qMax(0, mpConsole->mCurrentSearchResult - mBatchDeleteSize);
+    mpConsole->mCurrentSearchResult = qMax(0, mpConsole->mCurrentSearchResult - batchSize);
 
     if (mpConsole->getType() & (TConsole::MainConsole|TConsole::UserWindow|TConsole::SubConsole|TConsole::Buffer)) {
         // Signal to lua subsystem that indexes into the Console will need adjusting
@@ -3061,7 +2801,7 @@ void TBuffer::shrinkBuffer()
         bufferShrinkEvent.mArgumentTypeList.append(ARGUMENT_TYPE_STRING);
         bufferShrinkEvent.mArgumentList.append(mpConsole->mConsoleName);
         bufferShrinkEvent.mArgumentTypeList.append(ARGUMENT_TYPE_STRING);
-        bufferShrinkEvent.mArgumentList.append(QString::number(mBatchDeleteSize));
+        bufferShrinkEvent.mArgumentList.append(QString::number(batchSize));
         bufferShrinkEvent.mArgumentTypeList.append(ARGUMENT_TYPE_NUMBER);
         mpHost->raiseEvent(bufferShrinkEvent);
     }
@@ -3070,21 +2810,66 @@ void TBuffer::shrinkBuffer()
 bool TBuffer::deleteLines(int from, int to)
 {
     if ((from >= 0) && (from < static_cast<int>(buffer.size())) && (from <= to) && (to >= 0) && (to < static_cast<int>(buffer.size()))) {
-        const int delta = to - from + 1;
-
-        for (int i = from, total = from + delta; i < total; ++i) {
-            lineBuffer.removeAt(i);
-            timeBuffer.removeAt(i);
-            promptBuffer.removeAt(i);
-        }
-
-        buffer.erase(buffer.begin() + from, buffer.begin() + to + 1);
+        removeLines(from, to - from + 1);
         return true;
     } else {
         return false;
     }
 }
 
+QString TBuffer::timeStamp(const int lineNumber) const
+{
+    const qint64 time = timeBuffer.at(lineNumber);
+    if (time == csmNoTime) {
+        return QString();
+    }
+    if (time == csmContinuedTime) {
+        return csmBlankTimeStamp;
+    }
+    return QDateTime::fromMSecsSinceEpoch(time).time().toString(csmTimeStampFormat);
+}
+
+void TBuffer::pushLine(std::deque<TChar> format, const QString& text, const qint64 time, const bool isPrompt)
+{
+    buffer.push_back(std::move(format));
+    lineBuffer.append(text);
+    timeBuffer.append(time);
+    promptBuffer.append(isPrompt);
+}
+
+void TBuffer::insertLine(const int lineNumber, std::deque<TChar> format, const QString& text, const qint64 time, const bool isPrompt)
+{
+    buffer.insert(buffer.begin() + lineNumber, std::move(format));
+    lineBuffer.insert(lineNumber, text);
+    timeBuffer.insert(lineNumber, time);
+    promptBuffer.insert(lineNumber, isPrompt);
+}
+
+void TBuffer::removeLines(const int from, const int count)
+{
+    if (count < 1) {
+        return;
+    }
+
+    for (int i = from, total = from + count; i < total; ++i) {
+        mWordIndex.removeLine(lineBuffer.at(i));
+        mSearchIndex.removeLine(lineBuffer.at(i));
+    }
+    buffer.erase(buffer.begin() + from, buffer.begin() + from + count);
+    lineBuffer.erase(lineBuffer.begin() + from, lineBuffer.begin() + from + count);
+    timeBuffer.erase(timeBuffer.begin() + from, timeBuffer.begin() + from + count);
+    promptBuffer.erase(promptBuffer.begin() + from, promptBuffer.begin() + from + count);
+}
+
+int TBuffer::getLineNumberFromId(const qint64 lineId) const
+{
+    const qint64 lineNumber = lineId - mLinesEvicted;
+    if (lineNumber < 0 || lineNumber >= static_cast<qint64>(buffer.size())) {
+        return -1;
+    }
+    return static_cast<int>(lineNumber);
+}
+
 bool TBuffer::applyLink(const QPoint& P_begin, const QPoint& P_end, const QStringList& linkFunction, const QStringList& linkHint, QVector<int> luaReference)
 {
     const int x1 = P_begin.x();
@@ -3207,7 +2992,7 @@ bool TBuffer::applyFgColor(const QPoint& P_begin, const QPoint& P_end, const QCo
                     return true;
                 }
 
-                buffer.at(y).at(x++).mFgColor = newColor;
+                buffer.at(y).at(x++).setForeground(newColor);
             }
         }
         return true;
@@ -3249,7 +3034,7 @@ bool TBuffer::applyBgColor(const QPoint& P_begin, const QPoint& P_end, const QCo
                     return true;
                 }
 
-                buffer.at(y).at(x++).mBgColor = newColor;
+                buffer.at(y).at(x++).setBackground(newColor);
             }
         }
         return true;
@@ -3266,6 +3051,74 @@ QStringList TBuffer::getEndLines(int n)
     return linesList;
 }
 
+QStringList TBuffer::getCompletions(const QString& prefix, const QSet<QString>& foldedBlacklist, const int lines)
+{
+    // Only the lines that have arrived or been changed since the last time
+    // need to be gone through:
+    const int lastLine = getLastLineNumber();
+    mWordIndex.update(lineBuffer, lastLine - lines, lastLine);
+    return mWordIndex.wordsStartingWith(prefix, foldedBlacklist);
+}
+
+QList<TBuffer::SearchHit> TBuffer::findAll(const QString& text, const bool caseSensitive, const bool isRegex, QString* pErrorMessage)
+{
+    QList<SearchHit> hits;
+    if (text.isEmpty()) {
+        return hits;
+    }
+
+    // What every line with a hit must contain, when it is long enough for the
+    // index to be of use:
+    QString required = text;
+    QRegularExpression regex;
+    if (isRegex) {
+        regex.setPattern(text);
+        regex.setPatternOptions(caseSensitive ? QRegularExpression::NoPatternOption : QRegularExpression::CaseInsensitiveOption);
+        if (!regex.isValid()) {
+            if (pErrorMessage) {
+                *pErrorMessage = regex.errorString();
+            }
+            return hits;
+        }
+        required = TRegex::requiredLiteral(text);
+    }
+
+    const auto searchLine = [&](const int lineNumber) {
+        const QString& line = lineBuffer.at(lineNumber);
+        if (isRegex) {
+            auto matches = regex.globalMatch(line);
+            while (matches.hasNext()) {
+                const auto match = matches.next();
+                if (match.capturedLength()) {
+                    hits.append({lineNumber, static_cast<int>(match.capturedStart()), static_cast<int>(match.capturedLength())});
+                }
+            }
+            return;
+        }
+
+        for (int column = line.indexOf(text, 0, caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive); column > -1;
+             column = line.indexOf(text, column + 1, caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive)) {
+            hits.append({lineNumber, column, static_cast<int>(text.size())});
+        }
+    };
+
+    if (required.size() < TTrigramIndex::csmGramLength) {
+        for (int i = 0, total = lineBuffer.size(); i < total; ++i) {
+            searchLine(i);
+        }
+        return hits;
+    }
+
+    // Only the lines that have arrived or been changed since the last time
+    // need to be added to the index:
+    mSearchIndex.update(lineBuffer);
+    const auto candidates = mSearchIndex.candidateLines(required);
+    for (const int lineNumber : candidates) {
+        searchLine(lineNumber);
+    }
+    return hits;
+}
+
 // This actually only works on a SINGLE line at a time - so was restuctured to
 // reflect that in the arguments needed - with sensible defaults on all
 // arguments - the positions within the line refer to raw QChar/TChar indexes
@@ -3313,9 +3166,9 @@ QString TBuffer::bufferToHtml(const bool showTimeStamp /*= false*/, const int ro
     // then we need:
     // <span timestamp format>Timestamp (13 chars)</span><span default>___padding spaces___</span><span first chunk style>first chunk...
     // we will NOT need a closing "</span>"
-    if (showTimeStamp && !timeBuffer.at(row).isEmpty()) {
+    if (showTimeStamp && timeBuffer.at(row) != csmNoTime) {
         // TODO: formatting according to TTextEdit.cpp: if( i2 < timeOffset ) - needs updating if we allow the colours to be user set:
-        s.append(qsl("<span style=\"color: rgb(200,150,0); background: rgb(22,22,22); \">%1").arg(timeBuffer.at(row).left(csmTimeStampFormat.length())));
+        s.append(qsl("<span style=\"color: rgb(200,150,0); background: rgb(22,22,22); \">%1").arg(timeStamp(row)));
         // Set the current idea of what the formatting is so we can spot if it
         // changes:
         currentFgColor = QColor(200, 150, 0);
@@ -3343,8 +3196,8 @@ QString TBuffer::bufferToHtml(const bool showTimeStamp /*= false*/, const int ro
     for (auto cookedPos = static_cast<unsigned long>(pos); pos < lastPos; ++cookedPos, ++pos) {
         // Do we need to start a new span?
         if (firstSpan
-            || buffer.at(cookedRow).at(cookedPos).mFgColor != currentFgColor
-            || buffer.at(cookedRow).at(cookedPos).mBgColor != currentBgColor
+            || buffer.at(cookedRow).at(cookedPos).foreground() != currentFgColor
+            || buffer.at(cookedRow).at(cookedPos).background() != currentBgColor
             || (buffer.at(cookedRow).at(cookedPos).mFlags & TChar::TestMask) != currentFlags) {
 
             if (firstSpan) {
@@ -3352,8 +3205,8 @@ QString TBuffer::bufferToHtml(const bool showTimeStamp /*= false*/, const int ro
             } else {
                 s.append(QLatin1String("</span>"));
             }
-            currentFgColor = buffer.at(cookedRow).at(cookedPos).mFgColor;
-            currentBgColor = buffer.at(cookedRow).at(cookedPos).mBgColor;
+            currentFgColor = buffer.at(cookedRow).at(cookedPos).foreground();
+            currentBgColor = buffer.at(cookedRow).at(cookedPos).background();
             currentFlags = buffer.at(cookedRow).at(cookedPos).mFlags & TChar::TestMask;
 
             // clang-format off
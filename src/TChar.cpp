@@ -0,0 +1,214 @@
+/***************************************************************************
+ *   Copyright (C) 2008-2013 by Heiko Koehn - KoehnHeiko@googlemail.com    *
+ *   Copyright (C) 2014 by Ahmed Charles - acharles@outlook.com            *
+ *   Copyright (C) 2015, 2017-2018, 2020, 2022-2023, 2026 by Stephen Lyons *
+ *                                               - slysven@virginmedia.com *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include "TChar.h"
+#if !defined(TChar_Test)
+#include "TConsole.h"
+#endif
+
+#include <algorithm>
+
+TCharColorTable::TCharColorTable()
+{
+    // The first entry is the one used by a TChar that was not given any
+    // colours, it has an extra use so that it is never reused for another
+    // pair:
+    mEntries.push_back(Entry{QColorConstants::White, QColorConstants::Black, 1, false});
+    mLookup[Key{QColor(QColorConstants::White).rgba64(), QColor(QColorConstants::Black).rgba64()}].push_back(0);
+}
+
+TCharColorTable& TCharColorTable::self()
+{
+    static TCharColorTable table;
+    return table;
+}
+
+quint32 TCharColorTable::internPair(const QColor& foreground, const QColor& background)
+{
+    if (mEntries[mLastIndex].mForeground == foreground && mEntries[mLastIndex].mBackground == background) {
+        ++mEntries[mLastIndex].mUseCount;
+        return mLastIndex;
+    }
+
+    const Key key{foreground.rgba64(), background.rgba64()};
+    const auto itKey = mLookup.find(key);
+    if (itKey != mLookup.cend()) {
+        for (const auto candidate : itKey->second) {
+            if (mEntries[candidate].mForeground == foreground && mEntries[candidate].mBackground == background) {
+                ++mEntries[candidate].mUseCount;
+                mLastIndex = candidate;
+                return candidate;
+            }
+        }
+    }
+
+    quint32 index = takeFreeIndex();
+    if (index) {
+        mEntries[index].mForeground = foreground;
+        mEntries[index].mBackground = background;
+        mEntries[index].mUseCount = 1;
+    } else {
+        index = static_cast<quint32>(mEntries.size());
+        mEntries.push_back(Entry{foreground, background, 1, false});
+    }
+    mLookup[key].push_back(index);
+    mLastIndex = index;
+    return index;
+}
+
+void TCharColorTable::releaseEntry(const quint32 index)
+{
+    auto& entry = mEntries[index];
+    if (!--entry.mUseCount && !entry.mIsFree) {
+        entry.mIsFree = true;
+        mFreeIndexes.push_back(index);
+    }
+}
+
+// Returns an entry that is not in use, with it taken out of the lookup, or 0
+// (which is never free) if there are none:
+quint32 TCharColorTable::takeFreeIndex()
+{
+    while (!mFreeIndexes.empty()) {
+        const quint32 index = mFreeIndexes.back();
+        mFreeIndexes.pop_back();
+        auto& entry = mEntries[index];
+        entry.mIsFree = false;
+        if (entry.mUseCount) {
+            // It was looked up again after it was released:
+            continue;
+        }
+
+        const auto itKey = mLookup.find(Key{entry.mForeground.rgba64(), entry.mBackground.rgba64()});
+        if (itKey != mLookup.end()) {
+            auto& candidates = itKey->second;
+            candidates.erase(std::remove(candidates.begin(), candidates.end(), index), candidates.end());
+            if (candidates.empty()) {
+                mLookup.erase(itKey);
+            }
+        }
+        return index;
+    }
+    return 0;
+}
+
+TChar::TChar(const QColor& foreground, const QColor& background, const TChar::AttributeFlags flags, const int linkIndex)
+: mColors(TCharColorTable::intern(foreground, background))
+, mFlags(flags)
+, mLinkIndex(linkIndex)
+{
+}
+
+// Without a console this gets the default colours of the first entry in the
+// TCharColorTable:
+TChar::TChar(TConsole* pC)
+{
+#if !defined(TChar_Test)
+    if (pC) {
+        mColors = pC->mFormatCurrent.mColors;
+        mFlags = pC->mFormatCurrent.allDisplayAttributes();
+    }
+#else
+    Q_UNUSED(pC)
+#endif
+    TCharColorTable::addRef(mColors);
+}
+
+// Note: this operator compares ALL aspects of 'this' against 'other' which may
+// not be wanted in every case:
+bool TChar::operator==(const TChar& other)
+{
+    if (mIsSelected != other.mIsSelected) {
+        return false;
+    }
+    if (mLinkIndex != other.mLinkIndex) {
+        return false;
+    }
+    if (mColors != other.mColors) {
+        return false;
+    }
+    if (mFlags != other.mFlags) {
+        return false;
+    }
+    return true;
+}
+
+// Copy constructor - because it is resetting the mIsSelected flag it is NOT a
+// default copy constructor:
+TChar::TChar(const TChar& copy)
+: mColors(copy.mColors)
+, mFlags(copy.mFlags)
+, mIsSelected(false)
+, mLinkIndex(copy.mLinkIndex)
+{
+    TCharColorTable::addRef(mColors);
+}
+
+// Unlike the copy constructor this does carry over the mIsSelected flag, as
+// the default one that it replaces did:
+TChar& TChar::operator=(const TChar& other)
+{
+    if (mColors != other.mColors) {
+        TCharColorTable::addRef(other.mColors);
+        TCharColorTable::release(mColors);
+        mColors = other.mColors;
+    }
+    mFlags = other.mFlags;
+    mIsSelected = other.mIsSelected;
+    mLinkIndex = other.mLinkIndex;
+    return *this;
+}
+
+quint8 TChar::alternateFont() const
+{
+    // As this is the most likely case check it first:
+    if (!(mFlags & AltFontMask)) {
+        return 0;
+    }
+
+    if (mFlags & AltFont9) {
+        return 9;
+    }
+    if (mFlags & AltFont8) {
+        return 8;
+    }
+    if (mFlags & AltFont7) {
+        return 7;
+    }
+    if (mFlags & AltFont6) {
+        return 6;
+    }
+    if (mFlags & AltFont5) {
+        return 5;
+    }
+    if (mFlags & AltFont4) {
+        return 4;
+    }
+    if (mFlags & AltFont3) {
+        return 3;
+    }
+    if (mFlags & AltFont2) {
+        return 2;
+    }
+    return 1;
+}
@@ -0,0 +1,371 @@
+#ifndef MUDLET_TCHAR_H
+#define MUDLET_TCHAR_H
+
+/***************************************************************************
+ *   Copyright (C) 2008-2013 by Heiko Koehn - KoehnHeiko@googlemail.com    *
+ *   Copyright (C) 2014 by Ahmed Charles - acharles@outlook.com            *
+ *   Copyright (C) 2015, 2017-2018, 2020, 2022-2023, 2026 by Stephen Lyons *
+ *                                               - slysven@virginmedia.com *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include "utils.h"
+
+#include "pre_guard.h"
+#include <QColor>
+#include <QDebug>
+#include <QFlags>
+#include <QString>
+#include <QStringList>
+#include "post_guard.h"
+
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+class TConsole;
+
+// The palette of the distinct foreground/background colour pairs used by all
+// the TChars in the application; each TChar only holds the (four byte) index
+// of its pair in here instead of the two (sixteen byte) QColors themselves.
+// Each entry counts the TChars using it and once there are none it is reused
+// for the next new pair, so the table only ever has as many entries as there
+// are pairs in use at once (in practice a few hundred) rather than growing
+// with every colour seen for the life of the application. It is only ever
+// touched from the main thread.
+class TCharColorTable
+{
+public:
+    // The index returned has already been counted as used by the caller:
+    static quint32 intern(const QColor& foreground, const QColor& background) { return self().internPair(foreground, background); }
+    static void addRef(const quint32 index) { ++self().mEntries[index].mUseCount; }
+    static void release(const quint32 index) { self().releaseEntry(index); }
+    static const QColor& foreground(const quint32 index) { return self().mEntries[index].mForeground; }
+    static const QColor& background(const quint32 index) { return self().mEntries[index].mBackground; }
+    static int size() { return static_cast<int>(self().mEntries.size()); }
+
+private:
+    struct Entry
+    {
+        QColor mForeground;
+        QColor mBackground;
+        quint32 mUseCount = 0;
+        // Whether it is in mFreeIndexes - it may have been used again since
+        // it was put there:
+        bool mIsFree = false;
+    };
+    struct Key
+    {
+        quint64 foreground;
+        quint64 background;
+        bool operator==(const Key& other) const { return foreground == other.foreground && background == other.background; }
+    };
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const { return std::hash<quint64>()(key.foreground) ^ (std::hash<quint64>()(key.background) * 31); }
+    };
+
+    TCharColorTable();
+    static TCharColorTable& self();
+    quint32 internPair(const QColor& foreground, const QColor& background);
+    void releaseEntry(const quint32 index);
+    quint32 takeFreeIndex();
+
+    // A std::deque so that the references handed out by foreground(...) and
+    // background(...) are not invalidated when more entries are added:
+    std::deque<Entry> mEntries;
+    // Keyed on the 64-bit RGBA values, there can be more than one entry for
+    // a key when QColors with different specs convert to the same value:
+    std::unordered_map<Key, std::vector<quint32>, KeyHash> mLookup;
+    // Entries that no TChar was using when they were released:
+    std::vector<quint32> mFreeIndexes;
+    // Text nearly always arrives in runs of the same colours so the last one
+    // looked up is remembered to save hashing the colours for every
+    // character:
+    quint32 mLastIndex = 0;
+};
+
+class TChar
+{
+    friend class TBuffer;
+
+public:
+    enum AttributeFlag {
+        None = 0x0,
+        // Replaces TCHAR_BOLD 2
+        Bold = 0x1,                   // 0000 0000 0000 0000 0000 0000 0000 0001
+        // Replaces TCHAR_ITALICS 1
+        Italic = 0x2,                 // 0000 0000 0000 0000 0000 0000 0000 0010
+        // Replaces TCHAR_UNDERLINE 4
+        Underline = 0x4,              // 0000 0000 0000 0000 0000 0000 0000 0100
+        // ANSI CSI SGR Overline (53 on, 55 off)
+        Overline = 0x8,               // 0000 0000 0000 0000 0000 0000 0000 1000
+        // Replaces TCHAR_STRIKEOUT 32
+        StrikeOut = 0x10,             // 0000 0000 0000 0000 0000 0000 0001 0000
+        // NOT a replacement for TCHAR_INVERSE, that is now covered by the
+        // separate isSelected bool but they must be EX-ORed at the point of
+        // painting the Character
+        Reverse = 0x20,               // 0000 0000 0000 0000 0000 0000 0010 0000
+        // Flashing less than 150 times a minute:
+        Blink = 0x40,                 // 0000 0000 0000 0000 0000 0000 0100 0000
+        // Flashing at least 150 times a minute:
+        FastBlink = 0x80,             // 0000 0000 0000 0000 0000 0000 1000 0000
+        // Alternate fonts 1 to 9 from SGR 11 m to SGR 19 m; we flag each one
+        // separately so that trigger processing can select them individually
+        // which could not be done should they be rolled up into just 4 bits.
+        // As one can only be active at a time only the highest one should be
+        // used if/when we can actually paint different fonts in a TConsole at
+        // the same time; currently there is no MUD standard to specify what the
+        // alternatives are:
+        AltFont1 = 0x00100,           // 0000 0000 0000 0000 0000 0001 0000 0000
+        AltFont2 = 0x00200,           // 0000 0000 0000 0000 0000 0010 0000 0000
+        AltFont3 = 0x00400,           // 0000 0000 0000 0000 0000 0100 0000 0000
+        AltFont4 = 0x00800,           // 0000 0000 0000 0000 0000 1000 0000 0000
+        AltFont5 = 0x01000,           // 0000 0000 0000 0000 0001 0000 0000 0000
+        AltFont6 = 0x02000,           // 0000 0000 0000 0000 0010 0000 0000 0000
+        AltFont7 = 0x04000,           // 0000 0000 0000 0000 0100 0000 0000 0000
+        AltFont8 = 0x08000,           // 0000 0000 0000 0000 1000 0000 0000 0000
+        AltFont9 = 0x10000,           // 0000 0000 0000 0001 0000 0000 0000 0000
+        // From SGR 8 m; however there is no MUD standard protocol to control
+        // when we should show concealed text.
+        Concealed = 0x20000,          // 0000 0000 0000 0010 0000 0000 0000 0000
+        // Mask for "is flashing" at any rate - will return a logical true
+        // should either of the above be set - should both be set then FastBlink
+        // should take preference over Blink:
+        BlinkMask = 0xC0,             // 0000 0000 0000 0000 0000 0000 1100 0000
+        // Mask for "any alternate font" - only the most significant one should
+        // be used if more than one is set:
+        AltFontMask = 0x1ff00,        // 0000 0000 0000 0001 1111 1111 0000 0000
+        TestMask = 0x3ffff,           // 0000 0000 0000 0011 1111 1111 1111 1111
+        // The remainder are internal use ones that do not related to SGR codes
+        // that have been parsed from the incoming text.
+        // Has been found in a search operation (currently Main Console only)
+        // and has been given a highlight to indicate that:
+        Found = 0x100000,             // 0000 0000 0001 0000 0000 0000 0000 0000
+        // Replaces TCHAR_ECHO 16
+        Echo = 0x200000               // 0000 0000 0010 0000 0000 0000 0000 0000
+    };
+    Q_DECLARE_FLAGS(AttributeFlags, AttributeFlag)
+
+    // Not a default constructor - the defaulted argument means it could have
+    // been used if supplied with no arguments, but the 'explicit' prevents
+    // this:
+    explicit TChar(TConsole* pC = nullptr);
+    // Another non-default constructor:
+    TChar(const QColor& foreground, const QColor& background, const TChar::AttributeFlags flags = TChar::None, const int linkIndex = 0);
+    // User defined copy-constructor:
+    TChar(const TChar&);
+    // Under the rule of three, because we have a user defined copy-constructor,
+    // we should also have a destructor and an assignment operator - and they
+    // have to keep the count of the users of the colour table entries:
+    TChar& operator=(const TChar&);
+    ~TChar() { TCharColorTable::release(mColors); }
+
+    bool operator==(const TChar&);
+    void setColors(const QColor& newForeGroundColor, const QColor& newBackGroundColor) { setColorIndex(TCharColorTable::intern(newForeGroundColor, newBackGroundColor)); }
+    // Only considers the following flags: AltFont#, Bold, Conceal,
+    // FastBlink/Blink, Italic, Overline, Reverse, Strikeout, Underline,
+    // - does not consider Echo or Found:
+    void setAllDisplayAttributes(const AttributeFlags newDisplayAttributes) { mFlags = (mFlags & ~TestMask) | (newDisplayAttributes & TestMask); }
+    void setForeground(const QColor& newColor) { setColorIndex(TCharColorTable::intern(newColor, background())); }
+    void setBackground(const QColor& newColor) { setColorIndex(TCharColorTable::intern(foreground(), newColor)); }
+    void setTextFormat(const QColor& newFgColor, const QColor& newBgColor, const AttributeFlags newDisplayAttributes) {
+        setColors(newFgColor, newBgColor);
+        setAllDisplayAttributes(newDisplayAttributes);
+    }
+
+    const QColor& foreground() const { return TCharColorTable::foreground(mColors); }
+    const QColor& background() const { return TCharColorTable::background(mColors); }
+    // Two TChars have the same colours if, and only if, these are the same:
+    quint32 colorIndex() const { return mColors; }
+    AttributeFlags allDisplayAttributes() const { return mFlags & TestMask; }
+    void select() { mIsSelected = true; }
+    void deselect() { mIsSelected = false; }
+    bool isSelected() const { return mIsSelected; }
+    int linkIndex () const { return mLinkIndex; }
+    bool isBold() const { return mFlags & Bold; }
+    bool isItalic() const { return mFlags & Italic; }
+    bool isUnderlined() const { return mFlags & Underline; }
+    bool isOverlined() const { return mFlags & Overline; }
+    bool isStruckOut() const { return mFlags & StrikeOut; }
+    bool isReversed() const { return mFlags & Reverse; }
+    bool isFound() const { return mFlags & Found; }
+    // Special case - if fast blink is set then do NOT say that blink is set to
+    // preserve priority of the former over the latter:
+    bool isBlinking() const { return (mFlags & FastBlink) ? false : (mFlags & Blink); }
+    bool isFastBlinking() const { return mFlags & FastBlink; }
+    quint8 alternateFont() const;
+    static TChar::AttributeFlag alternateFontFlag(const quint8 altFontNumber) {
+        switch (altFontNumber) {
+        case 1: return AltFont1;
+        case 2: return AltFont2;
+        case 3: return AltFont3;
+        case 4: return AltFont4;
+        case 5: return AltFont5;
+        case 6: return AltFont6;
+        case 7: return AltFont7;
+        case 8: return AltFont8;
+        case 9: return AltFont9;
+        default:
+            Q_ASSERT_X(altFontNumber < 10, "alternateFontFlag", "value out of range 0 to 9");
+            return None;
+        }
+    }
+    static QString attributeType(const AttributeFlag flag) {
+        switch (flag) {
+        case None:
+            return qsl("None");
+        case Bold:
+            return qsl("Bold");
+        case Italic:
+            return qsl("Italic");
+        case Underline:
+            return qsl("Underline");
+        case Overline:
+            return qsl("Overline");
+        case StrikeOut:
+            return qsl("StrikeOut");
+        case Reverse:
+            return qsl("Reverse");
+        case Blink:
+            return qsl("Blink");
+        case FastBlink:
+            return qsl("FastBlink");
+        case AltFont1:
+            return qsl("AltFont1");
+        case AltFont2:
+            return qsl("AltFont2");
+        case AltFont3:
+            return qsl("AltFont3");
+        case AltFont4:
+            return qsl("AltFont4");
+        case AltFont5:
+            return qsl("AltFont5");
+        case AltFont6:
+            return qsl("AltFont6");
+        case AltFont7:
+            return qsl("AltFont7");
+        case AltFont8:
+            return qsl("AltFont8");
+        case AltFont9:
+            return qsl("AltFont9");
+        case Concealed:
+            return qsl("Concealed");
+        default:
+            return qsl("Unknown");
+        }
+    }
+
+private:
+    // Takes over the use of the (already counted) new entry from intern(...):
+    void setColorIndex(const quint32 index)
+    {
+        TCharColorTable::release(mColors);
+        mColors = index;
+    }
+
+    // Index into the TCharColorTable, rather than a pair of QColors, as there
+    // can be millions of these in the buffers of a profile:
+    quint32 mColors = 0;
+    AttributeFlags mFlags = None;
+    // Kept as a separate flag because it must often be handled separately
+    bool mIsSelected = false;
+    int mLinkIndex = 0;
+};
+Q_DECLARE_OPERATORS_FOR_FLAGS(TChar::AttributeFlags)
+
+#ifndef QT_NO_DEBUG_STREAM
+// Dumper for the TChar::AttributeFlags - so that qDebug gives a detailed broken
+// down results when presented with the value rather than just a hex value.
+// Note "inline" is REQUIRED:
+inline QDebug& operator<<(QDebug& debug, const TChar::AttributeFlags& attributes)
+{
+    const QDebugStateSaver saver(debug);
+    QString result = QLatin1String("TChar::AttributeFlags(");
+    QStringList presentAttributes;
+    if (attributes & TChar::Bold) {
+        presentAttributes << QLatin1String("Bold (0x01)");
+    }
+    if (attributes & TChar::Italic) {
+        presentAttributes << QLatin1String("Italic (0x02)");
+    }
+    if (attributes & TChar::Underline) {
+        presentAttributes << QLatin1String("Underline (0x04)");
+    }
+    if (attributes & TChar::Overline) {
+        presentAttributes << QLatin1String("Overline (0x08)");
+    }
+    if (attributes & TChar::StrikeOut) {
+        presentAttributes << QLatin1String("StrikeOut (0x10)");
+    }
+    if (attributes & TChar::Reverse) {
+        presentAttributes << QLatin1String("Reverse (0x20)");
+    }
+    if (attributes & TChar::Blink) {
+        presentAttributes << QLatin1String("Blink (0x40)");
+    }
+    if (attributes & TChar::FastBlink) {
+        presentAttributes << QLatin1String("FastBlink (0x80)");
+    }
+    if (attributes & TChar::AltFont1) {
+        presentAttributes << QLatin1String("AltFont1 (0x100)");
+    }
+    if (attributes & TChar::AltFont2) {
+        presentAttributes << QLatin1String("AltFont2 (0x200)");
+    }
+    if (attributes & TChar::AltFont3) {
+        presentAttributes << QLatin1String("AltFont3 (0x400)");
+    }
+    if (attributes & TChar::AltFont4) {
+        presentAttributes << QLatin1String("AltFont4 (0x800)");
+    }
+    if (attributes & TChar::AltFont5) {
+        presentAttributes << QLatin1String("AltFont5 (0x1000)");
+    }
+    if (attributes & TChar::AltFont6) {
+        presentAttributes << QLatin1String("AltFont6 (0x2000)");
+    }
+    if (attributes & TChar::AltFont7) {
+        presentAttributes << QLatin1String("AltFont7 (0x4000)");
+    }
+    if (attributes & TChar::AltFont8) {
+        presentAttributes << QLatin1String("AltFont8 (0x8000)");
+    }
+    if (attributes & TChar::AltFont9) {
+        presentAttributes << QLatin1String("AltFont9 (0x10000)");
+    }
+    if (attributes & TChar::Concealed) {
+        presentAttributes << QLatin1String("AltFont9 (0x20000)");
+    }
+    if (attributes & TChar::Found) {
+        presentAttributes << QLatin1String("Found (0x100000)");
+    }
+    if (attributes & TChar::Echo) {
+        presentAttributes << QLatin1String("Echo (0x200000)");
+    }
+    if (presentAttributes.isEmpty()) {
+        result.append(QLatin1String("None (0x0))"));
+    } else {
+        result.append(presentAttributes.join(QLatin1String(", ")).append(QLatin1String(")")));
+    }
+    debug.nospace().noquote() << result;
+    return debug;
+}
+#endif // QT_NO_DEBUG_STREAM
+
+#endif // MUDLET_TCHAR_H
@@ -1002,82 +1002,65 @@ void TCommandLine::handleTabCompletion(bool direction)
         mUserKeptOnTyping = false;
         mTabCompletionCount = -1;
     }
-    int amount = mpHost->mpConsole->buffer.size();
-    if (amount > 500) {
-        amount = 500;
-    }
-
-    const QStringList bufferList = mpHost->mpConsole->buffer.getEndLines(amount);
-    QString buffer = bufferList.join(QChar::Space);
-
-    buffer.replace(QChar(0x21af), QChar::LineFeed);
-    buffer.replace(QChar::LineFeed, QChar::Space);
-
-    QStringList wordList = buffer.split(QRegularExpression(qsl(R"(\b)"), QRegularExpression::UseUnicodePropertiesOption), Qt::SkipEmptyParts);
-    wordList.append(commandLineSuggestions.values()); // hindsight 20/20 I do not need to split this to a separate table, a check to not append buffer to this table and only append suggested list does same thing for far less overhead.
-    const QStringList blacklist = tabCompleteBlacklist.values();
-    QStringList toDelete;
-
-    for (const QString& wstr : std::as_const(wordList)) {
-        if (blacklist.contains(wstr, Qt::CaseInsensitive)) {
-            toDelete += wstr;
-        }
-    }
-    for (const QString& dstr : std::as_const(toDelete)) {
-        wordList.removeAll(dstr);
-    }
-
     if (direction) {
         mTabCompletionCount++;
     } else {
         mTabCompletionCount--;
     }
-    if (!wordList.empty()) {
-        if (mTabCompletionTyped.endsWith(QChar::Space)) {
-            return;
-        }
-        QString lastWord;
-        const QRegularExpression reg = QRegularExpression(qsl(R"(\b(\w+)$)"), QRegularExpression::UseUnicodePropertiesOption);
-        const QRegularExpressionMatch match = reg.match(mTabCompletionTyped);
-        const int typePosition = match.capturedStart();
-        if (reg.captureCount() >= 1) {
-            lastWord = match.captured(1);
-        } else {
-            lastWord = QString();
-        }
+    if (mTabCompletionTyped.endsWith(QChar::Space)) {
+        return;
+    }
+
+    QString lastWord;
+    const QRegularExpression reg = QRegularExpression(qsl(R"(\b(\w+)$)"), QRegularExpression::UseUnicodePropertiesOption);
+    const QRegularExpressionMatch match = reg.match(mTabCompletionTyped);
+    const int typePosition = match.capturedStart();
+    if (reg.captureCount() >= 1) {
+        lastWord = match.captured(1);
+    } else {
+        lastWord = QString();
+    }
 
-        QStringList filterList = wordList.filter(QRegularExpression(qsl(R"(^%1\w+)").arg(lastWord), QRegularExpression::CaseInsensitiveOption | QRegularExpression::UseUnicodePropertiesOption));
+    QSet<QString> blacklist;
+    for (const QString& word : std::as_const(tabCompleteBlacklist)) {
+        blacklist.insert(TWordIndex::fold(word));
+    }
 
-        if (filterList.empty()) {
-            return;
+    // The suggestions come first, then the words from the last 500 lines of
+    // the main console, the most recently seen first:
+    QStringList filterList;
+    QSet<QString> suggested;
+    const QRegularExpression suggestionFilter(qsl(R"(^%1\w+)").arg(lastWord), QRegularExpression::CaseInsensitiveOption | QRegularExpression::UseUnicodePropertiesOption);
+    for (const QString& suggestion : std::as_const(commandLineSuggestions)) {
+        if (suggestionFilter.match(suggestion).hasMatch() && !blacklist.contains(TWordIndex::fold(suggestion))) {
+            filterList.append(suggestion);
+            suggested.insert(suggestion);
         }
-        int offset = 0;
-        forever {
-            const QString tmp = filterList.back();
-            filterList.removeAll(tmp);
-            filterList.insert(offset, tmp);
-            ++offset;
-            if (offset >= filterList.size()) {
-                break;
-            }
+    }
+    const QStringList words = mpHost->mpConsole->buffer.getCompletions(lastWord, blacklist, 500);
+    for (const QString& word : words) {
+        if (!suggested.contains(word)) {
+            filterList.append(word);
         }
+    }
 
-        if (!filterList.empty()) {
-            if (mTabCompletionCount >= filterList.size()) {
-                mTabCompletionCount = filterList.size() - 1;
-            }
-            if (mTabCompletionCount < 0) {
-                mTabCompletionCount = 0;
-            }
+    if (filterList.empty()) {
+        return;
+    }
 
-            const QString proposal = filterList[mTabCompletionCount];
-            const QString userWords = mTabCompletionTyped.left(typePosition);
-            setPlainText(QString(userWords + proposal));
-            mudlet::self()->announce(proposal);
-            moveCursor(QTextCursor::End, QTextCursor::MoveAnchor);
-            mTabCompletionOld = toPlainText();
-        }
+    if (mTabCompletionCount >= filterList.size()) {
+        mTabCompletionCount = filterList.size() - 1;
     }
+    if (mTabCompletionCount < 0) {
+        mTabCompletionCount = 0;
+    }
+
+    const QString proposal = filterList[mTabCompletionCount];
+    const QString userWords = mTabCompletionTyped.left(typePosition);
+    setPlainText(QString(userWords + proposal));
+    mudlet::self()->announce(proposal);
+    moveCursor(QTextCursor::End, QTextCursor::MoveAnchor);
+    mTabCompletionOld = toPlainText();
 }
 
 // Hitting the cursor up key gets you in autocompletion mode.
@@ -1101,8 +1084,7 @@ void TCommandLine::handleAutoCompletion()
         mAutoCompletionCount = 0;
     }
     for (int i = mAutoCompletionCount; i < mHistoryList.size(); i++) {
-        const QString h = mHistoryList[i].mid(0, neu.size());
-        if (neu == h) {
+        if (mHistoryList.at(i).startsWith(neu)) {
             mAutoCompletionCount = i;
             mLastCompletion = mHistoryList[i];
             setPlainText(mHistoryList[i]);
@@ -53,6 +53,8 @@
 #include <QPainter>
 #include "post_guard.h"
 
+#include <algorithm>
+
 const QString TConsole::cmLuaLineVariable("line");
 
 // A high-performance text widget with split screen ability for scrolling back
@@ -1003,8 +1005,7 @@ void TConsole::scrollDown(int lines)
     }
 
     mUpperPane->scrollDown(lines);
-    if (!mUpperPane->mIsTailMode &&
-        (mUpperPane->imageTopLine() + mUpperPane->getScreenHeight() >= buffer.lineBuffer.size() - mLowerPane->getRowCount())) {
+    if (!mUpperPane->mIsTailMode && mUpperPane->rowsBelowScreen() <= mLowerPane->getRowCount()) {
         mUpperPane->scrollDown(mLowerPane->getRowCount() + 100); // Gets to the bottom
         mUpperPane->scrollDown(100);                             // needs another scroll to force mIsTailMode
     }
@@ -1130,7 +1131,7 @@ void TConsole::insertLink(const QString& text, QStringList& func, QStringList& h
             buffer.applyLink(P, P2, func, hint, luaReference);
             if (text.indexOf("\n") != -1) {
                 const int y_tmp = mUserCursor.y();
-                const int down = buffer.wrapLine(mUserCursor.y(), mpHost->mScreenWidth, mpHost->mWrapIndentCount, mFormatCurrent);
+                const int down = buffer.splitLines(mUserCursor.y());
                 mUpperPane->needUpdate(y_tmp, y_tmp + down + 1);
                 const int y_neu = y_tmp + down;
                 const int x_adjust = text.lastIndexOf("\n");
@@ -1167,7 +1168,7 @@ void TConsole::insertText(const QString& text, QPoint P)
             buffer.insertInLine(mUserCursor, text, mFormatCurrent);
             const int y_tmp = mUserCursor.y();
             if (text.indexOf(QChar::LineFeed) != -1) {
-                const int down = buffer.wrapLine(y_tmp, mpHost->mScreenWidth, mpHost->mWrapIndentCount, mFormatCurrent);
+                const int down = buffer.splitLines(y_tmp);
                 mUpperPane->needUpdate(y_tmp, y_tmp + down + 1);
             } else {
                 mUpperPane->needUpdate(y_tmp, y_tmp + 1);
@@ -1680,7 +1681,7 @@ void TConsole::printCommand(QString& msg)
                 QPoint P(promptEnd, lineBeforeNewContent);
                 const TChar format(mCommandFgColor, mCommandBgColor);
                 buffer.insertInLine(P, msg, format);
-                const int down = buffer.wrapLine(lineBeforeNewContent, mpHost->mScreenWidth, mpHost->mWrapIndentCount, mFormatCurrent);
+                const int down = buffer.splitLines(lineBeforeNewContent);
 
                 mUpperPane->needUpdate(lineBeforeNewContent, lineBeforeNewContent + 1 + down);
                 mLowerPane->needUpdate(lineBeforeNewContent, lineBeforeNewContent + 1 + down);
@@ -1825,25 +1826,14 @@ void TConsole::slot_searchBufferUp()
         return;
     }
 
-    bool found = false;
-    for (int searchY = mCurrentSearchResult - 1; searchY >= 0; --searchY) {
-        int searchX = -1;
-        do {
-            searchX = buffer.lineBuffer[searchY].indexOf(mSearchQuery, searchX + 1, ((mSearchOptions & SearchOptionCaseSensitive) ? Qt::CaseSensitive : Qt::CaseInsensitive));
-            if (searchX > -1) {
-                buffer.applyAttribute(QPoint(searchX, searchY), QPoint(searchX + mSearchQuery.size(), searchY), TChar::Found, true);
-                found = true;
-            }
-        } while (searchX > -1);
-
-        if (found) {
-            scrollUp(buffer.mCursorY - searchY - 3);
-            mUpperPane->forceUpdate();
-            mCurrentSearchResult = searchY;
-            return;
-        }
+    const auto hits = buffer.findAll(mSearchQuery, mSearchOptions & SearchOptionCaseSensitive);
+    // The last line before the current result that has any:
+    const auto next = std::lower_bound(hits.cbegin(), hits.cend(), mCurrentSearchResult, [](const TBuffer::SearchHit& hit, const int line) { return hit.mLine < line; });
+    if (next == hits.cbegin()) {
+        print(qsl("%1\n").arg(tr("No search results, sorry!")));
+        return;
     }
-    print(qsl("%1\n").arg(tr("No search results, sorry!")));
+    showSearchHits(hits, std::prev(next)->mLine);
 }
 
 void TConsole::slot_searchBufferDown()
@@ -1860,25 +1850,27 @@ void TConsole::slot_searchBufferDown()
         return;
     }
 
-    bool found = false;
-    for (int searchY = mCurrentSearchResult + 1; searchY < buffer.lineBuffer.size(); ++searchY) {
-        int searchX = -1;
-        do {
-            searchX = buffer.lineBuffer[searchY].indexOf(mSearchQuery, searchX + 1, ((mSearchOptions & SearchOptionCaseSensitive) ? Qt::CaseSensitive : Qt::CaseInsensitive));
-            if (searchX > -1) {
-                buffer.applyAttribute(QPoint(searchX, searchY), QPoint(searchX + mSearchQuery.size(), searchY), TChar::Found, true);
-                found = true;
-            }
-        } while (searchX > -1);
+    const auto hits = buffer.findAll(mSearchQuery, mSearchOptions & SearchOptionCaseSensitive);
+    // The first line after the current result that has any:
+    const auto next = std::upper_bound(hits.cbegin(), hits.cend(), mCurrentSearchResult, [](const int line, const TBuffer::SearchHit& hit) { return line < hit.mLine; });
+    if (next == hits.cend()) {
+        print(qsl("%1\n").arg(tr("No search results, sorry!")));
+        return;
+    }
+    showSearchHits(hits, next->mLine);
+}
 
-        if (found) {
-            scrollUp(buffer.mCursorY - searchY - 3);
-            mUpperPane->forceUpdate();
-            mCurrentSearchResult = searchY;
-            return;
+// Highlights all the hits in the line and scrolls to it:
+void TConsole::showSearchHits(const QList<TBuffer::SearchHit>& hits, const int lineNumber)
+{
+    for (const auto& hit : hits) {
+        if (hit.mLine == lineNumber) {
+            buffer.applyAttribute(QPoint(hit.mColumn, lineNumber), QPoint(hit.mColumn + hit.mLength, lineNumber), TChar::Found, true);
         }
     }
-    print(qsl("%1\n").arg(tr("No search results, sorry!")));
+    scrollUp(mUpperPane->rowsUpToLine(lineNumber + 3));
+    mUpperPane->forceUpdate();
+    mCurrentSearchResult = lineNumber;
 }
 
 QSize TConsole::getMainWindowSize() const
@@ -330,6 +330,7 @@ private slots:
 
 private:
     void createSearchOptionIcon();
+    void showSearchHits(const QList<TBuffer::SearchHit>&, const int lineNumber);
 
     ConsoleType mType = UnknownType;
     QSize mOldSize;
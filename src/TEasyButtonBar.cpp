@@ -171,6 +171,7 @@ void TEasyButtonBar::slot_pressed(const bool isChecked)
     if (pA->mIsPushDownButton) {
         // DO NOT MANIPULATE THE BUTTON STATE OURSELF NOW
         pA->mButtonState = isChecked;
+        pA->setUnsaved();
         pA->mpHost->mpConsole->mButtonState = (pA->mButtonState ? 2 : 1);
     } else {
         pA->mButtonState = false;                // Forces a fixup if not correct
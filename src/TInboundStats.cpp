@@ -0,0 +1,117 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include "TInboundStats.h"
+
+#include "utils.h"
+
+#include "pre_guard.h"
+#include <QStringList>
+#include "post_guard.h"
+
+void TInboundStats::start()
+{
+    mStageNanoseconds.fill(0);
+    mBytes = 0;
+    mLines = 0;
+    mTotalNanoseconds = 0;
+    mCurrent = None;
+    mMark = 0;
+    mActive = true;
+    mTimer.start();
+}
+
+void TInboundStats::stop()
+{
+    if (!mActive) {
+        return;
+    }
+    chargeCurrentStage();
+    mTotalNanoseconds = mTimer.nsecsElapsed();
+    mActive = false;
+}
+
+qint64 TInboundStats::totalNanoseconds() const
+{
+    return mActive ? mTimer.nsecsElapsed() : mTotalNanoseconds;
+}
+
+void TInboundStats::chargeCurrentStage()
+{
+    const qint64 now = mTimer.nsecsElapsed();
+    if (mCurrent != None) {
+        mStageNanoseconds[mCurrent] += now - mMark;
+    }
+    mMark = now;
+}
+
+TInboundStats::Stage TInboundStats::enter(const Stage stage)
+{
+    chargeCurrentStage();
+    const Stage previous = mCurrent;
+    mCurrent = stage;
+    return previous;
+}
+
+void TInboundStats::leave(const Stage previous)
+{
+    chargeCurrentStage();
+    mCurrent = previous;
+}
+
+QString TInboundStats::stageName(const Stage stage)
+{
+    switch (stage) {
+    case Telnet:
+        return qsl("telnet");
+    case Translate:
+        return qsl("translate");
+    case Triggers:
+        return qsl("triggers");
+    case Lua:
+        return qsl("lua");
+    default:
+        return qsl("other");
+    }
+}
+
+QString TInboundStats::report() const
+{
+    const qint64 total = totalNanoseconds();
+    const double seconds = total * 1.0e-9;
+    QStringList lines;
+    lines << qsl("%1 bytes and %2 lines in %3 ms").arg(QString::number(mBytes), QString::number(mLines), QString::number(total * 1.0e-6, 'f', 3));
+    if (seconds > 0.0) {
+        lines << qsl("throughput: %1 bytes/s, %2 lines/s").arg(QString::number(mBytes / seconds, 'f', 0), QString::number(mLines / seconds, 'f', 0));
+    }
+
+    qint64 staged = 0;
+    auto addStage = [&](const QString& name, const qint64 nanoseconds) {
+        const double share = total ? 100.0 * nanoseconds / total : 0.0;
+        lines << qsl("%1 %2 ms %3%").arg(name, -10).arg(nanoseconds * 1.0e-6, 12, 'f', 3).arg(share, 6, 'f', 1);
+    };
+    for (int stage = 0; stage < StageCount; ++stage) {
+        addStage(stageName(static_cast<Stage>(stage)), mStageNanoseconds.at(stage));
+        staged += mStageNanoseconds.at(stage);
+    }
+    // Everything else, mostly updating the consoles:
+    addStage(stageName(None), qMax(qint64(0), total - staged));
+    return lines.join(QChar::LineFeed);
+}
@@ -0,0 +1,105 @@
+#ifndef MUDLET_TINBOUNDSTATS_H
+#define MUDLET_TINBOUNDSTATS_H
+
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include "pre_guard.h"
+#include <QElapsedTimer>
+#include <QString>
+#include "post_guard.h"
+
+#include <array>
+
+// Times how long the processing of data from the game server spends in each
+// stage of the pipeline - telnet decoding, turning it into lines of text in
+// the buffer, running the triggers and running Lua code - for the
+// --replay-benchmark command line option. Stages nest (triggers run while a
+// line is being added to the buffer and they run Lua code) and the time is
+// always given to the innermost one, so the stage times add up to no more
+// than the total. When it has not been started all it costs is the check of a
+// bool at the start of each stage.
+class TInboundStats
+{
+public:
+    enum Stage {
+        None = -1,
+        Telnet = 0,
+        Translate,
+        Triggers,
+        Lua,
+        StageCount
+    };
+
+    // Puts the time, until it goes out of scope, into the given stage:
+    class Scope
+    {
+    public:
+        Q_DISABLE_COPY(Scope)
+        Scope(TInboundStats& stats, const Stage stage)
+        : mpStats(stats.isActive() ? &stats : nullptr)
+        {
+            if (mpStats) {
+                mPrevious = mpStats->enter(stage);
+            }
+        }
+        ~Scope()
+        {
+            if (mpStats) {
+                mpStats->leave(mPrevious);
+            }
+        }
+
+    private:
+        TInboundStats* mpStats;
+        Stage mPrevious = None;
+    };
+
+    // Clears the figures and starts the clock:
+    void start();
+    void stop();
+    bool isActive() const { return mActive; }
+    void addBytes(const qint64 bytes) { mBytes += bytes; }
+    void addLines(const qint64 lines) { mLines += lines; }
+    qint64 bytes() const { return mBytes; }
+    qint64 lines() const { return mLines; }
+    qint64 stageNanoseconds(const Stage stage) const { return mStageNanoseconds.at(stage); }
+    // From start() to stop() (or now if still running):
+    qint64 totalNanoseconds() const;
+    QString report() const;
+    static QString stageName(const Stage);
+
+private:
+    Stage enter(const Stage);
+    void leave(const Stage previous);
+    void chargeCurrentStage();
+
+    bool mActive = false;
+    QElapsedTimer mTimer;
+    qint64 mTotalNanoseconds = 0;
+    // When the time was last given to a stage:
+    qint64 mMark = 0;
+    Stage mCurrent = None;
+    std::array<qint64, StageCount> mStageNanoseconds{};
+    qint64 mBytes = 0;
+    qint64 mLines = 0;
+};
+
+#endif // MUDLET_TINBOUNDSTATS_H
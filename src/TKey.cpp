@@ -59,6 +59,7 @@ TKey::~TKey()
 
 void TKey::setName(const QString& name)
 {
+    setUnsaved();
     if (!isTemporary()) {
         mpHost->getKeyUnit()->mLookupTable.remove(mName, this);
     }
@@ -157,6 +158,7 @@ void TKey::compile()
 
 bool TKey::setScript(const QString& script)
 {
+    setUnsaved();
     mScript = script;
     mNeedsToBeCompiled = true;
     mOK_code = compileScript();
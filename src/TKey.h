@@ -51,10 +51,10 @@ public:
     QString getName() const { return mName; }
     void setName(const QString & name);
     Qt::Key getKeyCode() const { return mKeyCode; }
-    void setKeyCode(const Qt::Key code) { mKeyCode = code; }
+    void setKeyCode(const Qt::Key code) { mKeyCode = code; setUnsaved(); }
     void setKeyCode(const int codeNumber) { setKeyCode(static_cast<Qt::Key>(codeNumber)); }
     Qt::KeyboardModifiers getKeyModifiers() const { return mKeyModifier; }
-    void setKeyModifiers(const Qt::KeyboardModifiers code) { mKeyModifier = code; }
+    void setKeyModifiers(const Qt::KeyboardModifiers code) { mKeyModifier = code; setUnsaved(); }
     void setKeyModifiers(const int codeNumber) { setKeyModifiers(static_cast<Qt::KeyboardModifiers>(codeNumber)); }
     void enableKey(const QString& name);
     void disableKey(const QString& name);
@@ -63,7 +63,7 @@ public:
     void execute();
     QString getScript() const { return mScript; }
     bool setScript(const QString& script);
-    void setCommand(QString command) { mCommand = command; }
+    void setCommand(QString command) { mCommand = command; setUnsaved(); }
     QString getCommand() const { return mCommand; }
 
     bool match(const Qt::Key, const Qt::KeyboardModifiers, const bool);
@@ -39,6 +39,7 @@
 #include "TFlipButton.h"
 #include "TForkedProcess.h"
 #include "TLabel.h"
+#include "TLuaJsonDecoder.h"
 #include "TMapLabel.h"
 #include "TMedia.h"
 #include "TRoomDB.h"
@@ -2212,7 +2213,7 @@ int TLuaInterpreter::getTimestamp(lua_State* L)
         if (luaLine > 0 && luaLine < host.mpConsole->buffer.timeBuffer.size()) {
             // CHECK: Lua starts counting at 1 but we are indexing into a C/C++
             // structure but the previous code did not accept a zero line number
-            lua_pushstring(L, host.mpConsole->buffer.timeBuffer.at(luaLine).toUtf8().constData());
+            lua_pushstring(L, host.mpConsole->buffer.timeStamp(luaLine).toUtf8().constData());
         } else {
             lua_pushstring(L, "getTimestamp: invalid line number");
         }
@@ -2223,7 +2224,7 @@ int TLuaInterpreter::getTimestamp(lua_State* L)
             return warnArgumentValue(L, __func__, qsl("mini console, user window or buffer '%1' not found").arg(name));
         }
         if (luaLine > 0 && luaLine < pC->buffer.timeBuffer.size()) {
-            lua_pushstring(L, pC->buffer.timeBuffer.at(luaLine).toUtf8().constData());
+            lua_pushstring(L, pC->buffer.timeStamp(luaLine).toUtf8().constData());
         } else {
             lua_pushstring(L, "getTimestamp: invalid line number");
         }
@@ -3428,7 +3429,7 @@ void TLuaInterpreter::signalMXPEvent(const QString &type, const QMap<QString, QS
 }
 
 // No documentation available in wiki - internal function
-void TLuaInterpreter::setGMCPTable(QString& key, const QString& string_data)
+void TLuaInterpreter::setGMCPTable(QString& key, const QByteArray& data)
 {
     lua_State* L = pGlobalLua;
     lua_getglobal(L, "gmcp"); //defined in Lua init
@@ -3441,7 +3442,7 @@ void TLuaInterpreter::setGMCPTable(QString& key, const QString& string_data)
             return;
         }
     }
-    parseJSON(key, string_data, QLatin1String("gmcp"));
+    parseJSON(key, data, QLatin1String("gmcp"));
 }
 
 // No documentation available in wiki - internal function
@@ -3476,79 +3477,69 @@ void TLuaInterpreter::setMSDPTable(QString& key, const QString& string_data)
         }
     }
 
-    parseJSON(key, string_data, QLatin1String("msdp"));
+    parseJSON(key, string_data.toUtf8(), QLatin1String("msdp"));
 }
 
 // No documentation available in wiki - internal function
-void TLuaInterpreter::parseJSON(QString& key, const QString& string_data, const QString& protocol)
+void TLuaInterpreter::parseJSON(QString& key, const QByteArray& data, const QString& protocol)
 {
     // key is in format of Blah.Blah or Blah.Blah.Bleh - we want to push & pre-create the tables as appropriate
     lua_State* L = pGlobalLua;
-    QStringList tokenList = key.split(QLatin1Char('.'));
-    if (!lua_checkstack(L, tokenList.size() + 5)) {
-        qCritical() << "ERROR: could not grow Lua stack by" << tokenList.size() + 5 << "elements, parsing GMCP/MSDP failed. Current stack size is" << lua_gettop(L);
+    const QList<QByteArray> path = key.toUtf8().split('.');
+    if (!lua_checkstack(L, path.size() + 5)) {
+        qCritical() << "ERROR: could not grow Lua stack by" << path.size() + 5 << "elements, parsing GMCP/MSDP failed. Current stack size is" << lua_gettop(L);
         return;
     }
-    int i = 0;
-    for (const int total = tokenList.size() - 1; i < total; ++i) {
-        lua_getfield(L, -1, tokenList.at(i).toUtf8().constData());
+    for (int i = 0, total = path.size() - 1; i < total; ++i) {
+        lua_getfield(L, -1, path.at(i).constData());
         if (!lua_istable(L, -1)) {
             lua_pop(L, 1);
-            lua_pushstring(L, tokenList.at(i).toUtf8().constData());
+            lua_pushstring(L, path.at(i).constData());
             lua_newtable(L);
             lua_rawset(L, -3);
-            lua_getfield(L, -1, tokenList.at(i).toUtf8().constData());
+            lua_getfield(L, -1, path.at(i).constData());
         }
         lua_remove(L, -2);
     }
-    bool __needMerge = false;
-    lua_getfield(L, -1, tokenList.at(i).toUtf8().constData());
+    const int parentIndex = lua_gettop(L);
+    const char* leafName = path.constLast().constData();
+
     Host& host = getHostFromLua(L);
-    if (lua_istable(L, -1)) {
-        // only merge tables (instead of replacing them) if the key has been registered as a need to merge key by the user default is Char.Status only
-        if (host.mGMCP_merge_table_keys.contains(key)) {
-            __needMerge = true;
-        }
-    }
-    lua_pop(L, 1);
-    if (!__needMerge) {
-        lua_pushstring(L, tokenList.at(i).toUtf8().constData());
+    bool needMerge = false;
+    lua_getfield(L, parentIndex, leafName);
+    // only merge tables (instead of replacing them) if the key has been registered as a need to merge key by the user default is Char.Status only
+    if (lua_istable(L, -1) && host.mGMCP_merge_table_keys.contains(key)) {
+        // Keep the existing table on the stack to merge into:
+        needMerge = true;
     } else {
-        lua_pushstring(L, "__needMerge");
+        lua_pop(L, 1);
     }
 
-    lua_getglobal(L, "json_to_value");
-
-    if (!lua_isfunction(L, -1)) {
-        lua_settop(L, 0);
-        qDebug() << "CRITICAL ERROR: json_to_value not defined";
-        return;
+    // Use the same value for a JSON null as the yajl library does:
+    lua_getglobal(L, "yajl");
+    if (lua_istable(L, -1)) {
+        lua_getfield(L, -1, "null");
+        lua_remove(L, -2);
+    } else {
+        lua_pop(L, 1);
+        lua_pushlightuserdata(L, nullptr);
     }
-    auto dataInUtf8 = string_data.toUtf8();
-    lua_pushlstring(L, dataInUtf8.constData(), dataInUtf8.length());
-    const int error = lua_pcall(L, 1, 1, 0);
-    if (!error) {
-        // Top of stack should now contain the lua representation of json.
-        lua_rawset(L, -3);
-        if (__needMerge) {
+    const int nullIndex = lua_gettop(L);
+
+    QString decoderError;
+    bool isDecoded = TLuaJsonDecoder::decode(L, data.constData(), data.size(), nullIndex, decoderError);
+    if (!isDecoded) {
+        // Let the yajl library have a go, it might accept something that the
+        // native decoder does not (or it will report the problem):
+        lua_getglobal(L, "json_to_value");
+        if (!lua_isfunction(L, -1)) {
             lua_settop(L, 0);
-            lua_getglobal(L, "__gmcp_merge_gmcp_sub_tables");
-            if (!lua_isfunction(L, -1)) {
-                lua_settop(L, 0);
-                qDebug() << "CRITICAL ERROR: __gmcp_merge_gmcp_sub_tables is not defined in lua_LuaGlobal.lua";
-                return;
-            }
-            lua_getglobal(L, "gmcp");
-            i = 0;
-            for (const int total = tokenList.size() - 1; i < total; ++i) {
-                lua_getfield(L, -1, tokenList.at(i).toUtf8().constData());
-                lua_remove(L, -2);
-            }
-            lua_pushstring(L, tokenList.at(i).toUtf8().constData());
-            lua_pcall(L, 2, 0, 0);
+            qDebug() << "CRITICAL ERROR: json_to_value not defined";
+            return;
         }
-    } else {
-        {
+        lua_pushlstring(L, data.constData(), data.size());
+        isDecoded = !lua_pcall(L, 1, 1, 0);
+        if (!isDecoded) {
             std::string e;
             if (lua_isstring(L, -1)) {
                 e = "Lua error:";
@@ -3559,11 +3550,24 @@ void TLuaInterpreter::parseJSON(QString& key, const QString& string_data, const
             logError(e, _n, _f);
         }
     }
+
+    if (isDecoded) {
+        // Top of stack should now contain the lua representation of json.
+        lua_remove(L, nullIndex);
+        if (needMerge && lua_istable(L, -1)) {
+            TLuaJsonDecoder::mergeInto(L, parentIndex + 1);
+        } else {
+            lua_pushstring(L, leafName);
+            lua_insert(L, -2);
+            lua_rawset(L, parentIndex);
+        }
+    }
     lua_settop(L, 0);
 
     // events: for key "foo.bar.top" we raise: gmcp.foo, gmcp.foo.bar and gmcp.foo.bar.top
     // with the actual key given as parameter e.g. event=gmcp.foo, param="gmcp.foo.bar"
 
+    const QStringList tokenList = key.split(QLatin1Char('.'));
     QString token = protocol;
     if (protocol == QLatin1String("msdp")) {
         key.prepend(QLatin1String("msdp."));
@@ -3588,7 +3592,7 @@ void TLuaInterpreter::parseJSON(QString& key, const QString& string_data, const
     // auto-detect IRE composer
     if (tokenList.size() == 3 && tokenList.at(0).toLower() == "ire" && tokenList.at(1).toLower() == "composer" && tokenList.at(2).toLower() == "edit") {
         const QRegularExpression rx(qsl(R"lit(\{ ?"title": ?"(.*)", ?"text": ?"(.*)" ?\})lit"));
-        const QRegularExpressionMatch match = rx.match(string_data);
+        const QRegularExpressionMatch match = rx.match(QString::fromUtf8(data));
 
         if (match.capturedStart() != -1) {
             const QString title = match.captured(1);
@@ -4007,6 +4011,7 @@ std::pair<bool, bool> TLuaInterpreter::callLuaFunctionReturnBool(void* pT)
 // to cut down on spammy output if things are okay.
 bool TLuaInterpreter::call(const QString& function, const QString& mName, const bool muteDebugOutput)
 {
+    const TInboundStats::Scope timeLua(mpHost->mInboundStats, TInboundStats::Lua);
     lua_State* L = pGlobalLua;
     setMatches(L);
 
@@ -4171,6 +4176,7 @@ bool TLuaInterpreter::callConditionFunction(std::string& function, const QString
 // No documentation available in wiki - internal function
 bool TLuaInterpreter::callMulti(const QString& function, const QString& mName)
 {
+    const TInboundStats::Scope timeLua(mpHost->mInboundStats, TInboundStats::Lua);
     lua_State* L = pGlobalLua;
 
     if (!mMultiCaptureGroupList.empty()) {
@@ -4477,17 +4483,18 @@ bool TLuaInterpreter::callEventHandler(const QString& function, const TEvent& pE
         return false;
     }
 
+    const TInboundStats::Scope timeLua(mpHost->mInboundStats, TInboundStats::Lua);
+    const TProfiler::Scope profile(mpHost->mProfiler, function);
     lua_State* L = pGlobalLua;
 
-    int error = luaL_dostring(L, qsl("return %1").arg(function).toUtf8().constData());
-    if (error) {
-        std::string err;
-        if (lua_isstring(L, 1)) {
-            err = "Lua error: ";
-            err += lua_tostring(L, 1);
-        }
-        const QString name = "event handler function";
-        logError(err, name, function);
+    // getEventHandlerStats() always counts the calls but the handlers are only
+    // timed along with everything else that the profiler collects:
+    const bool isProfiling = mpHost->mProfiler.isEnabled();
+    QElapsedTimer timer;
+    if (isProfiling) {
+        timer.start();
+    }
+    if (!pushEventHandler(L, function)) {
         return false;
     }
 
@@ -4519,7 +4526,13 @@ bool TLuaInterpreter::callEventHandler(const QString& function, const TEvent& pE
         }
     }
 
-    error = lua_pcall(L, maxArguments, LUA_MULTRET, 0);
+    const int error = lua_pcall(L, maxArguments, LUA_MULTRET, 0);
+
+    auto& stats = mEventHandlerStats[pE.mArgumentList.value(0)][function];
+    ++stats.mCalls;
+    if (isProfiling) {
+        stats.mNanoSeconds += timer.nsecsElapsed();
+    }
 
     if (mudlet::smDebugMode && pE.mArgumentList.size() > LUA_FUNCTION_MAX_ARGS) {
         auto& host = getHostFromLua(L);
@@ -4545,6 +4558,81 @@ bool TLuaInterpreter::callEventHandler(const QString& function, const TEvent& pE
     return !error;
 }
 
+// No documentation available in wiki - internal function
+// Pushes the current value of the given event handler function onto the
+// stack, the first time a handler is seen it works out how to find it and
+// caches that so that it does not have to parse and compile a
+// "return <function>" chunk on every event. Returns false (with nothing left
+// on the stack) and reports the error if the function cannot be resolved:
+bool TLuaInterpreter::pushEventHandler(lua_State* L, const QString& function)
+{
+    auto resolver = mEventHandlerResolvers.find(function);
+    if (resolver == mEventHandlerResolvers.end()) {
+        EventHandlerResolver newResolver;
+        static const QRegularExpression plainPath(qsl(R"(^[A-Za-z_][A-Za-z0-9_]*(\.[A-Za-z_][A-Za-z0-9_]*)*$)"));
+        if (plainPath.match(function).hasMatch()) {
+            newResolver.mPath = function.toUtf8().split('.');
+        } else {
+            if (luaL_loadstring(L, qsl("return %1").arg(function).toUtf8().constData())) {
+                std::string err = "Lua error: ";
+                if (lua_isstring(L, -1)) {
+                    err += lua_tostring(L, -1);
+                }
+                lua_pop(L, 1);
+                const QString name = "event handler function";
+                logError(err, name, function);
+                return false;
+            }
+            newResolver.mChunkRef = luaL_ref(L, LUA_REGISTRYINDEX);
+        }
+        resolver = mEventHandlerResolvers.insert(function, newResolver);
+    }
+
+    if (resolver->mChunkRef != LUA_NOREF) {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, resolver->mChunkRef);
+        if (lua_pcall(L, 0, 1, 0)) {
+            std::string err = "Lua error: ";
+            if (lua_isstring(L, -1)) {
+                err += lua_tostring(L, -1);
+            }
+            lua_pop(L, 1);
+            const QString name = "event handler function";
+            logError(err, name, function);
+            return false;
+        }
+        return true;
+    }
+
+    lua_getfield(L, LUA_GLOBALSINDEX, resolver->mPath.constFirst().constData());
+    for (int i = 1, total = resolver->mPath.size(); i < total; ++i) {
+        if (!lua_istable(L, -1)) {
+            // Leave a nil for lua_pcall(...) to complain about rather than
+            // raising an unprotected error by indexing a non-table:
+            lua_pop(L, 1);
+            lua_pushnil(L);
+            return true;
+        }
+        lua_getfield(L, -1, resolver->mPath.at(i).constData());
+        lua_remove(L, -2);
+    }
+    return true;
+}
+
+// No documentation available in wiki - internal function
+// Drops the cached way of finding the handler, e.g. because it is no longer
+// registered for any event:
+void TLuaInterpreter::forgetEventHandler(const QString& function)
+{
+    const auto resolver = mEventHandlerResolvers.constFind(function);
+    if (resolver == mEventHandlerResolvers.cend()) {
+        return;
+    }
+    if (resolver->mChunkRef != LUA_NOREF) {
+        luaL_unref(pGlobalLua, LUA_REGISTRYINDEX, resolver->mChunkRef);
+    }
+    mEventHandlerResolvers.erase(resolver);
+}
+
 // No documentation available in wiki - internal function
 double TLuaInterpreter::condenseMapLoad()
 {
@@ -4928,6 +5016,9 @@ end)LUA");
 // on initialization of a new session *or* in case of an interpreter reset by the user.
 void TLuaInterpreter::initLuaGlobals()
 {
+    // Any registry references held for event handlers belonged to the
+    // previous Lua state:
+    mEventHandlerResolvers.clear();
     pGlobalLua = newstate();
     storeHostInLua(pGlobalLua, mpHost);
 
@@ -4978,6 +5069,9 @@ void TLuaInterpreter::initLuaGlobals()
     lua_register(pGlobalLua, "moveCursor", TLuaInterpreter::moveCursor);
     lua_register(pGlobalLua, "getLines", TLuaInterpreter::getLines);
     lua_register(pGlobalLua, "getLineNumber", TLuaInterpreter::getLineNumber);
+    lua_register(pGlobalLua, "getLineId", TLuaInterpreter::getLineId);
+    lua_register(pGlobalLua, "getLineNumberFromId", TLuaInterpreter::getLineNumberFromId);
+    lua_register(pGlobalLua, "searchBuffer", TLuaInterpreter::searchBuffer);
     lua_register(pGlobalLua, "insertHTML", TLuaInterpreter::insertHTML);
     lua_register(pGlobalLua, "insertText", TLuaInterpreter::insertText);
     lua_register(pGlobalLua, "enableTrigger", TLuaInterpreter::enableTrigger);
@@ -5178,6 +5272,8 @@ void TLuaInterpreter::initLuaGlobals()
     lua_register(pGlobalLua, "getAreaTableSwap", TLuaInterpreter::getAreaTableSwap);
     lua_register(pGlobalLua, "getAreaRooms", TLuaInterpreter::getAreaRooms);
     lua_register(pGlobalLua, "getPath", TLuaInterpreter::getPath);
+    lua_register(pGlobalLua, "getPathWeights", TLuaInterpreter::getPathWeights);
+    lua_register(pGlobalLua, "getPaths", TLuaInterpreter::getPaths);
     lua_register(pGlobalLua, "centerview", TLuaInterpreter::centerview);
     lua_register(pGlobalLua, "denyCurrentSend", TLuaInterpreter::denyCurrentSend);
     lua_register(pGlobalLua, "tempBeginOfLineTrigger", TLuaInterpreter::tempBeginOfLineTrigger);
@@ -5431,6 +5527,12 @@ void TLuaInterpreter::initLuaGlobals()
     lua_register(pGlobalLua, "deleteMap", TLuaInterpreter::deleteMap);
     lua_register(pGlobalLua, "windowType", TLuaInterpreter::windowType);
     lua_register(pGlobalLua, "getProfileStats", TLuaInterpreter::getProfileStats);
+    lua_register(pGlobalLua, "getEventHandlerStats", TLuaInterpreter::getEventHandlerStats);
+    lua_register(pGlobalLua, "resetEventHandlerStats", TLuaInterpreter::resetEventHandlerStats);
+    lua_register(pGlobalLua, "getProfilingData", TLuaInterpreter::getProfilingData);
+    lua_register(pGlobalLua, "resetProfiling", TLuaInterpreter::resetProfiling);
+    lua_register(pGlobalLua, "startProfiling", TLuaInterpreter::startProfiling);
+    lua_register(pGlobalLua, "stopProfiling", TLuaInterpreter::stopProfiling);
     lua_register(pGlobalLua, "getBackgroundColor", TLuaInterpreter::getBackgroundColor);
     lua_register(pGlobalLua, "getLabelStyleSheet", TLuaInterpreter::getLabelStyleSheet);
     lua_register(pGlobalLua, "getLabelSizeHint", TLuaInterpreter::getLabelSizeHint);
@@ -7082,6 +7184,10 @@ int TLuaInterpreter::setConfig(lua_State * L)
         }
     }
 
+    if (key == qsl("mapAreaRouting")) {
+        host.mMapperAreaRouting = getVerifiedBool(L, __func__, 2, "value");
+        return success();
+    }
     if (key == qsl("enableGMCP")) {
         host.mEnableGMCP = getVerifiedBool(L, __func__, 2, "value");
         return success();
@@ -7110,6 +7216,10 @@ int TLuaInterpreter::setConfig(lua_State * L)
         host.mAskTlsAvailable = getVerifiedBool(L, __func__, 2, "value");
         return success();
     }
+    if (key == qsl("usePcreJit")) {
+        host.setUsePcreJit(getVerifiedBool(L, __func__, 2, "value"));
+        return success();
+    }
     if (key == qsl("inputLineStrictUnixEndings")) {
         host.mUSE_UNIX_EOL = getVerifiedBool(L, __func__, 2, "value");
         return success();
@@ -7307,6 +7417,7 @@ int TLuaInterpreter::getConfig(lua_State *L)
         }},
         { qsl("mapperPanelVisible"), [&](){ lua_pushboolean(L, host.mShowPanel); } },
         { qsl("mapShowRoomBorders"), [&](){ lua_pushboolean(L, host.mMapperShowRoomBorders); } },
+        { qsl("mapAreaRouting"), [&](){ lua_pushboolean(L, host.mMapperAreaRouting); } },
         { qsl("enableGMCP"), [&](){ lua_pushboolean(L, host.mEnableGMCP); } },
         { qsl("enableMSSP"), [&](){ lua_pushboolean(L, host.mEnableMSSP); } },
         { qsl("enableMSDP"), [&](){ lua_pushboolean(L, host.mEnableMSDP); } },
@@ -7314,6 +7425,7 @@ int TLuaInterpreter::getConfig(lua_State *L)
         { qsl("enableMTTS"), [&](){ lua_pushboolean(L, host.mEnableMTTS); } },
         { qsl("enableMNES"), [&](){ lua_pushboolean(L, host.mEnableMNES); } },
         { qsl("askTlsAvailable"), [&](){ lua_pushboolean(L, host.mAskTlsAvailable); } },
+        { qsl("usePcreJit"), [&](){ lua_pushboolean(L, host.mUsePcreJit); } },
         { qsl("inputLineStrictUnixEndings"), [&](){ lua_pushboolean(L, host.mUSE_UNIX_EOL); } },
         { qsl("autoClearInputLine"), [&](){ lua_pushboolean(L, host.mAutoClearCommandLineAfterSend); } },
         { qsl("showSentText"), [&](){ lua_pushboolean(L, host.mPrintCommand); } },
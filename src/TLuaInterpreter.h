@@ -32,6 +32,7 @@
 #include "utils.h"
 
 #include "pre_guard.h"
+#include <QElapsedTimer>
 #include <QEvent>
 #include <QFileSystemWatcher>
 #include <QNetworkAccessManager>
@@ -87,7 +88,7 @@ public:
     TLuaInterpreter(Host* pH, const QString& hostName, const int id);
     ~TLuaInterpreter();
     void setMSDPTable(QString& key, const QString& string_data);
-    void parseJSON(QString& key, const QString& string_data, const QString& protocol);
+    void parseJSON(QString& key, const QByteArray& data, const QString& protocol);
     void parseMSSP(const QString& string_data);
     void msdp2Lua(const char*);
     void initLuaGlobals();
@@ -107,7 +108,7 @@ public:
     bool compile(const QString& code, QString& error, const QString& name);
     void setAtcpTable(const QString&, const QString&);
     void signalMXPEvent(const QString& type, const QMap<QString, QString>& attrs, const QStringList& actions);
-    void setGMCPTable(QString&, const QString&);
+    void setGMCPTable(QString&, const QByteArray&);
     void setMSSPTable(const QString&);
     void setChannel102Table(int& var, int& arg);
     bool compileAndExecuteScript(const QString&);
@@ -125,6 +126,7 @@ public:
     void adjustCaptureGroups(int x, int a);
     void clearCaptureGroups();
     bool callEventHandler(const QString& function, const TEvent& pE);
+    void forgetEventHandler(const QString& function);
     bool callCmdLineAction(const int func, QString);
     bool callAnonymousFunction(const int func, QString name);
     bool callLabelCallbackEvent(const int func, const QEvent* qE = nullptr);
@@ -276,6 +278,8 @@ public:
     static int getAreaTable(lua_State*);
     static int getAreaTableSwap(lua_State*);
     static int getPath(lua_State*);
+    static int getPathWeights(lua_State*);
+    static int getPaths(lua_State*);
     static int getAreaRooms(lua_State*);
     static int clearCmdLine(lua_State*);
     static int printCmdLine(lua_State*);
@@ -333,7 +337,10 @@ public:
     static int tempComplexRegexTrigger(lua_State*);
     static int killTrigger(lua_State*);
     static int getLineCount(lua_State*);
+    static int getLineId(lua_State*);
     static int getLineNumber(lua_State*);
+    static int getLineNumberFromId(lua_State*);
+    static int searchBuffer(lua_State*);
     static int getColumnNumber(lua_State*);
     static int selectCaptureGroup(lua_State*);
     static int tempLineTrigger(lua_State*);
@@ -651,6 +658,12 @@ public:
     static int deleteMap(lua_State*);
     static int windowType(lua_State*);
     static int getProfileStats(lua_State*);
+    static int getEventHandlerStats(lua_State*);
+    static int resetEventHandlerStats(lua_State*);
+    static int getProfilingData(lua_State*);
+    static int resetProfiling(lua_State*);
+    static int startProfiling(lua_State*);
+    static int stopProfiling(lua_State*);
     static int getBackgroundColor(lua_State*);
     static int getLabelStyleSheet(lua_State*);
     static int getLabelSizeHint(lua_State*);
@@ -760,6 +773,7 @@ private:
     static QByteArray parseTelnetCodes(const QByteArray&);
 
     bool callReference(lua_State*, QString name, int parameters);
+    bool pushEventHandler(lua_State*, const QString& function);
     void logError(std::string& e, const QString&, const QString& function);
     void logEventError(const QString& event, const QString& error);
     std::pair<bool, QString> validLuaCode(const QString &code);
@@ -805,6 +819,23 @@ private:
     QNetworkAccessManager* mpFileDownloader = nullptr;
     QFileSystemWatcher* mpFileSystemWatcher = nullptr;
 
+    // How an event handler's function is found each time it is called,
+    // either by looking up a plain (possibly dotted) name or by running the
+    // once compiled "return <function>" chunk held in the Lua registry - so
+    // the name is never reparsed but reassigning it still takes effect:
+    struct EventHandlerResolver {
+        QList<QByteArray> mPath;
+        int mChunkRef = LUA_NOREF;
+    };
+    QHash<QString, EventHandlerResolver> mEventHandlerResolvers;
+    struct EventHandlerStats {
+        quint64 mCalls = 0;
+        qint64 mNanoSeconds = 0;
+    };
+    // Event name -> handler function -> how often and for how long it ran, the
+    // latter only being added to whilst the profiler is running:
+    QHash<QString, QHash<QString, EventHandlerStats>> mEventHandlerStats;
+
     // Holds the list of places to look for the LuaGlobal.lua file:
     QStringList mPossiblePaths;
 };
@@ -947,8 +947,6 @@ int TLuaInterpreter::connectExitStub(lua_State* L)
         return 2;
     }
 
-    host.mpMap->mMapGraphNeedsUpdate = true;
-
     host.mpMap->update();
     lua_pushboolean(L, true);
     return 1;
@@ -1824,6 +1822,140 @@ int TLuaInterpreter::getPath(lua_State* L)
     }
 }
 
+// Documentation: https://wiki.mudlet.org/w/Manual:Lua_Functions#getPathWeights
+int TLuaInterpreter::getPathWeights(lua_State* L)
+{
+    const int originRoomId = getVerifiedInt(L, __func__, 1, "starting roomID");
+    QList<int> targetRoomIds;
+    if (lua_gettop(L) > 1) {
+        if (!lua_istable(L, 2)) {
+            lua_pushfstring(L, "getPathWeights: bad argument #2 type (table of target roomIDs as {number} is optional, got %s!)", luaL_typename(L, 2));
+            return lua_error(L);
+        }
+        lua_pushnil(L);
+        while (lua_next(L, 2) != 0) {
+            if (!lua_isnumber(L, -1)) {
+                // Use a copy of the key so that lua_tostring(...) cannot change it:
+                lua_pushvalue(L, -2);
+                lua_pushfstring(L, "getPathWeights: bad argument #2 table item %s type (target roomID as number expected, got %s!)",
+                                lua_isstring(L, -1) ? lua_tostring(L, -1) : luaL_typename(L, -1), luaL_typename(L, -2));
+                return lua_error(L);
+            }
+            targetRoomIds.append(lua_tointeger(L, -1));
+            lua_pop(L, 1);
+        }
+    }
+
+    Host& host = getHostFromLua(L);
+    if (!host.mpMap || !host.mpMap->mpRoomDB) {
+        return warnArgumentValue(L, __func__, "no map present or loaded");
+    } else if (!host.mpMap->mpRoomDB->getRoom(originRoomId)) {
+        return warnArgumentValue(L, __func__, qsl("number %1 is not a valid source roomID").arg(originRoomId));
+    }
+
+    lua_newtable(L);
+    if (!host.mpMap->findPaths(originRoomId, targetRoomIds)) {
+        return 1;
+    }
+
+    if (targetRoomIds.isEmpty()) {
+        const QHash<int, cost> reachedRooms = host.mpMap->mGraph.reachedRooms();
+        for (auto it = reachedRooms.cbegin(), end = reachedRooms.cend(); it != end; ++it) {
+            lua_pushnumber(L, it.value());
+            lua_rawseti(L, -2, it.key());
+        }
+        return 1;
+    }
+
+    for (const int targetRoomId : std::as_const(targetRoomIds)) {
+        const cost weight = host.mpMap->mGraph.distanceTo(targetRoomId);
+        if (weight >= 0) {
+            lua_pushnumber(L, weight);
+            lua_rawseti(L, -2, targetRoomId);
+        }
+    }
+    return 1;
+}
+
+// Documentation: https://wiki.mudlet.org/w/Manual:Lua_Functions#getPaths
+int TLuaInterpreter::getPaths(lua_State* L)
+{
+    const int originRoomId = getVerifiedInt(L, __func__, 1, "starting roomID");
+    if (!lua_istable(L, 2)) {
+        lua_pushfstring(L, "getPaths: bad argument #2 type (table of target roomIDs as {number} expected, got %s!)", luaL_typename(L, 2));
+        return lua_error(L);
+    }
+    QList<int> targetRoomIds;
+    lua_pushnil(L);
+    while (lua_next(L, 2) != 0) {
+        if (!lua_isnumber(L, -1)) {
+            // Use a copy of the key so that lua_tostring(...) cannot change it:
+            lua_pushvalue(L, -2);
+            lua_pushfstring(L, "getPaths: bad argument #2 table item %s type (target roomID as number expected, got %s!)",
+                            lua_isstring(L, -1) ? lua_tostring(L, -1) : luaL_typename(L, -1), luaL_typename(L, -2));
+            return lua_error(L);
+        }
+        targetRoomIds.append(lua_tointeger(L, -1));
+        lua_pop(L, 1);
+    }
+
+    Host& host = getHostFromLua(L);
+    if (!host.mpMap || !host.mpMap->mpRoomDB) {
+        return warnArgumentValue(L, __func__, "no map present or loaded");
+    } else if (!host.mpMap->mpRoomDB->getRoom(originRoomId)) {
+        return warnArgumentValue(L, __func__, qsl("number %1 is not a valid source roomID").arg(originRoomId));
+    } else if (targetRoomIds.isEmpty()) {
+        return warnArgumentValue(L, __func__, "no target roomIDs given");
+    }
+
+    // A table keyed by each target room that can be reached, with the same
+    // details that getPath(...) puts into speedWalkPath, speedWalkDir and
+    // speedWalkWeight (but as numbers) plus the total weight:
+    lua_newtable(L);
+    if (!host.mpMap->findPaths(originRoomId, targetRoomIds)) {
+        return 1;
+    }
+
+    for (const int targetRoomId : std::as_const(targetRoomIds)) {
+        const cost weight = host.mpMap->mGraph.distanceTo(targetRoomId);
+        if (weight < 0) {
+            continue;
+        }
+
+        const QList<int> path = host.mpMap->mGraph.pathTo(targetRoomId);
+        const QStringList commands = host.mpMap->pathCommands(originRoomId, path);
+        lua_newtable(L);
+        lua_pushnumber(L, weight);
+        lua_setfield(L, -2, "weight");
+
+        lua_newtable(L);
+        for (int i = 0, total = path.size(); i < total; ++i) {
+            lua_pushnumber(L, path.at(i));
+            lua_rawseti(L, -2, i + 1);
+        }
+        lua_setfield(L, -2, "rooms");
+
+        lua_newtable(L);
+        for (int i = 0, total = commands.size(); i < total; ++i) {
+            lua_pushstring(L, commands.at(i).toUtf8().constData());
+            lua_rawseti(L, -2, i + 1);
+        }
+        lua_setfield(L, -2, "directions");
+
+        lua_newtable(L);
+        int previousRoomId = originRoomId;
+        for (int i = 0, total = path.size(); i < total; ++i) {
+            lua_pushnumber(L, host.mpMap->mGraph.routeBetween(previousRoomId, path.at(i)).cost);
+            lua_rawseti(L, -2, i + 1);
+            previousRoomId = path.at(i);
+        }
+        lua_setfield(L, -2, "weights");
+
+        lua_rawseti(L, -2, targetRoomId);
+    }
+    return 1;
+}
+
 // Documentation: https://wiki.mudlet.org/w/Manual:Lua_Functions#getPlayerRoom
 int TLuaInterpreter::getPlayerRoom(lua_State* L)
 {
@@ -2501,7 +2633,6 @@ int TLuaInterpreter::lockExit(lua_State* L)
         pR->setExitLock(dir, b);
         host.mpMap->setUnsaved(__func__);
         host.mpMap->update();
-        host.mpMap->mMapGraphNeedsUpdate = true;
     }
     return 0;
 }
@@ -2515,9 +2646,9 @@ int TLuaInterpreter::lockRoom(lua_State* L)
     TRoom* pR = host.mpMap->mpRoomDB->getRoom(id);
     if (pR) {
         pR->isLocked = b;
+        host.mpMap->markRoomChanged(id);
         host.mpMap->setUnsaved(__func__);
         host.mpMap->update();
-        host.mpMap->mMapGraphNeedsUpdate = true;
         lua_pushboolean(L, true);
     } else {
         lua_pushboolean(L, false);
@@ -2549,7 +2680,6 @@ int TLuaInterpreter::lockSpecialExit(lua_State* L)
     lua_pushboolean(L, true);
     host.mpMap->setUnsaved(__func__);
     host.mpMap->update();
-    host.mpMap->mMapGraphNeedsUpdate = true;
     return 1;
 }
 
@@ -3353,7 +3483,6 @@ int TLuaInterpreter::setExit(lua_State* L)
 
     const Host& host = getHostFromLua(L);
     lua_pushboolean(L, host.mpMap->setExit(from, to, dir));
-    host.mpMap->mMapGraphNeedsUpdate = true;
     host.mpMap->update();
     return 1;
 }
@@ -3728,7 +3857,6 @@ int TLuaInterpreter::setRoomWeight(lua_State* L)
     pR->setWeight(w);
     host.mpMap->setUnsaved(__func__);
     host.mpMap->update();
-    host.mpMap->mMapGraphNeedsUpdate = true;
     lua_pushboolean(L, true);
     return 1;
 }
@@ -589,6 +589,36 @@ int TLuaInterpreter::getConsoleBufferSize(lua_State* L)
     return 2;
 }
 
+// Documentation: https://wiki.mudlet.org/w/Manual:Lua_Functions#getEventHandlerStats
+// The calls are always counted but the time spent in the handlers is only
+// measured between startProfiling() and stopProfiling(), so it stays at zero
+// otherwise:
+int TLuaInterpreter::getEventHandlerStats(lua_State* L)
+{
+    const Host& host = getHostFromLua(L);
+    lua_newtable(L);
+    for (auto event = host.mLuaInterpreter.mEventHandlerStats.cbegin(), endEvent = host.mLuaInterpreter.mEventHandlerStats.cend(); event != endEvent; ++event) {
+        lua_pushstring(L, event.key().toUtf8().constData());
+        lua_newtable(L);
+        for (auto handler = event.value().cbegin(), endHandler = event.value().cend(); handler != endHandler; ++handler) {
+            lua_pushstring(L, handler.key().toUtf8().constData());
+            lua_newtable(L);
+
+            lua_pushstring(L, "calls");
+            lua_pushnumber(L, handler.value().mCalls);
+            lua_settable(L, -3);
+
+            // In seconds like getStopWatchTime(...):
+            lua_pushstring(L, "time");
+            lua_pushnumber(L, handler.value().mNanoSeconds / 1.0e9);
+            lua_settable(L, -3);
+
+            lua_settable(L, -3); // handler
+        }
+        lua_settable(L, -3); // event
+    }
+    return 1;
+}
 
 int TLuaInterpreter::getProfileStats(lua_State* L)
 {
@@ -717,6 +747,46 @@ int TLuaInterpreter::getProfileStats(lua_State* L)
     return 1;
 }
 
+// Documentation: https://wiki.mudlet.org/w/Manual:Lua_Functions#getProfilingData
+int TLuaInterpreter::getProfilingData(lua_State* L)
+{
+    const Host& host = getHostFromLua(L);
+    int count = -1;
+    if (!lua_isnoneornil(L, 1)) {
+        count = getVerifiedInt(L, __func__, 1, "count", true);
+        if (count < 1) {
+            return warnArgumentValue(L, __func__, qsl("count %1 is not a positive number").arg(count));
+        }
+    }
+
+    const QList<TProfiler::Entry> entries = host.mProfiler.entries();
+    const int total = count < 0 ? static_cast<int>(entries.size()) : qMin(count, static_cast<int>(entries.size()));
+    lua_createtable(L, total, 0);
+    for (int i = 0; i < total; ++i) {
+        const TProfiler::Entry& entry = entries.at(i);
+        lua_createtable(L, 0, 6);
+
+        lua_pushstring(L, TProfiler::kindName(entry.mKind).toUtf8().constData());
+        lua_setfield(L, -2, "type");
+        lua_pushstring(L, entry.mName.toUtf8().constData());
+        lua_setfield(L, -2, "name");
+        if (entry.mKind != TProfiler::EventHandler) {
+            lua_pushnumber(L, entry.mId);
+            lua_setfield(L, -2, "id");
+        }
+        lua_pushnumber(L, entry.mCalls);
+        lua_setfield(L, -2, "calls");
+        // In seconds like getStopWatchTime(...):
+        lua_pushnumber(L, entry.mTotalNanoseconds / 1.0e9);
+        lua_setfield(L, -2, "time");
+        lua_pushnumber(L, entry.mMaxNanoseconds / 1.0e9);
+        lua_setfield(L, -2, "max");
+
+        lua_rawseti(L, -2, i + 1);
+    }
+    return 1;
+}
+
 // Documentation: https://wiki.mudlet.org/w/Manual:Lua_Functions#getStopWatches
 int TLuaInterpreter::getStopWatches(lua_State* L)
 {
@@ -1461,6 +1531,15 @@ int TLuaInterpreter::remainingTime(lua_State* L)
     return 1;
 }
 
+// Documentation: https://wiki.mudlet.org/w/Manual:Lua_Functions#resetEventHandlerStats
+int TLuaInterpreter::resetEventHandlerStats(lua_State* L)
+{
+    Host& host = getHostFromLua(L);
+    host.mLuaInterpreter.mEventHandlerStats.clear();
+    lua_pushboolean(L, true);
+    return 1;
+}
+
 // Documentation: https://wiki.mudlet.org/w/Manual:Lua_Functions#resetProfileIcon
 int TLuaInterpreter::resetProfileIcon(lua_State* L)
 {
@@ -1474,6 +1553,15 @@ int TLuaInterpreter::resetProfileIcon(lua_State* L)
     return 1;
 }
 
+// Documentation: https://wiki.mudlet.org/w/Manual:Lua_Functions#resetProfiling
+int TLuaInterpreter::resetProfiling(lua_State* L)
+{
+    Host& host = getHostFromLua(L);
+    host.mProfiler.reset();
+    lua_pushboolean(L, true);
+    return 1;
+}
+
 // Documentation: https://wiki.mudlet.org/w/Manual:Lua_Functions#resetStopWatch
 int TLuaInterpreter::resetStopWatch(lua_State* L)
 {
@@ -1515,6 +1603,7 @@ int TLuaInterpreter::setButtonState(lua_State* L)
 
     if (pItem->mButtonState != checked) {
         pItem->mButtonState = checked;
+        pItem->setUnsaved();
         if (pItem->mpEButton) {
             pItem->mpEButton->setChecked(checked);
         }
@@ -1676,6 +1765,15 @@ int TLuaInterpreter::setTriggerStayOpen(lua_State* L)
     return 0;
 }
 
+// Documentation: https://wiki.mudlet.org/w/Manual:Lua_Functions#startProfiling
+int TLuaInterpreter::startProfiling(lua_State* L)
+{
+    Host& host = getHostFromLua(L);
+    host.mProfiler.setEnabled(true);
+    lua_pushboolean(L, true);
+    return 1;
+}
+
 // Documentation: https://wiki.mudlet.org/w/Manual:Lua_Functions#startStopWatch
 int TLuaInterpreter::startStopWatch(lua_State* L)
 {
@@ -1717,6 +1815,15 @@ int TLuaInterpreter::startStopWatch(lua_State* L)
     return 1;
 }
 
+// Documentation: https://wiki.mudlet.org/w/Manual:Lua_Functions#stopProfiling
+int TLuaInterpreter::stopProfiling(lua_State* L)
+{
+    Host& host = getHostFromLua(L);
+    host.mProfiler.setEnabled(false);
+    lua_pushboolean(L, true);
+    return 1;
+}
+
 // Documentation: https://wiki.mudlet.org/w/Manual:Lua_Functions#stopStopWatch
 int TLuaInterpreter::stopStopWatch(lua_State* L)
 {
@@ -994,6 +994,27 @@ int TLuaInterpreter::getLineCount(lua_State* L)
     return 1;
 }
 
+// Documentation: https://wiki.mudlet.org/w/Manual:Lua_Functions#getLineId
+int TLuaInterpreter::getLineId(lua_State* L)
+{
+    QString windowName;
+    int s = 0;
+    if (lua_gettop(L) > 1 || lua_type(L, 1) == LUA_TSTRING) {
+        windowName = WINDOW_NAME(L, ++s);
+    }
+
+    auto console = CONSOLE(L, windowName);
+    int lineNumber = console->getLineNumber();
+    if (lua_gettop(L) > s) {
+        lineNumber = getVerifiedInt(L, __func__, ++s, "line number {may be omitted for the current line}");
+        if (lineNumber < 0 || lineNumber > console->getLastLineNumber()) {
+            return warnArgumentValue(L, __func__, qsl("line number %1 is not in the range 0 to %2").arg(QString::number(lineNumber), QString::number(console->getLastLineNumber())));
+        }
+    }
+    lua_pushnumber(L, console->buffer.getLineId(lineNumber));
+    return 1;
+}
+
 // Documentation: https://wiki.mudlet.org/w/Manual:Lua_Functions#getLines
 int TLuaInterpreter::getLines(lua_State* L)
 {
@@ -1036,6 +1057,27 @@ int TLuaInterpreter::getLineNumber(lua_State* L)
     return 1;
 }
 
+// Documentation: https://wiki.mudlet.org/w/Manual:Lua_Functions#getLineNumberFromId
+int TLuaInterpreter::getLineNumberFromId(lua_State* L)
+{
+    QString windowName;
+    int s = 0;
+    if (lua_gettop(L) > 1) {
+        windowName = WINDOW_NAME(L, ++s);
+    }
+    const auto lineId = static_cast<qint64>(getVerifiedDouble(L, __func__, ++s, "line id"));
+
+    auto console = CONSOLE(L, windowName);
+    const int lineNumber = console->buffer.getLineNumberFromId(lineId);
+    if (lineNumber < 0) {
+        lua_pushnil(L);
+        lua_pushfstring(L, "line id %s is not in the buffer (it may have been removed as the buffer got too long)", QString::number(lineId).toUtf8().constData());
+        return 2;
+    }
+    lua_pushnumber(L, lineNumber);
+    return 1;
+}
+
 // Documentation: https://wiki.mudlet.org/w/Manual:Lua_Functions#getMainConsoleWidth
 int TLuaInterpreter::getMainConsoleWidth(lua_State* L)
 {
@@ -1857,6 +1899,49 @@ int TLuaInterpreter::scaleMovie(lua_State* L)
     return movieFunc(L, qsl("scaleMovie"));
 }
 
+// Documentation: https://wiki.mudlet.org/w/Manual:Lua_Functions#searchBuffer
+int TLuaInterpreter::searchBuffer(lua_State* L)
+{
+    QString windowName;
+    int s = 0;
+    if (lua_type(L, 2) == LUA_TSTRING) {
+        windowName = WINDOW_NAME(L, ++s);
+    }
+    const QString text = getVerifiedString(L, __func__, ++s, "text to search for");
+    if (text.isEmpty()) {
+        return warnArgumentValue(L, __func__, "the text to search for cannot be empty");
+    }
+    bool isRegex = false;
+    if (lua_gettop(L) > s) {
+        isRegex = getVerifiedBool(L, __func__, ++s, "is regex {default = false}", true);
+    }
+    bool caseSensitive = true;
+    if (lua_gettop(L) > s) {
+        caseSensitive = getVerifiedBool(L, __func__, ++s, "case sensitive {default = true}", true);
+    }
+
+    auto console = CONSOLE(L, windowName);
+    QString errorMessage;
+    const auto hits = console->buffer.findAll(text, caseSensitive, isRegex, &errorMessage);
+    if (!errorMessage.isEmpty()) {
+        return warnArgumentValue(L, __func__, qsl("invalid regular expression \"%1\": %2").arg(text, errorMessage));
+    }
+
+    lua_createtable(L, hits.size(), 0);
+    for (int i = 0, total = hits.size(); i < total; ++i) {
+        const auto& hit = hits.at(i);
+        lua_createtable(L, 0, 3);
+        lua_pushinteger(L, hit.mLine);
+        lua_setfield(L, -2, "line");
+        lua_pushinteger(L, hit.mColumn);
+        lua_setfield(L, -2, "column");
+        lua_pushinteger(L, hit.mLength);
+        lua_setfield(L, -2, "length");
+        lua_rawseti(L, -2, i + 1);
+    }
+    return 1;
+}
+
 // Documentation: https://wiki.mudlet.org/w/Manual:Lua_Functions#selectCaptureGroup
 int TLuaInterpreter::selectCaptureGroup(lua_State *L)
 {
@@ -2306,6 +2391,7 @@ int TLuaInterpreter::setButtonStyleSheet(lua_State* L)
     for (auto actionId : actionIds) {
         auto action = host.getActionUnit()->getAction(actionId);
         action->css = css;
+        action->setUnsaved();
     }
     host.getActionUnit()->updateToolbar();
     lua_pushboolean(L, 1);
@@ -3153,7 +3239,7 @@ int TLuaInterpreter::scrollTo(lua_State* L)
             console->mUpperPane->forceUpdate();
         }
     } else {
-        console->scrollUp(console->mUpperPane->mCursorY - targetLine);
+        console->scrollUp(console->mUpperPane->rowsUpToLine(targetLine));
     }
 
     return 0;
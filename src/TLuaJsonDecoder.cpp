@@ -0,0 +1,439 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include "TLuaJsonDecoder.h"
+
+#include "utils.h"
+
+#include "pre_guard.h"
+#include <QByteArray>
+#include "post_guard.h"
+
+// The same limit that yajl applies by default:
+static const int scmMaxDepth = 128;
+// Integers with no more digits than this are exactly representable in a
+// double so can be converted without going through strtod(...):
+static const int scmMaxExactDigits = 15;
+
+TLuaJsonDecoder::TLuaJsonDecoder(lua_State* L, const char* json, const int length, const int nullIndex)
+: mpL(L)
+, mpBegin(json)
+, mpCurrent(json)
+, mpEnd(json + length)
+, mNullIndex(nullIndex)
+{
+}
+
+bool TLuaJsonDecoder::decode(lua_State* L, const char* json, const int length, const int nullIndex, QString& error)
+{
+    const int top = lua_gettop(L);
+    TLuaJsonDecoder decoder(L, json, length, nullIndex);
+    if (decoder.parseValue(0)) {
+        decoder.skipWhitespace();
+        if (decoder.mpCurrent == decoder.mpEnd) {
+            return true;
+        }
+        decoder.fail("unexpected characters after the value");
+    }
+    lua_settop(L, top);
+    error = decoder.mError;
+    return false;
+}
+
+void TLuaJsonDecoder::splitGmcpMessage(const QByteArray& message, QByteArray& packageMessage, QByteArray& data)
+{
+    const int firstNewline = message.indexOf('\n');
+    const int firstSpace = message.indexOf(' ');
+
+    // if we see a space before a newline, or no newlines at all,
+    // then that's the separator for message and data
+    const int separator = (Q_LIKELY((firstSpace != -1 && firstSpace < firstNewline) || firstNewline == -1)) ? firstSpace : firstNewline;
+    packageMessage = (separator == -1) ? message : message.left(separator);
+    data = (separator == -1) ? QByteArray() : message.mid(separator + 1);
+}
+
+void TLuaJsonDecoder::mergeInto(lua_State* L, const int target)
+{
+    lua_pushnil(L);
+    while (lua_next(L, -2)) {
+        // Stack is now: source, key, value - and lua_next(...) needs the key
+        // left behind for the next iteration:
+        lua_pushvalue(L, -2);
+        lua_insert(L, -2);
+        lua_settable(L, target);
+    }
+    lua_pop(L, 1);
+}
+
+bool TLuaJsonDecoder::fail(const char* message)
+{
+    mError = qsl("%1 at byte %2").arg(QLatin1String(message), QString::number(mpCurrent - mpBegin));
+    return false;
+}
+
+void TLuaJsonDecoder::skipWhitespace()
+{
+    while (mpCurrent < mpEnd && (*mpCurrent == ' ' || *mpCurrent == '\t' || *mpCurrent == '\n' || *mpCurrent == '\r')) {
+        ++mpCurrent;
+    }
+}
+
+bool TLuaJsonDecoder::parseValue(const int depth)
+{
+    skipWhitespace();
+    if (mpCurrent >= mpEnd) {
+        return fail("unexpected end of data");
+    }
+    // Each level of nesting needs room for a table, a key and a value:
+    if (!lua_checkstack(mpL, 3)) {
+        return fail("insufficient Lua stack");
+    }
+
+    switch (*mpCurrent) {
+    case '{':
+        return parseObject(depth + 1);
+    case '[':
+        return parseArray(depth + 1);
+    case '"':
+        return parseString();
+    case 't':
+        if (!parseLiteral("true", 4)) {
+            return false;
+        }
+        lua_pushboolean(mpL, true);
+        return true;
+    case 'f':
+        if (!parseLiteral("false", 5)) {
+            return false;
+        }
+        lua_pushboolean(mpL, false);
+        return true;
+    case 'n':
+        if (!parseLiteral("null", 4)) {
+            return false;
+        }
+        lua_pushvalue(mpL, mNullIndex);
+        return true;
+    default:
+        if (*mpCurrent == '-' || (*mpCurrent >= '0' && *mpCurrent <= '9')) {
+            return parseNumber();
+        }
+        return fail("unexpected character");
+    }
+}
+
+bool TLuaJsonDecoder::parseObject(const int depth)
+{
+    if (depth > scmMaxDepth) {
+        return fail("too deeply nested");
+    }
+    // Skip the '{':
+    ++mpCurrent;
+    lua_newtable(mpL);
+    skipWhitespace();
+    if (mpCurrent < mpEnd && *mpCurrent == '}') {
+        ++mpCurrent;
+        return true;
+    }
+
+    while (true) {
+        skipWhitespace();
+        if (mpCurrent >= mpEnd || *mpCurrent != '"') {
+            return fail("expected a string for an object key");
+        }
+        if (!parseString()) {
+            return false;
+        }
+        skipWhitespace();
+        if (mpCurrent >= mpEnd || *mpCurrent != ':') {
+            return fail("expected ':' after an object key");
+        }
+        ++mpCurrent;
+        if (!parseValue(depth)) {
+            return false;
+        }
+        lua_rawset(mpL, -3);
+
+        skipWhitespace();
+        if (mpCurrent < mpEnd && *mpCurrent == ',') {
+            ++mpCurrent;
+            continue;
+        }
+        if (mpCurrent < mpEnd && *mpCurrent == '}') {
+            ++mpCurrent;
+            return true;
+        }
+        return fail("expected ',' or '}' in an object");
+    }
+}
+
+bool TLuaJsonDecoder::parseArray(const int depth)
+{
+    if (depth > scmMaxDepth) {
+        return fail("too deeply nested");
+    }
+    // Skip the '[':
+    ++mpCurrent;
+    lua_newtable(mpL);
+    skipWhitespace();
+    if (mpCurrent < mpEnd && *mpCurrent == ']') {
+        ++mpCurrent;
+        return true;
+    }
+
+    int index = 0;
+    while (true) {
+        if (!parseValue(depth)) {
+            return false;
+        }
+        lua_rawseti(mpL, -2, ++index);
+
+        skipWhitespace();
+        if (mpCurrent < mpEnd && *mpCurrent == ',') {
+            ++mpCurrent;
+            continue;
+        }
+        if (mpCurrent < mpEnd && *mpCurrent == ']') {
+            ++mpCurrent;
+            return true;
+        }
+        return fail("expected ',' or ']' in an array");
+    }
+}
+
+bool TLuaJsonDecoder::parseLiteral(const char* literal, const int length)
+{
+    if (mpEnd - mpCurrent < length || qstrncmp(mpCurrent, literal, length)) {
+        return fail("invalid literal");
+    }
+    mpCurrent += length;
+    return true;
+}
+
+bool TLuaJsonDecoder::parseHex4(unsigned int& value)
+{
+    if (mpEnd - mpCurrent < 4) {
+        return fail("incomplete \\u escape");
+    }
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+        const char c = *mpCurrent++;
+        value <<= 4;
+        if (c >= '0' && c <= '9') {
+            value |= static_cast<unsigned int>(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            value |= static_cast<unsigned int>(c - 'a' + 10);
+        } else if (c >= 'A' && c <= 'F') {
+            value |= static_cast<unsigned int>(c - 'A' + 10);
+        } else {
+            return fail("invalid hex digit in \\u escape");
+        }
+    }
+    return true;
+}
+
+void TLuaJsonDecoder::appendUtf8(const unsigned int codePoint)
+{
+    if (codePoint < 0x80) {
+        mScratch.push_back(static_cast<char>(codePoint));
+    } else if (codePoint < 0x800) {
+        mScratch.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+        mScratch.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else if (codePoint < 0x10000) {
+        mScratch.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+        mScratch.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        mScratch.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else {
+        mScratch.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+        mScratch.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        mScratch.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        mScratch.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+bool TLuaJsonDecoder::parseString()
+{
+    // Skip the opening '"':
+    const char* start = ++mpCurrent;
+
+    // Most strings have no escapes in them so can be pushed straight from the
+    // input without copying them anywhere else first:
+    while (mpCurrent < mpEnd) {
+        const auto c = static_cast<unsigned char>(*mpCurrent);
+        if (c == '"') {
+            lua_pushlstring(mpL, start, static_cast<size_t>(mpCurrent - start));
+            ++mpCurrent;
+            return true;
+        }
+        if (c == '\\') {
+            break;
+        }
+        if (c < 0x20) {
+            return fail("control character in a string");
+        }
+        ++mpCurrent;
+    }
+
+    mScratch.assign(start, static_cast<size_t>(mpCurrent - start));
+    while (mpCurrent < mpEnd) {
+        const auto c = static_cast<unsigned char>(*mpCurrent);
+        if (c == '"') {
+            lua_pushlstring(mpL, mScratch.data(), mScratch.size());
+            ++mpCurrent;
+            return true;
+        }
+        if (c < 0x20) {
+            return fail("control character in a string");
+        }
+        if (c != '\\') {
+            mScratch.push_back(static_cast<char>(c));
+            ++mpCurrent;
+            continue;
+        }
+
+        // Skip the '\\':
+        if (++mpCurrent >= mpEnd) {
+            break;
+        }
+        switch (*mpCurrent++) {
+        case '"':
+            mScratch.push_back('"');
+            break;
+        case '\\':
+            mScratch.push_back('\\');
+            break;
+        case '/':
+            mScratch.push_back('/');
+            break;
+        case 'b':
+            mScratch.push_back('\b');
+            break;
+        case 'f':
+            mScratch.push_back('\f');
+            break;
+        case 'n':
+            mScratch.push_back('\n');
+            break;
+        case 'r':
+            mScratch.push_back('\r');
+            break;
+        case 't':
+            mScratch.push_back('\t');
+            break;
+        case 'u': {
+            unsigned int codePoint = 0;
+            if (!parseHex4(codePoint)) {
+                return false;
+            }
+            if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+                // A high surrogate, which should be followed by the escape
+                // for a low one - like yajl an unpaired one becomes a '?':
+                const char* afterHigh = mpCurrent;
+                unsigned int lowSurrogate = 0;
+                if (mpEnd - mpCurrent >= 6 && mpCurrent[0] == '\\' && mpCurrent[1] == 'u') {
+                    mpCurrent += 2;
+                    if (!parseHex4(lowSurrogate)) {
+                        return false;
+                    }
+                }
+                if (lowSurrogate >= 0xDC00 && lowSurrogate <= 0xDFFF) {
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+                } else {
+                    mpCurrent = afterHigh;
+                    codePoint = '?';
+                }
+            } else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+                codePoint = '?';
+            }
+            appendUtf8(codePoint);
+            break;
+        }
+        default:
+            --mpCurrent;
+            return fail("invalid escape sequence in a string");
+        }
+    }
+    return fail("unterminated string");
+}
+
+bool TLuaJsonDecoder::parseNumber()
+{
+    const char* start = mpCurrent;
+    bool isNegative = false;
+    if (*mpCurrent == '-') {
+        isNegative = true;
+        ++mpCurrent;
+    }
+
+    const char* firstDigit = mpCurrent;
+    if (mpCurrent < mpEnd && *mpCurrent == '0') {
+        ++mpCurrent;
+    } else if (mpCurrent < mpEnd && *mpCurrent >= '1' && *mpCurrent <= '9') {
+        while (mpCurrent < mpEnd && *mpCurrent >= '0' && *mpCurrent <= '9') {
+            ++mpCurrent;
+        }
+    } else {
+        return fail("invalid number");
+    }
+    const auto integerDigits = static_cast<int>(mpCurrent - firstDigit);
+
+    bool isInteger = true;
+    if (mpCurrent < mpEnd && *mpCurrent == '.') {
+        isInteger = false;
+        ++mpCurrent;
+        if (mpCurrent >= mpEnd || *mpCurrent < '0' || *mpCurrent > '9') {
+            return fail("invalid number");
+        }
+        while (mpCurrent < mpEnd && *mpCurrent >= '0' && *mpCurrent <= '9') {
+            ++mpCurrent;
+        }
+    }
+    if (mpCurrent < mpEnd && (*mpCurrent == 'e' || *mpCurrent == 'E')) {
+        isInteger = false;
+        ++mpCurrent;
+        if (mpCurrent < mpEnd && (*mpCurrent == '+' || *mpCurrent == '-')) {
+            ++mpCurrent;
+        }
+        if (mpCurrent >= mpEnd || *mpCurrent < '0' || *mpCurrent > '9') {
+            return fail("invalid number");
+        }
+        while (mpCurrent < mpEnd && *mpCurrent >= '0' && *mpCurrent <= '9') {
+            ++mpCurrent;
+        }
+    }
+
+    if (isInteger && integerDigits <= scmMaxExactDigits) {
+        qint64 value = 0;
+        for (const char* digit = firstDigit; digit < mpCurrent; ++digit) {
+            value = value * 10 + (*digit - '0');
+        }
+        lua_pushnumber(mpL, static_cast<lua_Number>(isNegative ? -value : value));
+        return true;
+    }
+
+    // QByteArray::toDouble(...) always uses the C locale, unlike strtod(...):
+    bool isOk = false;
+    const double value = QByteArray::fromRawData(start, static_cast<int>(mpCurrent - start)).toDouble(&isOk);
+    if (!isOk) {
+        return fail("number out of range");
+    }
+    lua_pushnumber(mpL, value);
+    return true;
+}
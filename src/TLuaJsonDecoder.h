@@ -0,0 +1,86 @@
+#ifndef MUDLET_TLUAJSONDECODER_H
+#define MUDLET_TLUAJSONDECODER_H
+
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include "pre_guard.h"
+#include <QByteArray>
+#include <QString>
+#include "post_guard.h"
+
+extern "C" {
+    #include <lua.h>
+}
+
+#include <string>
+
+// Turns JSON text (in UTF-8) straight into the equivalent Lua value on the
+// stack of a Lua state in a single pass without going through a QString or
+// calling back into Lua. It produces the same shape of value as the yajl
+// to_value(...) function that was used for GMCP and MSDP data: objects and
+// arrays become tables (arrays with keys from 1), strings, numbers and
+// booleans become the Lua equivalents and null becomes whatever value the
+// caller supplies (yajl's null sentinel).
+class TLuaJsonDecoder
+{
+public:
+    // Pushes the decoded value and returns true, or pushes nothing, fills in
+    // error and returns false if the text is not valid JSON. A JSON null is
+    // decoded as a copy of the value at the (absolute) stack index nullIndex:
+    static bool decode(lua_State* L, const char* json, const int length, const int nullIndex, QString& error);
+
+    // Copies every key/value of the table on the top of the stack into the
+    // table at (absolute) stack index target and then pops it; this is how
+    // the data for a registered GMCP "merge" key updates the existing table
+    // rather than replacing it:
+    static void mergeInto(lua_State* L, const int target);
+
+    // Splits a GMCP message into the package(.message) name and the (JSON)
+    // data after it - which is separated by a space or, if there is a line
+    // feed before any space, by that. A message with neither, e.g.
+    // "Core.Ping", is all name and has no data:
+    static void splitGmcpMessage(const QByteArray& message, QByteArray& packageMessage, QByteArray& data);
+
+private:
+    TLuaJsonDecoder(lua_State* L, const char* json, const int length, const int nullIndex);
+
+    bool parseValue(const int depth);
+    bool parseObject(const int depth);
+    bool parseArray(const int depth);
+    bool parseString();
+    bool parseNumber();
+    bool parseLiteral(const char* literal, const int length);
+    bool parseHex4(unsigned int& value);
+    void appendUtf8(const unsigned int codePoint);
+    void skipWhitespace();
+    bool fail(const char* message);
+
+    lua_State* mpL = nullptr;
+    const char* mpBegin = nullptr;
+    const char* mpCurrent = nullptr;
+    const char* mpEnd = nullptr;
+    int mNullIndex = 0;
+    QString mError;
+    // Reused for strings that contain escape sequences:
+    std::string mScratch;
+};
+
+#endif // MUDLET_TLUAJSONDECODER_H
@@ -697,7 +697,9 @@ std::pair<bool, QString> TMainConsole::createMapper(const QString& windowname, i
         mpHost->mpMap->pushErrorMessagesToFile(tr("Pre-Map loading(2) report"), true);
         const QDateTime now(QDateTime::currentDateTime());
 
-        if (mpHost->mpMap->restore(QString())) {
+        // If the profile's map is already being loaded the mapper will be
+        // set up once that has finished:
+        if (!mpHost->mpMap->isLoadingInBackground() && mpHost->mpMap->restore(QString())) {
             mpHost->mpMap->audit();
             mpMapper->mp2dMap->init();
             mpMapper->updateAreaComboBox();
@@ -1153,7 +1155,10 @@ void TMainConsole::printOnDisplay(std::string& incomingSocketData, const bool is
     Q_ASSERT_X(mpLineEdit_networkLatency, "TMainConsole::printOnDisplay(...)", "mpLineEdit_networkLatency does not point to a valid QLineEdit");
     mProcessingTimer.restart();
     mTriggerEngineMode = true;
-    buffer.translateToPlainText(incomingSocketData, isFromServer);
+    {
+        const TInboundStats::Scope timeTranslate(mpHost->mInboundStats, TInboundStats::Translate);
+        buffer.translateToPlainText(incomingSocketData, isFromServer);
+    }
     mTriggerEngineMode = false;
 
     // dequeues MXP events and raise them through the LuaInterpreter
@@ -1191,6 +1196,8 @@ void TMainConsole::printOnDisplay(std::string& incomingSocketData, const bool is
 
 void TMainConsole::runTriggers(int line)
 {
+    const TInboundStats::Scope timeTriggers(mpHost->mInboundStats, TInboundStats::Triggers);
+    mpHost->mInboundStats.addLines(1);
     mUserCursor.setY(line);
     mIsPromptLine = buffer.promptBuffer.at(line);
     mEngineCursor = line;
@@ -1274,6 +1281,13 @@ bool TMainConsole::loadMap(const QString& location)
         return false;
     }
 
+    if (pHost->mpMap->isLoadingInBackground()) {
+        // Clearing the map now would lose the details already read for the
+        // map being loaded:
+        pHost->postMessage(tr("[ ERROR ] - Another map cannot be loaded until the one being loaded has finished."));
+        return false;
+    }
+
     pHost->mpMap->mapClear();
 
     qDebug() << "TMainConsole::loadMap() - restore map case 1.";
@@ -1338,6 +1352,15 @@ bool TMainConsole::importMap(const QString& location, QString* errMsg)
         return false;
     }
 
+    if (pHost->mpMap->isLoadingInBackground()) {
+        if (errMsg) {
+            *errMsg = qsl("loadMap: a map is still being loaded, try again when it has finished");
+        } else {
+            pHost->postMessage(tr("[ ERROR ] - Another map cannot be loaded until the one being loaded has finished."));
+        }
+        return false;
+    }
+
     // Dump any outstanding map errors from past activities that had not yet
     // been logged...
     qDebug() << "TMainConsole::importingMap() - importing map case 1.";
@@ -1523,6 +1546,10 @@ void TMainConsole::showStatistics()
     itemMsg = std::get<0>(mpHost->getGifTracker()->assembleReport());
     print(itemMsg, QColor(150, 120, 0), Qt::black);
 
+    //: Heading for the system's statistics information displayed in the console
+    mpHost->mLuaInterpreter.compileAndExecuteScript(itemScript.arg(tr("Profiler Report (slowest items first):")));
+    print(mpHost->mProfiler.report(20), QColor(150, 120, 0), Qt::black);
+
     // Footer for the system's statistics information displayed in the console, it should be 64 'narrow' characters wide
     const QString footer = qsl("\n+--------------------------------------------------------------+\n");
     mpHost->mpConsole->print(footer, QColor(150, 120, 0), Qt::black);
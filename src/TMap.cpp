@@ -41,6 +41,9 @@
 #include <QProgressDialog>
 #include <QPainter>
 #include <QBuffer>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QtConcurrent>
 #include "post_guard.h"
 
 
@@ -67,6 +70,11 @@ TMap::TMap(Host* pH, const QString& profileName)
 
 TMap::~TMap()
 {
+    if (mIsLoadingInBackground) {
+        mAbortBackgroundLoad = true;
+        mBackgroundLoad.waitForFinished();
+        delete mpBackgroundRoomDB;
+    }
     delete mpRoomDB;
     if (!mStoredMessages.isEmpty()) {
         qWarning() << "TMap::~TMap() Instance being destroyed before it could display some messages,\n"
@@ -90,9 +98,9 @@ void TMap::mapClear()
     mCustomEnvColors.clear();
     // Need to restore the default colours:
     restore16ColorSet();
-    roomidToIndex.clear();
-    edgeHash.clear();
-    locations.clear();
+    mGraph.clear();
+    mGraphDirtyRooms.clear();
+    mGraphDirtyExits.clear();
     mMapGraphNeedsUpdate = true;
     mNewMove = true;
     mVersion = mDefaultVersion;
@@ -157,7 +165,8 @@ bool TMap::setRoomArea(int id, int area, bool deferAreaRecalculations)
 
     const bool result = pR->setArea(area, deferAreaRecalculations);
     if (result) {
-        mMapGraphNeedsUpdate = true;
+        // The area level routing groups the rooms in the graph by area:
+        markRoomChanged(id);
         setUnsaved(__func__);
     }
     return result;
@@ -166,7 +175,7 @@ bool TMap::setRoomArea(int id, int area, bool deferAreaRecalculations)
 bool TMap::addRoom(int id)
 {
     if (mpRoomDB->addRoom(id)) {
-        mMapGraphNeedsUpdate = true;
+        markRoomChanged(id);
         setUnsaved(__func__);
         return true;
     }
@@ -506,7 +515,7 @@ bool TMap::setExit(int from, int to, int dir)
         ret = false;
     }
     pR->setExitStub(dir, false);
-    mMapGraphNeedsUpdate = true;
+    markRoomExitsChanged(from);
     TArea* pA = mpRoomDB->getArea(pR->getArea());
     if (!pA) {
         return false;
@@ -679,264 +688,170 @@ void TMap::initGraph()
 {
     QElapsedTimer _time;
     _time.start();
-    locations.clear();
-    roomidToIndex.clear();
-    g.clear();
-    g = mygraph_t();
-    unsigned int roomCount = 0;
-    unsigned int edgeCount = 0;
-    QSet<unsigned int> unUsableRoomSet;
-    // Keep track of the unusable rather than the usable ones because that is
-    // hopefully a MUCH smaller set in normal situations!
+    mGraph.clear();
+    mGraphDirtyRooms.clear();
+    mGraphDirtyExits.clear();
+    unsigned int unUsableRoomCount = 0;
     QHashIterator<int, TRoom*> itRoom = mpRoomDB->getRoomMap();
     while (itRoom.hasNext()) {
         itRoom.next();
         TRoom* pR = itRoom.value();
         if (itRoom.key() < 1 || !pR || pR->isLocked) {
-            unUsableRoomSet.insert(itRoom.key());
+            ++unUsableRoomCount;
             continue;
         }
 
-        location l;
-        l.pR = pR;
-        l.id = itRoom.key();
-        // locations is std::vector<location> and (locations.at(k)).id will give room ID value
-        locations.push_back(l);
-        // This command maps usable TRooms (key) to index of entry in locations (for route finding).
-        // It loses invalid and unusable (i.e. locked) rooms
-        roomidToIndex.insert(itRoom.key(), roomCount++);
-    }
-
-    // Now identify the routes between rooms, and pick out the best edges of parallel ones
-    for (auto l : locations) {
-        unsigned const int source = l.id;
-        TRoom* pSourceR = l.pR;
-        QHash<unsigned int, route> bestRoutes;
-        // key is target (destination room),
-        // value is data we will need to store later,
-        QMap<QString, int> const exitWeights = pSourceR->getExitWeights();
-
-        int target = pSourceR->getNorth();
-        TRoom* pTargetR;
-        quint8 direction = DIR_NORTH;
-        if (target > 0 && static_cast<int>(source) != target && !unUsableRoomSet.contains(target) && !pSourceR->hasExitLock(direction)) {
-            // In above tests the second test is to eliminate self-edges (they
-            // are of no use).  The third test is to eliminate targets that we
-            // have already found to be unreachable because they are invalid or
-            // locked.
-            pTargetR = mpRoomDB->getRoom(target);
-            if (pTargetR && !pTargetR->isLocked) { // OK got something that is valid
-                route r;
-                r.cost = exitWeights.value(qsl("n"), pTargetR->getWeight());
-                r.direction = direction;
-                bestRoutes.insert(target, r);
-            }
-        }
+        // This maps usable TRooms to a vertex in the graph (for route
+        // finding) - it loses invalid and unusable (i.e. locked) rooms:
+        mGraph.addRoom(itRoom.key(), pR, pR->getArea());
+    }
 
-        target = pSourceR->getEast();
-        direction = DIR_EAST;
-        if (target > 0 && static_cast<int>(source) != target && !unUsableRoomSet.contains(target) && !pSourceR->hasExitLock(direction)) {
-            pTargetR = mpRoomDB->getRoom(target);
-            if (pTargetR && !pTargetR->isLocked) {
-                route r;
-                r.cost = exitWeights.value(qsl("e"), pTargetR->getWeight());
-                if (!bestRoutes.contains(target) || bestRoutes.value(target).cost > r.cost) { // Ah, this is a better route
-                    r.direction = direction;
-                    bestRoutes.insert(target, r); // If the second part of conditional is the truth this will replace previous best route to this target
-                }
-            }
-        }
+    // Now identify the routes between rooms, and pick out the best edges of
+    // parallel ones - this has to wait until all the usable rooms have a
+    // vertex as they are the only ones that can be the target of an edge:
+    for (const auto& l : mGraph.locations()) {
+        mGraph.setRoutes(l.id, graphRoutesFrom(l.pR));
+    }
 
-        target = pSourceR->getSouth();
-        direction = DIR_SOUTH;
-        if (target > 0 && static_cast<int>(source) != target && !unUsableRoomSet.contains(target) && !pSourceR->hasExitLock(direction)) {
-            pTargetR = mpRoomDB->getRoom(target);
-            if (pTargetR && !pTargetR->isLocked) {
-                route r;
-                r.cost = exitWeights.value(qsl("s"), pTargetR->getWeight());
-                if (!bestRoutes.contains(target) || bestRoutes.value(target).cost > r.cost) {
-                    r.direction = direction;
-                    bestRoutes.insert(target, r);
-                }
-            }
-        }
+    mMapGraphNeedsUpdate = false;
+    qDebug() << "TMap::initGraph() INFO: built graph with:" << mGraph.roomCount() << "locations, and discarded" << unUsableRoomCount
+             << "other NOT usable rooms and found:" << mGraph.edgeCount() << "distinct, usable edges in:" << _time.nsecsElapsed() * 1.0e-6 << "ms.";
+}
 
-        target = pSourceR->getWest();
-        direction = DIR_WEST;
-        if (target > 0 && static_cast<int>(source) != target && !unUsableRoomSet.contains(target) && !pSourceR->hasExitLock(direction)) {
-            pTargetR = mpRoomDB->getRoom(target);
-            if (pTargetR && !pTargetR->isLocked) {
-                route r;
-                r.cost = exitWeights.value(qsl("w"), pTargetR->getWeight());
-                if (!bestRoutes.contains(target) || bestRoutes.value(target).cost > r.cost) {
-                    r.direction = direction;
-                    bestRoutes.insert(target, r);
-                }
-            }
-        }
+// Brings the graph up to date with the rooms that have been marked as changed
+// since it was last used, rather than building it all over again:
+void TMap::updateGraph()
+{
+    if (mMapGraphNeedsUpdate) {
+        initGraph();
+        return;
+    }
 
-        target = pSourceR->getUp();
-        direction = DIR_UP;
-        if (target > 0 && static_cast<int>(source) != target && !unUsableRoomSet.contains(target) && !pSourceR->hasExitLock(direction)) {
-            pTargetR = mpRoomDB->getRoom(target);
-            if (pTargetR && !pTargetR->isLocked) {
-                route r;
-                r.cost = exitWeights.value(qsl("up"), pTargetR->getWeight());
-                if (!bestRoutes.contains(target) || bestRoutes.value(target).cost > r.cost) {
-                    r.direction = direction;
-                    bestRoutes.insert(target, r);
-                }
-            }
-        }
+    if (mGraphDirtyRooms.isEmpty() && mGraphDirtyExits.isEmpty()) {
+        return;
+    }
 
-        target = pSourceR->getDown();
-        direction = DIR_DOWN;
-        if (target > 0 && static_cast<int>(source) != target && !unUsableRoomSet.contains(target) && !pSourceR->hasExitLock(direction)) {
-            pTargetR = mpRoomDB->getRoom(target);
-            if (pTargetR && !pTargetR->isLocked) {
-                route r;
-                r.cost = exitWeights.value(qsl("down"), pTargetR->getWeight());
-                if (!bestRoutes.contains(target) || bestRoutes.value(target).cost > r.cost) {
-                    r.direction = direction;
-                    bestRoutes.insert(target, r);
-                }
-            }
-        }
+    // Once a lot of vertices have been left behind by removed rooms it is
+    // better to start again than to keep searching through them:
+    if (mGraph.freeVertexCount() > 1000 && mGraph.freeVertexCount() > mGraph.roomCount()) {
+        initGraph();
+        return;
+    }
 
-        target = pSourceR->getNortheast();
-        direction = DIR_NORTHEAST;
-        if (target > 0 && static_cast<int>(source) != target && !unUsableRoomSet.contains(target) && !pSourceR->hasExitLock(direction)) {
-            pTargetR = mpRoomDB->getRoom(target);
-            if (pTargetR && !pTargetR->isLocked) {
-                route r;
-                r.cost = exitWeights.value(qsl("ne"), pTargetR->getWeight());
-                if (!bestRoutes.contains(target) || bestRoutes.value(target).cost > r.cost) {
-                    r.direction = direction;
-                    bestRoutes.insert(target, r);
-                }
-            }
+    // A room that has come or gone, been (un)locked or had its weight changed
+    // also changes the routes into it from every room with an exit to it:
+    const QMultiHash<int, int>& entranceMap = mpRoomDB->getEntranceHash();
+    for (const int roomId : std::as_const(mGraphDirtyRooms)) {
+        mGraphDirtyExits.insert(roomId);
+        const QList<int> graphEntrances = mGraph.entrances(roomId);
+        for (const int source : graphEntrances) {
+            mGraphDirtyExits.insert(source);
         }
-
-        target = pSourceR->getSoutheast();
-        direction = DIR_SOUTHEAST;
-        if (target > 0 && static_cast<int>(source) != target && !unUsableRoomSet.contains(target) && !pSourceR->hasExitLock(direction)) {
-            pTargetR = mpRoomDB->getRoom(target);
-            if (pTargetR && !pTargetR->isLocked) {
-                route r;
-                r.cost = exitWeights.value(qsl("se"), pTargetR->getWeight());
-                if (!bestRoutes.contains(target) || bestRoutes.value(target).cost > r.cost) {
-                    r.direction = direction;
-                    bestRoutes.insert(target, r);
-                }
-            }
+        for (auto itEntrance = entranceMap.constFind(roomId); itEntrance != entranceMap.cend() && itEntrance.key() == roomId; ++itEntrance) {
+            mGraphDirtyExits.insert(itEntrance.value());
         }
 
-        target = pSourceR->getSouthwest();
-        direction = DIR_SOUTHWEST;
-        if (target > 0 && static_cast<int>(source) != target && !unUsableRoomSet.contains(target) && !pSourceR->hasExitLock(direction)) {
-            pTargetR = mpRoomDB->getRoom(target);
-            if (pTargetR && !pTargetR->isLocked) {
-                route r;
-                r.cost = exitWeights.value(qsl("sw"), pTargetR->getWeight());
-                if (!bestRoutes.contains(target) || bestRoutes.value(target).cost > r.cost) {
-                    r.direction = direction;
-                    bestRoutes.insert(target, r);
-                }
-            }
+        TRoom* pR = mpRoomDB->getRoom(roomId);
+        if (roomId < 1 || !pR || pR->isLocked) {
+            mGraph.removeRoom(roomId);
+        } else {
+            mGraph.addRoom(roomId, pR, pR->getArea());
         }
+    }
+    mGraphDirtyRooms.clear();
 
-        target = pSourceR->getNorthwest();
-        direction = DIR_NORTHWEST;
-        if (target > 0 && static_cast<int>(source) != target && !unUsableRoomSet.contains(target) && !pSourceR->hasExitLock(direction)) {
-            pTargetR = mpRoomDB->getRoom(target);
-            if (pTargetR && !pTargetR->isLocked) {
-                route r;
-                r.cost = exitWeights.value(qsl("nw"), pTargetR->getWeight());
-                if (!bestRoutes.contains(target) || bestRoutes.value(target).cost > r.cost) {
-                    r.direction = direction;
-                    bestRoutes.insert(target, r);
-                }
-            }
+    for (const int roomId : std::as_const(mGraphDirtyExits)) {
+        if (mGraph.contains(roomId)) {
+            mGraph.setRoutes(roomId, graphRoutesFrom(mpRoomDB->getRoom(roomId)));
         }
+    }
+    mGraphDirtyExits.clear();
+}
 
-        target = pSourceR->getIn();
-        direction = DIR_IN;
-        if (target > 0 && static_cast<int>(source) != target && !unUsableRoomSet.contains(target) && !pSourceR->hasExitLock(direction)) {
-            pTargetR = mpRoomDB->getRoom(target);
-            if (pTargetR && !pTargetR->isLocked) {
-                route r;
-                r.cost = exitWeights.value(qsl("in"), pTargetR->getWeight());
-                if (!bestRoutes.contains(target) || bestRoutes.value(target).cost > r.cost) {
-                    r.direction = direction;
-                    bestRoutes.insert(target, r);
-                }
-            }
-        }
+void TMap::markRoomChanged(const int roomId)
+{
+    if (!mMapGraphNeedsUpdate) {
+        mGraphDirtyRooms.insert(roomId);
+    }
+}
 
-        target = pSourceR->getOut();
-        direction = DIR_OUT;
-        if (target > 0 && static_cast<int>(source) != target && !unUsableRoomSet.contains(target) && !pSourceR->hasExitLock(direction)) {
-            pTargetR = mpRoomDB->getRoom(target);
-            if (pTargetR && !pTargetR->isLocked) {
-                route r;
-                r.cost = exitWeights.value(qsl("out"), pTargetR->getWeight());
-                if (!bestRoutes.contains(target) || bestRoutes.value(target).cost > r.cost) {
-                    r.direction = direction;
-                    bestRoutes.insert(target, r);
-                }
-            }
+void TMap::markRoomExitsChanged(const int roomId)
+{
+    if (!mMapGraphNeedsUpdate) {
+        mGraphDirtyExits.insert(roomId);
+    }
+}
+
+// Works out the best (cheapest) usable route from the given room to each of
+// the other usable rooms that it has one or more exits to - only rooms that
+// already have a vertex in the graph count as usable:
+QHash<int, route> TMap::graphRoutesFrom(TRoom* pSourceR) const
+{
+    // The order matters - where parallel exits have the same cost the first
+    // one found is kept:
+    static const QList<QPair<quint8, QString>> scmNormalExits{{DIR_NORTH, qsl("n")},
+                                                              {DIR_EAST, qsl("e")},
+                                                              {DIR_SOUTH, qsl("s")},
+                                                              {DIR_WEST, qsl("w")},
+                                                              {DIR_UP, qsl("up")},
+                                                              {DIR_DOWN, qsl("down")},
+                                                              {DIR_NORTHEAST, qsl("ne")},
+                                                              {DIR_SOUTHEAST, qsl("se")},
+                                                              {DIR_SOUTHWEST, qsl("sw")},
+                                                              {DIR_NORTHWEST, qsl("nw")},
+                                                              {DIR_IN, qsl("in")},
+                                                              {DIR_OUT, qsl("out")}};
+
+    QHash<int, route> bestRoutes;
+    // key is target (destination room),
+    // value is data we will need to store later,
+    if (!pSourceR) {
+        return bestRoutes;
+    }
+
+    const int source = pSourceR->getId();
+    const QMap<QString, int> exitWeights = pSourceR->getExitWeights();
+    auto consider = [&](const int target, const quint8 direction, const QString& weightKey, const QString& specialExitName) {
+        // In the following tests the second one is to eliminate self-edges
+        // (they are of no use) and the third one eliminates targets that are
+        // invalid or locked:
+        if (target < 1 || target == source || !mGraph.contains(target)) {
+            return;
+        }
+        const TRoom* pTargetR = mpRoomDB->getRoom(target);
+        if (!pTargetR || pTargetR->isLocked) {
+            return;
+        }
+        route r;
+        r.cost = exitWeights.value(weightKey, pTargetR->getWeight());
+        if (!bestRoutes.contains(target) || bestRoutes.value(target).cost > r.cost) { // Ah, this is a better route
+            r.direction = direction;
+            r.specialExitName = specialExitName;
+            bestRoutes.insert(target, r); // If the second part of conditional is the truth this will replace previous best route to this target
         }
+    };
 
-        QMapIterator<QString, int> itSpecialExit(pSourceR->getSpecialExits());
-        while (itSpecialExit.hasNext()) {
-            itSpecialExit.next();
-            if (pSourceR->hasSpecialExitLock(itSpecialExit.key())) {
-                continue; // Is a locked exit so forget it...
-            }
+    for (const auto& normalExit : scmNormalExits) {
+        if (!pSourceR->hasExitLock(normalExit.first)) {
+            consider(pSourceR->getExit(normalExit.first), normalExit.first, normalExit.second, QString());
+        }
+    }
 
-            target = itSpecialExit.value();
-            direction = DIR_OTHER;
-            if (target > 0 && static_cast<int>(source) != target && !unUsableRoomSet.contains(target)) {
-                pTargetR = mpRoomDB->getRoom(target);
-                if (pTargetR && !pTargetR->isLocked) {
-                    route r;
-                    r.specialExitName = itSpecialExit.key();
-                    r.cost = exitWeights.value(r.specialExitName, pTargetR->getWeight());
-                    if (!bestRoutes.contains(target) || bestRoutes.value(target).cost > r.cost) {
-                        r.direction = direction;
-                        bestRoutes.insert(target, r);
-                    }
-                }
-            }
-        } // End of while(itSpecialExit.hasNext())
-
-        // Now we have eliminated possible duplicate and useless edges we can create and
-        // insert the remainder into the BGL graph:
-        QHashIterator<unsigned int, route> itRoute = bestRoutes;
-        while (itRoute.hasNext()) {
-            itRoute.next();
-            edge_descriptor e;
-            bool inserted; // This is always going to be false as it gets set if
-                           // we had tried to insert a parallel edge into a graph
-                           // that does not support them - but we've just been
-                           // and disposed of those already!
-            tie(e, inserted) = add_edge(roomidToIndex.value(source), roomidToIndex.value(itRoute.key()), itRoute.value().cost, g);
-            edgeHash.insert(qMakePair(source, itRoute.key()), itRoute.value());
-            // The key is made from the QPair<edgeSourceRoomId, edgeTargetRoomId>...
-            edgeCount++;
-        }
-    } // End of foreach(location l, locations)
+    QMapIterator<QString, int> itSpecialExit(pSourceR->getSpecialExits());
+    while (itSpecialExit.hasNext()) {
+        itSpecialExit.next();
+        if (pSourceR->hasSpecialExitLock(itSpecialExit.key())) {
+            continue; // Is a locked exit so forget it...
+        }
+        consider(itSpecialExit.value(), DIR_OTHER, itSpecialExit.key(), itSpecialExit.key());
+    }
 
-    mMapGraphNeedsUpdate = false;
-    qDebug() << "TMap::initGraph() INFO: built graph with:" << locations.size() << "(" << roomCount << ") locations(roomCount), and discarded" << unUsableRoomSet.count()
-             << "other NOT usable rooms and found:" << edgeCount << "distinct, usable edges in:" << _time.nsecsElapsed() * 1.0e-6 << "ms.";
+    return bestRoutes;
 }
 
 bool TMap::findPath(int from, int to)
 {
-    if (mMapGraphNeedsUpdate) {
-        initGraph();
-    }
+    updateGraph();
 
     QElapsedTimer t;
     t.start();
@@ -1013,43 +928,70 @@ bool TMap::findPath(int from, int to)
         return false; // No available exits from the start room so give up!
     }
 
-    if (!roomidToIndex.contains(from)) {
+    if (!mGraph.contains(from)) {
         qDebug() << "TMap::findPath(" << from << "," << to << ") FAIL: start room not in map graph!";
         return false;
         // The start room is NOT one that has been included in the BGL graph
         // probably because it is locked - so no route finding can be done
     }
-    vertex const start = roomidToIndex.value(from);
+    TMapGraph::vertex const start = mGraph.vertexOf(from);
 
-    if (!roomidToIndex.contains(to)) {
+    if (!mGraph.contains(to)) {
         qDebug() << "TMap::findPath(" << from << "," << to << ") FAIL: target room not in map graph!";
         return false;
         // The target room is NOT one that has been included in the BGL graph
         // probably because it is locked - so no route finding can be done
     }
-    vertex const goal = roomidToIndex.value(to);
+    TMapGraph::vertex const goal = mGraph.vertexOf(to);
 
-    std::vector<vertex> p(num_vertices(g));
+    if (mpHost && mpHost->mMapperAreaRouting) {
+        QList<int> path;
+        cost total = 0;
+        if (!mGraph.findAreaRoute(from, to, path, total)) {
+            qDebug() << "TMap::findPath(" << from << "," << to << ") INFO: did NOT find area level route in:" << t.nsecsElapsed() * 1.0e-6 << "ms.";
+            return false;
+        }
+
+        int previousRoomId = from;
+        for (const int roomId : std::as_const(path)) {
+            const route r = mGraph.routeBetween(previousRoomId, roomId);
+            mPathList.append(roomId);
+            mWeightList.append(r.cost);
+            const QString command = routeCommand(r);
+            if (command.isEmpty()) {
+                qWarning().nospace().noquote() << "TMap::findPath(" << from << ", " << to << ") WARNING - found route between rooms (from id: " << previousRoomId << ", to id: " << roomId << ") with an invalid DIR_xxxx code: " << r.direction << " - the path will not be valid!";
+            } else {
+                mDirList.append(command);
+            }
+            previousRoomId = roomId;
+        }
+        qDebug() << "TMap::findPath(" << from << "," << to << ") INFO: found area level route through:" << mGraph.portalCount() << "portals in:" << t.nsecsElapsed() * 1.0e-6 << "ms.";
+        return true;
+    }
+
+    const TMapGraph::mygraph_t& g = mGraph.graph();
+    const std::vector<location>& locations = mGraph.locations();
+    std::vector<TMapGraph::vertex> p(num_vertices(g));
     // Somehow p is an ascending, monotonic series of numbers start at 0, it
     // seems we have a redundant indirection in play there as p[0]=0, p[1]=1,..., p[n]=n ...!
     std::vector<cost> d(num_vertices(g));
     try {
-        astar_search(g, start, distance_heuristic<mygraph_t, cost, std::vector<location>>(locations, goal), predecessor_map(&p[0]).distance_map(&d[0]).visitor(astar_goal_visitor<vertex>(goal)));
+        astar_search(g, start, distance_heuristic<TMapGraph::mygraph_t, cost, const std::vector<location>&>(locations, goal), predecessor_map(&p[0]).distance_map(&d[0]).visitor(astar_goal_visitor<TMapGraph::vertex>(goal)));
     } catch (found_goal) {
         qDebug() << "TMap::findPath(" << from << "," << to << ") INFO: time elapsed in A*:" << t.nsecsElapsed() * 1.0e-6 << "ms.";
         t.restart();
-        if (!roomidToIndex.contains(to)) {
+        if (!mGraph.contains(to)) {
             qDebug() << "TMap::findPath(" << from << "," << to << ") FAIL: target room not in map graph!";
             return false;
         }
 
-        vertex currentVertex = roomidToIndex.value(to);
+        TMapGraph::vertex currentVertex = mGraph.vertexOf(to);
         unsigned int currentRoomId = (locations.at(currentVertex)).id;
 
         // We step through the found path BACKWARDS so advance (well retard)
         // the "previous" one first, and it will be the SOURCE vertex for the
         // edge and current will be the TARGET vertex:
-        vertex previousVertex = currentVertex;
+        TMapGraph::vertex previousVertex = currentVertex;
         do {
             previousVertex = p[currentVertex];
             if (previousVertex == currentVertex) {
@@ -1060,8 +1002,7 @@ bool TMap::findPath(int from, int to)
                 return false;
             }
             const unsigned int previousRoomId = (locations.at(previousVertex)).id;
-            QPair<unsigned int, unsigned int> const edgeRoomIdPair = qMakePair(previousRoomId, currentRoomId);
-            const route r = edgeHash.value(edgeRoomIdPair);
+            const route r = mGraph.routeBetween(previousRoomId, currentRoomId);
             mPathList.prepend(currentRoomId);
             Q_ASSERT_X(r.cost > 0, "TMap::findPath()", "broken path {QPair made from source and target roomIds for a path step NOT found in QHash table of all possible steps.}");
             // Above was found to be triggered by the situation described in:
@@ -1071,30 +1012,11 @@ bool TMap::findPath(int from, int to)
             // the do{} loop - added a test for this so should bail out if it
             // happens - Slysven
             mWeightList.prepend(r.cost);
-            switch (r.direction) {
-                /*
-                 * Do not translate the directions into the user's locale here,
-                 * that is to be done in the profile specific doSpeedwalk()
-                 * function of the mapper package as the language of the MUD
-                 * need not be the native language of the user - translating
-                 * them here makes the mapper harder to code as it has to
-                 * accommodate all the possible languages the GUI of Mudlet was
-                 * configured to support!
-                 */
-            case DIR_NORTH:        mDirList.prepend(qsl("n"));             break;
-            case DIR_NORTHEAST:    mDirList.prepend(qsl("ne"));            break;
-            case DIR_EAST:         mDirList.prepend(qsl("e"));             break;
-            case DIR_SOUTHEAST:    mDirList.prepend(qsl("se"));            break;
-            case DIR_SOUTH:        mDirList.prepend(qsl("s"));             break;
-            case DIR_SOUTHWEST:    mDirList.prepend(qsl("sw"));            break;
-            case DIR_WEST:         mDirList.prepend(qsl("w"));             break;
-            case DIR_NORTHWEST:    mDirList.prepend(qsl("nw"));            break;
-            case DIR_UP:           mDirList.prepend(qsl("up"));            break;
-            case DIR_DOWN:         mDirList.prepend(qsl("down"));          break;
-            case DIR_IN:           mDirList.prepend(qsl("in"));            break;
-            case DIR_OUT:          mDirList.prepend(qsl("out"));           break;
-            case DIR_OTHER:        mDirList.prepend(r.specialExitName);    break;
-            default:            qWarning().nospace().noquote() << "TMap::findPath(" << from << ", " << to << ") WARNING - found route between rooms (from id: " << previousRoomId << ", to id: " << currentRoomId << ") with an invalid DIR_xxxx code: " << r.direction << " - the path will not be valid!";
+            const QString command = routeCommand(r);
+            if (command.isEmpty()) {
+                qWarning().nospace().noquote() << "TMap::findPath(" << from << ", " << to << ") WARNING - found route between rooms (from id: " << previousRoomId << ", to id: " << currentRoomId << ") with an invalid DIR_xxxx code: " << r.direction << " - the path will not be valid!";
+            } else {
+                mDirList.prepend(command);
             }
             currentVertex = previousVertex;
             currentRoomId = previousRoomId;
@@ -1108,8 +1030,81 @@ bool TMap::findPath(int from, int to)
     return false;
 }
 
+// Finds the best routes from one room to each of the given ones - or to every
+// room that can be reached from it if none are given - with a single search
+// instead of one findPath(...) per target; the results are then read from
+// mGraph with distanceTo(...), pathTo(...) and reachedRooms():
+bool TMap::findPaths(const int from, const QList<int>& targets)
+{
+    updateGraph();
+
+    QElapsedTimer t;
+    t.start();
+    if (!mGraph.contains(from)) {
+        qDebug() << "TMap::findPaths(" << from << ", ...) FAIL: start room not in map graph!";
+        return false;
+    }
+
+    mGraph.searchFrom(from, targets);
+    qDebug() << "TMap::findPaths(" << from << ", ...) INFO: searched for:" << (targets.isEmpty() ? qsl("all rooms") : QString::number(targets.size()))
+             << "in:" << t.nsecsElapsed() * 1.0e-6 << "ms.";
+    return true;
+}
+
+// The command for each step of a path (as returned by mGraph.pathTo(...))
+// from the given room:
+QStringList TMap::pathCommands(const int from, const QList<int>& path) const
+{
+    QStringList result;
+    int previousRoomId = from;
+    for (const int roomId : path) {
+        result.append(routeCommand(mGraph.routeBetween(previousRoomId, roomId)));
+        previousRoomId = roomId;
+    }
+    return result;
+}
+
+// Empty if the route has an invalid direction code:
+QString TMap::routeCommand(const route& r)
+{
+    switch (r.direction) {
+        /*
+         * Do not translate the directions into the user's locale here,
+         * that is to be done in the profile specific doSpeedwalk()
+         * function of the mapper package as the language of the MUD
+         * need not be the native language of the user - translating
+         * them here makes the mapper harder to code as it has to
+         * accommodate all the possible languages the GUI of Mudlet was
+         * configured to support!
+         */
+    case DIR_NORTH:        return qsl("n");
+    case DIR_NORTHEAST:    return qsl("ne");
+    case DIR_EAST:         return qsl("e");
+    case DIR_SOUTHEAST:    return qsl("se");
+    case DIR_SOUTH:        return qsl("s");
+    case DIR_SOUTHWEST:    return qsl("sw");
+    case DIR_WEST:         return qsl("w");
+    case DIR_NORTHWEST:    return qsl("nw");
+    case DIR_UP:           return qsl("up");
+    case DIR_DOWN:         return qsl("down");
+    case DIR_IN:           return qsl("in");
+    case DIR_OUT:          return qsl("out");
+    case DIR_OTHER:        return r.specialExitName;
+    default:               return QString();
+    }
+}
+
 bool TMap::serialize(QDataStream& ofs, int saveVersion)
 {
+    if (mIsLoadingInBackground) {
+        // Otherwise the (empty) map in use while the other one is loading
+        // would be saved:
+        const QString errMsg = tr("[ ERROR ] - The map cannot be saved while it is still being loaded.");
+        appendErrorMsgWithNoLf(errMsg, false);
+        postMessage(errMsg);
+        return false;
+    }
+
     // clamp version values
     if (saveVersion < 0) {
         saveVersion = 0;
@@ -1149,6 +1144,12 @@ bool TMap::serialize(QDataStream& ofs, int saveVersion)
         postMessage(message);
     }
 
+    if (mSaveVersion >= mChunkedVersion) {
+        const bool result = serializeChunked(ofs);
+        mSaveVersion = oldSaveVersion;
+        return result;
+    }
+
     ofs << mSaveVersion;
     ofs << mEnvColors;
     ofs << mpRoomDB->getAreaNamesMap();
@@ -1180,58 +1181,7 @@ bool TMap::serialize(QDataStream& ofs, int saveVersion)
         const int areaID = itAreaList.key();
         TArea* pA = itAreaList.value();
         ofs << areaID;
-        if (mSaveVersion >= 18) {
-            ofs << pA->rooms;
-        } else {
-            // Switched to a (faster) QSet<int> from a QList<int> in version 18
-            QList<int> const _oldList = pA->rooms.values();
-            ofs << _oldList;
-        }
-        ofs << pA->zLevels;
-        ofs << pA->mAreaExits;
-        ofs << pA->gridMode;
-        ofs << pA->max_x;
-        ofs << pA->max_y;
-        ofs << pA->max_z;
-        ofs << pA->min_x;
-        ofs << pA->min_y;
-        ofs << pA->min_z;
-        ofs << pA->span;
-        ofs << pA->xmaxForZ;
-        ofs << pA->ymaxForZ;
-        ofs << pA->xminForZ;
-        ofs << pA->yminForZ;
-        ofs << pA->pos;
-        ofs << pA->isZone;
-        ofs << pA->zoneAreaRef;
-        if (mSaveVersion >= 21) {
-            // Revised in version 21 to store the value directly:
-            ofs << pA->mLast2DMapZoom;
-        } else {
-            pA->mUserData.insert(QLatin1String("system.fallback_map2DZoom"), QString::number(pA->get2DMapZoom()));
-        }
-        ofs << pA->mUserData;
-        if (mSaveVersion >= 21) {
-            // Revised in version 21 to store labels within the TArea class:
-            // Also we now have temporary labels, so we need to count the
-            // permanent ones first to use as the count for ones to store:
-            const auto permanentLabelsList{pA->getPermanentLabelIds()};
-            ofs << static_cast<qint32>(permanentLabelsList.size());
-            QListIterator<int> itMapLabelId(permanentLabelsList);
-            while (itMapLabelId.hasNext()) {
-                const auto labelID = itMapLabelId.next();
-                const auto label = pA->mMapLabels.value(labelID);
-                ofs << labelID;
-                ofs << label.pos;
-                ofs << label.size;
-                ofs << label.text;
-                ofs << label.fgColor;
-                ofs << label.bgColor;
-                ofs << label.pix;
-                ofs << label.noScaling;
-                ofs << label.showOnTop;
-            }
-        }
+        writeArea(ofs, pA);
     }
 
     if (mSaveVersion >= 18) {
@@ -1297,202 +1247,451 @@ bool TMap::serialize(QDataStream& ofs, int saveVersion)
             continue;
         }
 
-        ofs << pR->getId();
-        if (mSaveVersion <= 19) {
-            if (!pR->mSymbol.isEmpty()) {
-                pR->userData.insert(QLatin1String("system.fallback_symbol"), pR->mSymbol);
-            }
+        writeRoom(ofs, pR);
+    }
+
+    // reset to the old map version
+    mSaveVersion = oldSaveVersion;
+    return true;
+}
+
+void TMap::writeArea(QDataStream& ofs, TArea* pA)
+{
+    if (mSaveVersion >= 18) {
+        ofs << pA->rooms;
+    } else {
+        // Switched to a (faster) QSet<int> from a QList<int> in version 18
+        QList<int> const _oldList = pA->rooms.values();
+        ofs << _oldList;
+    }
+    ofs << pA->zLevels;
+    ofs << pA->mAreaExits;
+    ofs << pA->gridMode;
+    ofs << pA->max_x;
+    ofs << pA->max_y;
+    ofs << pA->max_z;
+    ofs << pA->min_x;
+    ofs << pA->min_y;
+    ofs << pA->min_z;
+    ofs << pA->span;
+    ofs << pA->xmaxForZ;
+    ofs << pA->ymaxForZ;
+    ofs << pA->xminForZ;
+    ofs << pA->yminForZ;
+    ofs << pA->pos;
+    ofs << pA->isZone;
+    ofs << pA->zoneAreaRef;
+    if (mSaveVersion >= 21) {
+        // Revised in version 21 to store the value directly:
+        ofs << pA->mLast2DMapZoom;
+    } else {
+        pA->mUserData.insert(QLatin1String("system.fallback_map2DZoom"), QString::number(pA->get2DMapZoom()));
+    }
+    ofs << pA->mUserData;
+    if (mSaveVersion >= 21) {
+        // Revised in version 21 to store labels within the TArea class:
+        // Also we now have temporary labels, so we need to count the
+        // permanent ones first to use as the count for ones to store:
+        const auto permanentLabelsList{pA->getPermanentLabelIds()};
+        ofs << static_cast<qint32>(permanentLabelsList.size());
+        QListIterator<int> itMapLabelId(permanentLabelsList);
+        while (itMapLabelId.hasNext()) {
+            const auto labelID = itMapLabelId.next();
+            const auto label = pA->mMapLabels.value(labelID);
+            ofs << labelID;
+            ofs << label.pos;
+            ofs << label.size;
+            ofs << label.text;
+            ofs << label.fgColor;
+            ofs << label.bgColor;
+            ofs << label.pix;
+            ofs << label.noScaling;
+            ofs << label.showOnTop;
         }
-        ofs << pR->getArea();
-        ofs << pR->x;
-        ofs << pR->y;
-        ofs << pR->z;
-        ofs << pR->getNorth();
-        ofs << pR->getNortheast();
-        ofs << pR->getEast();
-        ofs << pR->getSoutheast();
-        ofs << pR->getSouth();
-        ofs << pR->getSouthwest();
-        ofs << pR->getWest();
-        ofs << pR->getNorthwest();
-        ofs << pR->getUp();
-        ofs << pR->getDown();
-        ofs << pR->getIn();
-        ofs << pR->getOut();
-        ofs << pR->environment;
-        ofs << pR->getWeight();
-        ofs << pR->name;
-        ofs << pR->isLocked;
-        if (mSaveVersion >= 21) {
-            ofs << pR->getSpecialExits();
-        } else {
-            QMultiMap<int, QString> oldSpecialExits;
-            QMapIterator<QString, int> itSpecialExit(pR->getSpecialExits());
-            while (itSpecialExit.hasNext()) {
-                itSpecialExit.next();
-                oldSpecialExits.insert(itSpecialExit.value(),
-                                       (pR->hasSpecialExitLock(itSpecialExit.key())
-                                                ? QLatin1Char('1')
-                                                : QLatin1Char('0'))
-                                               % itSpecialExit.key());
-            }
-            ofs << oldSpecialExits;
+    }
+}
+
+void TMap::writeRoom(QDataStream& ofs, TRoom* pR)
+{
+    ofs << pR->getId();
+    if (mSaveVersion <= 19) {
+        if (!pR->mSymbol.isEmpty()) {
+            pR->userData.insert(QLatin1String("system.fallback_symbol"), pR->mSymbol);
+        }
+    }
+    ofs << pR->getArea();
+    ofs << pR->x;
+    ofs << pR->y;
+    ofs << pR->z;
+    ofs << pR->getNorth();
+    ofs << pR->getNortheast();
+    ofs << pR->getEast();
+    ofs << pR->getSoutheast();
+    ofs << pR->getSouth();
+    ofs << pR->getSouthwest();
+    ofs << pR->getWest();
+    ofs << pR->getNorthwest();
+    ofs << pR->getUp();
+    ofs << pR->getDown();
+    ofs << pR->getIn();
+    ofs << pR->getOut();
+    ofs << pR->environment;
+    ofs << pR->getWeight();
+    ofs << pR->name;
+    ofs << pR->isLocked;
+    if (mSaveVersion >= 21) {
+        ofs << pR->getSpecialExits();
+    } else {
+        QMultiMap<int, QString> oldSpecialExits;
+        QMapIterator<QString, int> itSpecialExit(pR->getSpecialExits());
+        while (itSpecialExit.hasNext()) {
+            itSpecialExit.next();
+            oldSpecialExits.insert(itSpecialExit.value(),
+                                   (pR->hasSpecialExitLock(itSpecialExit.key())
+                                            ? QLatin1Char('1')
+                                            : QLatin1Char('0'))
+                                           % itSpecialExit.key());
         }
-        if (mSaveVersion >= 19) {
-            ofs << pR->mSymbol;
-        } else {
-            qint8 oldCharacterCode = 0;
-            if (pR->mSymbol.length()) {
-                // There is something for a symbol
-                const QChar firstChar = pR->mSymbol.at(0);
-                if (pR->mSymbol.length() == 1 && firstChar.row() == 0 && firstChar.cell() > 32) {
-                    // It is something that can be represented by the past unsigned short
-                    oldCharacterCode = firstChar.toLatin1();
-                } else {
-                    // Not representable - put in a '?' for older Mudlet
-                    // versions that cannot display the character and will not
-                    // parse the value placed in the room's user data:
-                    oldCharacterCode = QChar('?').toLatin1();
-                }
+        ofs << oldSpecialExits;
+    }
+    if (mSaveVersion >= 19) {
+        ofs << pR->mSymbol;
+    } else {
+        qint8 oldCharacterCode = 0;
+        if (pR->mSymbol.length()) {
+            // There is something for a symbol
+            const QChar firstChar = pR->mSymbol.at(0);
+            if (pR->mSymbol.length() == 1 && firstChar.row() == 0 && firstChar.cell() > 32) {
+                // It is something that can be represented by the past unsigned short
+                oldCharacterCode = firstChar.toLatin1();
+            } else {
+                // Not representable - put in a '?' for older Mudlet
+                // versions that cannot display the character and will not
+                // parse the value placed in the room's user data:
+                oldCharacterCode = QChar('?').toLatin1();
             }
-            ofs << oldCharacterCode;
         }
+        ofs << oldCharacterCode;
+    }
 
-        if (mSaveVersion >= 21) {
-            ofs << pR->mSymbolColor;
-        } else {
-            if (pR->mSymbolColor.isValid()) {
-                pR->userData.insert(QLatin1String("system.fallback_symbol_color"), pR->mSymbolColor.name());
-            }
+    if (mSaveVersion >= 21) {
+        ofs << pR->mSymbolColor;
+    } else {
+        if (pR->mSymbolColor.isValid()) {
+            pR->userData.insert(QLatin1String("system.fallback_symbol_color"), pR->mSymbolColor.name());
         }
+    }
 
-        ofs << pR->userData;
-        if (mSaveVersion >= 20) {
-            // Before version 20 stored the style as an Latin1 string, the color
-            // as a QList<int> for the RGB components and used UPPER case for
-            // the NORMAL exit direction keys...
-            ofs << pR->customLines;
-            ofs << pR->customLinesArrow;
-            ofs << pR->customLinesColor;
-            ofs << pR->customLinesStyle;
-        } else {
-            QMap<QString, QList<QPointF>> oldLinesData;
-            QMapIterator<QString, QList<QPointF>> itCustomLine(pR->customLines);
-            while (itCustomLine.hasNext()) {
-                itCustomLine.next();
-                const QString direction(itCustomLine.key());
-                if (direction == QLatin1String("n") || direction == QLatin1String("e") || direction == QLatin1String("s") || direction == QLatin1String("w") || direction == QLatin1String("up")
-                    || direction == QLatin1String("down")
-                    || direction == QLatin1String("ne")
-                    || direction == QLatin1String("se")
-                    || direction == QLatin1String("sw")
-                    || direction == QLatin1String("nw")
-                    || direction == QLatin1String("in")
-                    || direction == QLatin1String("out")) {
-                    oldLinesData.insert(itCustomLine.key().toUpper(), itCustomLine.value());
-                } else {
-                    oldLinesData.insert(itCustomLine.key(), itCustomLine.value());
-                }
+    ofs << pR->userData;
+    if (mSaveVersion >= 20) {
+        // Before version 20 stored the style as an Latin1 string, the color
+        // as a QList<int> for the RGB components and used UPPER case for
+        // the NORMAL exit direction keys...
+        ofs << pR->customLines;
+        ofs << pR->customLinesArrow;
+        ofs << pR->customLinesColor;
+        ofs << pR->customLinesStyle;
+    } else {
+        QMap<QString, QList<QPointF>> oldLinesData;
+        QMapIterator<QString, QList<QPointF>> itCustomLine(pR->customLines);
+        while (itCustomLine.hasNext()) {
+            itCustomLine.next();
+            const QString direction(itCustomLine.key());
+            if (direction == QLatin1String("n") || direction == QLatin1String("e") || direction == QLatin1String("s") || direction == QLatin1String("w") || direction == QLatin1String("up")
+                || direction == QLatin1String("down")
+                || direction == QLatin1String("ne")
+                || direction == QLatin1String("se")
+                || direction == QLatin1String("sw")
+                || direction == QLatin1String("nw")
+                || direction == QLatin1String("in")
+                || direction == QLatin1String("out")) {
+                oldLinesData.insert(itCustomLine.key().toUpper(), itCustomLine.value());
+            } else {
+                oldLinesData.insert(itCustomLine.key(), itCustomLine.value());
             }
-            ofs << oldLinesData;
-
-            QMap<QString, bool> oldLinesArrowData;
-            QMapIterator<QString, bool> itCustomLineArrow(pR->customLinesArrow);
-            while (itCustomLineArrow.hasNext()) {
-                itCustomLineArrow.next();
-                const QString direction(itCustomLineArrow.key());
-                if (direction == QLatin1String("n") || direction == QLatin1String("e") || direction == QLatin1String("s") || direction == QLatin1String("w") || direction == QLatin1String("up")
-                    || direction == QLatin1String("down")
-                    || direction == QLatin1String("ne")
-                    || direction == QLatin1String("se")
-                    || direction == QLatin1String("sw")
-                    || direction == QLatin1String("nw")
-                    || direction == QLatin1String("in")
-                    || direction == QLatin1String("out")) {
-                    oldLinesArrowData.insert(itCustomLineArrow.key().toUpper(), itCustomLineArrow.value());
-                } else {
-                    oldLinesArrowData.insert(itCustomLineArrow.key(), itCustomLineArrow.value());
-                }
+        }
+        ofs << oldLinesData;
+
+        QMap<QString, bool> oldLinesArrowData;
+        QMapIterator<QString, bool> itCustomLineArrow(pR->customLinesArrow);
+        while (itCustomLineArrow.hasNext()) {
+            itCustomLineArrow.next();
+            const QString direction(itCustomLineArrow.key());
+            if (direction == QLatin1String("n") || direction == QLatin1String("e") || direction == QLatin1String("s") || direction == QLatin1String("w") || direction == QLatin1String("up")
+                || direction == QLatin1String("down")
+                || direction == QLatin1String("ne")
+                || direction == QLatin1String("se")
+                || direction == QLatin1String("sw")
+                || direction == QLatin1String("nw")
+                || direction == QLatin1String("in")
+                || direction == QLatin1String("out")) {
+                oldLinesArrowData.insert(itCustomLineArrow.key().toUpper(), itCustomLineArrow.value());
+            } else {
+                oldLinesArrowData.insert(itCustomLineArrow.key(), itCustomLineArrow.value());
             }
-            ofs << oldLinesArrowData;
-
-            QMap<QString, QList<int>> oldLinesColorData;
-            QMapIterator<QString, QColor> itCustomLineColor(pR->customLinesColor);
-            while (itCustomLineColor.hasNext()) {
-                itCustomLineColor.next();
-                const QString direction(itCustomLineColor.key());
-                QList<int> colorComponents;
-                colorComponents << itCustomLineColor.value().red() << itCustomLineColor.value().green() << itCustomLineColor.value().blue();
-                if (direction == QLatin1String("n") || direction == QLatin1String("e") || direction == QLatin1String("s") || direction == QLatin1String("w") || direction == QLatin1String("up")
-                    || direction == QLatin1String("down")
-                    || direction == QLatin1String("ne")
-                    || direction == QLatin1String("se")
-                    || direction == QLatin1String("sw")
-                    || direction == QLatin1String("nw")
-                    || direction == QLatin1String("in")
-                    || direction == QLatin1String("out")) {
-                    oldLinesColorData.insert(itCustomLineColor.key().toUpper(), colorComponents);
-                } else {
-                    oldLinesColorData.insert(itCustomLineColor.key(), colorComponents);
-                }
+        }
+        ofs << oldLinesArrowData;
+
+        QMap<QString, QList<int>> oldLinesColorData;
+        QMapIterator<QString, QColor> itCustomLineColor(pR->customLinesColor);
+        while (itCustomLineColor.hasNext()) {
+            itCustomLineColor.next();
+            const QString direction(itCustomLineColor.key());
+            QList<int> colorComponents;
+            colorComponents << itCustomLineColor.value().red() << itCustomLineColor.value().green() << itCustomLineColor.value().blue();
+            if (direction == QLatin1String("n") || direction == QLatin1String("e") || direction == QLatin1String("s") || direction == QLatin1String("w") || direction == QLatin1String("up")
+                || direction == QLatin1String("down")
+                || direction == QLatin1String("ne")
+                || direction == QLatin1String("se")
+                || direction == QLatin1String("sw")
+                || direction == QLatin1String("nw")
+                || direction == QLatin1String("in")
+                || direction == QLatin1String("out")) {
+                oldLinesColorData.insert(itCustomLineColor.key().toUpper(), colorComponents);
+            } else {
+                oldLinesColorData.insert(itCustomLineColor.key(), colorComponents);
             }
-            ofs << oldLinesColorData;
-
-            QMap<QString, QString> oldLineStyleData;
-            QMapIterator<QString, Qt::PenStyle> itCustomLineStyle(pR->customLinesStyle);
-            while (itCustomLineStyle.hasNext()) {
-                itCustomLineStyle.next();
-                QString direction(itCustomLineStyle.key());
-                if (direction == QLatin1String("n") || direction == QLatin1String("e") || direction == QLatin1String("s") || direction == QLatin1String("w") || direction == QLatin1String("up")
-                    || direction == QLatin1String("down")
-                    || direction == QLatin1String("ne")
-                    || direction == QLatin1String("se")
-                    || direction == QLatin1String("sw")
-                    || direction == QLatin1String("nw")
-                    || direction == QLatin1String("in")
-                    || direction == QLatin1String("out")) {
-                    direction = direction.toUpper();
-                }
-                switch (itCustomLineStyle.value()) {
-                case Qt::DotLine:
-                    oldLineStyleData.insert(direction, QLatin1String("dot line"));
-                    break;
-                case Qt::DashLine:
-                    oldLineStyleData.insert(direction, QLatin1String("dash line"));
-                    break;
-                case Qt::DashDotLine:
-                    oldLineStyleData.insert(direction, QLatin1String("dash dot line"));
-                    break;
-                case Qt::DashDotDotLine:
-                    oldLineStyleData.insert(direction, QLatin1String("dash dot dot line"));
-                    break;
-                case Qt::SolidLine:
-                    [[fallthrough]];
-                default:
-                    oldLineStyleData.insert(direction, QLatin1String("solid line"));
-                }
+        }
+        ofs << oldLinesColorData;
+
+        QMap<QString, QString> oldLineStyleData;
+        QMapIterator<QString, Qt::PenStyle> itCustomLineStyle(pR->customLinesStyle);
+        while (itCustomLineStyle.hasNext()) {
+            itCustomLineStyle.next();
+            QString direction(itCustomLineStyle.key());
+            if (direction == QLatin1String("n") || direction == QLatin1String("e") || direction == QLatin1String("s") || direction == QLatin1String("w") || direction == QLatin1String("up")
+                || direction == QLatin1String("down")
+                || direction == QLatin1String("ne")
+                || direction == QLatin1String("se")
+                || direction == QLatin1String("sw")
+                || direction == QLatin1String("nw")
+                || direction == QLatin1String("in")
+                || direction == QLatin1String("out")) {
+                direction = direction.toUpper();
+            }
+            switch (itCustomLineStyle.value()) {
+            case Qt::DotLine:
+                oldLineStyleData.insert(direction, QLatin1String("dot line"));
+                break;
+            case Qt::DashLine:
+                oldLineStyleData.insert(direction, QLatin1String("dash line"));
+                break;
+            case Qt::DashDotLine:
+                oldLineStyleData.insert(direction, QLatin1String("dash dot line"));
+                break;
+            case Qt::DashDotDotLine:
+                oldLineStyleData.insert(direction, QLatin1String("dash dot dot line"));
+                break;
+            case Qt::SolidLine:
+                [[fallthrough]];
+            default:
+                oldLineStyleData.insert(direction, QLatin1String("solid line"));
             }
-            ofs << oldLineStyleData;
         }
-        if (mSaveVersion >= 21) {
-            ofs << pR->getSpecialExitLocks();
+        ofs << oldLineStyleData;
+    }
+    if (mSaveVersion >= 21) {
+        ofs << pR->getSpecialExitLocks();
+    }
+    ofs << pR->exitLocks;
+    ofs << pR->exitStubs;
+    ofs << pR->getExitWeights();
+    ofs << pR->doors;
+}
+
+// From version 22 the map file is written as:
+// * the version (as for all other versions)
+// * a header: the number of areas and rooms, the player room for each profile,
+//   the length of the global data chunk and an index of the area chunks - so
+//   that the details of a map file can be found without reading the rest of it
+// * a qCompress(...)ed chunk of the data that is not part of any area
+// * a qCompress(...)ed chunk for each area holding the area and all the rooms
+//   in it - rooms in an area that does not exist get a chunk without an area
+//   in it.
+// The layout itself is handled by TMapChunkedFile. As each area chunk stands
+// alone they can be compressed and decompressed in parallel, and areas that
+// have not changed since the last save do not need compressing again:
+bool TMap::serializeChunked(QDataStream& ofs)
+{
+    QByteArray globalData;
+    QDataStream globalStream(&globalData, QIODevice::WriteOnly);
+    globalStream.setVersion(ofs.version());
+    globalStream << mEnvColors;
+    globalStream << mpRoomDB->getAreaNamesMap();
+    globalStream << mCustomEnvColors;
+    globalStream << mpRoomDB->hashToRoomID;
+    globalStream << mUserData;
+    globalStream << mMapSymbolFont;
+    globalStream << mMapSymbolFontFudgeFactor;
+    globalStream << mIsOnlyMapSymbolFontToBeUsed;
+    const QByteArray globalChunk = qCompress(globalData);
+
+    // Sort the rooms into their areas, in id order so that the data for an
+    // area that has not changed comes out the same each time:
+    QMap<int, QList<int>> areaRoomIds;
+    const auto& areaMap = mpRoomDB->getAreaMap();
+    for (auto itArea = areaMap.cbegin(); itArea != areaMap.cend(); ++itArea) {
+        areaRoomIds[itArea.key()];
+    }
+    const auto& roomMap = mpRoomDB->getRoomMap();
+    for (auto itRoom = roomMap.cbegin(); itRoom != roomMap.cend(); ++itRoom) {
+        if (!itRoom.value()) {
+            qDebug() << "TMap::serializeChunked(...) skipping a room with a NULL TRoom pointer:" << itRoom.key();
+            continue;
         }
-        ofs << pR->exitLocks;
-        ofs << pR->exitStubs;
-        ofs << pR->getExitWeights();
-        ofs << pR->doors;
+        areaRoomIds[itRoom.value()->getArea()].append(itRoom.key());
     }
 
-    // reset to the old map version
-    mSaveVersion = oldSaveVersion;
+    // The data has to be gathered here, as the map labels are QPixmaps which
+    // can only be used on this thread, but the compressing is shared out:
+    TMapChunkedFile::Header header;
+    QList<std::pair<int, QByteArray>> areaData;
+    for (auto itArea = areaRoomIds.begin(); itArea != areaRoomIds.end(); ++itArea) {
+        auto& roomIds = itArea.value();
+        std::sort(roomIds.begin(), roomIds.end());
+
+        QByteArray data;
+        QDataStream chunkStream(&data, QIODevice::WriteOnly);
+        chunkStream.setVersion(ofs.version());
+        TArea* pA = areaMap.value(itArea.key());
+        chunkStream << (pA != nullptr);
+        if (pA) {
+            writeArea(chunkStream, pA);
+        }
+        chunkStream << static_cast<qint32>(roomIds.size());
+        for (const int roomId : roomIds) {
+            writeRoom(chunkStream, roomMap.value(roomId));
+        }
+        areaData.append({itArea.key(), data});
+
+        TMapChunkedFile::Chunk chunk;
+        chunk.mAreaId = itArea.key();
+        chunk.mRoomCount = static_cast<int>(roomIds.size());
+        header.mRoomCount += chunk.mRoomCount;
+        header.mChunks.append(chunk);
+    }
+    header.mAreaCount = areaMap.size();
+    header.mRoomIdHash = mRoomIdHash;
+
+    ofs << mSaveVersion;
+    return TMapChunkedFile::write(ofs, header, globalChunk, mChunkedFile.compressAreaChunks(areaData));
+}
+
+bool TMap::readGlobalChunk(const QByteArray& globalChunk, const int streamVersion, TRoomDB* pRoomDB, MapGlobals& globals)
+{
+    const QByteArray globalData = qUncompress(globalChunk);
+    QDataStream globalStream(globalData);
+    globalStream.setVersion(streamVersion);
+    globalStream >> globals.mEnvColors;
+    pRoomDB->restoreAreaMap(globalStream);
+    globalStream >> globals.mCustomEnvColors;
+    globalStream >> pRoomDB->hashToRoomID;
+    for (auto itHash = pRoomDB->hashToRoomID.cbegin(); itHash != pRoomDB->hashToRoomID.cend(); ++itHash) {
+        pRoomDB->roomIDToHash.insert(itHash.value(), itHash.key());
+    }
+    globalStream >> globals.mUserData;
+    globalStream >> globals.mMapSymbolFont;
+    globalStream >> globals.mMapSymbolFontFudgeFactor;
+    globalStream >> globals.mIsOnlyMapSymbolFontToBeUsed;
+    if (globalStream.status() != QDataStream::Ok) {
+        return false;
+    }
+    globals.mMapSymbolFont.setStyleStrategy(static_cast<QFont::StyleStrategy>((globals.mIsOnlyMapSymbolFontToBeUsed ? QFont::NoFontMerging : 0)
+                                                                              |QFont::PreferOutline | QFont::PreferAntialias | QFont::PreferQuality
+                                                                              |QFont::PreferNoShaping
+                                                                              ));
+    return true;
+}
+
+// The map is read into a TRoomDB of its own which is only put in place once
+// all of it has been read, so that a damaged area chunk part way through the
+// file does not leave a half restored map:
+bool TMap::restoreChunked(QDataStream& ifs, const TMapChunkedFile::Header& header)
+{
+    QByteArray globalChunk;
+    QList<QByteArray> compressedChunks;
+    auto pRoomDB = new TRoomDB(this);
+    MapGlobals globals = currentMapGlobals();
+    bool isOk = TMapChunkedFile::readChunks(ifs.device(), header, globalChunk, compressedChunks) && readGlobalChunk(globalChunk, ifs.version(), pRoomDB, globals);
+    if (isOk) {
+        // The file reading has to be done in turn but the decompressing can
+        // be shared out between threads:
+        const QList<QByteArray> chunkData = TMapChunkedFile::uncompressChunks(compressedChunks);
+        for (int i = 0, total = header.mChunks.size(); isOk && i < total; ++i) {
+            if (!restoreAreaChunk(chunkData.at(i), header.mChunks.at(i), ifs.version(), pRoomDB)) {
+                postDamagedAreaChunkMessage(header.mChunks.at(i).mAreaId);
+                isOk = false;
+            }
+        }
+    }
+    if (!isOk) {
+        pRoomDB->discard();
+        delete pRoomDB;
+        return false;
+    }
+
+    addDefaultAreaIfMissing(pRoomDB);
+    globals.mRoomIdHash = header.mRoomIdHash;
+    TRoomDB* pOldRoomDB = mpRoomDB;
+    mpRoomDB = pRoomDB;
+    applyMapGlobals(globals);
+    pOldRoomDB->clearMapDB();
+    delete pOldRoomDB;
+    mGraph.clear();
+    mGraphDirtyRooms.clear();
+    mGraphDirtyExits.clear();
+    mMapGraphNeedsUpdate = true;
     return true;
 }
 
+void TMap::postDamagedAreaChunkMessage(const int areaId)
+{
+    const QString errMsg = tr("[ ERROR ] - The data for area %1 in the map file is damaged, the map has not\n"
+                              "been loaded.").arg(areaId);
+    appendErrorMsgWithNoLf(errMsg, false);
+    postMessage(errMsg);
+}
+
+// Does not use anything but the given TRoomDB (and the map version) so can be
+// used on another thread for one that is not (yet) the one in use, in which
+// case pLabelImages must be supplied to take the map label images for the
+// area, as QPixmaps can only be made on the GUI thread:
+bool TMap::restoreAreaChunk(const QByteArray& data, const TMapChunkedFile::Chunk& chunk, const int streamVersion, TRoomDB* pRoomDB, QHash<int, QImage>* pLabelImages)
+{
+    if (data.isEmpty()) {
+        // qUncompress(...) gives an empty result if the data is not valid:
+        return false;
+    }
+
+    QDataStream chunkStream(data);
+    chunkStream.setVersion(streamVersion);
+    bool hasArea = false;
+    chunkStream >> hasArea;
+    if (hasArea) {
+        auto pA = new TArea(this, pRoomDB);
+        readArea(chunkStream, pA, pLabelImages);
+        pRoomDB->restoreSingleArea(chunk.mAreaId, pA);
+    }
+
+    qint32 roomCount = 0;
+    chunkStream >> roomCount;
+    for (qint32 i = 0; i < roomCount && chunkStream.status() == QDataStream::Ok; ++i) {
+        int roomId = 0;
+        chunkStream >> roomId;
+        auto pT = new TRoom(pRoomDB);
+        pT->restore(chunkStream, roomId, mVersion);
+        pRoomDB->restoreSingleRoom(roomId, pT);
+    }
+    return chunkStream.status() == QDataStream::Ok;
+}
+
 // file is expected to be linked to a file name but not be opened; ifs is not
 // expected to be linked to any IODevice. On success file will be opened and
 // ifs will be part way through it (has read the first 4 bytes which encode the
-// map file version). On failure both will be in the same states as initial one:
-bool TMap::validatePotentialMapFile(QFile& file, QDataStream& ifs)
+// map file version - and for a chunked map file the header, which is placed
+// in pChunkedHeader). On failure both will be in the same states as initial
+// one:
+bool TMap::validatePotentialMapFile(QFile& file, QDataStream& ifs, TMapChunkedFile::Header* pChunkedHeader)
 {
     int version = 0;
     if (!file.open(QFile::ReadOnly)) {
@@ -1548,6 +1747,28 @@ bool TMap::validatePotentialMapFile(QFile& file, QDataStream& ifs)
         return false;
     }
 
+    if (version >= mChunkedVersion) {
+        // Check that all the chunks the header lists are in the file before
+        // anything is done to the current map:
+        TMapChunkedFile::Header header;
+        if (!TMapChunkedFile::readHeader(ifs, header) || !TMapChunkedFile::fitsIn(header, file.size() - file.pos())) {
+            const QString errMsg = tr("[ ALERT ] - Map file is damaged or incomplete, the index of its contents does\n"
+                                "not match the rest of it. The file is:\n\"%1\".")
+                                     .arg(file.fileName());
+            appendErrorMsgWithNoLf(errMsg);
+            postMessage(errMsg);
+            const QString infoMsg = tr("[ INFO ]  - Ignoring this map file.");
+            appendErrorMsgWithNoLf(infoMsg);
+            postMessage(infoMsg);
+            ifs.setDevice(nullptr);
+            file.close();
+            return false;
+        }
+        if (pChunkedHeader) {
+            *pChunkedHeader = header;
+        }
+    }
+
     if (version < 4) {
         const QString alertMsg = tr("[ ALERT ] - Map file is really old. Its format version \"%1\" is so ancient that\n"
                               "this version of Mudlet may not gain enough information from\n"
@@ -1579,6 +1800,13 @@ bool TMap::restore(QString location, bool downloadIfNotFound)
 {
     qDebug().noquote().nospace() << "TMap::restore(\"" << location << "\") INFO: restoring map of Profile: \"" << mProfileName << "\" URL: " << mpHost->getUrl();
 
+    if (mIsLoadingInBackground) {
+        const QString errMsg = tr("[ ERROR ] - Another map cannot be loaded until the one being loaded has finished.");
+        appendErrorMsgWithNoLf(errMsg, false);
+        postMessage(errMsg);
+        return false;
+    }
+
     QElapsedTimer _time;
     _time.start();
     QString folder;
@@ -1600,6 +1828,7 @@ bool TMap::restore(QString location, bool downloadIfNotFound)
 
     QDataStream ifs;
     QFile file;
+    TMapChunkedFile::Header chunkedHeader;
     if (canRestore && (!entries.empty() || !location.isEmpty())) {
         // We get to here if there is one or more entries OR location is
         // supplied - if the latter then there is only one file to consider but
@@ -1612,7 +1841,7 @@ bool TMap::restore(QString location, bool downloadIfNotFound)
             auto fileName = qsl("%1/%2").arg(folder, itFileName.next());
             if (!fileName.endsWith(qsl(".json"), Qt::CaseInsensitive)) {
                 file.setFileName(fileName);
-                if (validatePotentialMapFile(file, ifs)) {
+                if (validatePotentialMapFile(file, ifs, &chunkedHeader)) {
                     foundValidFile = true;
                 }
 
@@ -1637,7 +1866,7 @@ bool TMap::restore(QString location, bool downloadIfNotFound)
            qApp->processEvents();
         } else {
             file.setFileName(location);
-            if (validatePotentialMapFile(file, ifs)) {
+            if (validatePotentialMapFile(file, ifs, &chunkedHeader)) {
                 foundValidFile = true;
             }
         }
@@ -1646,262 +1875,531 @@ bool TMap::restore(QString location, bool downloadIfNotFound)
         }
     } else if (canRestore && !location.isEmpty()) {
         file.setFileName(location);
-        canRestore = validatePotentialMapFile(file, ifs);
+        canRestore = validatePotentialMapFile(file, ifs, &chunkedHeader);
+    }
+
+    if (canRestore && mVersion >= mChunkedVersion) {
+        canRestore = restoreChunked(ifs, chunkedHeader);
+    } else if (canRestore) {
+        MapGlobals globals = currentMapGlobals();
+        readMapFileHead(ifs, mpRoomDB, globals);
+        applyMapGlobals(globals);
+        readMapFileRooms(ifs, mpRoomDB);
     }
 
     if (canRestore) {
-        // As all but the room reading have version checks the fact that sub-4
-        // files will still be parsed despite canRestore being false is probably OK
-        if (mVersion >= 4) {
-            ifs >> mEnvColors;
-            mpRoomDB->restoreAreaMap(ifs);
-        }
-        if (mVersion >= 5) {
-            ifs >> mCustomEnvColors;
-        }
-        if (mVersion >= 7) {
-            ifs >> mpRoomDB->hashToRoomID;
-            QMap<QString, int>::const_iterator i;
-            for (i = mpRoomDB->hashToRoomID.constBegin(); i != mpRoomDB->hashToRoomID.constEnd(); ++i) {
-                mpRoomDB->roomIDToHash.insert(i.value(), i.key());
+        restore16ColorSet();
+
+        const QString okMsg = tr("[ INFO ]  - Successfully read the map file (%1s), checking some\n"
+                           "consistency details..." )
+                                .arg(_time.nsecsElapsed() * 1.0e-9, 0, 'f', 2);
+
+        postMessage(okMsg);
+        appendErrorMsgWithNoLf(okMsg);
+        return true;
+    }
+
+    if ((!canRestore || entries.empty()) && downloadIfNotFound) {
+        QMessageBox msgBox;
+
+        if (!getMmpMapLocation().isEmpty()) {
+            msgBox.setText(tr("No map found. Would you like to download the map or start your own?"));
+            QPushButton* yesButton = msgBox.addButton(tr("Download the map"), QMessageBox::ActionRole);
+            QPushButton* noButton = msgBox.addButton(tr("Start my own"), QMessageBox::ActionRole);
+            msgBox.exec();
+            if (msgBox.clickedButton() == yesButton) {
+                downloadMap();
+            } else if (msgBox.clickedButton() == noButton) {
+                ; //No-op to avoid unused "noButton"
             }
         }
+    }
 
-        if (mVersion >= 17) {
-            ifs >> mUserData;
-            if (mVersion >= 19) {
-                // Read the data from the file directly in version 19 or later
-                ifs >> mMapSymbolFont;
-                if ((mVersion < 21) && mMapSymbolFont.toString().split(QLatin1String(",")).size() > 15) {
-                    // We need to clean up the effects of using QFont(string)
-                    // for a format 17 or 18 below - as this fix went in before
-                    // 21 was used it only has to be used for map formats 19 and
-                    // 20:
-                    mMapSymbolFont.fromString(mMapSymbolFont.toString().split(QLatin1String(",")).mid(0, 10).join(QLatin1String(",")));
-                }
-                ifs >> mMapSymbolFontFudgeFactor;
-                ifs >> mIsOnlyMapSymbolFontToBeUsed;
-            } else {
-                // Fallback to reading the data from the map user data - and
-                // remove it from the data the user will see:
-                // BUGFIX: Using QFont::toString() and then using that to
-                // construct a font again afterwards via a QFont(string) was
-                // incorrect as it seemed to cause the last to duplicated the
-                // last nine elements each time. The details of the ::toString()
-                // ::fromString() methods are not currently documented so the
-                // only details are documented in the source:
-                // https://code.qt.io/cgit/qt/qtbase.git/tree/src/gui/text/qfont.cpp?h=5.15#n2070
-                // and:
-                // https://code.qt.io/cgit/qt/qtbase.git/tree/src/gui/text/qfont.cpp?h=5.15#n2128
-                // this suggests that only one or ten elements are accepted so
-                // we CAN fix past mistakes by only considering the first ten
-                // elements:
-                const QStringList fontStrings{mUserData.take(qsl("system.fallback_mapSymbolFont")).split(QLatin1Char(','))};
-                const QString fontString{fontStrings.mid(0, 10).join(QLatin1Char(','))};
-                const QString fontFudgeFactorString = mUserData.take(qsl("system.fallback_mapSymbolFontFudgeFactor"));
-                const QString onlyUseSymbolFontString = mUserData.take(qsl("system.fallback_onlyUseMapSymbolFont"));
-                if (!fontString.isEmpty()) {
-                    mMapSymbolFont.fromString(fontString);
-                }
-                if (!fontFudgeFactorString.isEmpty()) {
-                    mMapSymbolFontFudgeFactor = fontFudgeFactorString.toDouble();
+    return canRestore; //FIXME
+}
+
+// Loads the newest map file of the profile in the same way as
+// restore(QString(), false) but does the bulk of the work - decoding the
+// rooms (and for a chunked file decompressing and decoding the areas) - on
+// another thread, into a TRoomDB that is not in use, which is swapped in when
+// it is complete. Meanwhile the profile - and the current (normally empty) map
+// - can still be used and a "sysMapLoadProgress" event is raised now and then
+// with the percentage done, it is 100 once the map has been put in place and
+// audited or -1 if it could not be loaded (and the map in use is unchanged) -
+// one or the other is always the last one. onFinished is called before that
+// with whether it was successful:
+void TMap::restoreInBackground(const std::function<void(bool)>& onFinished)
+{
+    if (mIsLoadingInBackground) {
+        return;
+    }
+
+    const QString folder = mudlet::getMudletPath(mudlet::profileMapsPath, mProfileName);
+    const QDir dir(folder);
+    QStringList filters;
+    filters << qsl("*.[dD][aA][tT]");
+    filters << qsl("*.[jJ][sS][oO][nN]");
+    const QStringList entries = dir.entryList(filters, QDir::Files, QDir::Time);
+    if (entries.isEmpty() || entries.constFirst().endsWith(qsl(".json"), Qt::CaseInsensitive)) {
+        // Nothing to load or a JSON file which can only be parsed as a whole:
+        const bool isOk = restore(QString(), false);
+        onFinished(isOk);
+        raiseMapLoadProgressEvent(isOk ? 100 : -1);
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QFile file(qsl("%1/%2").arg(folder, entries.constFirst()));
+    QDataStream ifs;
+    TMapChunkedFile::Header chunkedHeader;
+    if (!validatePotentialMapFile(file, ifs, &chunkedHeader)) {
+        onFinished(false);
+        raiseMapLoadProgressEvent(-1);
+        return;
+    }
+
+    // The parts of the file that need the GUI thread - including everything
+    // with map label pixmaps in the older formats - are read now:
+    const int streamVersion = ifs.version();
+    auto pRoomDB = new TRoomDB(this);
+    const QList<TMapChunkedFile::Chunk> chunks = chunkedHeader.mChunks;
+    QList<QByteArray> compressedChunks;
+    QByteArray roomData;
+    // Only put in place along with the rooms:
+    MapGlobals globals = currentMapGlobals();
+    bool isOk = true;
+    if (mVersion >= mChunkedVersion) {
+        QByteArray globalChunk;
+        isOk = TMapChunkedFile::readChunks(&file, chunkedHeader, globalChunk, compressedChunks) && readGlobalChunk(globalChunk, streamVersion, pRoomDB, globals);
+        globals.mRoomIdHash = chunkedHeader.mRoomIdHash;
+    } else {
+        readMapFileHead(ifs, pRoomDB, globals);
+        roomData = file.readAll();
+    }
+    ifs.setDevice(nullptr);
+    file.close();
+    if (!isOk) {
+        const QString errMsg = tr("[ ERROR ] - Unable to read the map file:\n\"%1\".").arg(file.fileName());
+        appendErrorMsgWithNoLf(errMsg, false);
+        postMessage(errMsg);
+        pRoomDB->discard();
+        delete pRoomDB;
+        onFinished(false);
+        raiseMapLoadProgressEvent(-1);
+        return;
+    }
+
+    mIsLoadingInBackground = true;
+    mAbortBackgroundLoad = false;
+    mpBackgroundRoomDB = pRoomDB;
+    auto pLabelImages = std::make_shared<QHash<int, QHash<int, QImage>>>();
+    auto pDamagedAreaId = std::make_shared<std::optional<int>>();
+    // Runs on the worker thread, the event is raised on this one - and does
+    // not reach 100 until the map is actually in place:
+    auto reportProgress = [this, lastPercent = -1](const qint64 done, const qint64 total) mutable {
+        const int percent = (total > 0) ? static_cast<int>(qMin(done * 99 / total, qint64(99))) : 99;
+        if (percent == lastPercent) {
+            return;
+        }
+        lastPercent = percent;
+        QMetaObject::invokeMethod(this, [this, percent]() { raiseMapLoadProgressEvent(percent); }, Qt::QueuedConnection);
+    };
+
+    const bool isChunked = (mVersion >= mChunkedVersion);
+    mBackgroundLoad = QtConcurrent::run([this, isChunked, streamVersion, pRoomDB, chunks, compressedChunks, roomData, pLabelImages, pDamagedAreaId, reportProgress]() mutable {
+        if (isChunked) {
+            const QList<QByteArray> chunkData = TMapChunkedFile::uncompressChunks(compressedChunks);
+            for (int i = 0, total = chunks.size(); i < total && !mAbortBackgroundLoad; ++i) {
+                QHash<int, QImage> labelImages;
+                if (!restoreAreaChunk(chunkData.at(i), chunks.at(i), streamVersion, pRoomDB, &labelImages)) {
+                    *pDamagedAreaId = chunks.at(i).mAreaId;
+                    return false;
                 }
-                if (!onlyUseSymbolFontString.isEmpty()) {
-                    mIsOnlyMapSymbolFontToBeUsed = (onlyUseSymbolFontString != QLatin1String("false"));
+                if (!labelImages.isEmpty()) {
+                    pLabelImages->insert(chunks.at(i).mAreaId, labelImages);
                 }
+                reportProgress(i + 1, total);
+            }
+        } else {
+            QDataStream roomStream(roomData);
+            roomStream.setVersion(streamVersion);
+            readMapFileRooms(roomStream, pRoomDB, reportProgress);
+        }
+        return !mAbortBackgroundLoad;
+    });
+
+    auto watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcher<bool>::finished, this, [this, watcher, pRoomDB, globals, pLabelImages, pDamagedAreaId, onFinished, timer]() {
+        watcher->deleteLater();
+        mIsLoadingInBackground = false;
+        mpBackgroundRoomDB = nullptr;
+        if (!watcher->result()) {
+            if (pDamagedAreaId->has_value()) {
+                postDamagedAreaChunkMessage(pDamagedAreaId->value());
             }
+            pRoomDB->discard();
+            delete pRoomDB;
+            onFinished(false);
+            raiseMapLoadProgressEvent(-1);
+            return;
         }
 
-        mMapSymbolFont.setStyleStrategy(static_cast<QFont::StyleStrategy>((mIsOnlyMapSymbolFontToBeUsed ? QFont::NoFontMerging : 0)
-                                                                          |QFont::PreferOutline | QFont::PreferAntialias | QFont::PreferQuality
-                                                                          |QFont::PreferNoShaping
-                                                                          ));
-        if (mVersion >= 14) {
-            int areaSize = 0;
-            ifs >> areaSize;
-            // restore area table
-            for (int i = 0; i < areaSize; i++) {
-                auto pA = new TArea(this, mpRoomDB);
-                int areaID = 0;
-                ifs >> areaID;
-                if (mVersion >= 18) {
-                    // In version 18 changed from QList<int> to QSet<int> as the later is
-                    // faster in many of the cases where we use it.
-                    ifs >> pA->rooms;
-                } else {
-                    QList<int> oldRoomsList;
-                    ifs >> oldRoomsList;
-                    pA->rooms = QSet<int>{oldRoomsList.begin(), oldRoomsList.end()};
-                }
-                // Can be useful when analysing suspect map files!
-                //                qDebug() << "TMap::restore(...)" << "Area:" << areaID;
-                //                qDebug() << "Rooms:" << pA->rooms;
-                ifs >> pA->zLevels;
-                ifs >> pA->mAreaExits;
-                ifs >> pA->gridMode;
-                ifs >> pA->max_x;
-                ifs >> pA->max_y;
-                ifs >> pA->max_z;
-                ifs >> pA->min_x;
-                ifs >> pA->min_y;
-                ifs >> pA->min_z;
-                ifs >> pA->span;
-                if (mVersion >= 17) {
-                    ifs >> pA->xmaxForZ;
-                    ifs >> pA->ymaxForZ;
-                    ifs >> pA->xminForZ;
-                    ifs >> pA->yminForZ;
-                } else {
-                    QMap<int, int> dummyMinMaxForZ;
-                    ifs >> pA->xmaxForZ;
-                    ifs >> pA->ymaxForZ;
-                    ifs >> dummyMinMaxForZ;
-                    ifs >> pA->xminForZ;
-                    ifs >> pA->yminForZ;
-                    ifs >> dummyMinMaxForZ;
-                }
-                ifs >> pA->pos;
-                ifs >> pA->isZone;
-                ifs >> pA->zoneAreaRef;
-                if (mVersion >= 21) {
-                    ifs >> pA->mLast2DMapZoom;
-                    ifs >> pA->mUserData;
-                } else if (mVersion >= 17) {
-                    ifs >> pA->mUserData;
-                    const qreal fallback_map2DZoom = pA->mUserData.take(QLatin1String("system.fallback_map2DZoom")).toDouble();
-                    pA->mLast2DMapZoom = (fallback_map2DZoom >= T2DMap::csmMinXYZoom) ? fallback_map2DZoom : T2DMap::csmDefaultXYZoom;
-                }
-                if (mVersion >= 21) {
-                    int mapLabelsCount = -1;
-                    ifs >> mapLabelsCount;
-                    for (int i = 0; i < mapLabelsCount; ++i) {
-                        int labelId = -1;
-                        ifs >> labelId;
-                        TMapLabel label;
-                        ifs >> label.size;
-                        ifs >> label.text;
-                        ifs >> label.fgColor;
-                        ifs >> label.bgColor;
-                        ifs >> label.pix;
-                        ifs >> label.noScaling;
-                        ifs >> label.showOnTop;
-                        pA->mMapLabels.insert(labelId, label);
-                    }
+        for (auto itArea = pLabelImages->cbegin(); itArea != pLabelImages->cend(); ++itArea) {
+            TArea* pA = pRoomDB->getArea(itArea.key());
+            if (!pA) {
+                continue;
+            }
+            for (auto itImage = itArea.value().cbegin(); itImage != itArea.value().cend(); ++itImage) {
+                if (pA->mMapLabels.contains(itImage.key())) {
+                    pA->mMapLabels[itImage.key()].pix = QPixmap::fromImage(itImage.value());
                 }
-                mpRoomDB->restoreSingleArea(areaID, pA);
             }
         }
+        addDefaultAreaIfMissing(pRoomDB);
+
+        // This is it - the point at which the new map gets activated:
+        TRoomDB* pOldRoomDB = mpRoomDB;
+        reportDiscardedMapEdits(pOldRoomDB);
+        mpRoomDB = pRoomDB;
+        applyMapGlobals(globals);
+        pOldRoomDB->clearMapDB();
+        delete pOldRoomDB;
+        mGraph.clear();
+        mGraphDirtyRooms.clear();
+        mGraphDirtyExits.clear();
+        mMapGraphNeedsUpdate = true;
+        restore16ColorSet();
 
-        if (!mpRoomDB->getAreaMap().keys().contains(-1)) {
-            auto pDefaultA = new TArea(this, mpRoomDB);
-            mpRoomDB->restoreSingleArea(-1, pDefaultA);
-            const QString defaultAreaInsertionMsg = tr("[ INFO ]  - Default (reset) area (for rooms that have not been assigned to an\n"
-                                                 "area) not found, adding reserved -1 id.");
-            appendErrorMsgWithNoLf(defaultAreaInsertionMsg, false);
-            if (mudlet::self()->showMapAuditErrors()) {
-                postMessage(defaultAreaInsertionMsg);
-            }
+        const QString okMsg = tr("[ INFO ]  - Successfully read the map file (%1s), checking some\n"
+                           "consistency details..." )
+                                .arg(timer.nsecsElapsed() * 1.0e-9, 0, 'f', 2);
+        postMessage(okMsg);
+        appendErrorMsgWithNoLf(okMsg);
+        onFinished(true);
+        raiseMapLoadProgressEvent(100);
+    });
+    watcher->setFuture(mBackgroundLoad);
+}
+
+// Anything that scripts have put into the map that is in use whilst another
+// one is read in the background is thrown away when the latter is swapped in,
+// so at least let the user know about it:
+void TMap::reportDiscardedMapEdits(TRoomDB* pOldRoomDB)
+{
+    const int roomCount = pOldRoomDB->size();
+    int areaCount = 0;
+    for (auto itArea = pOldRoomDB->getAreaMap().cbegin(); itArea != pOldRoomDB->getAreaMap().cend(); ++itArea) {
+        if (itArea.key() != -1) {
+            ++areaCount;
         }
+    }
+    if (!roomCount && !areaCount) {
+        return;
+    }
 
-        if (mVersion >= 18) {
-            // In version 18 we changed to store the "userRoom" for each profile
-            // so that when copied/shared between profiles they do not interfere
-            // with each other's saved value
-            ifs >> mRoomIdHash;
-        } else if (mVersion >= 12) {
-            int oldRoomId = 0;
-            ifs >> oldRoomId;
-            mRoomIdHash[mProfileName] = oldRoomId;
-        }
-
-        if (mVersion >= 11 && mVersion <= 20) {
-            // After version 20 the map labels have been moved to each area
-            int areasWithLabelsTotal = 0;
-            ifs >> areasWithLabelsTotal;
-            int areasWithLabelsCounter = 0;
-            while (!ifs.atEnd() && areasWithLabelsCounter < areasWithLabelsTotal) {
-                int areaID = -1;
-                int areaLabelsTotal = 0;
-                ifs >> areaLabelsTotal;
-                // Only used to identify the area for this batch of labels:
-                ifs >> areaID;
-                int areaLabelCounter = 0;
-                auto pA = mpRoomDB->getArea(areaID);
-                while (!ifs.atEnd() && areaLabelCounter < areaLabelsTotal) {
-                    int labelID = 0;
-                    ifs >> labelID;
-                    TMapLabel label;
-                    if (mVersion >= 12) {
-                        // From version 12 labels could be placed on any level,
-                        // so they have a z coordinate:
-                        ifs >> label.pos;
-                    } else {
-                        QPointF labelPos2D;
-                        ifs >> labelPos2D;
-                        label.pos = QVector3D(labelPos2D);
-                    }
-                    // There was an unused QPointF in versions prior to 21
-                    QPointF dummyPointF;
-                    ifs >> dummyPointF;
-                    ifs >> label.size;
-                    ifs >> label.text;
-                    ifs >> label.fgColor;
-                    ifs >> label.bgColor;
-                    ifs >> label.pix;
-                    if (mVersion >= 15) {
-                        ifs >> label.noScaling;
-                        ifs >> label.showOnTop;
-                    }
-                    if (pA) {
-                        pA->mMapLabels.insert(labelID, label);
-                    }
-                    ++areaLabelCounter;
-                    // Else: we dump labels for areas not in map - this should
-                    // not be happening nowadays but did in the past - see
-                    // PR #4369
-                }
-                ++areasWithLabelsCounter;
+    const QString warnMsg = tr("[ WARN ]  - %n room(s) and %1 area(s) added to the map while it was still being\n"
+                               "loaded have been discarded, they should be created again now it is in place.",
+                               "Making use of %n to allow quantity dependent message form, the %1 is the number of areas.",
+                               roomCount)
+                                    .arg(areaCount);
+    appendErrorMsgWithNoLf(warnMsg, false);
+    postMessage(warnMsg);
+}
+
+TMap::MapGlobals TMap::currentMapGlobals() const
+{
+    MapGlobals globals;
+    globals.mEnvColors = mEnvColors;
+    globals.mCustomEnvColors = mCustomEnvColors;
+    globals.mUserData = mUserData;
+    globals.mMapSymbolFont = mMapSymbolFont;
+    globals.mMapSymbolFontFudgeFactor = mMapSymbolFontFudgeFactor;
+    globals.mIsOnlyMapSymbolFontToBeUsed = mIsOnlyMapSymbolFontToBeUsed;
+    globals.mRoomIdHash = mRoomIdHash;
+    return globals;
+}
+
+void TMap::applyMapGlobals(const MapGlobals& globals)
+{
+    mEnvColors = globals.mEnvColors;
+    mCustomEnvColors = globals.mCustomEnvColors;
+    mUserData = globals.mUserData;
+    mMapSymbolFont = globals.mMapSymbolFont;
+    mMapSymbolFontFudgeFactor = globals.mMapSymbolFontFudgeFactor;
+    mIsOnlyMapSymbolFontToBeUsed = globals.mIsOnlyMapSymbolFontToBeUsed;
+    mRoomIdHash = globals.mRoomIdHash;
+}
+
+void TMap::raiseMapLoadProgressEvent(const int percent)
+{
+    if (!mpHost) {
+        return;
+    }
+
+    TEvent event{};
+    event.mArgumentList.append(qsl("sysMapLoadProgress"));
+    event.mArgumentTypeList.append(ARGUMENT_TYPE_STRING);
+    event.mArgumentList.append(QString::number(percent));
+    event.mArgumentTypeList.append(ARGUMENT_TYPE_NUMBER);
+    mpHost->raiseEvent(event);
+}
+
+// Reads everything in a (non-chunked) map file up to the rooms, which are
+// always the last thing in it:
+void TMap::readMapFileHead(QDataStream& ifs, TRoomDB* pRoomDB, MapGlobals& globals)
+{
+    // As all but the room reading have version checks the fact that sub-4
+    // files will still be parsed despite canRestore being false is probably OK
+    if (mVersion >= 4) {
+        ifs >> globals.mEnvColors;
+        pRoomDB->restoreAreaMap(ifs);
+    }
+    if (mVersion >= 5) {
+        ifs >> globals.mCustomEnvColors;
+    }
+    if (mVersion >= 7) {
+        ifs >> pRoomDB->hashToRoomID;
+        QMap<QString, int>::const_iterator i;
+        for (i = pRoomDB->hashToRoomID.constBegin(); i != pRoomDB->hashToRoomID.constEnd(); ++i) {
+            pRoomDB->roomIDToHash.insert(i.value(), i.key());
+        }
+    }
+
+    if (mVersion >= 17) {
+        ifs >> globals.mUserData;
+        if (mVersion >= 19) {
+            // Read the data from the file directly in version 19 or later
+            ifs >> globals.mMapSymbolFont;
+            if ((mVersion < 21) && globals.mMapSymbolFont.toString().split(QLatin1String(",")).size() > 15) {
+                // We need to clean up the effects of using QFont(string)
+                // for a format 17 or 18 below - as this fix went in before
+                // 21 was used it only has to be used for map formats 19 and
+                // 20:
+                globals.mMapSymbolFont.fromString(globals.mMapSymbolFont.toString().split(QLatin1String(",")).mid(0, 10).join(QLatin1String(",")));
+            }
+            ifs >> globals.mMapSymbolFontFudgeFactor;
+            ifs >> globals.mIsOnlyMapSymbolFontToBeUsed;
+        } else {
+            // Fallback to reading the data from the map user data - and
+            // remove it from the data the user will see:
+            // BUGFIX: Using QFont::toString() and then using that to
+            // construct a font again afterwards via a QFont(string) was
+            // incorrect as it seemed to cause the last to duplicated the
+            // last nine elements each time. The details of the ::toString()
+            // ::fromString() methods are not currently documented so the
+            // only details are documented in the source:
+            // https://code.qt.io/cgit/qt/qtbase.git/tree/src/gui/text/qfont.cpp?h=5.15#n2070
+            // and:
+            // https://code.qt.io/cgit/qt/qtbase.git/tree/src/gui/text/qfont.cpp?h=5.15#n2128
+            // this suggests that only one or ten elements are accepted so
+            // we CAN fix past mistakes by only considering the first ten
+            // elements:
+            const QStringList fontStrings{globals.mUserData.take(qsl("system.fallback_mapSymbolFont")).split(QLatin1Char(','))};
+            const QString fontString{fontStrings.mid(0, 10).join(QLatin1Char(','))};
+            const QString fontFudgeFactorString = globals.mUserData.take(qsl("system.fallback_mapSymbolFontFudgeFactor"));
+            const QString onlyUseSymbolFontString = globals.mUserData.take(qsl("system.fallback_onlyUseMapSymbolFont"));
+            if (!fontString.isEmpty()) {
+                globals.mMapSymbolFont.fromString(fontString);
+            }
+            if (!fontFudgeFactorString.isEmpty()) {
+                globals.mMapSymbolFontFudgeFactor = fontFudgeFactorString.toDouble();
+            }
+            if (!onlyUseSymbolFontString.isEmpty()) {
+                globals.mIsOnlyMapSymbolFontToBeUsed = (onlyUseSymbolFontString != QLatin1String("false"));
             }
         }
+    }
 
-        while (!ifs.atEnd()) {
-            int i = 0;
-            ifs >> i;
-            auto pT = new TRoom(mpRoomDB);
-            pT->restore(ifs, i, mVersion);
-            mpRoomDB->restoreSingleRoom(i, pT);
+    globals.mMapSymbolFont.setStyleStrategy(static_cast<QFont::StyleStrategy>((globals.mIsOnlyMapSymbolFontToBeUsed ? QFont::NoFontMerging : 0)
+                                                                              |QFont::PreferOutline | QFont::PreferAntialias | QFont::PreferQuality
+                                                                              |QFont::PreferNoShaping
+                                                                              ));
+    if (mVersion >= 14) {
+        int areaSize = 0;
+        ifs >> areaSize;
+        // restore area table
+        for (int i = 0; i < areaSize; i++) {
+            auto pA = new TArea(this, pRoomDB);
+            int areaID = 0;
+            ifs >> areaID;
+            readArea(ifs, pA);
+            pRoomDB->restoreSingleArea(areaID, pA);
         }
+    }
 
-        restore16ColorSet();
+    addDefaultAreaIfMissing(pRoomDB);
 
-        const QString okMsg = tr("[ INFO ]  - Successfully read the map file (%1s), checking some\n"
-                           "consistency details..." )
-                                .arg(_time.nsecsElapsed() * 1.0e-9, 0, 'f', 2);
+    if (mVersion >= 18) {
+        // In version 18 we changed to store the "userRoom" for each profile
+        // so that when copied/shared between profiles they do not interfere
+        // with each other's saved value
+        ifs >> globals.mRoomIdHash;
+    } else if (mVersion >= 12) {
+        int oldRoomId = 0;
+        ifs >> oldRoomId;
+        globals.mRoomIdHash[mProfileName] = oldRoomId;
+    }
 
-        postMessage(okMsg);
-        appendErrorMsgWithNoLf(okMsg);
-        if (canRestore) {
-            return true;
+    if (mVersion >= 11 && mVersion <= 20) {
+        // After version 20 the map labels have been moved to each area
+        int areasWithLabelsTotal = 0;
+        ifs >> areasWithLabelsTotal;
+        int areasWithLabelsCounter = 0;
+        while (!ifs.atEnd() && areasWithLabelsCounter < areasWithLabelsTotal) {
+            int areaID = -1;
+            int areaLabelsTotal = 0;
+            ifs >> areaLabelsTotal;
+            // Only used to identify the area for this batch of labels:
+            ifs >> areaID;
+            int areaLabelCounter = 0;
+            auto pA = pRoomDB->getArea(areaID);
+            while (!ifs.atEnd() && areaLabelCounter < areaLabelsTotal) {
+                int labelID = 0;
+                ifs >> labelID;
+                TMapLabel label;
+                if (mVersion >= 12) {
+                    // From version 12 labels could be placed on any level,
+                    // so they have a z coordinate:
+                    ifs >> label.pos;
+                } else {
+                    QPointF labelPos2D;
+                    ifs >> labelPos2D;
+                    label.pos = QVector3D(labelPos2D);
+                }
+                // There was an unused QPointF in versions prior to 21
+                QPointF dummyPointF;
+                ifs >> dummyPointF;
+                ifs >> label.size;
+                ifs >> label.text;
+                ifs >> label.fgColor;
+                ifs >> label.bgColor;
+                ifs >> label.pix;
+                if (mVersion >= 15) {
+                    ifs >> label.noScaling;
+                    ifs >> label.showOnTop;
+                }
+                if (pA) {
+                    pA->mMapLabels.insert(labelID, label);
+                }
+                ++areaLabelCounter;
+                // Else: we dump labels for areas not in map - this should
+                // not be happening nowadays but did in the past - see
+                // PR #4369
+            }
+            ++areasWithLabelsCounter;
         }
     }
+}
 
-    if ((!canRestore || entries.empty()) && downloadIfNotFound) {
-        QMessageBox msgBox;
+// The rooms are read until the end of the data, if given reportProgress is
+// called now and then with the bytes read so far and the total:
+void TMap::readMapFileRooms(QDataStream& ifs, TRoomDB* pRoomDB, const std::function<void(qint64, qint64)>& reportProgress)
+{
+    const qint64 total = ifs.device() ? ifs.device()->size() : 0;
+    int count = 0;
+    while (!ifs.atEnd() && !mAbortBackgroundLoad) {
+        int i = 0;
+        ifs >> i;
+        auto pT = new TRoom(pRoomDB);
+        pT->restore(ifs, i, mVersion);
+        pRoomDB->restoreSingleRoom(i, pT);
+        if (reportProgress && !(++count % 1000)) {
+            reportProgress(ifs.device()->pos(), total);
+        }
+    }
+}
 
-        if (!getMmpMapLocation().isEmpty()) {
-            msgBox.setText(tr("No map found. Would you like to download the map or start your own?"));
-            QPushButton* yesButton = msgBox.addButton(tr("Download the map"), QMessageBox::ActionRole);
-            QPushButton* noButton = msgBox.addButton(tr("Start my own"), QMessageBox::ActionRole);
-            msgBox.exec();
-            if (msgBox.clickedButton() == yesButton) {
-                downloadMap();
-            } else if (msgBox.clickedButton() == noButton) {
-                ; //No-op to avoid unused "noButton"
+// If pLabelImages is given the map label images are placed in it (keyed by the
+// label id) rather than being put into the labels - which means that this can
+// be used on a thread other than the GUI one:
+void TMap::readArea(QDataStream& ifs, TArea* pA, QHash<int, QImage>* pLabelImages)
+{
+    if (mVersion >= 18) {
+        // In version 18 changed from QList<int> to QSet<int> as the later is
+        // faster in many of the cases where we use it.
+        ifs >> pA->rooms;
+    } else {
+        QList<int> oldRoomsList;
+        ifs >> oldRoomsList;
+        pA->rooms = QSet<int>{oldRoomsList.begin(), oldRoomsList.end()};
+    }
+    // Can be useful when analysing suspect map files!
+    //    qDebug() << "TMap::readArea(...)" << "Rooms:" << pA->rooms;
+    ifs >> pA->zLevels;
+    ifs >> pA->mAreaExits;
+    ifs >> pA->gridMode;
+    ifs >> pA->max_x;
+    ifs >> pA->max_y;
+    ifs >> pA->max_z;
+    ifs >> pA->min_x;
+    ifs >> pA->min_y;
+    ifs >> pA->min_z;
+    ifs >> pA->span;
+    if (mVersion >= 17) {
+        ifs >> pA->xmaxForZ;
+        ifs >> pA->ymaxForZ;
+        ifs >> pA->xminForZ;
+        ifs >> pA->yminForZ;
+    } else {
+        QMap<int, int> dummyMinMaxForZ;
+        ifs >> pA->xmaxForZ;
+        ifs >> pA->ymaxForZ;
+        ifs >> dummyMinMaxForZ;
+        ifs >> pA->xminForZ;
+        ifs >> pA->yminForZ;
+        ifs >> dummyMinMaxForZ;
+    }
+    ifs >> pA->pos;
+    ifs >> pA->isZone;
+    ifs >> pA->zoneAreaRef;
+    if (mVersion >= 21) {
+        ifs >> pA->mLast2DMapZoom;
+        ifs >> pA->mUserData;
+    } else if (mVersion >= 17) {
+        ifs >> pA->mUserData;
+        const qreal fallback_map2DZoom = pA->mUserData.take(QLatin1String("system.fallback_map2DZoom")).toDouble();
+        pA->mLast2DMapZoom = (fallback_map2DZoom >= T2DMap::csmMinXYZoom) ? fallback_map2DZoom : T2DMap::csmDefaultXYZoom;
+    }
+    if (mVersion >= 21) {
+        int mapLabelsCount = -1;
+        ifs >> mapLabelsCount;
+        for (int i = 0; i < mapLabelsCount; ++i) {
+            int labelId = -1;
+            ifs >> labelId;
+            TMapLabel label;
+            ifs >> label.pos;
+            ifs >> label.size;
+            ifs >> label.text;
+            ifs >> label.fgColor;
+            ifs >> label.bgColor;
+            if (pLabelImages) {
+                // A QPixmap is stored as a QImage so this is the same data:
+                QImage image;
+                ifs >> image;
+                pLabelImages->insert(labelId, image);
+            } else {
+                ifs >> label.pix;
             }
+            ifs >> label.noScaling;
+            ifs >> label.showOnTop;
+            pA->mMapLabels.insert(labelId, label);
         }
     }
+}
 
-    return canRestore; //FIXME
+void TMap::addDefaultAreaIfMissing(TRoomDB* pRoomDB)
+{
+    if (!pRoomDB->getAreaMap().keys().contains(-1)) {
+        auto pDefaultA = new TArea(this, pRoomDB);
+        pRoomDB->restoreSingleArea(-1, pDefaultA);
+        const QString defaultAreaInsertionMsg = tr("[ INFO ]  - Default (reset) area (for rooms that have not been assigned to an\n"
+                                             "area) not found, adding reserved -1 id.");
+        appendErrorMsgWithNoLf(defaultAreaInsertionMsg, false);
+        if (mudlet::self()->showMapAuditErrors()) {
+            postMessage(defaultAreaInsertionMsg);
+        }
+    }
 }
 
 // Reads the newest map file from the profile and retrieves some stats and data,
@@ -1984,6 +2482,26 @@ bool TMap::retrieveMapFileStats(QString profile, QString* latestFileName = nullp
         }
     }
 
+    if (otherProfileVersion >= mChunkedVersion) {
+        // Everything wanted is in the header so the rest need not be read:
+        TMapChunkedFile::Header header;
+        const bool isValid = TMapChunkedFile::readHeader(ifs, header);
+        file.close();
+        if (!isValid) {
+            return false;
+        }
+        if (areaCount) {
+            *areaCount = header.mAreaCount;
+        }
+        if (roomCount) {
+            *roomCount = header.mRoomCount;
+        }
+        if (roomId) {
+            *roomId = header.mRoomIdHash.value(profile);
+        }
+        return true;
+    }
+
     if (otherProfileVersion >= 4) {
         // envColorMap
         QMap<int, int> _dummyQMapIntInt;
@@ -25,6 +25,7 @@
 
 
 #include "TAstar.h"
+#include "TMapChunkedFile.h"
 #if defined(INCLUDE_3DMAPPER)
 #include "glwidget.h"
 #endif
@@ -34,6 +35,7 @@
 #include <QApplication>
 #include <QColor>
 #include <QFont>
+#include <QFuture>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -44,6 +46,8 @@
 #include <QSizeF>
 #include <QVector3D>
 #include <stdlib.h>
+#include <atomic>
+#include <functional>
 #include <optional>
 #include "post_guard.h"
 
@@ -70,6 +74,7 @@ class TArea;
 class TRoom;
 class TRoomDB;
 class QFile;
+class QImage;
 class QNetworkAccessManager;
 class QProgressDialog;
 class MapInfoContributorManager;
@@ -124,12 +129,23 @@ public:
     QList<int> detectRoomCollisions(int id);
     void setRoom(int);
     bool findPath(int from, int to);
+    bool findPaths(const int from, const QList<int>& targets = {});
+    QStringList pathCommands(const int from, const QList<int>& path) const;
+    static QString routeCommand(const route&);
     bool gotoRoom(int);
     bool gotoRoom(int, int);
     bool serialize(QDataStream&, int saveVersion = 0);
     bool restore(QString location, bool downloadIfNotFound = true);
+    void restoreInBackground(const std::function<void(bool)>& onFinished);
+    bool isLoadingInBackground() const { return mIsLoadingInBackground; }
     bool retrieveMapFileStats(QString, QString*, int*, int*, qsizetype*, qsizetype*);
     void initGraph();
+    void updateGraph();
+    // For when a room has been added, removed, (un)locked or had its weight
+    // changed - which affects the routes into it as well as out of it:
+    void markRoomChanged(const int roomId);
+    // For when only the exits (or their locks or weights) of a room changed:
+    void markRoomExitsChanged(const int roomId);
     QString connectExitStubByDirection(const int fromRoomId, const int dirType);
     QString connectExitStubByToId(const int fromRoomId, const int toRoomId);
     QString connectExitStubByDirectionAndToId(const int fromRoomId, const int dirType, const int toRoomId);
@@ -248,15 +264,10 @@ public:
     QPointer<GLWidget> mpM;
 #endif
     QPointer<dlgMapper> mpMapper;
-    QMap<int, int> roomidToIndex;
-
-    typedef boost::adjacency_list<boost::listS, boost::vecS, boost::directedS, boost::no_property, boost::property<boost::edge_weight_t, cost>> mygraph_t;
-    typedef boost::property_map<mygraph_t, boost::edge_weight_t>::type WeightMap;
-    typedef mygraph_t::vertex_descriptor vertex;
-    typedef mygraph_t::edge_descriptor edge_descriptor;
-    mygraph_t g;
-    QHash<QPair<unsigned int, unsigned int>, route> edgeHash; // For Mudlet to decode BGL edges
-    std::vector<location> locations;
+    TMapGraph mGraph;
+    // Set when the whole graph needs to be built again, e.g. after loading or
+    // clearing the map or deleting an area - individual changes are recorded
+    // with markRoomChanged(...) and markRoomExitsChanged(...) instead:
     bool mMapGraphNeedsUpdate = true;
     bool mNewMove = true;
 
@@ -282,8 +293,16 @@ public:
      *   directly into the TArea class serialization - for lower map versions it
      *   is placed into a "system.fallback_map2DZoom" value in the Area userdata.
      *   SlySven - 2023/03
+     * * Version 22 keeps all of the above but is written as a header, with an
+     *   index, followed by a separately compressed chunk for the global data
+     *   and for each area (together with the rooms in it) - so the header can
+     *   be read on its own and each area decoded independently of the others.
      */
-    const int mMaxVersion = 20;
+    const int mMaxVersion = 22;
+
+    // The first map format version that is written in chunks - see the
+    // comment before TMap::serializeChunked(...):
+    const int mChunkedVersion = 22;
 
     // Ideally would be the same as mDefaultVersion but we have it lower,
     // particularly for release builds and is the minimum version allowed for
@@ -347,7 +366,38 @@ private:
     const QString createFileHeaderLine(QString, QChar);
     void writeJsonUserData(QJsonObject&) const;
     void readJsonUserData(const QJsonObject&);
-    bool validatePotentialMapFile(QFile&, QDataStream&);
+    // The map-wide data read from a map file before the areas and rooms - it
+    // is read into one of these rather than the members so that a map being
+    // read in the background does not touch the live ones until it is
+    // swapped in:
+    struct MapGlobals
+    {
+        QMap<int, int> mEnvColors;
+        QMap<int, QColor> mCustomEnvColors;
+        QMap<QString, QString> mUserData;
+        QFont mMapSymbolFont;
+        qreal mMapSymbolFontFudgeFactor = 1.0;
+        bool mIsOnlyMapSymbolFontToBeUsed = false;
+        QHash<QString, int> mRoomIdHash;
+    };
+
+    bool validatePotentialMapFile(QFile&, QDataStream&, TMapChunkedFile::Header*);
+    bool serializeChunked(QDataStream&);
+    bool restoreChunked(QDataStream&, const TMapChunkedFile::Header&);
+    bool readGlobalChunk(const QByteArray&, const int streamVersion, TRoomDB*, MapGlobals&);
+    bool restoreAreaChunk(const QByteArray&, const TMapChunkedFile::Chunk&, const int streamVersion, TRoomDB*, QHash<int, QImage>* pLabelImages = nullptr);
+    void postDamagedAreaChunkMessage(const int areaId);
+    void readMapFileHead(QDataStream&, TRoomDB*, MapGlobals&);
+    MapGlobals currentMapGlobals() const;
+    void applyMapGlobals(const MapGlobals&);
+    void readMapFileRooms(QDataStream&, TRoomDB*, const std::function<void(qint64, qint64)>& reportProgress = {});
+    void writeArea(QDataStream&, TArea*);
+    void readArea(QDataStream&, TArea*, QHash<int, QImage>* pLabelImages = nullptr);
+    void writeRoom(QDataStream&, TRoom*);
+    void addDefaultAreaIfMissing(TRoomDB*);
+    void reportDiscardedMapEdits(TRoomDB* pOldRoomDB);
+    void raiseMapLoadProgressEvent(const int percent);
+    QHash<int, route> graphRoutesFrom(TRoom*) const;
 
     QStringList mStoredMessages;
 
@@ -381,6 +431,24 @@ private:
     qsizetype mProgressDialogLabelsTotal = 0;
     qsizetype mProgressDialogLabelsCount = 0;
 
+    // Rooms that need their vertex (and so the edges into them as well) or
+    // just the edges out of them brought up to date by updateGraph():
+    QSet<int> mGraphDirtyRooms;
+    QSet<int> mGraphDirtyExits;
+
+    // Used by serializeChunked(...) - it keeps the compressed area chunks from
+    // the last save so that areas that have not changed since then do not have
+    // to be compressed again:
+    TMapChunkedFile mChunkedFile;
+
+    // Set while restoreInBackground(...) has a map being read on another
+    // thread into mpBackgroundRoomDB, which is swapped with mpRoomDB when it
+    // is finished; setting the abort flag makes the other thread give up:
+    bool mIsLoadingInBackground = false;
+    std::atomic<bool> mAbortBackgroundLoad{false};
+    TRoomDB* mpBackgroundRoomDB = nullptr;
+    QFuture<bool> mBackgroundLoad;
+
     // Used to flag whether the map auto-save needs to be done after the next interval:
     bool mUnsavedMap = false;
     // Used to hide the default area from casual viewing for those MUDs that
@@ -0,0 +1,169 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include "TMapChunkedFile.h"
+
+#include "pre_guard.h"
+#include <QCryptographicHash>
+#include <QIODevice>
+#include <QtConcurrent>
+#include "post_guard.h"
+
+#include <algorithm>
+
+bool TMapChunkedFile::write(QDataStream& ofs, Header& header, const QByteArray& globalChunk, const QList<QByteArray>& areaChunks)
+{
+    if (header.mChunks.size() != areaChunks.size()) {
+        return false;
+    }
+
+    header.mGlobalLength = globalChunk.size();
+    qint64 offset = header.mGlobalLength;
+    for (int i = 0, total = header.mChunks.size(); i < total; ++i) {
+        header.mChunks[i].mOffset = offset;
+        header.mChunks[i].mLength = areaChunks.at(i).size();
+        offset += header.mChunks.at(i).mLength;
+    }
+
+    ofs << static_cast<qint32>(header.mAreaCount);
+    ofs << static_cast<qint32>(header.mRoomCount);
+    ofs << header.mRoomIdHash;
+    ofs << header.mGlobalLength;
+    ofs << static_cast<qint32>(header.mChunks.size());
+    for (const auto& chunk : std::as_const(header.mChunks)) {
+        ofs << static_cast<qint32>(chunk.mAreaId);
+        ofs << static_cast<qint32>(chunk.mRoomCount);
+        ofs << chunk.mOffset;
+        ofs << chunk.mLength;
+    }
+
+    ofs.writeRawData(globalChunk.constData(), globalChunk.size());
+    for (const auto& data : areaChunks) {
+        ofs.writeRawData(data.constData(), data.size());
+    }
+    return ofs.status() == QDataStream::Ok;
+}
+
+bool TMapChunkedFile::readHeader(QDataStream& ifs, Header& header)
+{
+    qint32 areaCount = 0;
+    qint32 roomCount = 0;
+    qint32 chunkCount = 0;
+    ifs >> areaCount;
+    ifs >> roomCount;
+    ifs >> header.mRoomIdHash;
+    ifs >> header.mGlobalLength;
+    ifs >> chunkCount;
+    if (ifs.status() != QDataStream::Ok || areaCount < 0 || roomCount < 0 || chunkCount < 0 || header.mGlobalLength < 0) {
+        return false;
+    }
+
+    header.mAreaCount = areaCount;
+    header.mRoomCount = roomCount;
+    header.mChunks.clear();
+    for (qint32 i = 0; i < chunkCount; ++i) {
+        qint32 areaId = 0;
+        qint32 chunkRoomCount = 0;
+        Chunk chunk;
+        ifs >> areaId;
+        ifs >> chunkRoomCount;
+        ifs >> chunk.mOffset;
+        ifs >> chunk.mLength;
+        if (ifs.status() != QDataStream::Ok || chunk.mOffset < header.mGlobalLength || chunk.mLength < 0) {
+            return false;
+        }
+        chunk.mAreaId = areaId;
+        chunk.mRoomCount = chunkRoomCount;
+        header.mChunks.append(chunk);
+    }
+    return true;
+}
+
+bool TMapChunkedFile::fitsIn(const Header& header, const qint64 dataLength)
+{
+    if (header.mGlobalLength > dataLength) {
+        return false;
+    }
+    return std::all_of(header.mChunks.cbegin(), header.mChunks.cend(), [dataLength](const Chunk& chunk) { return chunk.mOffset + chunk.mLength <= dataLength; });
+}
+
+bool TMapChunkedFile::readChunks(QIODevice* pDevice, const Header& header, QByteArray& globalChunk, QList<QByteArray>& areaChunks)
+{
+    const qint64 dataStart = pDevice->pos();
+    globalChunk = pDevice->read(header.mGlobalLength);
+    if (globalChunk.size() != header.mGlobalLength) {
+        return false;
+    }
+
+    areaChunks.clear();
+    areaChunks.reserve(header.mChunks.size());
+    for (const auto& chunk : std::as_const(header.mChunks)) {
+        if (!pDevice->seek(dataStart + chunk.mOffset)) {
+            return false;
+        }
+        areaChunks.append(pDevice->read(chunk.mLength));
+        if (areaChunks.constLast().size() != chunk.mLength) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static QByteArray uncompressChunk(const QByteArray& compressed)
+{
+    return qUncompress(compressed);
+}
+
+QList<QByteArray> TMapChunkedFile::uncompressChunks(const QList<QByteArray>& chunks)
+{
+    return QtConcurrent::blockingMapped<QList<QByteArray>>(chunks, uncompressChunk);
+}
+
+QList<QByteArray> TMapChunkedFile::compressAreaChunks(const QList<std::pair<int, QByteArray>>& areaData)
+{
+    // Only read by the other threads:
+    const QHash<int, CacheEntry>& cache = mCache;
+    auto compress = [&cache](const std::pair<int, QByteArray>& area) {
+        CacheEntry entry = cache.value(area.first);
+        const QByteArray digest = QCryptographicHash::hash(area.second, QCryptographicHash::Sha1);
+        if (entry.mCompressed.isEmpty() || entry.mDigest != digest) {
+            entry.mDigest = digest;
+            entry.mCompressed = qCompress(area.second);
+        }
+        return entry;
+    };
+    const QList<CacheEntry> entries = QtConcurrent::blockingMapped<QList<CacheEntry>>(areaData, compress);
+
+    QHash<int, CacheEntry> newCache;
+    QList<QByteArray> result;
+    result.reserve(entries.size());
+    mLastCompressedCount = 0;
+    for (int i = 0, total = entries.size(); i < total; ++i) {
+        const auto& entry = entries.at(i);
+        if (!mCache.contains(areaData.at(i).first) || mCache.value(areaData.at(i).first).mCompressed.constData() != entry.mCompressed.constData()) {
+            ++mLastCompressedCount;
+        }
+        newCache.insert(areaData.at(i).first, entry);
+        result.append(entry.mCompressed);
+    }
+    // Only keep the entries for the areas that still exist:
+    mCache = newCache;
+    return result;
+}
@@ -0,0 +1,102 @@
+#ifndef MUDLET_TMAPCHUNKEDFILE_H
+#define MUDLET_TMAPCHUNKEDFILE_H
+
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include "pre_guard.h"
+#include <QByteArray>
+#include <QDataStream>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include "post_guard.h"
+
+#include <utility>
+
+class QIODevice;
+
+// The layout of a map file from format version 22 - see the comment before
+// TMap::serializeChunked(...): after the version comes a header, with an index
+// of the chunks, and then the qCompress(...)ed chunks themselves. This only
+// deals with that layout and with the compressing, what is in each chunk is up
+// to TMap. It also keeps the compressed form of each area chunk from the last
+// time, together with a digest of the data it was made from, so that the areas
+// that have not changed since the last save do not need compressing again.
+class TMapChunkedFile
+{
+public:
+    // An entry in the index, the offset is from the end of the header:
+    struct Chunk
+    {
+        int mAreaId = 0;
+        int mRoomCount = 0;
+        qint64 mOffset = 0;
+        qint64 mLength = 0;
+    };
+
+    // Everything in the file after the version and before the chunks, it is
+    // enough on its own to give the details of the map:
+    struct Header
+    {
+        int mAreaCount = 0;
+        int mRoomCount = 0;
+        QHash<QString, int> mRoomIdHash;
+        qint64 mGlobalLength = 0;
+        QList<Chunk> mChunks;
+    };
+
+    // Fills in the offsets and lengths in the header from the compressed
+    // chunks (the others are up to the caller) and writes it and then them:
+    static bool write(QDataStream&, Header&, const QByteArray& globalChunk, const QList<QByteArray>& areaChunks);
+    // Leaves the stream at the start of the global data chunk:
+    static bool readHeader(QDataStream&, Header&);
+    // Whether everything the index lists is within the given length of data
+    // following the header:
+    static bool fitsIn(const Header&, const qint64 dataLength);
+    // Reads the global data chunk and the area chunks, in the order that the
+    // index lists them, from a device positioned just after the header:
+    static bool readChunks(QIODevice*, const Header&, QByteArray& globalChunk, QList<QByteArray>& areaChunks);
+    // Shares the work out between threads, a chunk that is damaged gives an
+    // empty result:
+    static QList<QByteArray> uncompressChunks(const QList<QByteArray>&);
+
+    // Takes the area id and the (uncompressed) data for each area chunk and
+    // gives the compressed chunks in the same order - the work is shared out
+    // between threads and only the areas with data that differs from the last
+    // time are actually compressed. Areas that are not included are forgotten:
+    QList<QByteArray> compressAreaChunks(const QList<std::pair<int, QByteArray>>& areaData);
+    // How many of the chunks the last compressAreaChunks(...) compressed:
+    int lastCompressedCount() const { return mLastCompressedCount; }
+    void clear() { mCache.clear(); }
+
+private:
+    struct CacheEntry
+    {
+        QByteArray mDigest;
+        QByteArray mCompressed;
+    };
+
+    // Key is the area id:
+    QHash<int, CacheEntry> mCache;
+    int mLastCompressedCount = 0;
+};
+
+#endif // MUDLET_TMAPCHUNKEDFILE_H
@@ -0,0 +1,514 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include "TMapGraph.h"
+
+#include <algorithm>
+#include <functional>
+
+void TMapGraph::clear()
+{
+    mGraph = mygraph_t();
+    mLocations.clear();
+    mVertexAreas.clear();
+    mAreaVertices.clear();
+    mAreaPortals.clear();
+    mDirtyAreas.clear();
+    mRoomIdToVertex.clear();
+    mRoutes.clear();
+    mEntrances.clear();
+    mFreeVertices.clear();
+    mSearchSource = -1;
+}
+
+void TMapGraph::addRoom(const int roomId, TRoom* pR, const int areaId)
+{
+    mSearchSource = -1;
+    const auto it = mRoomIdToVertex.constFind(roomId);
+    if (it != mRoomIdToVertex.cend()) {
+        const vertex v = it.value();
+        mLocations[v].pR = pR;
+        const int oldAreaId = mVertexAreas[v];
+        if (oldAreaId != areaId) {
+            // Moving the room can change which rooms are portals in the areas
+            // of all the rooms it is connected to as well as its own:
+            mAreaVertices[oldAreaId].remove(v);
+            mAreaVertices[areaId].insert(v);
+            mVertexAreas[v] = areaId;
+            markAreaDirty(oldAreaId);
+            markAreaDirty(areaId);
+            mygraph_t::out_edge_iterator itEdge, endEdge;
+            for (boost::tie(itEdge, endEdge) = boost::out_edges(v, mGraph); itEdge != endEdge; ++itEdge) {
+                markAreaDirty(mVertexAreas[boost::target(*itEdge, mGraph)]);
+            }
+            for (const int source : mEntrances.value(roomId)) {
+                markAreaDirty(mVertexAreas[mRoomIdToVertex.value(source)]);
+            }
+        }
+        return;
+    }
+
+    vertex v;
+    if (!mFreeVertices.empty()) {
+        v = mFreeVertices.back();
+        mFreeVertices.pop_back();
+        mLocations[v] = location{roomId, pR};
+        mVertexAreas[v] = areaId;
+    } else {
+        v = boost::add_vertex(mGraph);
+        mLocations.push_back(location{roomId, pR});
+        mVertexAreas.push_back(areaId);
+    }
+    mRoomIdToVertex.insert(roomId, v);
+    mAreaVertices[areaId].insert(v);
+    markAreaDirty(areaId);
+}
+
+void TMapGraph::removeRoom(const int roomId)
+{
+    mSearchSource = -1;
+    const auto it = mRoomIdToVertex.constFind(roomId);
+    if (it == mRoomIdToVertex.cend()) {
+        return;
+    }
+
+    const vertex v = it.value();
+    clearRoutesFrom(roomId, v);
+    const QSet<int> sources = mEntrances.take(roomId);
+    for (const int source : sources) {
+        const vertex sourceVertex = mRoomIdToVertex.value(source);
+        boost::remove_edge(sourceVertex, v, mGraph);
+        mRoutes.remove(qMakePair(source, roomId));
+        markAreaDirty(mVertexAreas[sourceVertex]);
+    }
+    const int areaId = mVertexAreas[v];
+    auto itArea = mAreaVertices.find(areaId);
+    if (itArea != mAreaVertices.end()) {
+        itArea.value().remove(v);
+        if (itArea.value().isEmpty()) {
+            mAreaVertices.erase(itArea);
+        }
+    }
+    markAreaDirty(areaId);
+    mLocations[v] = location{0, nullptr};
+    mRoomIdToVertex.remove(roomId);
+    mFreeVertices.push_back(v);
+}
+
+void TMapGraph::setRoutes(const int roomId, const QHash<int, route>& routes)
+{
+    mSearchSource = -1;
+    const auto it = mRoomIdToVertex.constFind(roomId);
+    if (it == mRoomIdToVertex.cend()) {
+        return;
+    }
+
+    const vertex source = it.value();
+    clearRoutesFrom(roomId, source);
+    for (auto itRoute = routes.cbegin(), endRoute = routes.cend(); itRoute != endRoute; ++itRoute) {
+        const int target = itRoute.key();
+        if (target == roomId) {
+            continue;
+        }
+        const auto itTarget = mRoomIdToVertex.constFind(target);
+        if (itTarget == mRoomIdToVertex.cend()) {
+            continue;
+        }
+        boost::add_edge(source, itTarget.value(), itRoute.value().cost, mGraph);
+        mRoutes.insert(qMakePair(roomId, target), itRoute.value());
+        mEntrances[target].insert(roomId);
+        markAreaDirty(mVertexAreas[itTarget.value()]);
+    }
+}
+
+QList<int> TMapGraph::entrances(const int roomId) const
+{
+    const auto it = mEntrances.constFind(roomId);
+    if (it == mEntrances.cend()) {
+        return {};
+    }
+    return it.value().values();
+}
+
+void TMapGraph::clearRoutesFrom(const int roomId, const vertex source)
+{
+    markAreaDirty(mVertexAreas[source]);
+    mygraph_t::out_edge_iterator itEdge, endEdge;
+    for (boost::tie(itEdge, endEdge) = boost::out_edges(source, mGraph); itEdge != endEdge; ++itEdge) {
+        const vertex targetVertex = boost::target(*itEdge, mGraph);
+        const int target = mLocations[targetVertex].id;
+        mRoutes.remove(qMakePair(roomId, target));
+        markAreaDirty(mVertexAreas[targetVertex]);
+        auto itEntrances = mEntrances.find(target);
+        if (itEntrances != mEntrances.end()) {
+            itEntrances.value().remove(roomId);
+            if (itEntrances.value().isEmpty()) {
+                mEntrances.erase(itEntrances);
+            }
+        }
+    }
+    boost::clear_out_edges(source, mGraph);
+}
+
+void TMapGraph::searchFrom(const int roomId, const QList<int>& targets)
+{
+    mSearchSource = -1;
+    const auto itSource = mRoomIdToVertex.constFind(roomId);
+    if (itSource == mRoomIdToVertex.cend()) {
+        return;
+    }
+
+    startSearch();
+    mSearchSource = roomId;
+    if (targets.isEmpty()) {
+        sweep(itSource.value(), -1, false, nullptr);
+        return;
+    }
+
+    QSet<vertex> pendingTargets;
+    for (const int target : targets) {
+        const auto itTarget = mRoomIdToVertex.constFind(target);
+        if (itTarget != mRoomIdToVertex.cend()) {
+            pendingTargets.insert(itTarget.value());
+        }
+    }
+    if (pendingTargets.isEmpty()) {
+        // None of them are in the graph so none can be reached:
+        return;
+    }
+    sweep(itSource.value(), -1, false, &pendingTargets);
+}
+
+// Makes the workspace big enough for the graph and starts a fresh set of
+// stamps so that everything in it is treated as unused:
+void TMapGraph::startSearch()
+{
+    const size_t vertexCount = boost::num_vertices(mGraph);
+    if (mSearchVisited.size() < vertexCount) {
+        // New entries get a zero stamp which is never used for a search:
+        mSearchVisited.resize(vertexCount, 0);
+        mSearchSettled.resize(vertexCount, 0);
+        mSearchDistances.resize(vertexCount);
+        mSearchPredecessors.resize(vertexCount);
+    }
+    if (++mSearchStamp == 0) {
+        // Wrapped around - so the old stamps could be mistaken for current ones:
+        std::fill(mSearchVisited.begin(), mSearchVisited.end(), 0);
+        std::fill(mSearchSettled.begin(), mSearchSettled.end(), 0);
+        mSearchStamp = 1;
+    }
+}
+
+// The Dijkstra search behind searchFrom(...) and the area level routing: when
+// areaId is not -1 only the rooms in that area are visited and when reverse
+// is true the edges are followed backwards, so the distances are then those
+// to, rather than from, the source. If pTargets is given the search stops
+// once all of them (they are removed from it as they are found) are reached:
+void TMapGraph::sweep(const vertex source, const int areaId, const bool reverse, QSet<vertex>* pTargets)
+{
+    const auto weights = boost::get(boost::edge_weight, mGraph);
+    const auto byDistance = std::greater<std::pair<cost, vertex>>();
+    mSearchQueue.clear();
+    mSearchVisited[source] = mSearchStamp;
+    mSearchDistances[source] = 0;
+    mSearchPredecessors[source] = source;
+    mSearchQueue.emplace_back(0, source);
+
+    auto relax = [&](const vertex u, const vertex v, const cost distance) {
+        if (mSearchSettled[v] == mSearchStamp || (areaId != -1 && mVertexAreas[v] != areaId)
+            || (mSearchVisited[v] == mSearchStamp && mSearchDistances[v] <= distance)) {
+            return;
+        }
+        mSearchVisited[v] = mSearchStamp;
+        mSearchDistances[v] = distance;
+        mSearchPredecessors[v] = u;
+        mSearchQueue.emplace_back(distance, v);
+        std::push_heap(mSearchQueue.begin(), mSearchQueue.end(), byDistance);
+    };
+
+    while (!mSearchQueue.empty()) {
+        std::pop_heap(mSearchQueue.begin(), mSearchQueue.end(), byDistance);
+        const auto [distance, u] = mSearchQueue.back();
+        mSearchQueue.pop_back();
+        if (mSearchSettled[u] == mSearchStamp) {
+            // A stale entry for a vertex already reached by a shorter route:
+            continue;
+        }
+        mSearchSettled[u] = mSearchStamp;
+        if (pTargets && pTargets->remove(u) && pTargets->isEmpty()) {
+            return;
+        }
+
+        if (reverse) {
+            const int roomId = mLocations[u].id;
+            for (const int sourceRoomId : mEntrances.value(roomId)) {
+                relax(u, mRoomIdToVertex.value(sourceRoomId), distance + mRoutes.value(qMakePair(sourceRoomId, roomId)).cost);
+            }
+            continue;
+        }
+
+        mygraph_t::out_edge_iterator itEdge, endEdge;
+        for (boost::tie(itEdge, endEdge) = boost::out_edges(u, mGraph); itEdge != endEdge; ++itEdge) {
+            relax(u, boost::target(*itEdge, mGraph), distance + boost::get(weights, *itEdge));
+        }
+    }
+}
+
+cost TMapGraph::distanceTo(const int roomId) const
+{
+    const auto it = mRoomIdToVertex.constFind(roomId);
+    if (it == mRoomIdToVertex.cend() || !wasReached(it.value())) {
+        return -1;
+    }
+    return mSearchDistances[it.value()];
+}
+
+QList<int> TMapGraph::pathTo(const int roomId) const
+{
+    QList<int> result;
+    const auto it = mRoomIdToVertex.constFind(roomId);
+    if (it == mRoomIdToVertex.cend() || !wasReached(it.value())) {
+        return result;
+    }
+
+    appendSweepPath(mRoomIdToVertex.value(mSearchSource), it.value(), result);
+    return result;
+}
+
+// Appends the rooms along the path found by the last (forwards) sweep from
+// source to target, the latter must have been settled by it:
+void TMapGraph::appendSweepPath(const vertex source, const vertex target, QList<int>& path) const
+{
+    const int insertAt = path.size();
+    vertex v = target;
+    while (v != source) {
+        path.insert(insertAt, mLocations[v].id);
+        v = mSearchPredecessors[v];
+    }
+}
+
+QHash<int, cost> TMapGraph::reachedRooms() const
+{
+    QHash<int, cost> result;
+    if (mSearchSource < 0) {
+        return result;
+    }
+
+    for (vertex v = 0, total = mSearchSettled.size(); v < total; ++v) {
+        if (mSearchSettled[v] == mSearchStamp) {
+            result.insert(mLocations[v].id, mSearchDistances[v]);
+        }
+    }
+    return result;
+}
+
+int TMapGraph::portalCount() const
+{
+    int result = 0;
+    for (const auto& areaPortals : mAreaPortals) {
+        result += areaPortals.mPortals.size();
+    }
+    return result;
+}
+
+void TMapGraph::updateAreaPortals()
+{
+    for (const int areaId : std::as_const(mDirtyAreas)) {
+        const auto itVertices = mAreaVertices.constFind(areaId);
+        if (itVertices == mAreaVertices.cend()) {
+            mAreaPortals.remove(areaId);
+            continue;
+        }
+
+        AreaPortals& areaPortals = mAreaPortals[areaId];
+        areaPortals.mPortals.clear();
+        areaPortals.mDistances.clear();
+        for (const vertex v : itVertices.value()) {
+            bool isPortal = false;
+            mygraph_t::out_edge_iterator itEdge, endEdge;
+            for (boost::tie(itEdge, endEdge) = boost::out_edges(v, mGraph); !isPortal && itEdge != endEdge; ++itEdge) {
+                isPortal = mVertexAreas[boost::target(*itEdge, mGraph)] != areaId;
+            }
+            if (!isPortal) {
+                for (const int source : mEntrances.value(mLocations[v].id)) {
+                    if (mVertexAreas[mRoomIdToVertex.value(source)] != areaId) {
+                        isPortal = true;
+                        break;
+                    }
+                }
+            }
+            if (isPortal) {
+                areaPortals.mPortals.append(v);
+            }
+        }
+
+        for (const vertex portal : std::as_const(areaPortals.mPortals)) {
+            QSet<vertex> targets{areaPortals.mPortals.cbegin(), areaPortals.mPortals.cend()};
+            startSearch();
+            sweep(portal, areaId, false, &targets);
+            QHash<vertex, cost>& distances = areaPortals.mDistances[portal];
+            for (const vertex other : std::as_const(areaPortals.mPortals)) {
+                if (other != portal && isSettled(other)) {
+                    distances.insert(other, mSearchDistances[other]);
+                }
+            }
+        }
+    }
+    mDirtyAreas.clear();
+}
+
+bool TMapGraph::findAreaRoute(const int fromRoomId, const int toRoomId, QList<int>& path, cost& total)
+{
+    path.clear();
+    total = 0;
+    mSearchSource = -1;
+    if (!contains(fromRoomId) || !contains(toRoomId)) {
+        return false;
+    }
+    if (fromRoomId == toRoomId) {
+        return true;
+    }
+
+    updateAreaPortals();
+    const vertex start = vertexOf(fromRoomId);
+    const vertex goal = vertexOf(toRoomId);
+    const int startAreaId = mVertexAreas[start];
+    const int goalAreaId = mVertexAreas[goal];
+
+    // How far it is, inside its area, from the start to the portals of that
+    // area (and to the goal if that is in the same one):
+    QHash<vertex, cost> fromStart;
+    startSearch();
+    sweep(start, startAreaId, false, nullptr);
+    for (const vertex portal : mAreaPortals.value(startAreaId).mPortals) {
+        if (isSettled(portal)) {
+            fromStart.insert(portal, mSearchDistances[portal]);
+        }
+    }
+    if (startAreaId == goalAreaId && isSettled(goal)) {
+        fromStart.insert(goal, mSearchDistances[goal]);
+    }
+
+    // And how far it is, inside its area, from the portals of the goal's area
+    // to the goal:
+    QHash<vertex, cost> toGoal;
+    startSearch();
+    sweep(goal, goalAreaId, true, nullptr);
+    for (const vertex portal : mAreaPortals.value(goalAreaId).mPortals) {
+        if (isSettled(portal)) {
+            toGoal.insert(portal, mSearchDistances[portal]);
+        }
+    }
+
+    // Now a Dijkstra search over the portals - the value of the predecessors
+    // records whether the step to each one is inside an area (true) or an
+    // edge between two areas (false):
+    QHash<vertex, cost> distances{{start, 0}};
+    QHash<vertex, QPair<vertex, bool>> predecessors;
+    QSet<vertex> settled;
+    const auto byDistance = std::greater<std::pair<cost, vertex>>();
+    std::vector<std::pair<cost, vertex>> queue{{0, start}};
+    const auto weights = boost::get(boost::edge_weight, mGraph);
+    auto relax = [&](const vertex u, const vertex v, const cost distance, const bool insideArea) {
+        if (settled.contains(v)) {
+            return;
+        }
+        const auto itDistance = distances.constFind(v);
+        if (itDistance != distances.cend() && itDistance.value() <= distance) {
+            return;
+        }
+        distances.insert(v, distance);
+        predecessors.insert(v, qMakePair(u, insideArea));
+        queue.emplace_back(distance, v);
+        std::push_heap(queue.begin(), queue.end(), byDistance);
+    };
+
+    bool found = false;
+    while (!queue.empty()) {
+        std::pop_heap(queue.begin(), queue.end(), byDistance);
+        const auto [distance, u] = queue.back();
+        queue.pop_back();
+        if (settled.contains(u)) {
+            continue;
+        }
+        settled.insert(u);
+        if (u == goal) {
+            found = true;
+            total = distance;
+            break;
+        }
+
+        const int areaId = mVertexAreas[u];
+        const QHash<vertex, cost>* pInsideSteps = (u == start) ? &fromStart : nullptr;
+        if (!pInsideSteps) {
+            const auto itArea = mAreaPortals.constFind(areaId);
+            if (itArea != mAreaPortals.cend()) {
+                const auto itPortal = itArea.value().mDistances.constFind(u);
+                if (itPortal != itArea.value().mDistances.cend()) {
+                    pInsideSteps = &itPortal.value();
+                }
+            }
+        }
+        if (pInsideSteps) {
+            for (auto itStep = pInsideSteps->cbegin(), endStep = pInsideSteps->cend(); itStep != endStep; ++itStep) {
+                relax(u, itStep.key(), distance + itStep.value(), true);
+            }
+        }
+        if (areaId == goalAreaId && u != start) {
+            const auto itGoal = toGoal.constFind(u);
+            if (itGoal != toGoal.cend()) {
+                relax(u, goal, distance + itGoal.value(), true);
+            }
+        }
+        mygraph_t::out_edge_iterator itEdge, endEdge;
+        for (boost::tie(itEdge, endEdge) = boost::out_edges(u, mGraph); itEdge != endEdge; ++itEdge) {
+            const vertex v = boost::target(*itEdge, mGraph);
+            if (mVertexAreas[v] != areaId) {
+                relax(u, v, distance + boost::get(weights, *itEdge), false);
+            }
+        }
+    }
+
+    if (!found) {
+        return false;
+    }
+
+    // Walk back from the goal to get the steps between portals and then fill
+    // in the rooms for the ones that cross an area:
+    QList<QPair<vertex, bool>> steps;
+    for (vertex v = goal; v != start;) {
+        const QPair<vertex, bool> predecessor = predecessors.value(v);
+        steps.prepend(qMakePair(v, predecessor.second));
+        v = predecessor.first;
+    }
+    vertex previous = start;
+    for (const auto& step : std::as_const(steps)) {
+        if (step.second) {
+            QSet<vertex> target{step.first};
+            startSearch();
+            sweep(previous, mVertexAreas[previous], false, &target);
+            appendSweepPath(previous, step.first, path);
+        } else {
+            path.append(mLocations[step.first].id);
+        }
+        previous = step.first;
+    }
+    return true;
+}
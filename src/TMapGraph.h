@@ -0,0 +1,184 @@
+#ifndef MUDLET_TMAPGRAPH_H
+#define MUDLET_TMAPGRAPH_H
+
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#ifndef Q_MOC_RUN
+#include "pre_guard.h"
+#include <boost/graph/adjacency_list.hpp>
+#include "post_guard.h"
+#endif
+
+#include "pre_guard.h"
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include "post_guard.h"
+
+#include <utility>
+#include <vector>
+
+class TRoom;
+
+// auxiliary types
+struct location
+{
+    int id;    // Typically 4 bytes
+    TRoom* pR; // 4 or 8 bytes? - so may have reduced size from 20 to 8 or 12 plus padding...?
+};
+
+typedef float cost;
+
+// Used to record edge details and to deduplicate parallel ones:
+struct route
+{
+    float cost;              // Needed during establishing the best parallel edge
+    quint8 direction;        // Use DIR_xxx values to code exit direction
+    QString specialExitName; // If direction is DIR_OTHER then this is needed
+};
+
+// The graph that TMap::findPath(...) runs the A* search over: a vertex for
+// each usable (existing and unlocked) room and an edge for the best usable
+// exit from one room to another. Rooms can be added and removed and the edges
+// out of a single room replaced without touching the rest of the graph, so
+// that editing the map does not mean building the whole thing again. Vertices
+// of removed rooms are left in place, without any edges, and handed out again
+// to rooms added later - this keeps the vertex numbers of all the other rooms
+// stable which the boost::vecS storage would not do if they were erased.
+class TMapGraph
+{
+public:
+    typedef boost::adjacency_list<boost::listS, boost::vecS, boost::directedS, boost::no_property, boost::property<boost::edge_weight_t, cost>> mygraph_t;
+    typedef mygraph_t::vertex_descriptor vertex;
+    typedef mygraph_t::edge_descriptor edge_descriptor;
+
+    void clear();
+    bool contains(const int roomId) const { return mRoomIdToVertex.contains(roomId); }
+    // Only valid for a room that contains(...) returns true for:
+    vertex vertexOf(const int roomId) const { return mRoomIdToVertex.value(roomId); }
+    // Gives the room a vertex (without any edges) if it does not have one,
+    // otherwise just updates the TRoom pointer and area for it:
+    void addRoom(const int roomId, TRoom* pR, const int areaId);
+    // Drops all the edges into and out of the room and frees its vertex:
+    void removeRoom(const int roomId);
+    // Replaces all the edges out of the room with one to each of the target
+    // rooms (the keys) - targets without a vertex of their own are skipped:
+    void setRoutes(const int roomId, const QHash<int, route>& routes);
+    // The rooms that currently have an edge to the given one:
+    QList<int> entrances(const int roomId) const;
+    // Returns a route with a zero cost if there is no such edge:
+    route routeBetween(const int fromRoomId, const int toRoomId) const { return mRoutes.value(qMakePair(fromRoomId, toRoomId)); }
+
+    const mygraph_t& graph() const { return mGraph; }
+    // Indexed by vertex, the entries for freed vertices have a zero id and a
+    // null pointer:
+    const std::vector<location>& locations() const { return mLocations; }
+    int roomCount() const { return mRoomIdToVertex.size(); }
+    int edgeCount() const { return mRoutes.size(); }
+    int freeVertexCount() const { return static_cast<int>(mFreeVertices.size()); }
+
+    // Runs a single Dijkstra sweep out from the room, stopping once the
+    // shortest distance to every one of the targets - or, if there are none,
+    // to every room that can be reached - is known. Unlike the A* search in
+    // TMap::findPath(...) this answers many queries at once and reuses the
+    // same storage each time. The results can be read with the following
+    // methods until the graph is next changed or searched again:
+    void searchFrom(const int roomId, const QList<int>& targets = {});
+    // Negative if the room was not reached by the last search:
+    cost distanceTo(const int roomId) const;
+    // The rooms, in order, along the best path from the room the last search
+    // started from to the given one, not including the starting room. Empty
+    // if there is no such path:
+    QList<int> pathTo(const int roomId) const;
+    // Every room reached by the last search and the distance to it:
+    QHash<int, cost> reachedRooms() const;
+
+    // Area level (hierarchical) routing: the rooms with an edge to or from a
+    // room in another area are the "portals" of their area and for each area
+    // the shortest distances, staying inside the area, between its portals are
+    // worked out (and kept until something in the area changes). A route is
+    // then found by searching the much smaller graph of portals, plus the
+    // start and end rooms, and then filling in the steps inside each area.
+    // As every part of a path that stays inside one area runs between the
+    // start, the end or a portal this gives an equally short route as a
+    // search over every room would. Fills in the rooms along the route (not
+    // including the starting one) and its total cost and returns true if
+    // there is one. Clobbers the results of the last searchFrom(...):
+    bool findAreaRoute(const int fromRoomId, const int toRoomId, QList<int>& path, cost& total);
+    int portalCount() const;
+
+private:
+    struct AreaPortals
+    {
+        QList<vertex> mPortals;
+        // The shortest distance, only going through rooms in the area, from
+        // each portal (first key) to each of the others it can reach:
+        QHash<vertex, QHash<vertex, cost>> mDistances;
+    };
+
+    void clearRoutesFrom(const int roomId, const vertex source);
+    void markAreaDirty(const int areaId) { mDirtyAreas.insert(areaId); }
+    void updateAreaPortals();
+    void startSearch();
+    void sweep(const vertex source, const int areaId, const bool reverse, QSet<vertex>* pTargets);
+    bool isSettled(const vertex v) const { return mSearchSettled[v] == mSearchStamp; }
+    void appendSweepPath(const vertex source, const vertex target, QList<int>& path) const;
+    // True if the last search found the shortest distance to the vertex:
+    bool wasReached(const vertex v) const { return mSearchSource >= 0 && v < mSearchSettled.size() && mSearchSettled[v] == mSearchStamp; }
+
+    mygraph_t mGraph;
+    std::vector<location> mLocations;
+    // Indexed by vertex, the area each room is in:
+    std::vector<int> mVertexAreas;
+    // Key is the area id, values are the vertices of the rooms in it:
+    QHash<int, QSet<vertex>> mAreaVertices;
+    QHash<int, AreaPortals> mAreaPortals;
+    // The areas whose portals need working out again:
+    QSet<int> mDirtyAreas;
+    QHash<int, vertex> mRoomIdToVertex;
+    // For Mudlet to decode BGL edges, the key is made from the
+    // QPair<edgeSourceRoomId, edgeTargetRoomId>:
+    QHash<QPair<int, int>, route> mRoutes;
+    // Key is a room id, the values are the ids of the rooms with an edge to
+    // it; needed to find the edges to remove along with a vertex because a
+    // directedS graph only knows about the edges out of each vertex:
+    QHash<int, QSet<int>> mEntrances;
+    std::vector<vertex> mFreeVertices;
+
+    // The workspace for searchFrom(...) - an entry in the distance and
+    // predecessor vectors is only valid if the vertex's entry in
+    // mSearchVisited matches the current search's stamp, and it is only final
+    // if its entry in mSearchSettled does as well, so none of them ever need
+    // clearing between searches. The source is reset to -1 whenever the graph
+    // is changed as that makes the results meaningless:
+    int mSearchSource = -1;
+    quint32 mSearchStamp = 0;
+    std::vector<quint32> mSearchVisited;
+    std::vector<quint32> mSearchSettled;
+    std::vector<cost> mSearchDistances;
+    std::vector<vertex> mSearchPredecessors;
+    // Used as a binary min-heap of (distance, vertex):
+    std::vector<std::pair<cost, vertex>> mSearchQueue;
+};
+
+#endif // MUDLET_TMAPGRAPH_H
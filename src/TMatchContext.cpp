@@ -0,0 +1,97 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "TMatchContext.h"
+
+void TMatchContext::setText(const QString& text)
+{
+    mpText = &text;
+    mPositionsMapped = false;
+
+    // Each UTF-16 code unit needs at most three bytes (a surrogate pair needs
+    // four for the two of them) - and there is the terminating NUL:
+    const auto size = static_cast<size_t>(text.size());
+    if (mUtf8.size() < 3 * size + 1) {
+        mUtf8.resize(3 * size + 1);
+    }
+
+    const ushort* pUnits = text.utf16();
+    char* pOut = mUtf8.data();
+    for (size_t i = 0; i < size; ++i) {
+        uint codePoint = pUnits[i];
+        if (codePoint < 0x80) {
+            *pOut++ = static_cast<char>(codePoint);
+            continue;
+        }
+        if (QChar::isSurrogate(codePoint)) {
+            if (QChar::isHighSurrogate(codePoint) && i + 1 < size && QChar::isLowSurrogate(pUnits[i + 1])) {
+                codePoint = QChar::surrogateToUcs4(static_cast<ushort>(codePoint), pUnits[++i]);
+            } else {
+                // A lone surrogate cannot be encoded, so use the replacement
+                // character in its place:
+                codePoint = QChar::ReplacementCharacter;
+            }
+        }
+        if (codePoint < 0x800) {
+            *pOut++ = static_cast<char>(0xC0 | (codePoint >> 6));
+        } else if (codePoint < 0x10000) {
+            *pOut++ = static_cast<char>(0xE0 | (codePoint >> 12));
+            *pOut++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        } else {
+            *pOut++ = static_cast<char>(0xF0 | (codePoint >> 18));
+            *pOut++ = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            *pOut++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        }
+        *pOut++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    *pOut = '\0';
+    mUtf8Length = static_cast<int>(pOut - mUtf8.data());
+}
+
+void TMatchContext::mapPositions() const
+{
+    if (mUtf16Positions.size() < static_cast<size_t>(mUtf8Length) + 1) {
+        mUtf16Positions.resize(static_cast<size_t>(mUtf8Length) + 1);
+    }
+
+    int position = 0;
+    for (int offset = 0; offset < mUtf8Length;) {
+        const auto lead = static_cast<unsigned char>(mUtf8[offset]);
+        const int bytes = lead < 0x80 ? 1 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+        for (int i = 0; i < bytes; ++i) {
+            mUtf16Positions[offset++] = position;
+        }
+        // Those needing four bytes are outside the BMP and so take a
+        // surrogate pair:
+        position += bytes == 4 ? 2 : 1;
+    }
+    mUtf16Positions[mUtf8Length] = position;
+    mPositionsMapped = true;
+}
+
+int TMatchContext::utf16Position(const int utf8Offset) const
+{
+    if (utf8Offset < 0 || utf8Offset > mUtf8Length) {
+        return -1;
+    }
+    if (!mPositionsMapped) {
+        mapPositions();
+    }
+    return mUtf16Positions[utf8Offset];
+}
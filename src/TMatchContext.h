@@ -0,0 +1,65 @@
+#ifndef MUDLET_TMATCHCONTEXT_H
+#define MUDLET_TMATCHCONTEXT_H
+
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include "pre_guard.h"
+#include <QString>
+#include "post_guard.h"
+
+#include <vector>
+
+// The form of one line of game text that all the triggers evaluated for it
+// share: the UTF-8 bytes that PCRE and the prefilter work on and, built only
+// once something has matched, the map from those bytes back to positions in
+// the original UTF-16 text. The buffers are kept between lines so, once they
+// have grown to fit the longest line seen, setting a new line does not touch
+// the heap at all. It does not take a copy of the text, which must outlive it
+// or be replaced with another setText(...) first.
+class TMatchContext
+{
+public:
+    TMatchContext() = default;
+    explicit TMatchContext(const QString& text) { setText(text); }
+    Q_DISABLE_COPY(TMatchContext)
+
+    void setText(const QString&);
+    const QString& text() const { return *mpText; }
+    // NUL terminated:
+    const char* utf8() const { return mUtf8.data(); }
+    int utf8Length() const { return mUtf8Length; }
+    // The position in text() of the character that the byte at the given
+    // offset in utf8() is part of, an offset of utf8Length() gives the length
+    // of text():
+    int utf16Position(const int utf8Offset) const;
+
+private:
+    void mapPositions() const;
+
+    inline static const QString csmEmpty;
+    const QString* mpText = &csmEmpty;
+    std::vector<char> mUtf8 = std::vector<char>(1, '\0');
+    int mUtf8Length = 0;
+    mutable std::vector<int> mUtf16Positions;
+    mutable bool mPositionsMapped = false;
+};
+
+#endif // MUDLET_TMATCHCONTEXT_H
@@ -0,0 +1,143 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "TProfiler.h"
+
+#include "utils.h"
+
+#include "pre_guard.h"
+#include <QStringList>
+#include "post_guard.h"
+
+#include <algorithm>
+
+void TProfiler::setEnabled(const bool enabled)
+{
+    if (enabled == mEnabled) {
+        return;
+    }
+    if (enabled && !mTimer.isValid()) {
+        mTimer.start();
+    }
+    // Any items already running when it is enabled are not timed and those
+    // still running when it is disabled are finished off as usual:
+    mMark = mTimer.nsecsElapsed();
+    mEnabled = enabled;
+}
+
+void TProfiler::reset()
+{
+    mEntries.clear();
+    mHandlerIds.clear();
+}
+
+int TProfiler::handlerId(const QString& name)
+{
+    auto it = mHandlerIds.constFind(name);
+    if (it == mHandlerIds.cend()) {
+        it = mHandlerIds.insert(name, mHandlerIds.size() + 1);
+    }
+    return it.value();
+}
+
+void TProfiler::chargeCurrent()
+{
+    const qint64 now = mTimer.nsecsElapsed();
+    if (mpCurrent) {
+        mpCurrent->mNanoseconds += now - mMark;
+    }
+    mMark = now;
+}
+
+void TProfiler::enter(Scope* pScope)
+{
+    chargeCurrent();
+    pScope->mpOuter = mpCurrent;
+    mpCurrent = pScope;
+}
+
+void TProfiler::leave(Scope* pScope)
+{
+    chargeCurrent();
+    mpCurrent = pScope->mpOuter;
+
+    auto& entry = mEntries[qMakePair(static_cast<int>(pScope->mKind), pScope->mId)];
+    if (!entry.mCalls) {
+        entry.mKind = pScope->mKind;
+        entry.mId = pScope->mId;
+    }
+    // Items can be renamed while they are being profiled:
+    entry.mName = pScope->mName;
+    ++entry.mCalls;
+    entry.mTotalNanoseconds += pScope->mNanoseconds;
+    entry.mMaxNanoseconds = std::max(entry.mMaxNanoseconds, pScope->mNanoseconds);
+}
+
+QList<TProfiler::Entry> TProfiler::entries() const
+{
+    QList<Entry> result = mEntries.values();
+    std::sort(result.begin(), result.end(), [](const Entry& a, const Entry& b) {
+        return a.mTotalNanoseconds > b.mTotalNanoseconds;
+    });
+    return result;
+}
+
+QString TProfiler::kindName(const Kind kind)
+{
+    switch (kind) {
+    case TriggerMatch:
+        return qsl("trigger match");
+    case TriggerScript:
+        return qsl("trigger script");
+    case AliasMatch:
+        return qsl("alias match");
+    case AliasScript:
+        return qsl("alias script");
+    case TimerScript:
+        return qsl("timer script");
+    case EventHandler:
+        return qsl("event handler");
+    }
+    return QString();
+}
+
+QString TProfiler::report(const int count) const
+{
+    const QList<Entry> sorted = entries();
+    if (sorted.isEmpty()) {
+        return mEnabled ? qsl("nothing has run since the profiler was started\n") : qsl("the profiler is not running, start it with startProfiling()\n");
+    }
+
+    QStringList lines;
+    lines << qsl("%1 %2 %3  %4").arg(qsl("total ms"), 12).arg(qsl("calls"), 9).arg(qsl("max ms"), 10).arg(qsl("item"));
+    for (int i = 0, total = std::min(count, static_cast<int>(sorted.size())); i < total; ++i) {
+        const Entry& entry = sorted.at(i);
+        const QString item = entry.mKind == EventHandler ? qsl("%1: %2").arg(kindName(entry.mKind), entry.mName)
+                                                         : qsl("%1: %2 (id: %3)").arg(kindName(entry.mKind), entry.mName, QString::number(entry.mId));
+        lines << qsl("%1 %2 %3  %4")
+                         .arg(entry.mTotalNanoseconds * 1.0e-6, 12, 'f', 3)
+                         .arg(entry.mCalls, 9)
+                         .arg(entry.mMaxNanoseconds * 1.0e-6, 10, 'f', 3)
+                         .arg(item);
+    }
+    if (sorted.size() > count) {
+        lines << qsl("... and %1 more, see getProfilingData()").arg(sorted.size() - count);
+    }
+    return lines.join(QChar::LineFeed) + QChar::LineFeed;
+}
@@ -0,0 +1,134 @@
+#ifndef MUDLET_TPROFILER_H
+#define MUDLET_TPROFILER_H
+
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include "pre_guard.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include "post_guard.h"
+
+// Records, per trigger, alias, timer and event handler, how many times it
+// ran, for how long in total and the longest single run - so that the few
+// items that make a profile lag can be found. Like TInboundStats the time is
+// always given to the innermost item running, so a trigger's pattern matching
+// does not include the time spent running its script or its children and the
+// totals for all the items add up to no more than the time spent in them.
+// When it is not enabled all it costs is the check of a bool at the start of
+// each item.
+class TProfiler
+{
+public:
+    enum Kind {
+        TriggerMatch = 0,
+        TriggerScript,
+        AliasMatch,
+        AliasScript,
+        TimerScript,
+        EventHandler
+    };
+
+    struct Entry
+    {
+        Kind mKind = TriggerMatch;
+        // The item's id, for event handlers it is only unique within the
+        // profiler:
+        int mId = 0;
+        QString mName;
+        quint64 mCalls = 0;
+        qint64 mTotalNanoseconds = 0;
+        qint64 mMaxNanoseconds = 0;
+    };
+
+    // Times the item until it goes out of scope:
+    class Scope
+    {
+    public:
+        Q_DISABLE_COPY(Scope)
+        Scope(TProfiler& profiler, const Kind kind, const int id, const QString& name)
+        : mpProfiler(profiler.isEnabled() ? &profiler : nullptr)
+        {
+            if (mpProfiler) {
+                mKind = kind;
+                mId = id;
+                mName = name;
+                mpProfiler->enter(this);
+            }
+        }
+        // For event handlers, which are only known by name:
+        Scope(TProfiler& profiler, const QString& handlerName)
+        : mpProfiler(profiler.isEnabled() ? &profiler : nullptr)
+        {
+            if (mpProfiler) {
+                mKind = EventHandler;
+                mId = mpProfiler->handlerId(handlerName);
+                mName = handlerName;
+                mpProfiler->enter(this);
+            }
+        }
+        ~Scope()
+        {
+            if (mpProfiler) {
+                mpProfiler->leave(this);
+            }
+        }
+
+    private:
+        friend class TProfiler;
+
+        TProfiler* mpProfiler;
+        Kind mKind = TriggerMatch;
+        int mId = 0;
+        QString mName;
+        Scope* mpOuter = nullptr;
+        // The time given to this run of the item so far:
+        qint64 mNanoseconds = 0;
+    };
+
+    // Starting it again does not clear the figures, reset() does that:
+    void setEnabled(const bool);
+    bool isEnabled() const { return mEnabled; }
+    void reset();
+    // Sorted by total time, the longest first:
+    QList<Entry> entries() const;
+    // The given number of items that took the longest, for the statistics:
+    QString report(const int count) const;
+    static QString kindName(const Kind);
+
+private:
+    void enter(Scope*);
+    void leave(Scope*);
+    void chargeCurrent();
+    int handlerId(const QString&);
+
+    bool mEnabled = false;
+    QElapsedTimer mTimer;
+    // When the time was last given to an item:
+    qint64 mMark = 0;
+    Scope* mpCurrent = nullptr;
+    QHash<QPair<int, int>, Entry> mEntries;
+    QHash<QString, int> mHandlerIds;
+};
+
+#endif // MUDLET_TPROFILER_H
@@ -0,0 +1,365 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include "TRegex.h"
+
+#include "pre_guard.h"
+#include <QRegularExpression>
+#include <QSet>
+#include <QtConcurrent>
+#include "post_guard.h"
+
+#include <algorithm>
+#include <cctype>
+#include <memory>
+
+// Sizes for the shared JIT stack, PCRE's own default (32K on the machine
+// stack) is too small for some of the more elaborate patterns seen in
+// the wild:
+static const int scmJitStackStartSize = 32 * 1024;
+static const int scmJitStackMaxSize = 1024 * 1024;
+
+TRegex::~TRegex()
+{
+    if (mpExtra) {
+        pcre_free_study(mpExtra);
+    }
+    if (mpCode) {
+        pcre_free(mpCode);
+    }
+}
+
+bool TRegex::jitAvailable()
+{
+    static const bool available = [] {
+        int result = 0;
+        pcre_config(PCRE_CONFIG_JIT, &result);
+        return result == 1;
+    }();
+    return available;
+}
+
+pcre_jit_stack* TRegex::sharedJitStack()
+{
+    static const std::unique_ptr<pcre_jit_stack, void (*)(pcre_jit_stack*)> stack(pcre_jit_stack_alloc(scmJitStackStartSize, scmJitStackMaxSize), pcre_jit_stack_free);
+    return stack.get();
+}
+
+QSharedPointer<TRegex> TRegex::compile(const QByteArray& pattern, const bool useJit, QString& error, int& errorOffset)
+{
+    const char* compileError = nullptr;
+    // PCRE_UTF8 needed to run compile in UTF-8 mode
+    // PCRE_UCP needed for \d, \w etc. to use Unicode properties:
+    pcre* code = pcre_compile(pattern.constData(), PCRE_UTF8 | PCRE_UCP, &compileError, &errorOffset, nullptr);
+    if (!code) {
+        error = QString::fromUtf8(compileError);
+        return {};
+    }
+
+    // The constructor is private so we cannot use QSharedPointer::create():
+    QSharedPointer<TRegex> result(new TRegex());
+    result->mpCode = code;
+
+    const char* studyError = nullptr;
+    const int studyOptions = (useJit && jitAvailable()) ? PCRE_STUDY_JIT_COMPILE : 0;
+    // This can return a nullptr without there being an error if there was
+    // nothing useful to be learnt from studying the pattern - that is fine as
+    // pcre_exec(...) accepts a nullptr for the extra block:
+    result->mpExtra = pcre_study(code, studyOptions, &studyError);
+    if (result->mpExtra && studyOptions) {
+        int jitCompiled = 0;
+        pcre_fullinfo(code, result->mpExtra, PCRE_INFO_JIT, &jitCompiled);
+        result->mIsJitCompiled = (jitCompiled == 1);
+        if (result->mIsJitCompiled) {
+            pcre_assign_jit_stack(result->mpExtra, nullptr, sharedJitStack());
+        }
+    }
+
+    return result;
+}
+
+namespace {
+// A functor rather than a lambda so that QtConcurrent can work out the result
+// type with the older Qt versions as well:
+struct RegexCompiler
+{
+    using result_type = QSharedPointer<TRegex>;
+
+    bool mUseJit;
+
+    QSharedPointer<TRegex> operator()(const QByteArray& pattern) const
+    {
+        QString error;
+        int errorOffset = 0;
+        return TRegex::compile(pattern, mUseJit, error, errorOffset);
+    }
+};
+} // namespace
+
+QHash<QByteArray, QSharedPointer<TRegex>> TRegex::compileAll(const QList<QByteArray>& patterns, const bool useJit)
+{
+    QList<QByteArray> uniquePatterns;
+    QSet<QByteArray> seen;
+    for (const auto& pattern : patterns) {
+        if (!seen.contains(pattern)) {
+            seen.insert(pattern);
+            uniquePatterns.append(pattern);
+        }
+    }
+
+    const QList<QSharedPointer<TRegex>> compiled = QtConcurrent::blockingMapped<QList<QSharedPointer<TRegex>>>(uniquePatterns, RegexCompiler{useJit});
+    QHash<QByteArray, QSharedPointer<TRegex>> result;
+    result.reserve(uniquePatterns.size());
+    for (int i = 0, total = uniquePatterns.size(); i < total; ++i) {
+        if (compiled.at(i)) {
+            result.insert(uniquePatterns.at(i), compiled.at(i));
+        }
+    }
+    return result;
+}
+
+int TRegex::captureCount() const
+{
+    int count = 0;
+    pcre_fullinfo(mpCode, mpExtra, PCRE_INFO_CAPTURECOUNT, &count);
+    return count;
+}
+
+// Returns the index just past the end of the character class that starts at
+// the '[' at index start, or -1 if it is not terminated:
+static int skipCharacterClass(const QString& pattern, int start)
+{
+    const int length = pattern.size();
+    int i = start + 1;
+    if (i < length && pattern.at(i) == QLatin1Char('^')) {
+        ++i;
+    }
+    // A ']' immediately after the opening (or the negation) is a literal:
+    if (i < length && pattern.at(i) == QLatin1Char(']')) {
+        ++i;
+    }
+    while (i < length) {
+        const QChar c = pattern.at(i);
+        if (c == QLatin1Char('\\')) {
+            i += 2;
+        } else if (c == QLatin1Char('[') && i + 1 < length && pattern.at(i + 1) == QLatin1Char(':')) {
+            // A POSIX class like [:alpha:]
+            const int end = pattern.indexOf(QLatin1String(":]"), i + 2);
+            if (end < 0) {
+                return -1;
+            }
+            i = end + 2;
+        } else if (c == QLatin1Char(']')) {
+            return i + 1;
+        } else {
+            ++i;
+        }
+    }
+    return -1;
+}
+
+// Returns the index just past the ')' that closes the group that starts at
+// the '(' at index start, or -1 if it is not closed:
+static int skipGroup(const QString& pattern, int start)
+{
+    const int length = pattern.size();
+    int depth = 0;
+    int i = start;
+    while (i < length) {
+        const QChar c = pattern.at(i);
+        if (c == QLatin1Char('\\')) {
+            i += 2;
+        } else if (c == QLatin1Char('[')) {
+            i = skipCharacterClass(pattern, i);
+            if (i < 0) {
+                return -1;
+            }
+        } else if (c == QLatin1Char('(')) {
+            ++depth;
+            ++i;
+        } else if (c == QLatin1Char(')')) {
+            ++i;
+            if (!--depth) {
+                return i;
+            }
+        } else {
+            ++i;
+        }
+    }
+    return -1;
+}
+
+// Returns the index just past the whole of the escape sequence (a character
+// type, assertion, back-reference or character given by a code) whose letter
+// or digit is at index start (i.e. one past the backslash):
+static int skipEscapeSequence(const QString& pattern, int start)
+{
+    const int length = pattern.size();
+    const QChar kind = pattern.at(start);
+    int i = start + 1;
+    if (i < length && (pattern.at(i) == QLatin1Char('{') || pattern.at(i) == QLatin1Char('<') || pattern.at(i) == QLatin1Char('\''))) {
+        // Things like \p{L}, \x{263a}, \g{-1}, \k<name> or \g'name':
+        const QChar close = (pattern.at(i) == QLatin1Char('{')) ? QLatin1Char('}') : (pattern.at(i) == QLatin1Char('<')) ? QLatin1Char('>') : QLatin1Char('\'');
+        const int end = pattern.indexOf(close, i + 1);
+        return (end < 0) ? length : end + 1;
+    }
+    if (kind == QLatin1Char('x')) {
+        // Up to two hex digits:
+        for (int count = 0; count < 2 && i < length && isxdigit(pattern.at(i).toLatin1()); ++count) {
+            ++i;
+        }
+    } else if (kind == QLatin1Char('c')) {
+        // A control character, e.g. \cA:
+        ++i;
+    } else if (kind.isDigit()) {
+        // A back-reference or an octal character code:
+        while (i < length && pattern.at(i).isDigit()) {
+            ++i;
+        }
+    } else if (kind == QLatin1Char('p') || kind == QLatin1Char('P')) {
+        // A single letter property, e.g. \pL:
+        ++i;
+    }
+    return std::min(i, length);
+}
+
+QString TRegex::requiredLiteral(const QString& pattern)
+{
+    QString best;
+    QString current;
+    auto endRun = [&]() {
+        if (current.size() > best.size()) {
+            best = current;
+        }
+        current.clear();
+    };
+    // The last character added is optional after all (it was followed by a
+    // quantifier that allows zero repetitions) so take it back off:
+    auto dropLast = [&]() {
+        if (current.isEmpty()) {
+            return;
+        }
+        current.chop((current.size() > 1 && current.back().isLowSurrogate() && current.at(current.size() - 2).isHighSurrogate()) ? 2 : 1);
+    };
+
+    const int length = pattern.size();
+    int i = 0;
+    while (i < length) {
+        const QChar c = pattern.at(i);
+        switch (c.unicode()) {
+        case '\\': {
+            if (i + 1 >= length) {
+                return {};
+            }
+            const QChar next = pattern.at(i + 1);
+            if (next == QLatin1Char('Q')) {
+                // Quoted literal text up to a \E - just skip over it:
+                endRun();
+                const int end = pattern.indexOf(QLatin1String("\\E"), i + 2);
+                if (end < 0) {
+                    return best;
+                }
+                i = end + 2;
+            } else if (next.isLetterOrNumber()) {
+                endRun();
+                i = skipEscapeSequence(pattern, i + 1);
+            } else {
+                // Escaped punctuation stands for itself:
+                current.append(next);
+                i += 2;
+            }
+            break;
+        }
+        case '[':
+            endRun();
+            i = skipCharacterClass(pattern, i);
+            if (i < 0) {
+                return {};
+            }
+            break;
+        case '(': {
+            endRun();
+            if (i + 1 < length && pattern.at(i + 1) == QLatin1Char('?')) {
+                // An option setting at this level, like (?i) or (?x-s), affects
+                // everything that follows it:
+                int j = i + 2;
+                bool affectsLiterals = false;
+                while (j < length && QLatin1String("imsxXUJ-").contains(pattern.at(j))) {
+                    if (pattern.at(j) == QLatin1Char('i') || pattern.at(j) == QLatin1Char('x')) {
+                        affectsLiterals = true;
+                    }
+                    ++j;
+                }
+                if (j < length && pattern.at(j) == QLatin1Char(')') && affectsLiterals) {
+                    return {};
+                }
+            }
+            i = skipGroup(pattern, i);
+            if (i < 0) {
+                return {};
+            }
+            break;
+        }
+        case ')':
+        case '|':
+            // Unbalanced or a top level alternation - so nothing is certain:
+            return {};
+        case '.':
+        case '^':
+        case '$':
+            endRun();
+            ++i;
+            break;
+        case '?':
+        case '*':
+            dropLast();
+            endRun();
+            ++i;
+            break;
+        case '+':
+            endRun();
+            ++i;
+            break;
+        case '{': {
+            // Only a quantifier if it looks like {n}, {n,} or {n,m} otherwise
+            // it is a literal:
+            const int end = pattern.indexOf(QLatin1Char('}'), i + 1);
+            static const QRegularExpression quantifier(QStringLiteral(R"(^\{(\d+)(,\d*)?\}$)"));
+            const auto match = (end < 0) ? QRegularExpressionMatch() : quantifier.match(pattern.mid(i, end - i + 1));
+            if (match.hasMatch()) {
+                if (!match.captured(1).toInt()) {
+                    dropLast();
+                }
+                endRun();
+                i = end + 1;
+            } else {
+                current.append(c);
+                ++i;
+            }
+            break;
+        }
+        default:
+            current.append(c);
+            ++i;
+        }
+    }
+    endRun();
+    return best;
+}
@@ -0,0 +1,82 @@
+#ifndef MUDLET_TREGEX_H
+#define MUDLET_TREGEX_H
+
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include "pre_guard.h"
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+#include "post_guard.h"
+
+#include <pcre.h>
+
+// A compiled PCRE pattern together with the pcre_extra block produced by
+// pcre_study(...) for it. When the PCRE library was built with JIT support
+// (and it has not been turned off for the profile) the extra block carries the
+// JIT compiled machine code for the pattern and every match then runs that
+// instead of the interpreter. All the JIT compiled patterns share one JIT
+// stack - matching only ever happens on the main thread so that is safe.
+class TRegex
+{
+public:
+    ~TRegex();
+
+    // Returns a null pointer (and fills in error/errorOffset) if the pattern
+    // does not compile; a failure to study or JIT compile the pattern is NOT
+    // an error - the pattern is then just run by the PCRE interpreter:
+    static QSharedPointer<TRegex> compile(const QByteArray& pattern, const bool useJit, QString& error, int& errorOffset);
+    // Compiles many patterns at once, spread over the global thread pool, for
+    // when a whole profile or package is being loaded. Duplicates are only
+    // compiled once and the patterns that do not compile are left out - so
+    // that compile(...) can be used to get the error for them:
+    static QHash<QByteArray, QSharedPointer<TRegex>> compileAll(const QList<QByteArray>& patterns, const bool useJit);
+
+    pcre* code() const { return mpCode; }
+    pcre_extra* extra() const { return mpExtra; }
+    bool isJitCompiled() const { return mIsJitCompiled; }
+    // Direct replacement for pcre_exec(...) that supplies the extra block:
+    int exec(const char* subject, const int length, const int startOffset, const int options, int* ovector, const int ovecsize) const
+    {
+        return pcre_exec(mpCode, mpExtra, subject, length, startOffset, options, ovector, ovecsize);
+    }
+    int captureCount() const;
+
+    // Whether the PCRE library we are linked to can do JIT compilation at all:
+    static bool jitAvailable();
+    // The longest run of plain characters that every subject must contain for
+    // the (Perl) pattern to match, or an empty string if nothing can be said
+    // for certain - e.g. the pattern has a top level alternation or is
+    // (partly) caseless. Used to pre-filter which triggers need evaluating:
+    static QString requiredLiteral(const QString& pattern);
+
+private:
+    TRegex() = default;
+    static pcre_jit_stack* sharedJitStack();
+
+    pcre* mpCode = nullptr;
+    pcre_extra* mpExtra = nullptr;
+    bool mIsJitCompiled = false;
+};
+
+#endif // MUDLET_TREGEX_H
@@ -238,6 +238,7 @@ void TRoom::setWeight(int w)
         w = 1;
     }
     weight = w;
+    mpRoomDB->mpMap->markRoomChanged(id);
     mpRoomDB->mpMap->setUnsaved(__func__);
 }
 
@@ -246,11 +247,11 @@ void TRoom::setExitWeight(const QString& cmd, int w)
     if (w > 0) {
         exitWeights[cmd] = w;
         mpRoomDB->mpMap->setUnsaved(__func__);
-        mpRoomDB->mpMap->mMapGraphNeedsUpdate = true;
+        mpRoomDB->mpMap->markRoomExitsChanged(id);
     } else if (exitWeights.contains(cmd)) {
         exitWeights.remove(cmd);
         mpRoomDB->mpMap->setUnsaved(__func__);
-        mpRoomDB->mpMap->mMapGraphNeedsUpdate = true;
+        mpRoomDB->mpMap->markRoomExitsChanged(id);
     }
 }
 
@@ -374,6 +375,7 @@ bool TRoom::setExit(const int to, const int direction)
         return false;
     }
     mpRoomDB->updateEntranceMap(this);
+    mpRoomDB->mpMap->markRoomExitsChanged(id);
     mpRoomDB->mpMap->setUnsaved(__func__);
     return true;
 }
@@ -523,6 +525,7 @@ void TRoom::setExitLock(int exit, bool state)
     } else {
         exitLocks.removeAll(exit);
     }
+    mpRoomDB->mpMap->markRoomExitsChanged(id);
     mpRoomDB->mpMap->setUnsaved(__func__);
 }
 
@@ -538,6 +541,7 @@ bool TRoom::setSpecialExitLock(const QString& cmd, const bool doLock)
         mSpecialExitLocks.remove(cmd);
     }
 
+    mpRoomDB->mpMap->markRoomExitsChanged(id);
     mpRoomDB->mpMap->setUnsaved(__func__);
     return true;
 }
@@ -583,7 +587,7 @@ void TRoom::setSpecialExit(const int to, const QString& cmd)
         // This updates the (TArea *)->exits map even for exit REMOVALS
     }
     mpRoomDB->updateEntranceMap(this);
-    mpRoomDB->mpMap->mMapGraphNeedsUpdate = true;
+    mpRoomDB->mpMap->markRoomExitsChanged(id);
     mpRoomDB->mpMap->setUnsaved(__func__);
 }
 
@@ -607,7 +611,7 @@ void TRoom::clearSpecialExits()
         itSpecialExit.remove();
     }
     mpRoomDB->updateEntranceMap(this);
-    mpRoomDB->mpMap->mMapGraphNeedsUpdate = true;
+    mpRoomDB->mpMap->markRoomExitsChanged(id);
     mpRoomDB->mpMap->setUnsaved(__func__);
 }
 
@@ -639,7 +643,7 @@ void TRoom::removeAllSpecialExitsToRoom(const int roomId)
             pA->determineAreaExitsOfRoom(id);
         }
         mpRoomDB->updateEntranceMap(this);
-        mpRoomDB->mpMap->mMapGraphNeedsUpdate = true;
+        mpRoomDB->mpMap->markRoomExitsChanged(id);
         mpRoomDB->mpMap->setUnsaved(__func__);
     }
 }
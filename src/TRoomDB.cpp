@@ -271,10 +271,12 @@ bool TRoomDB::__removeRoom(int id)
             entranceMap.remove(id);                                           // Only removes matching keys
             deleteValuesFromEntranceMap(id);                                  // Needed to remove matching values
         }
-        // Because we clear the graph in initGraph which will be called
-        // if mMapGraphNeedsUpdate is true -- we don't need to
-        // remove the vertex using clear_vertex and remove_vertex here
-        mpMap->mMapGraphNeedsUpdate = true;
+        // The vertex for this room, and the edges into it from the rooms
+        // whose exits were just cleared above, get removed from the routing
+        // graph the next time it is used:
+        if (!mIsDiscarded) {
+            mpMap->markRoomChanged(id);
+        }
         return true;
     }
     return false;
@@ -283,7 +285,7 @@ bool TRoomDB::__removeRoom(int id)
 bool TRoomDB::removeRoom(int id)
 {
     if (rooms.contains(id) && id > 0) {
-        if (mpMap->mRoomIdHash.value(mpMap->mProfileName) == id) {
+        if (!mIsDiscarded && mpMap->mRoomIdHash.value(mpMap->mProfileName) == id) {
             // Now we store mRoomId for each profile, we must remove any where
             // this room was used
             QList<QString> const profilesWithUserInThisRoom = mpMap->mRoomIdHash.keys(id);
@@ -291,7 +293,7 @@ bool TRoomDB::removeRoom(int id)
                 mpMap->mRoomIdHash[key] = 0;
             }
         }
-        if (mpMap->mTargetID == id) {
+        if (!mIsDiscarded && mpMap->mTargetID == id) {
             mpMap->mTargetID = 0;
         }
         TRoom* pR = getRoom(id);
@@ -348,7 +350,9 @@ bool TRoomDB::removeArea(int id)
         // deletion
         areas.remove(id);
 
-        mpMap->mMapGraphNeedsUpdate = true;
+        if (!mIsDiscarded) {
+            mpMap->mMapGraphNeedsUpdate = true;
+        }
         return true;
     } else if (areaNamesMap.contains(id)) {
         // Handle corner case where the area name was created but not used
@@ -1106,11 +1110,23 @@ void TRoomDB::clearMapDB()
         delete area;
     }
     assert(areas.empty());
-    // Must now reinsert areaId -1 name = "Default Area"
-    addArea(-1, mpMap->getDefaultAreaName());
+    if (!mIsDiscarded) {
+        // Must now reinsert areaId -1 name = "Default Area"
+        addArea(-1, mpMap->getDefaultAreaName());
+    }
     qDebug() << "TRoomDB::clearMapDB() run time:" << timer.nsecsElapsed() * 1.0e-9 << "sec.";
 }
 
+// Empties one that was never put in place as the map - e.g. the one a map file
+// was being read into when that failed - so it can be deleted without the
+// player room, the target room or the routing graph of the map that is in use
+// being touched:
+void TRoomDB::discard()
+{
+    mIsDiscarded = true;
+    clearMapDB();
+}
+
 void TRoomDB::restoreAreaMap(QDataStream& ifs)
 {
     QMap<int, QString> areaNamesMapWithPossibleEmptyOrDuplicateItems;
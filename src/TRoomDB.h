@@ -81,6 +81,7 @@ public:
 
     void buildAreas();
     void clearMapDB();
+    void discard();
     void auditRooms(QHash<int, int>&, QHash<int, int>&);
     bool addRoom(int id, TRoom* pR, bool isMapLoading = false);
     int getAreaID(TArea* pA);
@@ -113,6 +114,9 @@ private:
     QMap<int, QString> areaNamesMap;
     TMap* mpMap;
     QSet<int>* mpTempRoomDeletionSet; // Used during bulk room deletion
+    // Set by discard(), after which nothing in mpMap is touched as this is
+    // not (and never was) the TRoomDB that it uses:
+    bool mIsDiscarded = false;
 
     friend class TRoom;
     friend class XMLexport;
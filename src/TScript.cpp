@@ -70,6 +70,7 @@ bool TScript::registerScript()
 
 void TScript::setEventHandlerList(QStringList handlerList)
 {
+    setUnsaved();
     for (int i = 0; i < mEventHandlerList.size(); i++) {
         mpHost->unregisterEventHandler(mEventHandlerList[i], this);
     }
@@ -120,6 +121,7 @@ void TScript::compile(bool saveLoadingError)
 
 bool TScript::setScript(const QString& script)
 {
+    setUnsaved();
     mScript = script;
     mNeedsToBeCompiled = true;
     if (!mpHost->blockScripts()) {
@@ -46,7 +46,7 @@ public:
     TScript(const QString& name, Host* pHost);
 
     QString getName() const { return mName; }
-    void setName(const QString& name) { mName = name; }
+    void setName(const QString& name) { mName = name; setUnsaved(); }
     void compile(bool saveLoadingError = false);
     void compileAll(bool saveLoadingError = false);
     bool compileScript(bool saveLoadingError = false);
@@ -0,0 +1,89 @@
+#ifndef MUDLET_TSPSCQUEUE_H
+#define MUDLET_TSPSCQUEUE_H
+
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include <atomic>
+#include <utility>
+
+// An unbounded queue, without locks, for handing items from exactly one
+// producer thread to exactly one consumer thread - push(...) must only ever
+// be called from the one and pop(...) from the other. It is a linked list
+// that starts with a dummy node: the producer only touches the last node and
+// the consumer only ever frees nodes that the producer has moved past, so the
+// only thing they share is each node's link to the next, which is atomic.
+// Items come out in the order they went in.
+template <typename T>
+class TSpscQueue
+{
+public:
+    TSpscQueue() : mpHead(new Node), mpTail(mpHead) {}
+    ~TSpscQueue()
+    {
+        while (mpHead) {
+            Node* pNext = mpHead->mpNext.load(std::memory_order_relaxed);
+            delete mpHead;
+            mpHead = pNext;
+        }
+    }
+    TSpscQueue(const TSpscQueue&) = delete;
+    TSpscQueue& operator=(const TSpscQueue&) = delete;
+
+    // Producer only:
+    void push(T value)
+    {
+        auto pNode = new Node;
+        pNode->mValue = std::move(value);
+        mpTail->mpNext.store(pNode, std::memory_order_release);
+        mpTail = pNode;
+    }
+
+    // Consumer only, returns false, leaving value alone, if it is empty:
+    bool pop(T& value)
+    {
+        Node* pNext = mpHead->mpNext.load(std::memory_order_acquire);
+        if (!pNext) {
+            return false;
+        }
+        value = std::move(pNext->mValue);
+        // The node that held it becomes the new dummy one:
+        delete mpHead;
+        mpHead = pNext;
+        return true;
+    }
+
+    // Consumer only:
+    bool isEmpty() const { return !mpHead->mpNext.load(std::memory_order_acquire); }
+
+private:
+    struct Node
+    {
+        T mValue{};
+        std::atomic<Node*> mpNext{nullptr};
+    };
+
+    // Only used by the consumer:
+    Node* mpHead;
+    // Only used by the producer:
+    Node* mpTail;
+};
+
+#endif // MUDLET_TSPSCQUEUE_H
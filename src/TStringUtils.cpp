@@ -18,6 +18,17 @@
  ***************************************************************************/
 #include "TStringUtils.h"
 
+#include "pre_guard.h"
+#include <QtAlgorithms>
+#include "post_guard.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MUDLET_USE_SSE2
+#endif
+
 
 bool TStringUtils::isQuote(QChar ch)
 {
@@ -35,4 +46,41 @@ bool TStringUtils::isOneOf(QChar inputCharacter, const QString& characterSet)
     return false;
 }
 
-
+size_t TStringUtils::plainTextRunLength(const char* data, const size_t length)
+{
+    size_t position = 0;
+#if defined(__AVX2__) || defined(MUDLET_USE_SSE2)
+    // The bytes are compared as signed values so those with the high bit set
+    // are negative and fail the first test along with the control characters:
+#if defined(__AVX2__)
+    const __m256i unitSeparators = _mm256_set1_epi8(0x1F);
+    const __m256i deletes = _mm256_set1_epi8(0x7F);
+    for (; position + sizeof(__m256i) <= length; position += sizeof(__m256i)) {
+        const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + position));
+        const __m256i isPrintable = _mm256_and_si256(_mm256_cmpgt_epi8(bytes, unitSeparators), _mm256_cmpgt_epi8(deletes, bytes));
+        const auto mask = static_cast<quint32>(_mm256_movemask_epi8(isPrintable));
+        if (mask != 0xFFFFFFFFu) {
+            return position + qCountTrailingZeroBits(~mask);
+        }
+    }
+#endif
+    const __m128i unitSeparators128 = _mm_set1_epi8(0x1F);
+    const __m128i deletes128 = _mm_set1_epi8(0x7F);
+    for (; position + sizeof(__m128i) <= length; position += sizeof(__m128i)) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position));
+        const __m128i isPrintable = _mm_and_si128(_mm_cmpgt_epi8(bytes, unitSeparators128), _mm_cmplt_epi8(bytes, deletes128));
+        const auto mask = static_cast<quint32>(_mm_movemask_epi8(isPrintable));
+        if (mask != 0xFFFFu) {
+            return position + qCountTrailingZeroBits(~mask);
+        }
+    }
+#endif
+    // What is left over (or everything if there is no SIMD to use):
+    for (; position < length; ++position) {
+        const auto byte = static_cast<unsigned char>(data[position]);
+        if (byte < 0x20 || byte > 0x7E) {
+            break;
+        }
+    }
+    return position;
+}
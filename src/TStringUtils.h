@@ -24,6 +24,7 @@
 #include <QString>
 #include <QStringList>
 #include "post_guard.h"
+#include <cstddef>
 #include <functional>
 #include "utils.h"
 
@@ -42,6 +43,11 @@ class TStringUtils
 public:
     static bool isQuote(QChar ch);
     static bool isOneOf(QChar inputCharacter, const QString& characterSet);
+    // How many of the bytes at the start of the data are printable ASCII
+    // (space to '~') - so not ESC, CR, LF, any other control character or
+    // anything with the high bit set. Uses SSE2 (or AVX2 if the compiler
+    // has been told it can) to look at many bytes at a time:
+    static size_t plainTextRunLength(const char* data, const size_t length);
 };
 
 #endif //MUDLET_TSTRINGUTILS_H
@@ -0,0 +1,325 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "TTelnetReceiver.h"
+
+#include "ctelnet.h"
+
+#include "pre_guard.h"
+#include <QDebug>
+#include <QThread>
+#include "post_guard.h"
+
+TTelnetReceiver::~TTelnetReceiver()
+{
+    if (mDecompressing) {
+        inflateEnd(&mZstream);
+    }
+}
+
+void TTelnetReceiver::post(const QByteArray& data)
+{
+    if (data.isEmpty()) {
+        return;
+    }
+    mInput.push(data);
+    if (!mInputScheduled.exchange(true)) {
+        QMetaObject::invokeMethod(this, &TTelnetReceiver::slot_processInput, Qt::QueuedConnection);
+    }
+}
+
+void TTelnetReceiver::postReset()
+{
+    ++mPostedGeneration;
+    mInput.push(QByteArray());
+    if (!mInputScheduled.exchange(true)) {
+        QMetaObject::invokeMethod(this, &TTelnetReceiver::slot_processInput, Qt::QueuedConnection);
+    }
+}
+
+void TTelnetReceiver::waitForInput()
+{
+    // Without a (running) thread of its own nothing else can be processing
+    // the input at the same time:
+    if (thread() == QThread::currentThread() || !thread()->isRunning()) {
+        slot_processInput();
+        return;
+    }
+    // Any run already asked for happens before this one, so by the time it
+    // returns everything posted so far has been dealt with:
+    QMetaObject::invokeMethod(this, &TTelnetReceiver::slot_processInput, Qt::BlockingQueuedConnection);
+}
+
+void TTelnetReceiver::slot_processInput()
+{
+    // Cleared before looking at the input so that anything posted from now on
+    // will schedule another run, even if this one ends up processing it:
+    mInputScheduled.exchange(false);
+    QByteArray data;
+    bool gotAny = false;
+    while (mInput.pop(data)) {
+        if (data.isNull()) {
+            ++mProcessedGeneration;
+            reset();
+            continue;
+        }
+        receive(data.constData(), data.size());
+        gotAny = true;
+    }
+    if (gotAny && !mEventsNotified.exchange(true)) {
+        emit signal_eventsReady();
+    }
+}
+
+bool TTelnetReceiver::takeEvent(TTelnetEvent& event)
+{
+    if (popCurrentEvent(event)) {
+        return true;
+    }
+    // Nothing left so ask to be told about the next one - but something may
+    // have been added just before this, when it was not going to be signalled:
+    mEventsNotified.exchange(false);
+    return popCurrentEvent(event);
+}
+
+// Skips over any events produced before the last reset that was posted, which
+// would otherwise be delivered to whatever the owner has started since:
+bool TTelnetReceiver::popCurrentEvent(TTelnetEvent& event)
+{
+    while (mEvents.pop(event)) {
+        if (event.mGeneration == mPostedGeneration) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void TTelnetReceiver::setCompressionAllowed(const bool version1, const bool version2)
+{
+    mMCCP_version_1 = version1;
+    mMCCP_version_2 = version2;
+}
+
+void TTelnetReceiver::reset()
+{
+    if (mDecompressing) {
+        inflateEnd(&mZstream);
+        mDecompressing = false;
+    }
+    mIac = false;
+    mIac2 = false;
+    mInsb = false;
+    mIncompleteSB = false;
+    mCommand.clear();
+    mText.clear();
+}
+
+void TTelnetReceiver::receive(const char* data, int length)
+{
+    while (length > 0) {
+        int used = 0;
+        if (mDecompressing) {
+            bool streamEnded = false;
+            mInflated.clear();
+            used = inflateInto(data, length, streamEnded);
+            mChunk += mInflated;
+            parse(mInflated.data(), static_cast<int>(mInflated.size()));
+            if (streamEnded) {
+                mDecompressing = false;
+                push(TTelnetEvent::CompressionEnded, {});
+            } else if (!used) {
+                break;
+            }
+        } else {
+            used = parse(data, length);
+            mChunk.append(data, used);
+        }
+        data += used;
+        length -= used;
+    }
+    push(TTelnetEvent::Chunk, std::move(mChunk));
+    mChunk.clear();
+}
+
+void TTelnetReceiver::push(const TTelnetEvent::Type type, std::string data)
+{
+    if (type != TTelnetEvent::Text) {
+        flushText();
+    }
+    TTelnetEvent event;
+    event.mType = type;
+    event.mData = std::move(data);
+    event.mGeneration = mProcessedGeneration;
+    mEvents.push(std::move(event));
+}
+
+void TTelnetReceiver::flushText()
+{
+    if (!mText.empty()) {
+        push(TTelnetEvent::Text, std::move(mText));
+        mText.clear();
+    }
+}
+
+void TTelnetReceiver::startDecompression()
+{
+    push(TTelnetEvent::CompressionStarted, {});
+    mZstream = {};
+    mZstream.zalloc = Z_NULL;
+    mZstream.zfree = Z_NULL;
+    mZstream.opaque = Z_NULL;
+    mZstream.avail_in = 0;
+    mZstream.next_in = Z_NULL;
+    inflateInit(&mZstream);
+    mDecompressing = true;
+    // The compressed data starts in a clean state:
+    mIac = false;
+    mIac2 = false;
+    mInsb = false;
+    mCommand.clear();
+}
+
+// Appends what it can to mInflated and returns how much of the data was used,
+// which is less than all of it only if the compressed stream ends part way
+// through, as what follows is not compressed:
+int TTelnetReceiver::inflateInto(const char* data, const int length, bool& streamEnded)
+{
+    char out[16384];
+    mZstream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    mZstream.avail_in = static_cast<uInt>(length);
+    int zval = Z_OK;
+    do {
+        mZstream.next_out = reinterpret_cast<Bytef*>(out);
+        mZstream.avail_out = sizeof(out);
+        zval = inflate(&mZstream, Z_SYNC_FLUSH);
+        mInflated.append(out, sizeof(out) - mZstream.avail_out);
+    } while (zval == Z_OK && (mZstream.avail_in > 0 || mZstream.avail_out == 0));
+
+    if (zval == Z_STREAM_END) {
+        inflateEnd(&mZstream);
+        qDebug() << "recv Z_STREAM_END, ending compression";
+        streamEnded = true;
+    } else if (zval != Z_OK && zval != Z_BUF_ERROR) {
+        qWarning().nospace() << "TTelnetReceiver::inflateInto(...) WARNING - decompression failed (" << zval << "), discarding " << mZstream.avail_in << " bytes.";
+        return length;
+    }
+    return length - static_cast<int>(mZstream.avail_in);
+}
+
+// Returns how much of the data was used, which is less than all of it only if
+// MCCP is started part way through, as what follows is then compressed:
+int TTelnetReceiver::parse(const char* buffer, const int length)
+{
+    for (int i = 0; i < length; ++i) {
+        const char ch = buffer[i];
+
+        if (!(mIac || mIac2 || mInsb || (ch == TN_IAC))) {
+            if (ch != '\r' && ch != '\0') {
+                mText += ch;
+            }
+            continue;
+        }
+
+        if (!(mIac || mIac2 || mInsb) && (ch == TN_IAC)) {
+            mIac = true;
+            mCommand += ch;
+        } else if (mIac && (ch == TN_IAC) && (!mInsb)) {
+            //2. seq. of two IACs
+            mIac = false;
+            mText += ch;
+            mCommand.clear();
+        } else if (mIac && (!mInsb) && ((ch == TN_WILL) || (ch == TN_WONT) || (ch == TN_DO) || (ch == TN_DONT))) {
+            //3. IAC DO/DONT/WILL/WONT
+            mIac = false;
+            mIac2 = true;
+            mCommand += ch;
+        } else if (mIac2) {
+            //4. IAC DO/DONT/WILL/WONT <command code>
+            mIac2 = false;
+            mCommand += ch;
+            push(TTelnetEvent::Command, std::move(mCommand));
+            mCommand.clear();
+        } else if (mIac && (!mInsb) && (ch == TN_SB)) {
+            //5. IAC SB
+            mIac = false;
+            mInsb = true;
+            mCommand += ch;
+        } else if (mIac && (!mInsb) && (ch == TN_SE)) {
+            //6. IAC SE without IAC SB - error - ignored
+            mCommand.clear();
+            mIac = false;
+        } else if (mInsb) {
+            // IAC SB COMPRESS WILL SE for MCCP v1 (unterminated invalid telnet sequence)
+            // IAC SB COMPRESS2 IAC SE for MCCP v2
+            // from the byte after these the data is compressed by zlib:
+            if (!mDecompressing && ch == TN_SE) {
+                if (!mIac && mMCCP_version_1 && mCommand == std::string{TN_IAC, TN_SB, OPT_COMPRESS, TN_WILL}) {
+                    qDebug() << "MCCP version 1 starting sequence";
+                    startDecompression();
+                    return i + 1;
+                }
+                if (mIac && mMCCP_version_2 && mCommand == std::string{TN_IAC, TN_SB, OPT_COMPRESS2, TN_IAC}) {
+                    qDebug() << "MCCP version 2 starting sequence";
+                    startDecompression();
+                    return i + 1;
+                }
+            }
+            //7. inside IAC SB
+
+            mCommand += ch;
+            if (mIac && (ch == TN_SE)) { //IAC SE - end of subcommand
+                push(TTelnetEvent::Command, std::move(mCommand));
+                mCommand.clear();
+                mIac = false;
+                mInsb = false;
+            } else if (mIac && (ch == TN_IAC)) { // escaped TN_IAC
+                mCommand.pop_back();
+                mIac = false;
+            } else if (mIac) {
+                // Telnet options within a subcommand are not supported.
+                // We assume that the SE went missing, possibly due to a
+                // server bug, and try to recover.
+                // Cf. https://github.com/Mudlet/Mudlet/issues/4385
+                mCommand.pop_back();
+                mCommand += TN_SE;
+                if (!mIncompleteSB) {
+                    mIncompleteSB = true;
+                    qWarning(R"("TELNET: the server did not properly complete a subnegotiation (code %02x).
+Some data loss is likely - please mention this problem to the game admins.)", mCommand[2]);
+                }
+                push(TTelnetEvent::Command, std::move(mCommand));
+
+                // Re-enter the state machine.
+                mCommand = TN_IAC;
+                mIac = true;
+                mInsb = false;
+                i -= 1;
+            } else if (ch == TN_IAC) {
+                mIac = true;
+            }
+        } else {
+            //8. IAC fol. by something else than IAC, SB, SE, DO, DONT, WILL, WONT
+            mIac = false;
+            mCommand += ch;
+            push(TTelnetEvent::Command, std::move(mCommand));
+            mCommand.clear();
+        }
+    }
+    return length;
+}
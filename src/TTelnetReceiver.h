@@ -0,0 +1,137 @@
+#ifndef MUDLET_TTELNETRECEIVER_H
+#define MUDLET_TTELNETRECEIVER_H
+
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include "TSpscQueue.h"
+
+#include "pre_guard.h"
+#include <QByteArray>
+#include <QObject>
+#include "post_guard.h"
+
+#include <zlib.h>
+
+#include <atomic>
+#include <string>
+
+// What the game sent, split up by TTelnetReceiver into the pieces that
+// cTelnet has to act on, in the order that they arrived:
+struct TTelnetEvent
+{
+    enum Type {
+        // Game text, with any doubled IACs undone and CRs and NULs removed:
+        Text,
+        // A complete telnet command or subnegotiation, starting with the IAC:
+        Command,
+        // MCCP has started or the compressed stream has ended:
+        CompressionStarted,
+        CompressionEnded,
+        // Marks the end of what was received in one read of the socket, the
+        // data is all of it (after decompression) for replay recording:
+        Chunk
+    };
+
+    Type mType = Text;
+    std::string mData;
+    // How many resets had been processed when this was produced, so that
+    // events from before the latest one can be dropped:
+    quint32 mGeneration = 0;
+};
+
+// Does the byte level work on the incoming stream - MCCP decompression and
+// finding the telnet commands in it - so that it can be run on a thread of
+// its own, away from the GUI: the raw data is passed to it with post(...)
+// and, after it has been processed on that thread, the resulting events are
+// handed back, with signal_eventsReady() emitted so the owner knows to fetch
+// them with takeEvent(...). It can also be used without a thread of its own
+// by calling receive(...) directly.
+class TTelnetReceiver : public QObject
+{
+    Q_OBJECT
+
+public:
+    Q_DISABLE_COPY(TTelnetReceiver)
+    explicit TTelnetReceiver(QObject* parent = nullptr) : QObject(parent) {}
+    ~TTelnetReceiver() override;
+
+    // From the owner's thread:
+    void post(const QByteArray&);
+    // Clears the telnet and decompression state, in order with the data - and
+    // any events from before it that have not been taken yet are dropped:
+    void postReset();
+    // Does not return until everything posted so far has been processed, so
+    // that all the resulting events can be taken before a postReset():
+    void waitForInput();
+    bool takeEvent(TTelnetEvent&);
+    // MCCP is only started if it has been negotiated. These can be changed
+    // from any thread, and must be set before agreeing to it with the game:
+    void setCompressionAllowed(const bool version1, const bool version2);
+
+    // From the thread that processes the data:
+    void receive(const char*, int);
+    void reset();
+
+signals:
+    void signal_eventsReady();
+
+private slots:
+    void slot_processInput();
+
+private:
+    int parse(const char*, const int);
+    int inflateInto(const char*, const int, bool& streamEnded);
+    void startDecompression();
+    void push(const TTelnetEvent::Type, std::string);
+    void flushText();
+    bool popCurrentEvent(TTelnetEvent&);
+
+    // A null QByteArray is a request to reset:
+    TSpscQueue<QByteArray> mInput;
+    TSpscQueue<TTelnetEvent> mEvents;
+    // Whether the processing of the input or the fetching of the events has
+    // already been asked for and not yet started - to save doing so for
+    // every post(...) or event:
+    std::atomic<bool> mInputScheduled{false};
+    std::atomic<bool> mEventsNotified{false};
+    std::atomic<bool> mMCCP_version_1{false};
+    std::atomic<bool> mMCCP_version_2{false};
+    // The number of resets posted, only used on the owner's thread, and the
+    // number processed, only used on the processing one - the events are
+    // tagged with the latter and any that do not match the former are stale:
+    quint32 mPostedGeneration = 0;
+    quint32 mProcessedGeneration = 0;
+
+    // The telnet state machine:
+    std::string mCommand;
+    bool mIac = false;
+    bool mIac2 = false;
+    bool mInsb = false;
+    bool mIncompleteSB = false;
+    std::string mText;
+
+    z_stream mZstream = {};
+    bool mDecompressing = false;
+    std::string mInflated;
+    std::string mChunk;
+};
+
+#endif // MUDLET_TTELNETRECEIVER_H
@@ -38,6 +38,7 @@
 #include "widechar_width.h"
 
 #include "pre_guard.h"
+#include <algorithm>
 #include <chrono>
 #include <QtEvents>
 #include <QtGlobal>
@@ -71,7 +72,6 @@ TTextEdit::TTextEdit(TConsole* pC, QWidget* pW, TBuffer* pB, Host* pH, bool isLo
 , mShowTimeStamps(false)
 , mForceUpdate(false)
 , mIsLowerPane(isLowerPane)
-, mLastRenderedOffset(0)
 , mMouseTracking(false)
 , mMouseTrackLevel(0)
 , mOldScrollPos(0)
@@ -135,6 +135,7 @@ TTextEdit::TTextEdit(TConsole* pC, QWidget* pW, TBuffer* pB, Host* pH, bool isLo
 void TTextEdit::forceUpdate()
 {
     mForceUpdate = true;
+    mScreenRowsDirty = true;
     update();
 }
 
@@ -147,15 +148,24 @@ void TTextEdit::needUpdate(int y1, int y2)
     if (mScreenHeight == 0) {
         return;
     }
-    int top = imageTopLine();
-    int bottom = y2 - y1;
-
-    if (top > 0) {
-        top = (y1 - top) % mScreenHeight;
-    } else {
-        top = y1 % mScreenHeight;
+    // The rows that the lines from y1 up to (but not including) y2 are on -
+    // which may have changed as those lines have:
+    mScreenRowsDirty = true;
+    layoutScreen();
+    int top = -1;
+    int bottom = -1;
+    for (int i = 0, total = mScreenRows.size(); i < total; ++i) {
+        if (mScreenRows.at(i).mLine >= y1 && mScreenRows.at(i).mLine < y2) {
+            if (top < 0) {
+                top = i;
+            }
+            bottom = i;
+        }
     }
-    QRect r(0, top * mFontHeight, mScreenWidth * mFontWidth, bottom * mFontHeight);
+    if (top < 0) {
+        return;
+    }
+    QRect r(0, top * mFontHeight, mScreenWidth * mFontWidth, (bottom - top + 1) * mFontHeight);
     mForceUpdate = true;
     update(r);
 }
@@ -202,16 +212,24 @@ void TTextEdit::slot_toggleTimeStamps(const bool state)
     }
 }
 
-// Only wired up for the upper pane:
-void TTextEdit::slot_scrollBarMoved(int line)
+// Only wired up for the upper pane, the value is how many rows, from the top
+// of the buffer, are down to the bottom of the screen:
+void TTextEdit::slot_scrollBarMoved(int rows)
 {
     if (mpConsole->mpScrollBar) {
-        updateScrollBar(line);
-        scrollTo(line);
+        if (rows >= rowCountTotal()) {
+            scrollTo(mpBuffer->size());
+        } else {
+            const auto [line, row] = positionOfRow(rows - 1);
+            scrollTo(line, row);
+        }
+        updateScrollBar();
     }
 }
 
-void TTextEdit::updateScrollBar(int line)
+// The scroll bar counts the rows the lines are wrapped into, so that each step
+// is one row and a line too long to fit on the screen can still be seen:
+void TTextEdit::updateScrollBar()
 {
     Q_ASSERT_X(!mIsLowerPane, "updateScrollBar(...)", "called on LOWER pane when it should only be used on upper one!");
     int screenHeight{mScreenHeight};
@@ -219,11 +237,12 @@ void TTextEdit::updateScrollBar(int line)
         screenHeight -= mpConsole->mLowerPane->getScreenHeight();
     }
     if (mpConsole->mpScrollBar) {
+        const int totalRows = rowCountTotal();
         disconnect(mpConsole->mpScrollBar, &QAbstractSlider::valueChanged, this, &TTextEdit::slot_scrollBarMoved);
-        mpConsole->mpScrollBar->setRange(screenHeight, mpBuffer->getLastLineNumber() + 1);
+        mpConsole->mpScrollBar->setRange(screenHeight, totalRows);
         mpConsole->mpScrollBar->setSingleStep(1);
         mpConsole->mpScrollBar->setPageStep(screenHeight);
-        mpConsole->mpScrollBar->setValue(std::max(0, line));
+        mpConsole->mpScrollBar->setValue(std::max(0, mIsTailMode ? totalRows : bottomRowIndex() + 1));
         connect(mpConsole->mpScrollBar, &QAbstractSlider::valueChanged, this, &TTextEdit::slot_scrollBarMoved);
     }
 }
@@ -306,7 +325,7 @@ void TTextEdit::updateScreenView()
     }
     mScreenHeight = visibleRegion().boundingRect().height() / mFontHeight;
     if (!mIsLowerPane) {
-        updateScrollBar(mpBuffer->mCursorY);
+        updateScrollBar();
     }
     int currentScreenWidth = visibleRegion().boundingRect().width() / mFontWidth;
     if (mpConsole->getType() == TConsole::MainConsole) {
@@ -354,7 +373,7 @@ void TTextEdit::showNewLines()
     if (!mIsLowerPane) {
         // This is ONLY for the upper pane
         if (mpConsole->mpScrollBar && mOldScrollPos > 0) {
-            updateScrollBar(mpBuffer->mCursorY);
+            updateScrollBar();
         }
     }
     update();
@@ -393,18 +412,20 @@ void TTextEdit::showNewLines()
     }
 }
 
-void TTextEdit::scrollTo(int line)
+void TTextEdit::scrollTo(int line, int row)
 {
     // Protect against modifying mIsTailMode on the lower pane where it would
     // be wrong:
     Q_ASSERT_X(!mIsLowerPane, "Inappropriate use of method on lower pane which should only be used for the upper one", "TTextEdit::scrollTo()");
     if ((line > -1) && (line <= mpBuffer->size())) {
-        if ((line < (mpBuffer->getLastLineNumber() + 1) && mIsTailMode)) {
+        // Only the last row of the last line is the end of the text:
+        const bool isAtEnd = line > mpBuffer->getLastLineNumber() && row < 0;
+        if (!isAtEnd && mIsTailMode) {
             mIsTailMode = false;
             mpConsole->mLowerPane->mCursorY = mpBuffer->size();
             mpConsole->mLowerPane->show();
             mpConsole->mLowerPane->forceUpdate();
-        } else if ((line > (mpBuffer->getLastLineNumber())) && !mIsTailMode) {
+        } else if (isAtEnd && !mIsTailMode) {
             mpConsole->mLowerPane->mCursorY = mpConsole->buffer.getLastLineNumber();
             mpConsole->mLowerPane->hide();
             mIsTailMode = true;
@@ -413,6 +434,8 @@ void TTextEdit::scrollTo(int line)
             forceUpdate();
         }
         mpBuffer->mCursorY = line;
+        mCursorRow = row;
+        mCursorRowLine = line;
 
         mScrollVector = 0;
         update();
@@ -425,30 +448,54 @@ void TTextEdit::scrollH(int offset)
     forceUpdate();
 }
 
-void TTextEdit::scrollUp(int lines)
+void TTextEdit::scrollUp(int rows)
 {
     if (mIsLowerPane) {
         return;
     }
 
-    mpBuffer->mCursorY -= lines;
+    // Not so far that the screen is no longer filled, if there is enough text
+    // to fill it:
+    setBottomRow(std::max(bottomRowIndex() - rows, std::min(rowCountTotal(), mScreenHeight) - 1));
     mScrollVector = 0;
     mIsTailMode = false;
-    updateScrollBar(mpBuffer->mCursorY);
+    updateScrollBar();
     update();
 }
 
-void TTextEdit::scrollDown(int lines)
+void TTextEdit::scrollDown(int rows)
 {
     if (mIsLowerPane) {
         return;
     }
 
-    if (bufferScrollDown(lines)) {
+    const int totalRows = rowCountTotal();
+    const int index = bottomRowIndex() + rows;
+    if (index >= totalRows - 1) {
+        // Back at the end, so follow the new text again:
+        mIsTailMode = true;
+        mpBuffer->mCursorY = mpBuffer->lineBuffer.size();
         mScrollVector = 0;
-        updateScrollBar(mpBuffer->mCursorY);
-        update();
+        updateScrollBar();
+        forceUpdate();
+        return;
     }
+
+    setBottomRow(std::max(index, std::min(totalRows, mScreenHeight) - 1));
+    mIsTailMode = false;
+    mScrollVector = 0;
+    updateScrollBar();
+    update();
+}
+
+int TTextEdit::rowsUpToLine(const int line)
+{
+    return bottomRowIndex() - (rowsBeforeLine(line) - 1);
+}
+
+int TTextEdit::rowsBelowScreen()
+{
+    return rowCountTotal() - 1 - bottomRowIndex();
 }
 
 // Extract the base (first) part which will be one or two QChars
@@ -480,70 +527,594 @@ inline uint TTextEdit::getGraphemeBaseCharacter(const QString& str) const
     return first.unicode();
 }
 
-void TTextEdit::drawLine(QPainter& painter, int lineNumber, int lineOfScreen, int* offset) const
+void TTextEdit::drawLine(QPainter& painter, int lineNumber, int lineOfScreen, int wrappedRow, int* offset, const bool useLayoutCache) const
 {
     QPoint cursor(-mCursorX, lineOfScreen);
-    QString lineText = mpBuffer->lineBuffer.at(lineNumber);
-    QTextBoundaryFinder boundaryFinder(QTextBoundaryFinder::Grapheme, lineText);
-    int currentSize = lineText.size();
+    const QString& lineText = mpBuffer->lineBuffer.at(lineNumber);
+    LineLayout uncachedLayout;
+    if (!useLayoutCache) {
+        layoutLine(lineText, uncachedLayout);
+        if (wrappedRow >= 0) {
+            wrapLineLayout(uncachedLayout);
+        }
+    }
+    const LineLayout& layout = useLayoutCache ? cachedLineLayout(lineNumber, lineText) : uncachedLayout;
+    const int graphemeCount = layout.mGraphemes.size();
+    const auto [begin, end] = rowGraphemes(layout, wrappedRow);
+    const int rowStartColumn = begin < graphemeCount ? layout.mGraphemes.at(begin).mColumn : 0;
+    const int rowIndent = wrappedRow > 0 ? layout.mRowsIndent : 0;
+    const int rowEndColumn = end < graphemeCount ? layout.mGraphemes.at(end).mColumn
+                                                 : (graphemeCount ? layout.mGraphemes.constLast().mColumn + layout.mGraphemes.constLast().mWidth : 0);
+    int currentSize = rowIndent + rowEndColumn - rowStartColumn;
+    const bool drawTextRuns = canDrawTextRuns(painter.font());
     if (mShowTimeStamps) {
         TChar timeStampStyle(QColor(200, 150, 0), QColor(22, 22, 22));
-        QString timestamp(mpBuffer->timeBuffer.at(lineNumber));
-        QVector<QColor> fgColors;
-        QVector<QRect> textRects;
-        QVector<int> charWidths;
-        QVector<QString> graphemes;
-        for (const QChar c : timestamp) {
-            // The column argument is not incremented here (is fixed at 0) so
-            // the timestamp does not take up any places when it is clicked on
-            // by the mouse...
-            cursor.setX(cursor.x() + drawGraphemeBackground(painter, fgColors, textRects, graphemes, charWidths, cursor, c, 0, lineNumber, timeStampStyle));
-        }
-        int index = -1;
-        for (const QChar c : timestamp) {
-            ++index;
-            drawGraphemeForeground(painter, fgColors.at(index), textRects.at(index), c, timeStampStyle);
+        // Only the first row of a wrapped line shows the time:
+        const QString timestamp(wrappedRow > 0 ? TBuffer::csmBlankTimeStamp : mpBuffer->timeStamp(lineNumber));
+        // The timestamp does not take up any columns so the caret, when it is
+        // in the first column of the line, shows across all of it:
+        const bool caretIsHere = mpHost->caretEnabled() && mCaretLine == lineNumber && mCaretColumn == 0 && wrappedRow <= 0;
+        const QColor fgColor = caretIsHere ? timeStampStyle.background() : timeStampStyle.foreground();
+        const QColor bgColor = caretIsHere ? mCaretColor : timeStampStyle.background();
+        if (drawTextRuns) {
+            const QRect textRect(mFontWidth * cursor.x(), mFontHeight * cursor.y(), mFontWidth * timestamp.size(), mFontHeight);
+            painter.fillRect(textRect, bgColor);
+            drawGraphemeForeground(painter, fgColor, textRect, timestamp, timeStampStyle);
+        } else {
+            for (int i = 0, total = timestamp.size(); i < total; ++i) {
+                const QRect textRect(mFontWidth * (cursor.x() + i), mFontHeight * cursor.y(), mFontWidth, mFontHeight);
+                painter.fillRect(textRect, bgColor);
+                drawGraphemeForeground(painter, fgColor, textRect, timestamp.at(i), timeStampStyle);
+            }
         }
+        cursor.setX(cursor.x() + timestamp.size());
         currentSize += mTimeStampWidth;
     }
+    // So that the graphemes on this row start at the left (after any indent):
+    cursor.setX(cursor.x() + rowIndent - rowStartColumn);
 
     //get the longest line
     if (offset && *offset < currentSize) {
         *offset = currentSize;
     }
 
-    int columnWithOutTimestamp = 0;
-    QVector<QColor> fgColors;
-    QVector<QRect> textRects;
-    QVector<int> charWidths;
-    QVector<QString> graphemes;
-    for (int indexOfChar = 0, total = lineText.size(); indexOfChar < total;) {
-        int nextBoundary = boundaryFinder.toNextBoundary();
+    auto& lineStyles = mpBuffer->buffer.at(lineNumber);
+    const bool caretEnabled = mpHost->caretEnabled() && mCaretLine == lineNumber;
+
+    // First the backgrounds - merging those next to each other that are the
+    // same colour - noting the foreground colours for the second pass:
+    QVector<QColor> fgColors(graphemeCount);
+    QRect pendingRect;
+    QColor pendingColor;
+    for (int index = begin; index < end; ++index) {
+        const GraphemeLayout& grapheme = layout.mGraphemes.at(index);
+        TChar& charStyle = lineStyles.at(grapheme.mIndex);
+        QColor bgColor;
+        const bool caretIsHere = caretEnabled && mCaretColumn == grapheme.mColumn;
+        if (Q_UNLIKELY(charStyle.isFound())) {
+            if (Q_UNLIKELY(charStyle.isReversed() != (charStyle.isSelected() != caretIsHere))) {
+                fgColors[index] = mSearchHighlightBgColor;
+                bgColor = mSearchHighlightFgColor;
+            } else {
+                fgColors[index] = mSearchHighlightFgColor;
+                bgColor = mSearchHighlightBgColor;
+            }
+        } else {
+            if (Q_UNLIKELY(charStyle.isReversed() != (charStyle.isSelected() != caretIsHere))) {
+                fgColors[index] = charStyle.background();
+                bgColor = charStyle.foreground();
+            } else {
+                fgColors[index] = charStyle.foreground();
+                bgColor = charStyle.background();
+            }
+        }
+        if (caretIsHere) {
+            bgColor = mCaretColor;
+        }
+        if (!grapheme.mWidth) {
+            continue;
+        }
 
-        TChar& charStyle = mpBuffer->buffer.at(lineNumber).at(indexOfChar);
-        int graphemeWidth = drawGraphemeBackground(painter, fgColors, textRects, graphemes, charWidths, cursor, lineText.mid(indexOfChar, nextBoundary - indexOfChar), columnWithOutTimestamp, lineNumber, charStyle);
-        cursor.setX(cursor.x() + graphemeWidth);
-        indexOfChar = nextBoundary;
-        columnWithOutTimestamp += graphemeWidth;
+        const QRect textRect(mFontWidth * (cursor.x() + grapheme.mColumn), mFontHeight * cursor.y(), mFontWidth * grapheme.mWidth, mFontHeight);
+        if (!pendingRect.isNull() && pendingColor == bgColor && pendingRect.right() + 1 == textRect.left()) {
+            pendingRect.setRight(textRect.right());
+            continue;
+        }
+        if (!pendingRect.isNull()) {
+            painter.fillRect(pendingRect, pendingColor);
+        }
+        pendingRect = textRect;
+        pendingColor = bgColor;
+    }
+    if (!pendingRect.isNull()) {
+        painter.fillRect(pendingRect, pendingColor);
     }
-    boundaryFinder.toStart();
-    int index = -1;
-    for (int indexOfChar = 0, total = lineText.size(); indexOfChar < total;) {
-        int nextBoundary = boundaryFinder.toNextBoundary();
 
-        TChar& charStyle = mpBuffer->buffer.at(lineNumber).at(indexOfChar);
-        ++index;
-        drawGraphemeForeground(painter, fgColors.at(index), textRects.at(index), graphemes.at(index), charStyle);
-        indexOfChar = nextBoundary;
+    // Then the text - runs of ASCII characters in the same style are drawn
+    // with a single call when the font allows it:
+    QString run;
+    for (int index = begin; index < end;) {
+        const GraphemeLayout& grapheme = layout.mGraphemes.at(index);
+        TChar& charStyle = lineStyles.at(grapheme.mIndex);
+        if (!grapheme.mWidth) {
+            ++index;
+            continue;
+        }
+
+        const QRect textRect(mFontWidth * (cursor.x() + grapheme.mColumn), mFontHeight * cursor.y(), mFontWidth * grapheme.mWidth, mFontHeight);
+        if (!drawTextRuns || !grapheme.mIsAscii) {
+            drawGraphemeForeground(painter, fgColors.at(index), textRect, grapheme.mIsAscii ? QString(lineText.at(grapheme.mIndex)) : grapheme.mText, charStyle);
+            ++index;
+            continue;
+        }
+
+        run.clear();
+        run.append(lineText.at(grapheme.mIndex));
+        const TChar::AttributeFlags attributes = charStyle.allDisplayAttributes();
+        int next = index + 1;
+        for (; next < end; ++next) {
+            const GraphemeLayout& following = layout.mGraphemes.at(next);
+            if (!following.mIsAscii || fgColors.at(next) != fgColors.at(index) || lineStyles.at(following.mIndex).allDisplayAttributes() != attributes) {
+                break;
+            }
+            run.append(lineText.at(following.mIndex));
+        }
+        drawGraphemeForeground(painter, fgColors.at(index), QRect(textRect.topLeft(), QSize(mFontWidth * run.size(), mFontHeight)), run, charStyle);
+        index = next;
     }
 
     // If caret mode is enabled and the line is empty, still draw the caret.
-    if (mpHost->caretEnabled() && mCaretLine == lineNumber && lineText.isEmpty()) {
+    if (mpHost->caretEnabled() && mCaretLine == lineNumber && lineText.isEmpty() && wrappedRow <= 0) {
         auto textRect = QRect(0, mFontHeight * lineOfScreen, mFontWidth, mFontHeight);
         painter.fillRect(textRect, mCaretColor);
     }
 }
 
+// Works out where each grapheme of the line goes and what is to be drawn for
+// it - this is the costly part of drawing a line that does not need doing
+// again until the line (or how control characters are shown) changes:
+void TTextEdit::layoutLine(const QString& lineText, LineLayout& layout) const
+{
+    layout.mLineText = lineText;
+    layout.mGraphemes.clear();
+    // It will need wrapping again:
+    layout.mRowStarts.clear();
+    layout.mGraphemes.reserve(lineText.size());
+    QTextBoundaryFinder boundaryFinder(QTextBoundaryFinder::Grapheme, lineText);
+    QVector<QString> graphemes;
+    int column = 0;
+    for (int indexOfChar = 0, total = lineText.size(); indexOfChar < total;) {
+        const int nextBoundary = boundaryFinder.toNextBoundary();
+        GraphemeLayout grapheme;
+        grapheme.mIndex = indexOfChar;
+        grapheme.mColumn = column;
+        const QChar first = lineText.at(indexOfChar);
+        if (nextBoundary == indexOfChar + 1 && first.unicode() >= 0x20 && first.unicode() < 0x7F) {
+            // The common case, none of these are control characters:
+            grapheme.mWidth = 1;
+            grapheme.mIsAscii = true;
+        } else {
+            graphemes.clear();
+            grapheme.mWidth = graphemeLayout(lineText.mid(indexOfChar, nextBoundary - indexOfChar), column, graphemes);
+            grapheme.mText = graphemes.constFirst();
+        }
+        layout.mGraphemes.append(grapheme);
+        column += grapheme.mWidth;
+        indexOfChar = nextBoundary;
+    }
+}
+
+const TTextEdit::LineLayout& TTextEdit::cachedLineLayout(const int lineNumber, const QString& lineText) const
+{
+    const int controlCharacterMode = static_cast<int>(mpConsole->mControlCharacter);
+    if (mLineLayoutsControlCharacterMode != controlCharacterMode) {
+        mLineLayouts.clear();
+        mLineLayoutsControlCharacterMode = controlCharacterMode;
+    }
+
+    auto it = mLineLayouts.find(lineNumber);
+    if (it != mLineLayouts.end()) {
+        // Any change to the line will have detached it from the copy held in
+        // the layout - as that keeps the old data alive the pointers cannot
+        // match by accident:
+        if (it.value().mLineText.constData() != lineText.constData() || it.value().mLineText.size() != lineText.size()) {
+            layoutLine(lineText, it.value());
+        }
+        wrapLineLayout(it.value());
+        return it.value();
+    }
+
+    // Only keep enough for a few screens' worth of lines:
+    if (mLineLayouts.size() > qMax(100, 4 * mScreenHeight)) {
+        mLineLayouts.clear();
+    }
+    it = mLineLayouts.insert(lineNumber, LineLayout());
+    layoutLine(lineText, it.value());
+    wrapLineLayout(it.value());
+    return it.value();
+}
+
+// Works out where the rows start when the laid out line is wrapped to fit the
+// current width - breaking after the last space or punctuation that fits if
+// there is one - unless that has already been done for that width:
+void TTextEdit::wrapLineLayout(LineLayout& layout) const
+{
+    // CHECK: What about other Unicode line breaks, e.g. soft-hyphen:
+    static const QString lineBreaks = qsl(",.- ");
+
+    const int columns = wrapColumns();
+    const int indent = wrapIndent();
+    if (!layout.mRowStarts.isEmpty() && layout.mRowsWidth == columns && layout.mRowsIndent == indent) {
+        return;
+    }
+
+    layout.mRowsWidth = columns;
+    layout.mRowsIndent = indent;
+    layout.mRowStarts.clear();
+    layout.mRowStarts.append(0);
+    int rowStart = 0;
+    int rowStartColumn = 0;
+    int available = columns;
+    // The grapheme after the last place in this row it can be broken at:
+    int breakBefore = -1;
+    for (int index = 0, total = layout.mGraphemes.size(); index < total; ++index) {
+        const GraphemeLayout& grapheme = layout.mGraphemes.at(index);
+        const bool isBreak = lineBreaks.contains(layout.mLineText.at(grapheme.mIndex));
+        if (grapheme.mColumn + grapheme.mWidth - rowStartColumn > available && index > rowStart) {
+            if (layout.mLineText.at(grapheme.mIndex) == QChar::Space) {
+                // Let spaces hang off the end rather than start the next row:
+                breakBefore = index + 1;
+                continue;
+            }
+            rowStart = (breakBefore > rowStart) ? breakBefore : index;
+            layout.mRowStarts.append(rowStart);
+            rowStartColumn = layout.mGraphemes.at(rowStart).mColumn;
+            available = columns - indent;
+            breakBefore = -1;
+            if (rowStart < index && grapheme.mColumn + grapheme.mWidth - rowStartColumn > available) {
+                // What was carried over, and this, still does not fit in the
+                // (indented) row:
+                rowStart = index;
+                layout.mRowStarts.append(rowStart);
+                rowStartColumn = grapheme.mColumn;
+            }
+        }
+        if (isBreak) {
+            breakBefore = index + 1;
+        }
+    }
+}
+
+// The graphemes, from the first up to but not including the second, that are
+// on the given row of the wrapped line - or all of them for row -1:
+std::pair<int, int> TTextEdit::rowGraphemes(const LineLayout& layout, const int wrappedRow) const
+{
+    const int graphemeCount = layout.mGraphemes.size();
+    if (wrappedRow < 0 || wrappedRow >= layout.mRowStarts.size()) {
+        return {wrappedRow < 0 ? 0 : graphemeCount, graphemeCount};
+    }
+    return {layout.mRowStarts.at(wrappedRow), wrappedRow + 1 < layout.mRowStarts.size() ? layout.mRowStarts.at(wrappedRow + 1) : graphemeCount};
+}
+
+// How many columns the lines are wrapped to fit in, the wrap at setting of
+// the buffer or the width of the screen, whichever is less - unless there is
+// a horizontal scroll bar to see the rest of a longer line with:
+int TTextEdit::wrapColumns() const
+{
+    const int wrapAt = std::max(1, mpBuffer->mWrapAt);
+    if (mpConsole->mHScrollBarEnabled) {
+        return wrapAt;
+    }
+    return std::max(1, std::min(wrapAt, mScreenWidth - (mShowTimeStamps ? mTimeStampWidth : 0)));
+}
+
+// How far the rows after the first one of a wrapped line are indented:
+int TTextEdit::wrapIndent() const
+{
+    return std::clamp(mpBuffer->mWrapIndent, 0, wrapColumns() - 1);
+}
+
+// Makes sure that mScreenRows is up to date - it is only worked out again if
+// the buffer, the scroll position or the size or wrapping of the screen has
+// changed since it last was, so this can be used as often as needed:
+void TTextEdit::layoutScreen()
+{
+    if (!mIsLowerPane) {
+        mCursorY = mpBuffer->mCursorY;
+    }
+
+    const int lineCount = mpBuffer->lineBuffer.size();
+    const ScreenLayoutKey key{mCursorY,
+                              cursorRow(),
+                              lineCount,
+                              mpBuffer->getLineId(0),
+                              lineCount ? static_cast<int>(mpBuffer->lineBuffer.constLast().size()) : 0,
+                              wrapColumns(),
+                              wrapIndent(),
+                              mScreenHeight,
+                              mIsTailMode};
+    if (!mScreenRowsDirty && key == mScreenLayoutKey) {
+        return;
+    }
+
+    mScreenLayoutKey = key;
+    mScreenRowsDirty = false;
+    buildScreenRows();
+}
+
+// Works out what goes on each row of the screen, starting from the line that
+// goes at the bottom and working upwards:
+void TTextEdit::buildScreenRows()
+{
+    mScreenRows.clear();
+    const int lineCount = mpBuffer->lineBuffer.size();
+    if (!lineCount || mScreenHeight <= 0) {
+        return;
+    }
+
+    int bottomLine = std::min(mCursorY, lineCount) - 1;
+    const int bottomRow = cursorRow();
+    // mIsTailMode is always true for lower pane and true for upper one when
+    // it is scrolled to the bottom and new text is to be appended and the
+    // older text is to scroll up - the last line is still being received
+    // then and is not shown while it is empty:
+    if (mIsTailMode && bottomLine == lineCount - 1 && bottomLine > 0 && mpBuffer->lineBuffer.at(bottomLine).isEmpty()) {
+        --bottomLine;
+    }
+    for (int line = bottomLine; line >= 0 && static_cast<int>(mScreenRows.size()) < mScreenHeight; --line) {
+        const int rowCount = cachedLineLayout(line, mpBuffer->lineBuffer.at(line)).mRowStarts.size();
+        // The screen may be scrolled to part way through the bottom line:
+        const int lastRow = (line == bottomLine && bottomRow >= 0 && bottomRow < rowCount) ? bottomRow : rowCount - 1;
+        for (int row = lastRow; row >= 0 && static_cast<int>(mScreenRows.size()) < mScreenHeight; --row) {
+            mScreenRows.push_back({line, row});
+        }
+    }
+    if (static_cast<int>(mScreenRows.size()) == mScreenHeight) {
+        std::reverse(mScreenRows.begin(), mScreenRows.end());
+        return;
+    }
+
+    // Everything up to the bottom line fits on the screen so show it from the
+    // top instead:
+    mScreenRows.clear();
+    for (int line = 0; line < lineCount && static_cast<int>(mScreenRows.size()) < mScreenHeight; ++line) {
+        const int rowCount = cachedLineLayout(line, mpBuffer->lineBuffer.at(line)).mRowStarts.size();
+        for (int row = 0; row < rowCount && static_cast<int>(mScreenRows.size()) < mScreenHeight; ++row) {
+            mScreenRows.push_back({line, row});
+        }
+    }
+}
+
+// Which row of the bottom line the scroll position is at, -1 for the last one -
+// which it always is when following the new text:
+int TTextEdit::cursorRow() const
+{
+    if (mIsTailMode || mpBuffer->mCursorY != mCursorRowLine) {
+        return -1;
+    }
+    return mCursorRow;
+}
+
+// How many rows the line wraps into - without laying it out for the common case
+// of plain ASCII text that fits on one:
+int TTextEdit::lineRowCount(const QString& lineText) const
+{
+    if (lineText.size() <= wrapColumns()
+        && std::all_of(lineText.cbegin(), lineText.cend(), [](const QChar c) { return c.unicode() >= 0x20 && c.unicode() < 0x7F; })) {
+        return 1;
+    }
+    LineLayout layout;
+    layoutLine(lineText, layout);
+    wrapLineLayout(layout);
+    return layout.mRowStarts.size();
+}
+
+// Brings mLineRowCounts (and mTotalRows) up to date with the buffer, only the
+// lines that have been added or changed since the last time (or all of them if
+// the wrapping has changed) have their rows counted again:
+void TTextEdit::updateLineRowCounts() const
+{
+    const int columns = wrapColumns();
+    const int indent = wrapIndent();
+    const int controlCharacterMode = static_cast<int>(mpConsole->mControlCharacter);
+    const qint64 firstId = mpBuffer->getLineId(0);
+    if (mLineRowCountsColumns != columns || mLineRowCountsIndent != indent || mLineRowCountsControlCharacterMode != controlCharacterMode
+        || firstId < mLineRowCountsFirstId) {
+        mLineRowCounts.clear();
+        mTotalRows = 0;
+        mLineRowCountsColumns = columns;
+        mLineRowCountsIndent = indent;
+        mLineRowCountsControlCharacterMode = controlCharacterMode;
+        mLineRowCountsFirstId = firstId;
+    }
+
+    // Lines removed from the top of the buffer:
+    while (mLineRowCountsFirstId < firstId && !mLineRowCounts.empty()) {
+        mTotalRows -= mLineRowCounts.front().mRows;
+        mLineRowCounts.pop_front();
+        ++mLineRowCountsFirstId;
+    }
+    mLineRowCountsFirstId = firstId;
+
+    const int lineCount = mpBuffer->lineBuffer.size();
+    while (static_cast<int>(mLineRowCounts.size()) > lineCount) {
+        mTotalRows -= mLineRowCounts.back().mRows;
+        mLineRowCounts.pop_back();
+    }
+    for (int line = 0; line < lineCount; ++line) {
+        const QString& lineText = mpBuffer->lineBuffer.at(line);
+        if (line == static_cast<int>(mLineRowCounts.size())) {
+            mLineRowCounts.push_back({lineText, lineRowCount(lineText)});
+            mTotalRows += mLineRowCounts.back().mRows;
+            continue;
+        }
+        LineRowCount& count = mLineRowCounts[line];
+        if (count.mLineText.constData() == lineText.constData() && count.mLineText.size() == lineText.size()) {
+            continue;
+        }
+        mTotalRows -= count.mRows;
+        count.mLineText = lineText;
+        count.mRows = lineRowCount(lineText);
+        mTotalRows += count.mRows;
+    }
+}
+
+int TTextEdit::rowCountTotal() const
+{
+    updateLineRowCounts();
+    return mTotalRows;
+}
+
+// How many rows all the lines before the given one wrap into:
+int TTextEdit::rowsBeforeLine(const int line) const
+{
+    updateLineRowCounts();
+    int rows = 0;
+    for (int index = 0, total = std::min(line, static_cast<int>(mLineRowCounts.size())); index < total; ++index) {
+        rows += mLineRowCounts.at(index).mRows;
+    }
+    return rows;
+}
+
+// The row, counting from the top of the buffer, at the bottom of the (upper
+// pane's) screen:
+int TTextEdit::bottomRowIndex() const
+{
+    const int bottomLine = std::min(mpBuffer->mCursorY, static_cast<int>(mpBuffer->lineBuffer.size())) - 1;
+    if (bottomLine < 0) {
+        return -1;
+    }
+    const int rows = rowsBeforeLine(bottomLine);
+    const int lineRows = mLineRowCounts.at(bottomLine).mRows;
+    const int row = cursorRow();
+    return rows + ((row < 0 || row >= lineRows) ? lineRows - 1 : row);
+}
+
+// The scroll position - as mpBuffer->mCursorY and the row of the line before
+// that - that puts the given row, counting from the top of the buffer, at the
+// bottom of the screen:
+std::pair<int, int> TTextEdit::positionOfRow(const int index) const
+{
+    updateLineRowCounts();
+    int rows = 0;
+    for (int line = 0, total = mLineRowCounts.size(); line < total; ++line) {
+        const int lineRows = mLineRowCounts.at(line).mRows;
+        if (index < rows + lineRows || line == total - 1) {
+            const int row = std::clamp(index - rows, 0, lineRows - 1);
+            return {line + 1, row == lineRows - 1 ? -1 : row};
+        }
+        rows += lineRows;
+    }
+    return {0, -1};
+}
+
+void TTextEdit::setBottomRow(const int index)
+{
+    const auto [line, row] = positionOfRow(index);
+    mpBuffer->mCursorY = line;
+    mCursorRow = row;
+    mCursorRowLine = line;
+}
+
+// What is on the row of the screen at the given height in pixels - rows
+// below the end of the text are taken to be the lines after it:
+TTextEdit::ScreenRow TTextEdit::screenRowAt(const int y)
+{
+    layoutScreen();
+    if (mScreenRows.empty()) {
+        return {std::max(0, y / mFontHeight), 0};
+    }
+    if (y < 0) {
+        return {std::max(0, mScreenRows.front().mLine - 1), 0};
+    }
+    const int index = y / mFontHeight;
+    if (index < static_cast<int>(mScreenRows.size())) {
+        return mScreenRows.at(index);
+    }
+    return {mScreenRows.back().mLine + 1 + index - static_cast<int>(mScreenRows.size()), 0};
+}
+
+// How many rows the text has moved up the screen since it was last drawn,
+// negative if it has moved down, or more than the height of the screen if
+// none of what was there before is still showing:
+int TTextEdit::scrolledRows() const
+{
+    if (mLastScreenRows.empty() || mScreenRows.empty()) {
+        return mScreenHeight + 1;
+    }
+
+    const auto isSameRow = [](const ScreenRow& a, const ScreenRow& b) { return a.mLine == b.mLine && a.mRow == b.mRow; };
+    for (int i = 0, total = mLastScreenRows.size(); i < total; ++i) {
+        if (isSameRow(mLastScreenRows.at(i), mScreenRows.front())) {
+            return i;
+        }
+    }
+    for (int i = 1, total = mScreenRows.size(); i < total; ++i) {
+        if (isSameRow(mScreenRows.at(i), mLastScreenRows.front())) {
+            return -i;
+        }
+    }
+    return mScreenHeight + 1;
+}
+
+bool TTextEdit::isLineOnScreen(const int lineNumber)
+{
+    layoutScreen();
+    return std::any_of(mScreenRows.cbegin(), mScreenRows.cend(), [lineNumber](const ScreenRow& row) { return row.mLine == lineNumber; });
+}
+
+// The column and row of the screen that the QChar at the index of the line is
+// drawn at, or (-1, -1) if it is not showing:
+QPoint TTextEdit::screenPosition(const int lineNumber, const int index)
+{
+    layoutScreen();
+    for (int i = 0, total = mScreenRows.size(); i < total; ++i) {
+        if (mScreenRows.at(i).mLine != lineNumber) {
+            continue;
+        }
+        const LineLayout& layout = cachedLineLayout(lineNumber, mpBuffer->lineBuffer.at(lineNumber));
+        const auto [begin, end] = rowGraphemes(layout, mScreenRows.at(i).mRow);
+        // The row holds the index if it is not before the row's first grapheme
+        // and it is before the next row's first one (if there is one):
+        if ((begin < end && layout.mGraphemes.at(begin).mIndex > index)
+            || (end < layout.mGraphemes.size() && layout.mGraphemes.at(end).mIndex <= index)) {
+            continue;
+        }
+        int column = 0;
+        for (int grapheme = begin; grapheme < end && layout.mGraphemes.at(grapheme).mIndex < index; ++grapheme) {
+            column = layout.mGraphemes.at(grapheme).mColumn + layout.mGraphemes.at(grapheme).mWidth - layout.mGraphemes.at(begin).mColumn;
+        }
+        const int indent = mScreenRows.at(i).mRow > 0 ? layout.mRowsIndent : 0;
+        return QPoint((mShowTimeStamps ? mTimeStampWidth : 0) + indent + column - mCursorX, i);
+    }
+    return QPoint(-1, -1);
+}
+
+bool TTextEdit::canDrawTextRuns(const QFont& font) const
+{
+    if (mTextRunsFontWidth == mFontWidth && mTextRunsFont == font) {
+        return mCanDrawTextRuns;
+    }
+
+    static const QString printableAscii = []() {
+        QString result;
+        for (char16_t c = 0x20; c < 0x7F; ++c) {
+            result.append(QChar(c));
+        }
+        return result;
+    }();
+    mTextRunsFont = font;
+    mTextRunsFontWidth = mFontWidth;
+    mCanDrawTextRuns = mFontWidth > 0;
+    for (int variant = 0; mCanDrawTextRuns && variant < 4; ++variant) {
+        QFont variantFont = font;
+        variantFont.setBold(variant & 1);
+        variantFont.setItalic(variant & 2);
+        mCanDrawTextRuns = QFontMetrics(variantFont).horizontalAdvance(printableAscii) == mFontWidth * printableAscii.size();
+    }
+    return mCanDrawTextRuns;
+}
+
 /* inline */ void TTextEdit::replaceControlCharacterWith_Picture(const uint unicode, const QString& grapheme, const int column, QVector<QString>& graphemes, int& charWidth) const
 {
     switch (unicode) {
@@ -636,7 +1207,9 @@ void TTextEdit::drawLine(QPainter& painter, int lineNumber, int lineOfScreen, in
     }
 }
 
-int TTextEdit::drawGraphemeBackground(QPainter& painter, QVector<QColor>& fgColors, QVector<QRect>& textRects, QVector<QString>& graphemes, QVector<int>& charWidths, QPoint& cursor, const QString& grapheme, const int column, const int line, TChar& charStyle) const
+// Appends what is to be drawn for the grapheme to graphemes and returns how
+// many columns it takes up:
+int TTextEdit::graphemeLayout(const QString& grapheme, const int column, QVector<QString>& graphemes) const
 {
     uint unicode = getGraphemeBaseCharacter(grapheme);
     int charWidth = 0;
@@ -669,38 +1242,6 @@ int TTextEdit::drawGraphemeBackground(QPainter& painter, QVector<QColor>& fgColo
         replaceControlCharacterWith_OEMFont(unicode, grapheme, column, graphemes, charWidth);
         break;
     } // End of switch
-    charWidths.append(charWidth);
-
-    QRect textRect;
-    if (charWidth > 0) {
-        textRect = QRect(mFontWidth * cursor.x(), mFontHeight * cursor.y(), mFontWidth * charWidth, mFontHeight);
-    }
-    textRects.append(textRect);
-    QColor bgColor;
-    bool caretIsHere = mpHost->caretEnabled() && mCaretLine == line && mCaretColumn == column;
-    if (Q_UNLIKELY(charStyle.isFound())) {
-        if (Q_UNLIKELY(charStyle.isReversed() != (charStyle.isSelected() != caretIsHere))) {
-            fgColors.append(mSearchHighlightBgColor);
-            bgColor = mSearchHighlightFgColor;
-        } else {
-            fgColors.append(mSearchHighlightFgColor);
-            bgColor = mSearchHighlightBgColor;
-        }
-    } else {
-        if (Q_UNLIKELY(charStyle.isReversed() != (charStyle.isSelected() != caretIsHere))) {
-            fgColors.append(charStyle.background());
-            bgColor = charStyle.foreground();
-        } else {
-            fgColors.append(charStyle.foreground());
-            bgColor = charStyle.background();
-        }
-    }
-    if (caretIsHere) {
-        bgColor = mCaretColor;
-    }
-    if (!textRect.isNull()) {
-        painter.fillRect(textRect, bgColor);
-    }
     return charWidth;
 }
 
@@ -896,17 +1437,20 @@ void TTextEdit::drawForeground(QPainter& painter, const QRect& r)
     int x2 = x_bottomRight / mFontWidth;
     int y2 = y_bottomRight / mFontHeight;
 
+    // Everything has to be rewrapped if the width it is wrapped to has changed:
+    if (wrapColumns() != mLastRenderedWrapColumns || wrapIndent() != mLastRenderedWrapIndent) {
+        mForceUpdate = true;
+    }
+    // The screen is laid out afresh once for each paint, anything else that
+    // needs it until the next one uses that unless something changes:
+    mScreenRowsDirty = true;
+
     int lineOffset = imageTopLine();
     int from = 0;
     if (lineOffset == 0) {
         mScrollVector = 0;
     } else {
-        // Was: mScrollVector = lineOffset - mLastRenderedOffset;
-        if (mLastRenderedOffset) {
-            mScrollVector = lineOffset - mLastRenderedOffset;
-        } else {
-            mScrollVector = y2 + lineOffset;
-        }
+        mScrollVector = scrolledRows();
     }
 
     bool noScroll = false;
@@ -934,6 +1478,11 @@ void TTextEdit::drawForeground(QPainter& painter, const QRect& r)
             screenPixmap = mScreenMap.copy(0, mScrollVector * mFontHeight * dpr, mScreenWidth * mFontWidth * dpr, (mScreenHeight - mScrollVector) * mFontHeight * dpr);
             p.drawPixmap(0, 0, screenPixmap);
             from = mScreenHeight - mScrollVector - 1;
+            // The line that was at the bottom may have had more put on the
+            // end of it, so all of its rows have to be redrawn:
+            while (from > 0 && from < static_cast<int>(mScreenRows.size()) && mScreenRows.at(from).mRow > 0) {
+                --from;
+            }
         }
     } else if ((!noScroll) && (mScrollVector < 0 && mScrollVector >= ((-1) * mScreenHeight)) && (!mForceUpdate)) {
         if (abs(mScrollVector) * mFontHeight < mScreenMap.height() && mScreenWidth * mFontWidth <= mScreenMap.width() && (mScreenHeight - abs(mScrollVector)) * mFontHeight > 0
@@ -953,10 +1502,10 @@ void TTextEdit::drawForeground(QPainter& painter, const QRect& r)
 
     p.setCompositionMode(QPainter::CompositionMode_SourceOver);
     for (int i = from; i <= y2; ++i) {
-        if (static_cast<int>(mpBuffer->buffer.size()) <= i + lineOffset) {
+        if (static_cast<int>(mScreenRows.size()) <= i) {
             break;
         }
-        drawLine(p, i + lineOffset, i, &mScreenOffset);
+        drawLine(p, mScreenRows.at(i).mLine, i, mScreenRows.at(i).mRow, &mScreenOffset);
     }
     calculateHMaxRange();
     if (Q_UNLIKELY(mpConsole->mHScrollBarEnabled && mpConsole->mpHScrollBar)) {
@@ -970,7 +1519,9 @@ void TTextEdit::drawForeground(QPainter& painter, const QRect& r)
         mScreenMap = pixmap.copy();
     }
     mScrollVector = 0;
-    mLastRenderedOffset = lineOffset;
+    mLastScreenRows = mScreenRows;
+    mLastRenderedWrapColumns = wrapColumns();
+    mLastRenderedWrapIndent = wrapIndent();
     mForceUpdate = false;
 }
 
@@ -1011,36 +1562,16 @@ void TTextEdit::highlightSelection()
 {
     QRegion newRegion;
 
-    int lineDelta = abs(mPA.y() - mPB.y()) - 1;
-    if (lineDelta > 0) {
-        QRect rectFirstLine(mPA.x() * mFontWidth, (mPA.y() - imageTopLine()) * mFontHeight, mScreenWidth * mFontWidth, mFontHeight);
-        newRegion += rectFirstLine;
-
-        QRect rectMiddlePart(0, (mPA.y() + 1 - imageTopLine()) * mFontHeight, mScreenWidth * mFontWidth, lineDelta * mFontHeight);
-        newRegion += rectMiddlePart;
-
-        QRect rectLastLine(0, (mPB.y() - imageTopLine()) * mFontHeight, mPB.x() * mFontWidth, mFontHeight);
-        newRegion += rectLastLine;
-    }
-
-    if (lineDelta == 0) {
-        QRect rectFirstLine(mPA.x() * mFontWidth, (mPA.y() - imageTopLine()) * mFontHeight, mScreenWidth * mFontWidth, mFontHeight);
-        newRegion += rectFirstLine;
-
-        QRect rectLastLine(0, (mPB.y() - imageTopLine()) * mFontHeight, mPB.x() * mFontWidth, mFontHeight);
-        newRegion += rectLastLine;
-    }
-
-    if (lineDelta < 0) {
-        QRect rectFirstLine(mPA.x() * mFontWidth, (mPA.y() - imageTopLine()) * mFontHeight, std::max(mPB.x() - mPA.x(), 1) * mFontWidth, mFontHeight);
-        newRegion += rectFirstLine;
+    // The lines may be wrapped over several rows so every row of the screen
+    // that any of the selected lines are on is covered:
+    layoutScreen();
+    for (int i = 0, total = mScreenRows.size(); i < total; ++i) {
+        if (mScreenRows.at(i).mLine >= mPA.y() && mScreenRows.at(i).mLine <= mPB.y()) {
+            newRegion += QRect(0, i * mFontHeight, mScreenWidth * mFontWidth, mFontHeight);
+        }
     }
 
-    QRect _r = mSelectedRegion.boundingRect();
-    if (lineDelta < 0) {
-        _r.setWidth(mScreenWidth * mFontWidth);
-    }
-    update(_r);
+    update(mSelectedRegion.boundingRect());
 
     mSelectedRegion = mSelectedRegion.subtracted(newRegion);
 
@@ -1184,8 +1715,9 @@ void TTextEdit::mouseMoveEvent(QMouseEvent* event)
 #else
     auto eventPos = event->position().toPoint();
 #endif
-    int lineIndex = std::max(0, (eventPos.y() / mFontHeight) + imageTopLine());
-    int tCharIndex = convertMouseXToBufferX(eventPos.x(), lineIndex, &isOutOfbounds);
+    const ScreenRow screenRow = screenRowAt(eventPos.y());
+    int lineIndex = screenRow.mLine;
+    int tCharIndex = convertMouseXToBufferX(eventPos.x(), lineIndex, screenRow.mRow, &isOutOfbounds);
 
     updateTextCursor(event, lineIndex, tCharIndex, isOutOfbounds);
 
@@ -1282,84 +1814,58 @@ void TTextEdit::updateTextCursor(const QMouseEvent* event, int lineIndex, int tC
 }
 
 // Returns the index into the relevant TBuffer::lineBuffer of the FIRST QChar
-// of the grapheme under the mouse - it ALSO returns zero (which will probably
+// of the grapheme under the mouse on the given row of the wrapped line (or
+// of the whole line for row -1) - it ALSO returns zero (which will probably
 // NOT be a valid index) if there is no valid index to return.
 // If a pointer to a boolean is provided as a third argument then it will
 // be set to true if the mouse is positioned over a visible time stamp
 // and left unchanged otherwise.
-int TTextEdit::convertMouseXToBufferX(const int mouseX, const int lineNumber, bool* isOutOfbounds, bool* isOverTimeStamp) const
+int TTextEdit::convertMouseXToBufferX(const int mouseX, const int lineNumber, const int wrappedRow, bool* isOutOfbounds, bool* isOverTimeStamp) const
 {
     if (lineNumber >= 0 && lineNumber < mpBuffer->lineBuffer.size()) {
         // Line number is (should be) within range of lines in the
         // TBuffer::lineBuffer - might need to check that this still works after
         // that buffer has reached the limit when it starts to have the
         // beginning lines deleted!
+        const LineLayout& layout = cachedLineLayout(lineNumber, mpBuffer->lineBuffer.at(lineNumber));
+        const auto [begin, end] = rowGraphemes(layout, wrappedRow);
+
+        // Do an additional check if we need to establish whether we are
+        // over just the timestamp part of the line:
+        // offset will only have a value for errorwindows if they use the
+        // horizontal scrollbar (for now):
+        if (Q_UNLIKELY(isOverTimeStamp && mShowTimeStamps && !layout.mGraphemes.isEmpty())) {
+            if ((mouseX + mCursorX * mFontWidth) < (mTimeStampWidth * mFontWidth)) {
+                // The mouse position is actually over the timestamp region
+                // to the left of the main text:
+                *isOverTimeStamp = true;
+            }
+        }
 
-        // offset will only have a value for errorwindows if they use the horizontal scrollbar (for now)
-        int offset = mCursorX * mFontWidth;
-        // Count of "normal" width equivalent characters - we will multiply that
-        // by the average character width to determine whether the mouse is over
-        // a particular grapheme:
-        int column = 0;
+        // How far, in columns, the graphemes in this row are drawn to the
+        // right of where they would be in an unwrapped line - mCursorX is
+        // relevant for horizontal scrollbars, otherwise the value is always 0:
+        const int rowIndent = (wrappedRow > 0) ? layout.mRowsIndent : 0;
+        const int shift = (mShowTimeStamps ? mTimeStampWidth : 0) - mCursorX + rowIndent - (begin < end ? layout.mGraphemes.at(begin).mColumn : 0);
         // These are the calculated horizontal limits in pixels from the left
         // for the current grapheme being considered in the line:
         int leftX = 0;
         int rightX = 0;
-        QString lineText = mpBuffer->lineBuffer.at(lineNumber);
-        // QStringList debugText;
-        QTextBoundaryFinder boundaryFinder(QTextBoundaryFinder::Grapheme, lineText);
         int indexOfLastChar = 0;
-        for (int indexOfChar = 0, total = lineText.size(); indexOfChar < total;) {
-            int nextBoundary = boundaryFinder.toNextBoundary();
-            // Width in "normal" width characters equivalent of this grapheme:
-            int charWidth = 0;
-            // This could contain a surrogate pair (i.e. pair of QChars) and/or
-            // include suffixed combining diacritical marks (additional QChars):
-            const QString grapheme = lineText.mid(indexOfChar, nextBoundary - indexOfChar);
-            const uint unicode = getGraphemeBaseCharacter(grapheme);
-            if (unicode == '\t') {
-                charWidth = mTabStopwidth - (column % mTabStopwidth);
-            } else {
-                auto reportedWidth = getGraphemeWidth(unicode);
-                // The paint code is set to use a replacement character for a
-                // zero return value - so handle the space that will need)
-                charWidth = (reportedWidth ? reportedWidth : 1);
-            }
-            column += charWidth;
-
-            // Do an additional check if we need to establish whether we are
-            // over just the timestamp part of the line:
-            if (Q_UNLIKELY(isOverTimeStamp && mShowTimeStamps && indexOfChar == 0)) {
-                if ((mouseX + offset) < (mTimeStampWidth * mFontWidth)) {
-                    // The mouse position is actually over the timestamp region
-                    // to the left of the main text:
-                    *isOverTimeStamp = true;
-                }
+        for (int index = begin; index < end; ++index) {
+            const GraphemeLayout& grapheme = layout.mGraphemes.at(index);
+            if (!grapheme.mWidth) {
+                continue;
             }
 
             leftX = rightX;
-            //mCursorX relevant for horizontal scrollbars
-            //Otherwise the value is always 0
-            if (mShowTimeStamps) {
-                rightX = (mTimeStampWidth + column - mCursorX) * mFontWidth;
-            } else {
-                rightX = (column - mCursorX) * mFontWidth;
-            }
-
-            // Format of display "[index of FIRST QChar in grapheme|leftX]grapheme[rightX|index of LAST QChar in grapheme (may be same as FIRST)]" ...
-            // debugText << qsl("[%1|%2]%3[%4|%5]").arg(QString::number(indexOfChar), QString::number(leftX), grapheme, QString::number(rightX - 1), QString::number(nextBoundary - 1));
+            rightX = (grapheme.mColumn + grapheme.mWidth + shift) * mFontWidth;
             if (leftX <= mouseX && mouseX < rightX) {
-                // qDebug().nospace().noquote() << "TTextEdit::convertMouseXToBufferX(" << mouseX << ", " << lineNumber << ") INFO - returning: " << std::max(0, indexOfChar) << " reckoning cursor is over the last grapheme within the calculated limits of:\n" << debugText.join(QString());
-                return std::max(0, indexOfChar);
-            }
-            if (nextBoundary >= 0) {
-                // nextBoundary will be -1 at end of line and we do not want THAT:
-                indexOfLastChar = indexOfChar;
+                return std::max(0, grapheme.mIndex);
             }
-            indexOfChar = nextBoundary;
+            indexOfLastChar = grapheme.mIndex;
         }
 
-        //        qDebug().nospace().noquote() << "TTextEdit::convertMouseXToBufferX(" << mouseX << ", " << lineNumber << ") INFO - falling out of bottom of for loop and returning: " << indexOfLastChar << " !";
         *isOutOfbounds = true;
         return std::max(0, indexOfLastChar);
     }
@@ -1411,7 +1917,8 @@ void TTextEdit::mousePressEvent(QMouseEvent* event)
     }
 
     if (event->button() == Qt::LeftButton) {
-        int y = (eventPos.y() / mFontHeight) + imageTopLine();
+        const ScreenRow screenRow = screenRowAt(eventPos.y());
+        int y = screenRow.mLine;
         int x = 0;
         y = std::max(y, 0);
 
@@ -1422,14 +1929,14 @@ void TTextEdit::mousePressEvent(QMouseEvent* event)
         bool isOutOfbounds = false;
         if (!mCtrlSelecting && mShowTimeStamps) {
             bool isOverTimeStamp = false;
-            x = convertMouseXToBufferX(eventPos.x(), y, &isOutOfbounds, &isOverTimeStamp);
+            x = convertMouseXToBufferX(eventPos.x(), y, screenRow.mRow, &isOutOfbounds, &isOverTimeStamp);
             if (isOverTimeStamp) {
                 // If we have clicked on the timestamp then emulate the effect
                 // of control clicking - i.e. select the WHOLE line:
                 mCtrlSelecting = true;
             }
         } else {
-            x = convertMouseXToBufferX(eventPos.x(), y, &isOutOfbounds);
+            x = convertMouseXToBufferX(eventPos.x(), y, screenRow.mRow, &isOutOfbounds);
         }
 
         if (mCtrlSelecting) {
@@ -1798,7 +2305,7 @@ std::pair<bool, int> TTextEdit::drawTextForClipboard(QPainter& painter, QRect re
         if (static_cast<int>(mpBuffer->buffer.size()) <= i + lineOffset) {
             break;
         }
-        drawLine(painter, i + lineOffset, i);
+        drawLine(painter, i + lineOffset, i, -1, nullptr, false);
 
         if (std::chrono::duration_cast<std::chrono::seconds>(std::chrono::high_resolution_clock::now() - mCopyImageStartTime).count() >= timeout) {
             qDebug().nospace() << "timeout for image copy (" << timeout << "s) reached, managed to draw " << i << " lines";
@@ -1861,11 +2368,9 @@ QString TTextEdit::getSelectedText(const QChar& newlineChar, const bool showTime
     }
 
     if (showTimestamps) {
-        QStringList timestamps = mpBuffer->timeBuffer.mid(startLine, endLine - startLine + 1);
-        QStringList result;
-        std::transform(textLines.cbegin(), textLines.cend(), timestamps.cbegin(), std::back_inserter(result),
-                               [](const QString& text, const QString& timestamp) { return timestamp + text; });
-        textLines = result;
+        for (int i = 0, total = textLines.size(); i < total; ++i) {
+            textLines[i].prepend(mpBuffer->timeStamp(startLine + i));
+        }
     }
 
     return textLines.join(newlineChar);
@@ -1885,10 +2390,11 @@ void TTextEdit::mouseReleaseEvent(QMouseEvent* event)
         mCtrlSelecting = false;
     }
     if (event->button() == Qt::RightButton) {
-        int y = (eventPos.y() / mFontHeight) + imageTopLine();
+        const ScreenRow screenRow = screenRowAt(eventPos.y());
+        int y = screenRow.mLine;
         y = std::max(y, 0);
         bool isOutOfbounds = false;
-        int x = convertMouseXToBufferX(eventPos.x(), y, &isOutOfbounds);
+        int x = convertMouseXToBufferX(eventPos.x(), y, screenRow.mRow, &isOutOfbounds);
 
         if (y < static_cast<int>(mpBuffer->buffer.size())) {
             if (x < static_cast<int>(mpBuffer->buffer.at(static_cast<size_t>(y)).size()) && !isOutOfbounds) {
@@ -2127,68 +2633,14 @@ void TTextEdit::wheelEvent(QWheelEvent* e)
     e->setAccepted(used);
 }
 
+// The line that the top row of the screen is part of:
 int TTextEdit::imageTopLine()
 {
-    if (!mIsLowerPane) {
-        mCursorY = mpBuffer->mCursorY;
-    }
-
-    if (mCursorY > mScreenHeight) {
-        // mIsTailMode is always true for lower pane and true for upper one when
-        // it is scrolled to the bottom and new text is to be appended and the
-        // older text is to scroll up:
-        if (mIsTailMode && (mpBuffer->lineBuffer.at(mpBuffer->getLastLineNumber()).isEmpty())) {
-            return mCursorY - mScreenHeight - 1;
-        }
-
-        return mCursorY - mScreenHeight;
-    } else {
-        return 0;
-    }
+    layoutScreen();
+    return mScreenRows.empty() ? 0 : mScreenRows.front().mLine;
 }
 
 
-// This should only be used on the upper pane:
-int TTextEdit::bufferScrollDown(int lines)
-{
-    if ((mpBuffer->mCursorY + lines) < static_cast<int>(mpBuffer->size())) {
-        if (mpBuffer->mCursorY < mScreenHeight) {
-            mpBuffer->mCursorY = mScreenHeight + lines;
-            if (mpBuffer->mCursorY > static_cast<int>(mpBuffer->size() - 1)) {
-                mpBuffer->mCursorY = mpBuffer->lineBuffer.size();
-                mIsTailMode = true;
-            }
-
-        } else {
-            mpBuffer->mCursorY += lines;
-            mIsTailMode = false;
-        }
-        return lines;
-
-    } else if (mpBuffer->mCursorY >= static_cast<int>(mpBuffer->size() - 1)) {
-        mIsTailMode = true;
-        mpBuffer->mCursorY = mpBuffer->lineBuffer.size();
-        forceUpdate();
-        return 0;
-
-    } else {
-        lines = static_cast<int>(mpBuffer->size() - 1) - mpBuffer->mCursorY;
-        if (mpBuffer->mCursorY + lines < mScreenHeight + lines) {
-            mpBuffer->mCursorY = mScreenHeight + lines;
-            if (mpBuffer->mCursorY > static_cast<int>(mpBuffer->size() - 1)) {
-                mpBuffer->mCursorY = static_cast<int>(mpBuffer->size() - 1);
-                mIsTailMode = true;
-            }
-
-        } else {
-            mpBuffer->mCursorY += lines;
-            mIsTailMode = false;
-        }
-
-        return lines;
-    }
-}
-
 int TTextEdit::getColumnCount()
 {
     int charWidth;
@@ -2802,6 +3254,7 @@ void TTextEdit::slot_changeIsAmbigousWidthGlyphsToBeWide(const bool state)
 {
     if (mWideAmbigousWidthGlyphs != state) {
         mWideAmbigousWidthGlyphs = state;
+        mLineLayouts.clear();
         update();
     }
 }
@@ -2899,11 +3352,14 @@ void TTextEdit::initializeCaret()
 void TTextEdit::updateCaret()
 {
     int lineOffset = imageTopLine();
+    // The lines are wrapped so the screen may show fewer of them than it has
+    // rows:
+    int lastLine = mScreenRows.empty() ? lineOffset + mScreenHeight - 1 : mScreenRows.back().mLine;
 
     if (!mIsLowerPane) {
         if (mCaretLine < lineOffset) {
             scrollTo(mCaretLine + 1);
-        } else if (mCaretLine >= lineOffset + mScreenHeight) {
+        } else if (mCaretLine > lastLine) {
             int emptyLastLine = mpBuffer->lineBuffer.last().isEmpty();
             if (mCaretLine == mpBuffer->lineBuffer.length() - 1 - emptyLastLine) {
                 scrollTo(mCaretLine + 2);
@@ -38,7 +38,10 @@
 #include <chrono>
 #include "post_guard.h"
 
+#include <deque>
 #include <string>
+#include <utility>
+#include <vector>
 
 class Host;
 class TConsole;
@@ -61,16 +64,25 @@ public:
     void contextMenuEvent(QContextMenuEvent* event) override;
     void drawForeground(QPainter&, const QRect&);
     uint getGraphemeBaseCharacter(const QString& str) const;
-    void drawLine(QPainter& painter, int lineNumber, int rowOfScreen, int *offset = nullptr) const;
-    int drawGraphemeBackground(QPainter&, QVector<QColor>&, QVector<QRect>&, QVector<QString>&, QVector<int>&, QPoint&, const QString&, const int, const int, TChar&) const;
+    // Draws the given row of the line as wrapped to fit the screen, or all of
+    // it on one row if that is -1:
+    void drawLine(QPainter& painter, int lineNumber, int rowOfScreen, int wrappedRow = -1, int *offset = nullptr, const bool useLayoutCache = true) const;
     void drawGraphemeForeground(QPainter&, const QColor&, const QRect&, const QString&, TChar &) const;
     void showNewLines();
     void forceUpdate();
     void needUpdate(int, int);
-    void scrollTo(int);
+    // Puts the given row of the line before the given one at the bottom of the
+    // screen, -1 being its last row:
+    void scrollTo(int line, int row = -1);
     void scrollH(int);
-    void scrollUp(int lines);
-    void scrollDown(int lines);
+    // These move by rows of the screen, not lines of the buffer:
+    void scrollUp(int rows);
+    void scrollDown(int rows);
+    // How many rows the screen has to be scrolled up by for the given line to
+    // be the first one below it - negative if it has to go down:
+    int rowsUpToLine(const int line);
+    // How many rows of text there are below the bottom of the screen:
+    int rowsBelowScreen();
     void wheelEvent(QWheelEvent* e) override;
     void resizeEvent(QResizeEvent* event) override;
     void mousePressEvent(QMouseEvent*) override;
@@ -78,14 +90,13 @@ public:
     void mouseMoveEvent(QMouseEvent*) override;
     void showEvent(QShowEvent* event) override;
     void updateScreenView();
-    void updateScrollBar(int);
+    void updateScrollBar();
     void calculateHMaxRange();
     void updateHorizontalScrollBar();
     void highlightSelection();
     void unHighlight();
     void focusInEvent(QFocusEvent* event) override;
     int imageTopLine();
-    int bufferScrollDown(int lines);
 // Not used:    void setConsoleFgColor(int r, int g, int b) { mFgColor = QColor(r, g, b); }
     void setConsoleBgColor(int r, int g, int b, int a ) { mBgColor = QColor(r, g, b, a); }
     void resetHScrollbar() { mScreenOffset = 0; mMaxHRange = 0; }
@@ -106,6 +117,12 @@ public:
     // position of cursor, in characters, across the entire buffer
     int mCursorY;
     int mCursorX;
+    // Which row of the line before mpBuffer->mCursorY is at the bottom of the
+    // (upper pane's) screen when it is scrolled up, -1 for its last one - only
+    // used while mpBuffer->mCursorY is still mCursorRowLine, so that anything
+    // else that scrolls by setting that puts the whole line at the bottom:
+    int mCursorRow = -1;
+    int mCursorRowLine = -1;
 
     // Position of "caret", the cursor used for accessibility purposes.
     int mCaretLine;
@@ -165,8 +182,88 @@ private:
     static QString htmlCenter(const QString&);
     static QString convertWhitespaceToVisual(const QChar& first, const QChar& second = QChar::Null);
     static QString byteToLuaCodeOrChar(const char*);
+    // What drawLine(...) needs to know about each grapheme of a line that only
+    // depends on the text of the line and not how it is formatted:
+    struct GraphemeLayout
+    {
+        // Index of the first QChar of the grapheme in the line:
+        int mIndex = 0;
+        // Column, not counting any timestamp, where it starts:
+        int mColumn = 0;
+        // In columns, zero for ones that are not drawn:
+        int mWidth = 0;
+        // A single printable ASCII character that can be drawn along with its
+        // neighbours in one go - in which case mText is left empty as the
+        // character is taken from the line instead:
+        bool mIsAscii = false;
+        // What to draw, with control characters replaced as configured:
+        QString mText;
+    };
+    struct LineLayout
+    {
+        // Shares the data of the buffer line it was made from - so a
+        // different data pointer means that line has changed since:
+        QString mLineText;
+        QVector<GraphemeLayout> mGraphemes;
+        // Where each row starts, as indexes into mGraphemes, when the line is
+        // wrapped to fit in mRowsWidth columns with the rows after the first
+        // indented by mRowsIndent - the first is always zero:
+        QVector<int> mRowStarts;
+        int mRowsWidth = 0;
+        int mRowsIndent = 0;
+    };
+    // The part of a line of the buffer that is shown on a row of the screen:
+    struct ScreenRow
+    {
+        int mLine = 0;
+        // Which of the rows the line is wrapped into:
+        int mRow = 0;
+    };
+    // What mScreenRows was worked out for - if any of this changes it has to
+    // be worked out again:
+    struct ScreenLayoutKey
+    {
+        int mCursorY = -1;
+        int mCursorRow = -1;
+        int mLineCount = -1;
+        qint64 mFirstLineId = -1;
+        int mLastLineLength = -1;
+        int mWrapColumns = -1;
+        int mWrapIndent = -1;
+        int mScreenHeight = -1;
+        bool mIsTailMode = false;
+
+        bool operator==(const ScreenLayoutKey& other) const
+        {
+            return mCursorY == other.mCursorY && mCursorRow == other.mCursorRow && mLineCount == other.mLineCount && mFirstLineId == other.mFirstLineId && mLastLineLength == other.mLastLineLength
+                   && mWrapColumns == other.mWrapColumns && mWrapIndent == other.mWrapIndent && mScreenHeight == other.mScreenHeight && mIsTailMode == other.mIsTailMode;
+        }
+    };
+
     std::pair<bool, int> drawTextForClipboard(QPainter& p, QRect r, int lineOffset) const;
-    int convertMouseXToBufferX(const int mouseX, const int lineNumber, bool *isOutOfbounds, bool *isOverTimeStamp = nullptr) const;
+    void layoutLine(const QString& lineText, LineLayout& layout) const;
+    const LineLayout& cachedLineLayout(const int lineNumber, const QString& lineText) const;
+    void wrapLineLayout(LineLayout& layout) const;
+    std::pair<int, int> rowGraphemes(const LineLayout& layout, const int wrappedRow) const;
+    int wrapColumns() const;
+    int wrapIndent() const;
+    void layoutScreen();
+    void buildScreenRows();
+    int cursorRow() const;
+    int lineRowCount(const QString& lineText) const;
+    void updateLineRowCounts() const;
+    int rowCountTotal() const;
+    int rowsBeforeLine(const int line) const;
+    int bottomRowIndex() const;
+    std::pair<int, int> positionOfRow(const int index) const;
+    void setBottomRow(const int index);
+    ScreenRow screenRowAt(const int y);
+    int scrolledRows() const;
+    bool isLineOnScreen(const int lineNumber);
+    QPoint screenPosition(const int lineNumber, const int index);
+    bool canDrawTextRuns(const QFont&) const;
+    int graphemeLayout(const QString& grapheme, const int column, QVector<QString>& graphemes) const;
+    int convertMouseXToBufferX(const int mouseX, const int lineNumber, const int wrappedRow, bool *isOutOfbounds, bool *isOverTimeStamp = nullptr) const;
     int getGraphemeWidth(uint unicode) const;
     void normaliseSelection();
     void updateTextCursor(const QMouseEvent* event, int lineIndex, int tCharIndex, bool isOutOfbounds);
@@ -189,8 +286,10 @@ private:
     // or reset on creation and is used to adjust the behaviour depending on
     // which one this instance is:
     const bool mIsLowerPane;
-    // last line offset rendered
-    int mLastRenderedOffset;
+    // What was on each row of the screen when it was last drawn:
+    std::vector<ScreenRow> mLastScreenRows;
+    int mLastRenderedWrapColumns = 0;
+    int mLastRenderedWrapIndent = 0;
     bool mMouseTracking;
     // 1/2/3 for single/double/triple click seen so far
     int  mMouseTrackLevel;
@@ -236,6 +335,42 @@ private:
     mutable QHash<uint, std::tuple<uint, std::string>> mProblemCodepoints;
 #endif
 
+    // Layouts of recently drawn lines, keyed by line number; they are checked
+    // against the buffer before use and are all dropped if the settings that
+    // affect them change:
+    mutable QHash<int, LineLayout> mLineLayouts;
+    mutable int mLineLayoutsControlCharacterMode = -1;
+    // What is on each row of the screen, worked out (by layoutScreen()) from
+    // the line at the bottom of it upwards, wrapping only the lines that
+    // appear - so when the width changes only these need wrapping again:
+    std::vector<ScreenRow> mScreenRows;
+    ScreenLayoutKey mScreenLayoutKey;
+    // Set when the text of the buffer may have changed in a way that the key
+    // does not show, e.g. a line in the middle being replaced:
+    bool mScreenRowsDirty = true;
+    // How many rows each line of the buffer wraps into, for the scroll bar
+    // and for scrolling by rows - like the layouts each holds a copy of the
+    // text it was worked out from, to spot the lines that have changed:
+    struct LineRowCount
+    {
+        QString mLineText;
+        int mRows = 1;
+    };
+    mutable std::deque<LineRowCount> mLineRowCounts;
+    // The id of the buffer line that the first one is for, and what they
+    // were all worked out for:
+    mutable qint64 mLineRowCountsFirstId = 0;
+    mutable int mLineRowCountsColumns = -1;
+    mutable int mLineRowCountsIndent = -1;
+    mutable int mLineRowCountsControlCharacterMode = -1;
+    mutable int mTotalRows = 0;
+    // Whether every printable ASCII character in mTextRunsFont (and its bold
+    // and italic variants) is exactly mFontWidth wide, so that a run of them
+    // lines up with the character grid when drawn as one string:
+    mutable QFont mTextRunsFont;
+    mutable int mTextRunsFontWidth = 0;
+    mutable bool mCanDrawTextRuns = false;
+
     // We scroll on the basis that one vertical mouse wheel click is one line
     // (vertically, not really concerned about horizontal stuff at present).
     // According to Qt: "Most mouse types work in steps of 15 degrees, in which
@@ -28,18 +28,10 @@
 #include "TDebug.h"
 #include "mudlet.h"
 
-const char* TTimer::scmProperty_HostName = "HostName";
-const char* TTimer::scmProperty_TTimerId = "TTimerId";
-
 TTimer::TTimer(TTimer* parent, Host* pHost)
 : Tree<TTimer>(parent)
 , mpHost(pHost)
-, mpQTimer(new QTimer)
 {
-    mpQTimer->stop();
-    mpQTimer->setProperty(scmProperty_HostName, mpHost->getName());
-    mpHost->getTimerUnit()->mQTimerSet.insert(mpQTimer);
-    mpQTimer->setProperty(scmProperty_TTimerId, 0);
 }
 
 TTimer::TTimer(const QString& name, QTime time, Host* pHost, bool repeating)
@@ -47,19 +39,14 @@ TTimer::TTimer(const QString& name, QTime time, Host* pHost, bool repeating)
 , mName(name)
 , mTime(time)
 , mpHost(pHost)
-, mpQTimer(new QTimer)
 {
-    mpQTimer->stop();
-    mpQTimer->setProperty(scmProperty_HostName, mpHost->getName());
-    mpHost->getTimerUnit()->mQTimerSet.insert(mpQTimer);
-    mpQTimer->setProperty(scmProperty_TTimerId, 0);
     mRepeating = repeating;
 }
 
 TTimer::~TTimer()
 {
-    mpQTimer->stop();
     if (mpHost) {
+        // This also stops it:
         mpHost->getTimerUnit()->unregisterTimer(this);
 
         if (isTemporary()) {
@@ -70,30 +57,26 @@ TTimer::~TTimer()
             }
         }
     }
-
-    mpHost->getTimerUnit()->mQTimerSet.remove(mpQTimer);
-    mpQTimer->deleteLater();
 }
 
 void TTimer::setName(const QString& name)
 {
+    setUnsaved();
     // temp timers do not need to check for names referring to multiple
     // timer objects as names=ID -> much faster tempTimer creation
     if (!isTemporary()) {
         mpHost->getTimerUnit()->mLookupTable.remove(mName, this);
     }
     mName = name;
-    // Merely for information if needed later:
-    mpQTimer->setObjectName(qsl("timer(Host:%1)(TTimerId:%2)").arg(mpHost->getName(), name));
     mpHost->getTimerUnit()->mLookupTable.insert(name, this);
 }
 
 void TTimer::setTime(QTime time)
 {
+    setUnsaved();
     // Stop the timer before doing anything else:
-    mpQTimer->stop();
+    stop();
     mTime = time;
-    mpQTimer->setInterval(time.msecsSinceStartOfDay());
 }
 
 bool TTimer::setIsActive(bool b)
@@ -111,11 +94,9 @@ bool TTimer::setIsActive(bool b)
 
 void TTimer::start()
 {
-    // temporary repeating timers are still singleshot not to change the design too much
-    mpQTimer->setSingleShot(isTemporary());
-
     if (!isFolder()) {
-        mpQTimer->start();
+        // temporary repeating timers are still singleshot not to change the design too much
+        mpHost->getTimerUnit()->scheduler().start(this, mTime.msecsSinceStartOfDay(), isTemporary());
     } else {
         stop();
     }
@@ -123,7 +104,7 @@ void TTimer::start()
 
 void TTimer::stop()
 {
-    mpQTimer->stop();
+    mpHost->getTimerUnit()->scheduler().stop(this);
 }
 
 void TTimer::compile()
@@ -157,6 +138,7 @@ void TTimer::compileAll()
 
 bool TTimer::setScript(const QString& script)
 {
+    setUnsaved();
     mScript = script;
     if (script == "") {
         mNeedsToBeCompiled = false;
@@ -191,8 +173,9 @@ bool TTimer::checkRestart()
 
 void TTimer::execute()
 {
+    const TProfiler::Scope profile(mpHost->mProfiler, TProfiler::TimerScript, mID, mName);
     if (!isActive() || isFolder()) {
-        mpQTimer->stop();
+        stop();
         return;
     }
 
@@ -204,7 +187,7 @@ void TTimer::execute()
         }
 
         if (!mRepeating) {
-            mpQTimer->stop();
+            stop();
             mpHost->getTimerUnit()->markCleanup(this);
         }
         return;
@@ -236,7 +219,7 @@ void TTimer::execute()
 
         if (!mpHost->mLuaInterpreter.call(mFuncName, mName, (mTime < mpHost->mTimerDebugOutputSuppressionInterval))) {
 
-            mpQTimer->stop();
+            stop();
         }
     }
 }
@@ -261,11 +244,11 @@ void TTimer::enableTimer(int id)
             if (activate()) {
                 // CHECKME: Should this not also check for a non-empty "command" as well?
                 if (!mScript.isEmpty()) {
-                    mpQTimer->start();
+                    start();
                 }
             } else {
                 deactivate();
-                mpQTimer->stop();
+                stop();
             }
         }
     }
@@ -283,7 +266,7 @@ void TTimer::disableTimer(int id)
 {
     if (mID == id) {
         deactivate();
-        mpQTimer->stop();
+        stop();
     }
 
     for (auto timer : *mpMyChildrenList) {
@@ -299,11 +282,11 @@ void TTimer::enableTimer()
         if (activate()) {
             // CHECKME: Should this not also check for a non-empty "command" as well?
             if (!mScript.isEmpty()) {
-                mpQTimer->start();
+                start();
             }
         } else {
             deactivate();
-            mpQTimer->stop();
+            stop();
         }
     }
     if (!isOffsetTimer()) {
@@ -318,7 +301,7 @@ void TTimer::enableTimer()
 void TTimer::disableTimer()
 {
     deactivate();
-    mpQTimer->stop();
+    stop();
     for (auto timer : *mpMyChildrenList) {
         timer->disableTimer();
     }
@@ -330,10 +313,10 @@ void TTimer::enableTimer(const QString& name)
     if (mName == name) {
         if (canBeUnlocked()) {
             if (activate()) {
-                mpQTimer->start();
+                start();
             } else {
                 deactivate();
-                mpQTimer->stop();
+                stop();
             }
         }
     }
@@ -349,7 +332,7 @@ void TTimer::disableTimer(const QString& name)
 {
     if (mName == name) {
         deactivate();
-        mpQTimer->stop();
+        stop();
     }
 
     for (auto timer : *mpMyChildrenList) {
@@ -361,17 +344,11 @@ void TTimer::disableTimer(const QString& name)
 void TTimer::killTimer()
 {
     deactivate();
-    mpQTimer->stop();
-}
-
-void TTimer::setID(const int id)
-{
-    Tree<TTimer>::setID(id);
-    mpQTimer->setProperty(scmProperty_TTimerId, id);
+    stop();
 }
 
 int TTimer::remainingTime()
 {
-    return mpQTimer->remainingTime();
+    return mpHost->getTimerUnit()->scheduler().remainingTime(this);
 }
 
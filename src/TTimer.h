@@ -34,8 +34,6 @@
 
 class Host;
 
-class QTimer;
-
 
 class TTimer : public Tree<TTimer>
 {
@@ -57,7 +55,7 @@ public:
     void execute();
     void setTime(QTime time);
     const QString& getCommand() const { return mCommand; }
-    void setCommand(const QString& cmd) { mCommand = cmd; }
+    void setCommand(const QString& cmd) { mCommand = cmd; setUnsaved(); }
     const QString& getScript() const { return mScript; }
     bool setScript(const QString& script);
     bool canBeUnlocked();
@@ -95,11 +93,6 @@ public:
     }
 
     QPointer<Host> getHost() { return mpHost; }
-    QTimer* getQTimer() { return mpQTimer; }
-    // Override the Tree version as we need to insert the id number as a
-    // property into the QTimer that mpQTimer points to as well:
-    void setID(int) override;
-
 
     // specifies whenever the payload is Lua code as a string
     // or a function
@@ -107,9 +100,6 @@ public:
     bool exportItem = true;
     bool mModuleMasterFolder = false;
 
-    static const char* scmProperty_HostName;
-    static const char* scmProperty_TTimerId;
-
     // temporary timers are single-shot by default, unless repeating is set
     bool mRepeating = false;
 
@@ -122,7 +112,6 @@ private:
     QString mFuncName;
     QPointer<Host> mpHost;
     bool mNeedsToBeCompiled = true;
-    QTimer* mpQTimer;
     bool mModuleMember = false;
 };
 
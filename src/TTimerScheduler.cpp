@@ -0,0 +1,161 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include "TTimerScheduler.h"
+
+#include <algorithm>
+
+
+TTimerScheduler::TTimerScheduler(std::function<void(TTimer*)> fire)
+: mFire(std::move(fire))
+{
+    // As there is only the one QTimer it might as well be an accurate one:
+    mQTimer.setTimerType(Qt::PreciseTimer);
+    mQTimer.setSingleShot(true);
+    connect(&mQTimer, &QTimer::timeout, this, &TTimerScheduler::slot_dispatch);
+    mClock.start();
+}
+
+void TTimerScheduler::start(TTimer* pTimer, const int interval, const bool singleShot)
+{
+    Running& running = mRunning[pTimer];
+    running.mInterval = qMax(0, interval);
+    running.mSingleShot = singleShot;
+    running.mDeadline = mClock.elapsed() + running.mInterval;
+    schedule(pTimer, running);
+    if (mArmedDeadline < 0 || running.mDeadline < mArmedDeadline) {
+        rearm();
+    }
+}
+
+void TTimerScheduler::stop(TTimer* pTimer)
+{
+    // Any entry for it in the heap is now stale - and will be dropped when it
+    // gets to the top:
+    mRunning.remove(pTimer);
+}
+
+void TTimerScheduler::clear()
+{
+    mQTimer.stop();
+    mArmedDeadline = -1;
+    mRunning.clear();
+    mHeap.clear();
+}
+
+int TTimerScheduler::remainingTime(TTimer* pTimer) const
+{
+    auto it = mRunning.constFind(pTimer);
+    if (it == mRunning.cend()) {
+        return -1;
+    }
+    return static_cast<int>(qMax(0LL, static_cast<long long>(it->mDeadline - mClock.elapsed())));
+}
+
+void TTimerScheduler::schedule(TTimer* pTimer, Running& running)
+{
+    running.mSequence = mNextSequence++;
+    mHeap.push_back({running.mDeadline, running.mSequence, pTimer});
+    std::push_heap(mHeap.begin(), mHeap.end());
+
+    // Timers that keep getting restarted before they go off leave a trail of
+    // stale entries behind them, so clear them out once they outnumber the
+    // live ones:
+    if (mHeap.size() > 2 * static_cast<size_t>(mRunning.size()) + 64) {
+        mHeap.erase(std::remove_if(mHeap.begin(), mHeap.end(), [this](const Pending& pending) { return isStale(pending); }), mHeap.end());
+        std::make_heap(mHeap.begin(), mHeap.end());
+    }
+}
+
+bool TTimerScheduler::isStale(const Pending& pending) const
+{
+    auto it = mRunning.constFind(pending.mpTimer);
+    return it == mRunning.cend() || it->mSequence != pending.mSequence;
+}
+
+void TTimerScheduler::dropStaleEntries()
+{
+    while (!mHeap.empty() && isStale(mHeap.front())) {
+        std::pop_heap(mHeap.begin(), mHeap.end());
+        mHeap.pop_back();
+    }
+}
+
+void TTimerScheduler::rearm()
+{
+    dropStaleEntries();
+    if (mHeap.empty()) {
+        mQTimer.stop();
+        mArmedDeadline = -1;
+        return;
+    }
+
+    const qint64 deadline = mHeap.front().mDeadline;
+    if (deadline == mArmedDeadline && mQTimer.isActive()) {
+        return;
+    }
+
+    mArmedDeadline = deadline;
+    mQTimer.start(static_cast<int>(qMax(0LL, static_cast<long long>(deadline - mClock.elapsed()))));
+}
+
+void TTimerScheduler::slot_dispatch()
+{
+    mArmedDeadline = -1;
+    const qint64 now = mClock.elapsed();
+    // Anything (re)started by the timers fired in this pass waits for the
+    // next one, even if it is already due, so that a repeating timer with a
+    // zero interval cannot keep this going forever:
+    const quint64 firstNewSequence = mNextSequence;
+    bool fired = false;
+    while (!mHeap.empty()) {
+        const Pending pending = mHeap.front();
+        if (pending.mDeadline > now || pending.mSequence >= firstNewSequence) {
+            break;
+        }
+
+        std::pop_heap(mHeap.begin(), mHeap.end());
+        mHeap.pop_back();
+        // Earlier timers in this pass may have stopped or restarted this one:
+        if (isStale(pending)) {
+            continue;
+        }
+
+        auto it = mRunning.find(pending.mpTimer);
+        if (it->mSingleShot) {
+            mRunning.erase(it);
+        } else {
+            // Like a QTimer this does not try to catch up on any runs that
+            // have been missed because things were too busy:
+            it->mDeadline = qMax(it->mDeadline + it->mInterval, now);
+            schedule(pending.mpTimer, it.value());
+        }
+
+        fired = true;
+        // This can start, stop or even (indirectly) destroy any of the
+        // timers, including this one:
+        mFire(pending.mpTimer);
+    }
+
+    if (fired) {
+        ++mDispatchCount;
+    }
+    rearm();
+}
@@ -0,0 +1,113 @@
+#ifndef MUDLET_TTIMERSCHEDULER_H
+#define MUDLET_TTIMERSCHEDULER_H
+
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include "pre_guard.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QTimer>
+#include "post_guard.h"
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+class TTimer;
+
+// Runs all the TTimers of one profile from a single QTimer instead of each
+// one having a QTimer of its own. The running timers are kept in a binary
+// min-heap ordered by when they are next due and the QTimer is only ever set
+// to go off for the one at the top. When it does every timer that has become
+// due - even if that is several of them - is handed, in the order they were
+// due, to the given callback in the same pass. Stopping (or restarting) a
+// timer does not touch the heap, the entry for its previous run is just
+// skipped when it comes to the top. The TTimer pointers are only used as keys
+// here and are never dereferenced.
+class TTimerScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    Q_DISABLE_COPY(TTimerScheduler)
+    explicit TTimerScheduler(std::function<void(TTimer*)> fire);
+
+    // Like QTimer::start() this restarts a timer that is already running. A
+    // timer that is not single shot is run again every interval until it is
+    // stopped:
+    void start(TTimer* pTimer, const int interval, const bool singleShot);
+    void stop(TTimer* pTimer);
+    void clear();
+    bool isActive(TTimer* pTimer) const { return mRunning.contains(pTimer); }
+    // As for QTimer::remainingTime(): in milliseconds, zero if it is overdue
+    // and -1 if the timer is not running:
+    int remainingTime(TTimer* pTimer) const;
+    int activeCount() const { return mRunning.size(); }
+    // The number of times timers have been fired, a pass that fires several
+    // that are due at the same time only counts once:
+    quint64 dispatchCount() const { return mDispatchCount; }
+
+private slots:
+    void slot_dispatch();
+
+private:
+    struct Running
+    {
+        qint64 mDeadline = 0;
+        int mInterval = 0;
+        bool mSingleShot = true;
+        // Matches the mSequence of the one heap entry that is not stale:
+        quint64 mSequence = 0;
+    };
+
+    struct Pending
+    {
+        qint64 mDeadline;
+        // Also breaks ties so that timers due at the same time fire in the
+        // order they were started:
+        quint64 mSequence;
+        TTimer* mpTimer;
+
+        // std::push_heap(...) and friends make a max-heap:
+        bool operator<(const Pending& other) const
+        {
+            return mDeadline != other.mDeadline ? mDeadline > other.mDeadline : mSequence > other.mSequence;
+        }
+    };
+
+    void schedule(TTimer* pTimer, Running& running);
+    bool isStale(const Pending& pending) const;
+    void dropStaleEntries();
+    void rearm();
+
+    std::function<void(TTimer*)> mFire;
+    QTimer mQTimer;
+    QElapsedTimer mClock;
+    QHash<TTimer*, Running> mRunning;
+    std::vector<Pending> mHeap;
+    quint64 mNextSequence = 0;
+    quint64 mDispatchCount = 0;
+    // When the QTimer has been set to go off, or -1 if it is not running:
+    qint64 mArmedDeadline = -1;
+};
+
+#endif // MUDLET_TTIMERSCHEDULER_H
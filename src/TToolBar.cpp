@@ -89,6 +89,7 @@ void TToolBar::moveEvent(QMoveEvent* e)
     if (mRecordMove) {
         mpTAction->mPosX = e->pos().x();
         mpTAction->mPosY = e->pos().y();
+        mpTAction->setUnsaved();
     }
     e->ignore();
 }
@@ -206,6 +207,7 @@ void TToolBar::slot_pressed(const bool isChecked)
 
     if (pA->mIsPushDownButton) {
         pA->mButtonState = isChecked;
+        pA->setUnsaved();
         mpHost->mpConsole->mButtonState = (pA->mButtonState ? 2 : 1); // Was using 1 and 0 but that was wrong
     } else {
         pA->mButtonState = false;
@@ -147,6 +147,7 @@ TTrigger::~TTrigger()
 
 void TTrigger::setName(const QString& name)
 {
+    setUnsaved();
     if (!isTemporary()) {
         mpHost->getTriggerUnit()->mLookupTable.remove( mName, this );
     }
@@ -154,14 +155,10 @@ void TTrigger::setName(const QString& name)
     mpHost->getTriggerUnit()->mLookupTable.insert(name, this);
 }
 
-static void pcre_deleter(pcre* pointer)
-{
-    pcre_free(pointer);
-}
-
 //FIXME: lock if code *OR* regex doesn't compile
-bool TTrigger::setRegexCodeList(QStringList patterns, QList<int> patternKinds)
+bool TTrigger::setRegexCodeList(QStringList patterns, QList<int> patternKinds, const QHash<QByteArray, QSharedPointer<TRegex>>& precompiled)
 {
+    setUnsaved();
     patterns.replaceInStrings("\n", "");
     mPatterns.clear();
     mRegexMap.clear();
@@ -194,6 +191,7 @@ bool TTrigger::setRegexCodeList(QStringList patterns, QList<int> patternKinds)
         setError(qsl("<b><font color='blue'>%1</font></b>")
                 .arg(tr("Error: This trigger has no patterns defined, yet. Add some to activate it.")));
         mOK_init = false;
+        updatePrefilterLiterals();
         return false;
     }
 
@@ -208,14 +206,15 @@ bool TTrigger::setRegexCodeList(QStringList patterns, QList<int> patternKinds)
         mPatternKinds.append(patternKinds.at(i));
 
         if (patternKinds.at(i) == REGEX_PERL) {
-            const char* error;
+            QString error;
             const QByteArray& regexp = patterns.at(i).toUtf8();
 
             int erroffset;
 
-            // PCRE_UTF8 needed to run compile in UTF-8 mode
-            // PCRE_UCP needed for \d, \w etc. to use Unicode properties:
-            QSharedPointer<pcre> const re(pcre_compile(regexp.constData(), PCRE_UTF8 | PCRE_UCP, &error, &erroffset, nullptr), pcre_deleter);
+            QSharedPointer<TRegex> re = precompiled.value(regexp);
+            if (!re) {
+                re = TRegex::compile(regexp, mpHost->mUsePcreJit, error, erroffset);
+            }
 
             if (!re) {
                 if (mudlet::smDebugMode) {
@@ -224,11 +223,11 @@ bool TTrigger::setRegexCodeList(QStringList patterns, QList<int> patternKinds)
                 }
                 setError(qsl("<b><font color='blue'>%1</font></b>")
                          .arg(tr(R"(Error: in item %1, perl regex "%2" failed to compile, reason: "%3".)")
-                         .arg(QString::number(i + 1), QString(regexp.constData()).toHtmlEscaped(), QString(error).toHtmlEscaped())));
+                         .arg(QString::number(i + 1), QString(regexp.constData()).toHtmlEscaped(), error.toHtmlEscaped())));
                 state = false;
             } else {
                 if (mudlet::smDebugMode) {
-                    TDebug(Qt::white, Qt::darkGreen) << "[OK]: REGEX_COMPILE OK\n" >> mpHost;
+                    TDebug(Qt::white, Qt::darkGreen) << (re->isJitCompiled() ? "[OK]: REGEX_COMPILE OK (JIT)\n" : "[OK]: REGEX_COMPILE OK\n") >> mpHost;
                 }
             }
             mRegexMap[i] = re;
@@ -283,14 +282,64 @@ bool TTrigger::setRegexCodeList(QStringList patterns, QList<int> patternKinds)
     }
 
     mOK_init = state;
+    updatePrefilterLiterals();
     return state;
 }
 
-bool TTrigger::match_perl(char* haystackC, const QString& haystack, int patternNumber, int posOffset)
+void TTrigger::updatePrefilterLiterals()
+{
+    mPrefilterLiterals.clear();
+    // A trigger without patterns is a structural folder that passes every
+    // line on to its children so it must always be evaluated:
+    mCanPrefilter = !mPatterns.isEmpty();
+    for (int i = 0, total = mPatterns.size(); mCanPrefilter && i < total; ++i) {
+        QString literal;
+        switch (mPatternKinds.at(i)) {
+        case REGEX_SUBSTRING:
+        case REGEX_BEGIN_OF_LINE_SUBSTRING:
+        case REGEX_EXACT_MATCH:
+            literal = mPatterns.at(i);
+            break;
+        case REGEX_PERL:
+            if (mRegexMap.value(i)) {
+                literal = TRegex::requiredLiteral(mPatterns.at(i));
+            }
+            break;
+        default:
+            // Lua code, line spacer, color and prompt patterns do not depend
+            // on the text of the line in a way that can be checked up front:
+            break;
+        }
+
+        if (literal.isEmpty()) {
+            mCanPrefilter = false;
+        } else {
+            mPrefilterLiterals.append(literal.toUtf8());
+        }
+    }
+
+    if (!mCanPrefilter) {
+        mPrefilterLiterals.clear();
+    }
+    if (mpHost) {
+        mpHost->getTriggerUnit()->markPrefilterDirty();
+    }
+}
+
+// Is it safe to not call match(...) for the current line as none of the
+// literals needed were found in it? The parts of match(...) that run
+// regardless of the patterns (line triggers, multi-line state and "fire
+// for n more lines") mean that these cases must always be evaluated:
+bool TTrigger::canSkipForPrefilter(const quint64 lineSerial) const
+{
+    return mCanPrefilter && mPrefilterHitSerial != lineSerial && !mIsLineTrigger && !mIsMultiline && mKeepFiring <= 0;
+}
+
+bool TTrigger::match_perl(const TMatchContext& context, int patternNumber, int posOffset)
 {
     assert(mRegexMap.contains(patternNumber));
 
-    QSharedPointer<pcre> const re = mRegexMap[patternNumber];
+    QSharedPointer<TRegex> const re = mRegexMap[patternNumber];
 
     if (!re) {
         if (mudlet::smDebugMode) {
@@ -302,24 +351,24 @@ bool TTrigger::match_perl(char* haystackC, const QString& haystack, int patternN
         return false; //regex compile error
     }
 
-    const int haystackCLength = strlen(haystackC);
     int rc = -1;
     int ovector[MAX_CAPTURE_GROUPS * 3];
 
-    rc = pcre_exec(re.data(), nullptr, haystackC, haystackCLength, 0, 0, ovector, MAX_CAPTURE_GROUPS * 3);
+    rc = re->exec(context.utf8(), context.utf8Length(), 0, 0, ovector, MAX_CAPTURE_GROUPS * 3);
 
     if (rc < 0) {
         return false;
     }
 
-    processRegexMatch(haystackC, haystack, patternNumber, posOffset, re, haystackCLength, rc, ovector);
+    processRegexMatch(context, patternNumber, posOffset, re, rc, ovector);
 
     return true;
 }
 
-void TTrigger::processRegexMatch(const char* haystackC, const QString& haystack, int patternNumber, int posOffset,
-                                 const QSharedPointer<pcre>& re, int haystackCLength, int rc, int* ovector)
+void TTrigger::processRegexMatch(const TMatchContext& context, int patternNumber, int posOffset, const QSharedPointer<TRegex>& re, int rc, int* ovector)
 {
+    const char* haystackC = context.utf8();
+    const int haystackCLength = context.utf8Length();
     if (rc == 0) {
         if (mpHost->mpEditorDialog) {
             mpHost->mpEditorDialog->mpErrorConsole->print(
@@ -343,7 +392,7 @@ void TTrigger::processRegexMatch(const char* haystackC, const QString& haystack,
     for (i = 0; i < rc; i++) {
         const char *substring_start = haystackC + ovector[2 * i];
         const int substring_length = ovector[2 * i + 1] - ovector[2 * i];
-        const int utf16_pos = haystack.indexOf(QString(substring_start));
+        const int utf16_pos = context.utf16Position(ovector[2 * i]);
         std::string match;
         if (substring_length < 1) {
             captureList.push_back(match);
@@ -364,19 +413,19 @@ void TTrigger::processRegexMatch(const char* haystackC, const QString& haystack,
     int name_entry_size = 0;
     char* tabptr = nullptr;
 
-    pcre_fullinfo(re.data(), nullptr, PCRE_INFO_NAMECOUNT, &namecount);
+    pcre_fullinfo(re->code(), re->extra(), PCRE_INFO_NAMECOUNT, &namecount);
 
     if (namecount > 0) {
         // Based on snippet https://github.com/vmg/pcre/blob/master/pcredemo.c#L216
         // Retrieves char table end entry size and extracts name of group and captures from
-        pcre_fullinfo(re.data(), nullptr, PCRE_INFO_NAMETABLE, &tabptr);
-        pcre_fullinfo(re.data(), nullptr, PCRE_INFO_NAMEENTRYSIZE, &name_entry_size);
+        pcre_fullinfo(re->code(), re->extra(), PCRE_INFO_NAMETABLE, &tabptr);
+        pcre_fullinfo(re->code(), re->extra(), PCRE_INFO_NAMEENTRYSIZE, &name_entry_size);
         for (i = 0; i < namecount; ++i) {
             const int n = (tabptr[0] << 8) | tabptr[1];
             auto name = QString::fromUtf8(&tabptr[2]).trimmed(); //NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic, cppcoreguidelines-pro-bounds-constant-array-index)
             auto* substring_start = haystackC + ovector[2*n]; //NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic, cppcoreguidelines-pro-bounds-constant-array-index)
             auto substring_length = ovector[2*n+1] - ovector[2*n]; //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
-            auto utf16_pos = haystack.indexOf(QString(substring_start));
+            auto utf16_pos = context.utf16Position(ovector[2*n]); //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
             auto capture = QString::fromUtf8(substring_start, substring_length);
             nameGroups << qMakePair(name, capture);
             tabptr += name_entry_size;
@@ -397,7 +446,7 @@ void TTrigger::processRegexMatch(const char* haystackC, const QString& haystack,
             options = PCRE_NOTEMPTY | PCRE_ANCHORED;
         }
 
-        rc = pcre_exec(re.data(), nullptr, haystackC, haystackCLength, start_offset, options, ovector, MAX_CAPTURE_GROUPS * 3);
+        rc = re->exec(haystackC, haystackCLength, start_offset, options, ovector, MAX_CAPTURE_GROUPS * 3);
 
         if (rc == PCRE_ERROR_NOMATCH) {
             if (options == 0) {
@@ -417,7 +466,7 @@ void TTrigger::processRegexMatch(const char* haystackC, const QString& haystack,
         for (i = 0; i < rc; i++) {
             const char *substring_start = haystackC + ovector[2 * i];
             const int substring_length = ovector[2 * i + 1] - ovector[2 * i];
-            const int utf16_pos = haystack.indexOf(QString(substring_start));
+            const int utf16_pos = context.utf16Position(ovector[2 * i]);
 
             std::string match;
             if (substring_length < 1) {
@@ -617,17 +666,11 @@ inline void TTrigger::filter(std::string& capture, int& posOffset)
     if (capture.empty()) {
         return;
     }
-    auto * filterSubject = static_cast<char*>(malloc(capture.size() + 2048));
-    if (filterSubject) {
-        strcpy(filterSubject, capture.c_str());
-    } else {
-        return;
-    }
-    const QString text = capture.c_str();
+    const QString text = QString::fromStdString(capture);
+    const TMatchContext context(text);
     for (auto& trigger : *mpMyChildrenList) {
-        trigger->match(filterSubject, text, -1, posOffset);
+        trigger->match(context, -1, posOffset);
     }
-    free(filterSubject);
 }
 
 int TTrigger::getExpiryCount() const
@@ -909,12 +952,10 @@ void TTrigger::processPromptMatch(int patternNumber)
 
 bool TTrigger::match_exact_match(const QString& haystack, const QString& needle, int patternNumber, int posOffset)
 {
-    QString text = haystack;
-    if (text.endsWith(QChar('\n'))) {
-        text.chop(1);
-    }
-
-    if (text == needle) {
+    // Compared in place, rather than on a copy without the trailing newline,
+    // so as not to allocate anything for lines that do not match:
+    const int length = haystack.endsWith(QChar('\n')) ? haystack.size() - 1 : haystack.size();
+    if (QStringView(haystack).left(length) == needle) {
         processExactMatch(needle, patternNumber, posOffset);
         return true;
     }
@@ -973,12 +1014,13 @@ void TTrigger::processExactMatch(const QString& line, int patternNumber, int pos
     }
 }
 
-// haystackC: string to match as a char*
-// haystack: string to match as a QString
+// context: the string to match, both as the original QString and as UTF-8
 // line: line number in the buffer
 // posOffset: position in the line to start matching from; used by child triggers
-bool TTrigger::match(char* haystackC, const QString& haystack, int line, int posOffset)
+bool TTrigger::match(const TMatchContext& context, int line, int posOffset)
 {
+    const TProfiler::Scope profile(mpHost->mProfiler, TProfiler::TriggerMatch, mID, mName);
+    const QString& haystack = context.text();
     bool ret = false;
     if (isActive()) {
         if (mIsLineTrigger) {
@@ -1022,7 +1064,7 @@ bool TTrigger::match(char* haystackC, const QString& haystack, int line, int pos
                 break;
 
             case REGEX_PERL:
-                ret = match_perl(haystackC, haystack, patternNumber, posOffset);
+                ret = match_perl(context, patternNumber, posOffset);
                 break;
 
             case REGEX_BEGIN_OF_LINE_SUBSTRING:
@@ -1131,7 +1173,7 @@ bool TTrigger::match(char* haystackC, const QString& haystack, int line, int pos
         if (!mFilterTrigger) {
             if (conditionMet || (mPatterns.empty())) {
                 for (auto trigger : *mpMyChildrenList) {
-                    ret = trigger->match(haystackC, haystack, line);
+                    ret = trigger->match(context, line);
                     if (ret) {
                         conditionMet = true;
                     }
@@ -1145,7 +1187,7 @@ bool TTrigger::match(char* haystackC, const QString& haystack, int line, int pos
                 execute();
             }
             for (auto trigger : *mpMyChildrenList) {
-                ret = trigger->match(haystackC, haystack, line);
+                ret = trigger->match(context, line);
                 if (ret) {
                     conditionMet = true;
                 }
@@ -1292,6 +1334,25 @@ void TTrigger::compileAll()
     }
 }
 
+void TTrigger::compileRegexes(const QHash<QByteArray, QSharedPointer<TRegex>>& precompiled)
+{
+    for (auto itRegex = mRegexMap.begin(); itRegex != mRegexMap.end(); ++itRegex) {
+        // One that did not compile before will not do so now:
+        if (!itRegex.value() || itRegex.key() >= mPatterns.size()) {
+            continue;
+        }
+        const QByteArray regexp = mPatterns.at(itRegex.key()).toUtf8();
+        QSharedPointer<TRegex> re = precompiled.value(regexp);
+        if (!re) {
+            QString error;
+            int erroffset;
+            re = TRegex::compile(regexp, mpHost->mUsePcreJit, error, erroffset);
+        }
+        if (re) {
+            itRegex.value() = re;
+        }
+    }
+}
 
 void TTrigger::compile()
 {
@@ -1310,6 +1371,7 @@ void TTrigger::compile()
 
 bool TTrigger::setScript(const QString& script)
 {
+    setUnsaved();
     mScript = script;
     if (script.isEmpty()) {
         mNeedsToBeCompiled = false;
@@ -1339,6 +1401,7 @@ bool TTrigger::compileScript()
 
 void TTrigger::execute()
 {
+    const TProfiler::Scope profile(mpHost->mProfiler, TProfiler::TriggerScript, mID, mName);
     if (mSoundTrigger) { /* eventually something should be added to the gui to change sound volumes. 100=full volume */
         QString mediaFileName = mSoundFile;
 
@@ -23,6 +23,8 @@
  ***************************************************************************/
 
 
+#include "TMatchContext.h"
+#include "TRegex.h"
 #include "Tree.h"
 
 #include "pre_guard.h"
@@ -34,8 +36,6 @@
 #include <QSharedPointer>
 #include "post_guard.h"
 
-#include <pcre.h>
-
 #include <map>
 #include <string>
 
@@ -90,25 +90,31 @@ public:
 
     QString getCommand() const { return mCommand; }
     void compileAll();
-    void setCommand(const QString& b) { mCommand = b; }
+    // Only compiles the Perl regexes (that compiled before) again, e.g. for a
+    // change of the JIT setting - taking them from precompiled where they are
+    // in it - without touching the Lua code or the children:
+    void compileRegexes(const QHash<QByteArray, QSharedPointer<TRegex>>& precompiled = {});
+    void setCommand(const QString& b) { mCommand = b; setUnsaved(); }
     QString getName() const { return mName; }
     void setName(const QString& name);
     const QStringList& getPatternsList() const { return mPatterns; }
     QList<int> getRegexCodePropertyList() const { return mPatternKinds; }
     QColor getFgColor() const { return mFgColor; }
     QColor getBgColor() const { return mBgColor; }
-    void setColorizerFgColor(const QColor& c) { mFgColor = c; }
-    void setColorizerBgColor(const QColor& c) { mBgColor = c; }
+    void setColorizerFgColor(const QColor& c) { mFgColor = c; setUnsaved(); }
+    void setColorizerBgColor(const QColor& c) { mBgColor = c; setUnsaved(); }
     bool isColorizerTrigger() const { return mIsColorizerTrigger; }
-    void setIsColorizerTrigger(const bool b) { mIsColorizerTrigger = b; }
+    void setIsColorizerTrigger(const bool b) { mIsColorizerTrigger = b; setUnsaved(); }
     void compile();
     void execute();
     bool isFilterChain();
-    bool setRegexCodeList(QStringList patterns, QList<int> patternKinds);
+    // precompiled can supply already compiled Perl regexes, keyed by the
+    // UTF-8 form of the pattern, see TRegex::compileAll(...):
+    bool setRegexCodeList(QStringList patterns, QList<int> patternKinds, const QHash<QByteArray, QSharedPointer<TRegex>>& precompiled = {});
     QString getScript() const { return mScript; }
     bool setScript(const QString& script);
     bool compileScript();
-    bool match(char*, const QString&, int line, int posOffset = 0);
+    bool match(const TMatchContext&, int line, int posOffset = 0);
 
     bool isMultiline() const { return mIsMultiline; }
     int getTriggerType() const { return mTriggerType; }
@@ -116,23 +122,23 @@ public:
     void setIsLineTrigger(bool b) { mIsLineTrigger = b; }
     void setStartOfLineDelta(int b) { mStartOfLineDelta = b; }
     void setLineDelta(int b) { mLineDelta = b; }
-    void setTriggerType(int b) { mTriggerType = b; }
-    void setIsMultiline(bool b) { mIsMultiline = b; }
+    void setTriggerType(int b) { mTriggerType = b; setUnsaved(); }
+    void setIsMultiline(bool b) { mIsMultiline = b; setUnsaved(); }
     void enableTrigger(const QString&);
     void disableTrigger(const QString&);
     TTrigger* killTrigger(const QString&);
     bool match_substring(const QString&, const QString&, int, int posOffset = 0);
-    bool match_perl(char*, const QString&, int, int posOffset = 0);
+    bool match_perl(const TMatchContext&, int, int posOffset = 0);
     bool match_exact_match(const QString&, const QString&, int, int posOffset = 0);
     bool match_begin_of_line_substring(const QString& haystack, const QString& needle, int patternNumber, int posOffset = 0);
     bool match_lua_code(int);
     bool match_line_spacer(int patternNumber);
     bool match_color_pattern(int, int);
     bool match_prompt(int patternNumber);
-    void setConditionLineDelta(int delta) { mConditionLineDelta = delta; }
+    void setConditionLineDelta(int delta) { mConditionLineDelta = delta; setUnsaved(); }
     int getConditionLineDelta() const { return mConditionLineDelta; }
     bool registerTrigger();
-    void setSound(const QString& file) { mSoundFile = file; }
+    void setSound(const QString& file) { mSoundFile = file; setUnsaved(); }
     bool setupColorTrigger(int, int);
     bool setupTmpColorTrigger(int ansiFg, int ansiBg);
     TColorTable* createColorPattern(int, int);
@@ -167,6 +173,18 @@ public:
 
     int getExpiryCount() const;
     void setExpiryCount(int expiryCount);
+    bool canSkipForPrefilter(const quint64 lineSerial) const;
+
+    // The literal strings (in UTF-8), at least one of which must be present
+    // in a line for any pattern of this trigger to match it - only meaningful
+    // when mCanPrefilter is true which is only the case when every pattern is
+    // a substring, begin of line substring, exact match or a Perl regex from
+    // which a required literal could be extracted:
+    QList<QByteArray> mPrefilterLiterals;
+    bool mCanPrefilter = false;
+    // Set by the TriggerUnit to the serial number of the line being processed
+    // when one of mPrefilterLiterals is found in it:
+    quint64 mPrefilterHitSerial = 0;
 
 
 private:
@@ -175,16 +193,16 @@ private:
     void updateMultistates(int regexNumber, std::list<std::string>& captureList, std::list<int>& posList, const NameGroupMatches* nameMatches = nullptr);
     void filter(std::string&, int&);
     void processExactMatch(const QString& line, int patternNumber, int posOffset);
-    void processRegexMatch(const char* haystackC, const QString& haystack, int patternNumber, int posOffset,
-                           const QSharedPointer<pcre>& re, int haystackCLength, int rc, int* ovector);
+    void processRegexMatch(const TMatchContext& context, int patternNumber, int posOffset, const QSharedPointer<TRegex>& re, int rc, int* ovector);
     void processBeginOfLine(const QString& needle, int patternNumber, int posOffset);
     void processSubstringMatch(const QString& haystack, const QString& needle, int regexNumber, int posOffset, int where);
     void processColorPattern(int patternNumber, std::list<std::string>& captureList, std::list<int>& posList);
     void processPromptMatch(int patternNumber);
+    void updatePrefilterLiterals();
 
 
     QList<int> mPatternKinds;
-    QMap<int, QSharedPointer<pcre>> mRegexMap;
+    QMap<int, QSharedPointer<TRegex>> mRegexMap;
 
     // Lua code as a string to run
     QString mScript;
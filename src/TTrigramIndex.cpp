@@ -0,0 +1,187 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include "TTrigramIndex.h"
+
+#include <algorithm>
+
+
+void TTrigramIndex::update(const QStringList& lines)
+{
+    ++mStamp;
+    for (int i = 0, total = lines.size(); i < total; ++i) {
+        const QString& text = lines.at(i);
+        if (text.size() < csmGramLength) {
+            // Too short to hold a trigram - and all empty lines share the
+            // same data anyhow:
+            continue;
+        }
+
+        const LineKey key = text.constData();
+        auto it = mLines.find(key);
+        if (it == mLines.end()) {
+            IndexedLine line;
+            line.mText = text;
+            line.mSequence = mNextSequence++;
+            const auto trigrams = trigramsOf(text);
+            line.mTrigramCount = static_cast<int>(trigrams.size());
+            for (const Trigram trigram : trigrams) {
+                mPostings[trigram].push_back(line.mSequence);
+            }
+            mLivePostings += line.mTrigramCount;
+            mSequences.insert(line.mSequence, key);
+            it = mLines.insert(key, line);
+        } else if (it->mStamp == mStamp) {
+            it->mOtherPositions.append(i);
+            continue;
+        }
+        it->mPosition = i;
+        it->mOtherPositions.clear();
+        it->mStamp = mStamp;
+    }
+
+    for (auto it = mLines.begin(); it != mLines.end();) {
+        if (it->mStamp != mStamp) {
+            dropLine(it.value());
+            it = mLines.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (mDeadPostings > mLivePostings) {
+        compact();
+    }
+}
+
+void TTrigramIndex::removeLine(const QString& line)
+{
+    if (line.size() < csmGramLength) {
+        return;
+    }
+
+    auto it = mLines.find(line.constData());
+    if (it != mLines.end()) {
+        dropLine(it.value());
+        mLines.erase(it);
+    }
+}
+
+void TTrigramIndex::clear()
+{
+    mLines.clear();
+    mSequences.clear();
+    mPostings.clear();
+    mLivePostings = 0;
+    mDeadPostings = 0;
+}
+
+QList<int> TTrigramIndex::candidateLines(const QString& text) const
+{
+    QList<int> results;
+    const auto trigrams = trigramsOf(text);
+    if (trigrams.empty()) {
+        return results;
+    }
+
+    std::vector<const std::vector<quint32>*> postings;
+    postings.reserve(trigrams.size());
+    for (const Trigram trigram : trigrams) {
+        const auto it = mPostings.constFind(trigram);
+        if (it == mPostings.cend()) {
+            // No line has this one so none can hold the text:
+            return results;
+        }
+        postings.push_back(&it.value());
+    }
+    // Go through the shortest list and look each line in it up in the others:
+    std::sort(postings.begin(), postings.end(), [](const auto* a, const auto* b) { return a->size() < b->size(); });
+    for (const quint32 sequence : *postings.front()) {
+        const auto itKey = mSequences.constFind(sequence);
+        if (itKey == mSequences.cend()) {
+            continue;
+        }
+        if (!std::all_of(std::next(postings.cbegin()), postings.cend(), [sequence](const auto* list) { return std::binary_search(list->cbegin(), list->cend(), sequence); })) {
+            continue;
+        }
+        const IndexedLine& line = *mLines.constFind(itKey.value());
+        results.append(line.mPosition);
+        results.append(line.mOtherPositions);
+    }
+    std::sort(results.begin(), results.end());
+    return results;
+}
+
+// The distinct trigrams in the text, each being three UTF-16 code units, after
+// folding each character (as QString::indexOf(...) does when ignoring case),
+// packed into one number:
+std::vector<TTrigramIndex::Trigram> TTrigramIndex::trigramsOf(const QString& text)
+{
+    std::vector<Trigram> trigrams;
+    if (text.size() < csmGramLength) {
+        return trigrams;
+    }
+
+    trigrams.reserve(text.size() - csmGramLength + 1);
+    Trigram trigram = 0;
+    int count = 0;
+    const auto add = [&](const char16_t unit) {
+        trigram = ((trigram << 16) | unit) & Q_UINT64_C(0xFFFFFFFFFFFF);
+        if (++count >= csmGramLength) {
+            trigrams.push_back(trigram);
+        }
+    };
+    for (int i = 0, total = text.size(); i < total; ++i) {
+        const QChar character = text.at(i);
+        if (character.isHighSurrogate() && i + 1 < total && text.at(i + 1).isLowSurrogate()) {
+            const char32_t folded = QChar::toCaseFolded(QChar::surrogateToUcs4(character, text.at(++i)));
+            add(QChar::highSurrogate(folded));
+            add(QChar::lowSurrogate(folded));
+        } else {
+            add(character.toCaseFolded().unicode());
+        }
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
+
+void TTrigramIndex::dropLine(const IndexedLine& line)
+{
+    mSequences.remove(line.mSequence);
+    mLivePostings -= line.mTrigramCount;
+    mDeadPostings += line.mTrigramCount;
+}
+
+// Takes the numbers of the lines that have gone out of the lists:
+void TTrigramIndex::compact()
+{
+    for (auto it = mPostings.begin(); it != mPostings.end();) {
+        auto& list = it.value();
+        list.erase(std::remove_if(list.begin(), list.end(), [this](const quint32 sequence) { return !mSequences.contains(sequence); }), list.end());
+        if (list.empty()) {
+            it = mPostings.erase(it);
+        } else {
+            list.shrink_to_fit();
+            ++it;
+        }
+    }
+    mDeadPostings = 0;
+}
@@ -0,0 +1,92 @@
+#ifndef MUDLET_TTRIGRAMINDEX_H
+#define MUDLET_TTRIGRAMINDEX_H
+
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include "pre_guard.h"
+#include <QChar>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include "post_guard.h"
+
+#include <vector>
+
+// The runs of three (case folded) characters in each line of a TBuffer, so
+// that searching the whole of the scroll-back only has to look in the lines
+// that could hold what is being looked for. As with TWordIndex a line is
+// recognised by the address of its QString's data, so only lines that are new,
+// or have been changed, since the last update have to be gone through. Each
+// line that is indexed is given the next number in a sequence that only goes
+// up, so the list of lines for each trigram stays sorted just by appending to
+// it. The numbers of lines that have gone are left in those lists - and
+// skipped over - until there are more of them than of the ones still in use.
+class TTrigramIndex
+{
+public:
+    // The shortest text that the index can narrow a search down for:
+    static constexpr int csmGramLength = 3;
+
+    // Brings the index into line with the given list of lines - any other
+    // lines are forgotten:
+    void update(const QStringList& lines);
+    // Forgets a line that is about to be removed from the buffer:
+    void removeLine(const QString& line);
+    void clear();
+    // The numbers, in order, of the lines given to the last update that hold
+    // (ignoring case) every trigram in the text - so they MIGHT contain it
+    // and need checking - the text must be at least csmGramLength long:
+    QList<int> candidateLines(const QString& text) const;
+    int lineCount() const { return mLines.size(); }
+
+private:
+    typedef const QChar* LineKey;
+    typedef quint64 Trigram;
+
+    struct IndexedLine
+    {
+        // Holds on to the data so that the key stays valid:
+        QString mText;
+        quint32 mSequence = 0;
+        int mTrigramCount = 0;
+        // Where it was in the lines given to the last update, the same data
+        // can be there more than once if the buffer has copied a line:
+        int mPosition = 0;
+        QList<int> mOtherPositions;
+        quint32 mStamp = 0;
+    };
+
+    static std::vector<Trigram> trigramsOf(const QString& text);
+    void dropLine(const IndexedLine& line);
+    void compact();
+
+    QHash<LineKey, IndexedLine> mLines;
+    // The sequence number of each line still in the index:
+    QHash<quint32, LineKey> mSequences;
+    QHash<Trigram, std::vector<quint32>> mPostings;
+    quint32 mNextSequence = 0;
+    quint32 mStamp = 0;
+    qint64 mLivePostings = 0;
+    qint64 mDeadPostings = 0;
+};
+
+#endif // MUDLET_TTRIGRAMINDEX_H
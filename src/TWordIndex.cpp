@@ -0,0 +1,234 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include "TWordIndex.h"
+
+#include "utils.h"
+
+#include "pre_guard.h"
+#include <QRegularExpression>
+#include "post_guard.h"
+
+#include <algorithm>
+
+
+void TWordIndex::update(const QStringList& lines, const int from, const int to)
+{
+    static const QRegularExpression wordPattern(qsl(R"(\w+)"), QRegularExpression::UseUnicodePropertiesOption);
+
+    ++mStamp;
+    for (int i = qMax(0, from), total = qMin(to, lines.size()); i < total; ++i) {
+        const QString& text = lines.at(i);
+        if (text.isEmpty()) {
+            // All empty lines share the same data and there are no words in
+            // them anyhow:
+            continue;
+        }
+
+        const LineKey key = text.constData();
+        auto it = mLines.find(key);
+        if (it == mLines.end()) {
+            IndexedLine line;
+            line.mText = text;
+            auto matches = wordPattern.globalMatch(text);
+            while (matches.hasNext()) {
+                line.mWords.append(matches.next().captured());
+            }
+            addLine(key, line);
+            it = mLines.insert(key, line);
+        }
+        it->mPosition = i;
+        it->mStamp = mStamp;
+    }
+
+    for (auto it = mLines.begin(); it != mLines.end();) {
+        if (it->mStamp != mStamp) {
+            dropLine(it.key(), it.value());
+            it = mLines.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void TWordIndex::removeLine(const QString& line)
+{
+    if (line.isEmpty()) {
+        return;
+    }
+
+    auto it = mLines.find(line.constData());
+    if (it != mLines.end()) {
+        dropLine(it.key(), it.value());
+        mLines.erase(it);
+    }
+}
+
+void TWordIndex::clear()
+{
+    mLines.clear();
+    mNodes.clear();
+    mNodes.resize(1);
+    mFreeNodes.clear();
+    mWordCount = 0;
+}
+
+QString TWordIndex::fold(const QString& text)
+{
+    // Done a QChar at a time, rather than with QString::toCaseFolded(), so
+    // that the length never changes:
+    QString result(text);
+    for (auto& character : result) {
+        character = character.toCaseFolded();
+    }
+    return result;
+}
+
+QStringList TWordIndex::wordsStartingWith(const QString& prefix, const QSet<QString>& foldedBlacklist) const
+{
+    QString folded = fold(prefix);
+    const int node = findNode(folded);
+    if (node < 0) {
+        return {};
+    }
+
+    // Each word with where it was last seen:
+    QList<std::pair<std::pair<int, int>, QString>> found;
+    collect(node, folded, prefix.size() + 1, foldedBlacklist, found);
+    std::sort(found.begin(), found.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    QStringList results;
+    results.reserve(found.size());
+    for (const auto& entry : std::as_const(found)) {
+        results.append(entry.second);
+    }
+    return results;
+}
+
+void TWordIndex::addLine(const LineKey key, const IndexedLine& line)
+{
+    for (int i = 0, total = line.mWords.size(); i < total; ++i) {
+        const QString& word = line.mWords.at(i);
+        const int node = findOrAddNode(fold(word));
+        auto& wordLines = mNodes[node].mWords[word];
+        if (wordLines.isEmpty()) {
+            ++mWordCount;
+        }
+        // A later time in the same line replaces an earlier one:
+        wordLines.insert(key, i);
+    }
+}
+
+void TWordIndex::dropLine(const LineKey key, const IndexedLine& line)
+{
+    for (const QString& word : line.mWords) {
+        const int node = findNode(fold(word));
+        if (node < 0) {
+            // Already gone because it was in the line more than once:
+            continue;
+        }
+        auto& words = mNodes[node].mWords;
+        auto itWord = words.find(word);
+        if (itWord == words.end()) {
+            continue;
+        }
+        itWord->remove(key);
+        if (itWord->isEmpty()) {
+            words.erase(itWord);
+            --mWordCount;
+            pruneNode(node);
+        }
+    }
+}
+
+int TWordIndex::findNode(const QString& folded) const
+{
+    int node = 0;
+    for (const QChar character : folded) {
+        node = mNodes[node].mChildren.value(character, -1);
+        if (node < 0) {
+            return -1;
+        }
+    }
+    return node;
+}
+
+int TWordIndex::findOrAddNode(const QString& folded)
+{
+    int node = 0;
+    for (const QChar character : folded) {
+        const int child = mNodes[node].mChildren.value(character, -1);
+        if (child >= 0) {
+            node = child;
+            continue;
+        }
+
+        int newNode;
+        if (!mFreeNodes.empty()) {
+            newNode = mFreeNodes.back();
+            mFreeNodes.pop_back();
+        } else {
+            // This may move all the nodes so no references to them can be
+            // held across it:
+            newNode = static_cast<int>(mNodes.size());
+            mNodes.emplace_back();
+        }
+        mNodes[newNode].mParent = node;
+        mNodes[newNode].mKey = character;
+        mNodes[node].mChildren.insert(character, newNode);
+        node = newNode;
+    }
+    return node;
+}
+
+// Removes the node, and then any of its ancestors, that no longer lead to
+// any words:
+void TWordIndex::pruneNode(int node)
+{
+    while (node > 0 && mNodes[node].mWords.isEmpty() && mNodes[node].mChildren.isEmpty()) {
+        const int parent = mNodes[node].mParent;
+        mNodes[parent].mChildren.remove(mNodes[node].mKey);
+        mNodes[node] = Node();
+        mFreeNodes.push_back(node);
+        node = parent;
+    }
+}
+
+void TWordIndex::collect(const int node, QString& folded, const int minimumLength, const QSet<QString>& foldedBlacklist, QList<std::pair<std::pair<int, int>, QString>>& found) const
+{
+    const Node& current = mNodes[node];
+    if (folded.size() >= minimumLength && !current.mWords.isEmpty() && !foldedBlacklist.contains(folded)) {
+        for (auto itWord = current.mWords.cbegin(); itWord != current.mWords.cend(); ++itWord) {
+            std::pair<int, int> lastSeen{-1, -1};
+            for (auto itLine = itWord->cbegin(); itLine != itWord->cend(); ++itLine) {
+                const auto itIndexedLine = mLines.constFind(itLine.key());
+                if (itIndexedLine != mLines.cend()) {
+                    lastSeen = std::max(lastSeen, std::make_pair(itIndexedLine->mPosition, itLine.value()));
+                }
+            }
+            found.append({lastSeen, itWord.key()});
+        }
+    }
+
+    for (auto itChild = current.mChildren.cbegin(); itChild != current.mChildren.cend(); ++itChild) {
+        folded.append(itChild.key());
+        collect(itChild.value(), folded, minimumLength, foldedBlacklist, found);
+        folded.chop(1);
+    }
+}
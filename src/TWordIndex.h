@@ -0,0 +1,100 @@
+#ifndef MUDLET_TWORDINDEX_H
+#define MUDLET_TWORDINDEX_H
+
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include "pre_guard.h"
+#include <QChar>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include "post_guard.h"
+
+#include <utility>
+#include <vector>
+
+// The words in the recent lines of a TBuffer, for the command line's tab
+// completion, kept in a trie so that finding the ones that start with what
+// the user has typed does not mean going through all the text each time.
+// Only lines that are new, or have been changed, since the last update are
+// split into words - a line is recognised by the address of its QString's
+// data which (as the index holds a copy of it) cannot change, or be reused,
+// without the buffer's copy being detached and so getting a new one. Each
+// word remembers which lines it is in, so it goes when the last of them drops
+// out of the range being indexed or is removed from the buffer.
+class TWordIndex
+{
+public:
+    // Brings the index into line with the lines from "from" up to, but not
+    // including, "to" of the given list - any other lines are forgotten:
+    void update(const QStringList& lines, const int from, const int to);
+    // Forgets a line that is about to be removed from the buffer:
+    void removeLine(const QString& line);
+    void clear();
+    // The words longer than the prefix that start with it (ignoring case) and
+    // are not in the blacklist - which must be case folded (with fold(...)) -
+    // in order of how recently they were last seen, the latest first:
+    QStringList wordsStartingWith(const QString& prefix, const QSet<QString>& foldedBlacklist) const;
+    int lineCount() const { return mLines.size(); }
+    int wordCount() const { return mWordCount; }
+    static QString fold(const QString&);
+
+private:
+    typedef const QChar* LineKey;
+
+    struct IndexedLine
+    {
+        // Holds on to the data so that the key stays valid:
+        QString mText;
+        QStringList mWords;
+        // Where it was in the lines given to the last update:
+        int mPosition = 0;
+        quint32 mStamp = 0;
+    };
+
+    struct Node
+    {
+        int mParent = -1;
+        QChar mKey;
+        QHash<QChar, int> mChildren;
+        // The (not case folded) words that end at this node; for each one the
+        // lines it is in and, for each line, the index of the last time it
+        // is in there:
+        QHash<QString, QHash<LineKey, int>> mWords;
+    };
+
+    void addLine(const LineKey key, const IndexedLine& line);
+    void dropLine(const LineKey key, const IndexedLine& line);
+    int findNode(const QString& folded) const;
+    int findOrAddNode(const QString& folded);
+    void pruneNode(int node);
+    void collect(const int node, QString& folded, const int minimumLength, const QSet<QString>& foldedBlacklist, QList<std::pair<std::pair<int, int>, QString>>& found) const;
+
+    QHash<LineKey, IndexedLine> mLines;
+    // The first one is the root:
+    std::vector<Node> mNodes = std::vector<Node>(1);
+    std::vector<int> mFreeNodes;
+    quint32 mStamp = 0;
+    int mWordCount = 0;
+};
+
+#endif // MUDLET_TWORDINDEX_H
@@ -27,13 +27,6 @@
 #include "mudlet.h"
 #include "TTimer.h"
 
-TimerUnit::~TimerUnit()
-{
-    for (auto&& timer : std::as_const(mQTimerSet)) {
-        delete timer;
-    }
-}
-
 void TimerUnit::resetStats()
 {
     statsItemsTotal = 0;
@@ -204,7 +197,6 @@ bool TimerUnit::registerTimer(TTimer* pT)
 
     // This has some side effects, including stopping the timer...
     pT->setTime(pT->getTime());
-    QTimer::connect(pT->getQTimer(), &QTimer::timeout, mudlet::self(), &mudlet::slot_timerFires, Qt::UniqueConnection);
     return true;
 }
 
@@ -213,10 +205,9 @@ void TimerUnit::unregisterTimer(TTimer* pT)
     if (!pT) {
         return;
     }
-    // Stop the QTimer ASAP:
+    // Stop it ASAP:
     pT->stop();
     pT->deactivate();
-    QTimer::disconnect(pT->getQTimer(), &QTimer::timeout, mudlet::self(), &mudlet::slot_timerFires);
     if (pT->getParent()) {
         _removeTimer(pT);
         return;
@@ -442,10 +433,12 @@ std::tuple<QString, int, int, int> TimerUnit::assembleReport()
     };
 }
 
-void TimerUnit::changeHostName(const QString& newName)
+void TimerUnit::fireTimer(TTimer* pT)
 {
-    QSetIterator<QTimer*> itQTimerPtr(mQTimerSet);
-    while (itQTimerPtr.hasNext()) {
-        itQTimerPtr.next()->setProperty(TTimer::scmProperty_HostName, newName);
+    // The scheduler stops a timer as it is unregistered so this is only ever
+    // called for live ones:
+    pT->execute();
+    if (pT->checkRestart()) {
+        pT->start();
     }
 }
@@ -24,6 +24,8 @@
  ***************************************************************************/
 
 
+#include "TTimerScheduler.h"
+
 #include "pre_guard.h"
 #include <QMultiMap>
 #include <QPointer>
@@ -35,7 +37,6 @@
 
 class Host;
 class TTimer;
-class QTimer;
 
 class TimerUnit
 {
@@ -45,8 +46,8 @@ class TimerUnit
 public:
     explicit TimerUnit(Host* pHost)
     : mpHost(pHost)
+    , mScheduler([this](TTimer* pT) { fireTimer(pT); })
     {}
-    ~TimerUnit();
 
     void resetStats();
     void removeAllTempTimers();
@@ -71,31 +72,25 @@ public:
     int getNewID();
     void uninstall(const QString&);
     void _uninstall(TTimer* pChild, const QString& packageName);
-    void changeHostName(const QString&);
+    // Runs all the timers of this profile:
+    TTimerScheduler& scheduler() { return mScheduler; }
 
 
     QMultiMap<QString, TTimer*> mLookupTable;
     QList<TTimer*> uninstallList;
 
-    // This will contain all the QTimers associated with the TTimer instances
-    // it is needed so that should mpHost be renamed we can update them to have
-    // the correct name (which is needed when they fire so the mudlet class
-    // knows when profile they belong to and where to find the TTimer that they
-    // are part of):
-    QSet<QTimer*> mQTimerSet;
-
 private:
-    TimerUnit() = default;
-
     void assembleReport(TTimer*);
     TTimer* getTimerPrivate(int id);
     void addTimerRootNode(TTimer* pT, int parentPosition = -1, int childPosition = -1);
     void addTimer(TTimer* pT);
     void _removeTimerRootNode(TTimer* pT);
     void _removeTimer(TTimer*);
+    void fireTimer(TTimer*);
 
 
     QPointer<Host> mpHost;
+    TTimerScheduler mScheduler;
     QMap<int, TTimer*> mTimerMap;
     std::list<TTimer*> mTimerRootNodeList;
     int mMaxID = 0;
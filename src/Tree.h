@@ -65,6 +65,16 @@ public:
     QString& getError();
     void setError(QString);
     bool state() const;
+    // Whether anything that is saved in the profile has changed, for this
+    // item or any below it, since the profile was last saved. This should be
+    // set whenever such a detail is changed - the setters do that themselves
+    // but code that writes to the public members directly must do so itself.
+    // It allows a save to reuse the XML written for an unchanged top level
+    // item (and everything below it) last time, see XMLexportCache:
+    bool isUnsaved() const { return mUnsaved; }
+    void setUnsaved();
+    // Clears the flag for this item and everything below it:
+    void setSaved();
 /* No longer used - most cases were accessing the member directly
     QString getPackageName() const { return mPackageName; }
     void setPackageName(const QString& n) { mPackageName = n; }
@@ -76,6 +86,9 @@ public:
     bool isFolder() const { return mFolder; }
     void setIsFolder(bool b)
     {
+        if (b != mFolder) {
+            setUnsaved();
+        }
         mFolder = b;
         // Allow the folder to be enabled
         if (b) {
@@ -101,6 +114,8 @@ private:
     QString mErrorMessage;
     bool mTemporary;
     bool mFolder;
+    // Set for new items as they have never been saved:
+    bool mUnsaved;
 };
 
 template <class T>
@@ -114,6 +129,7 @@ Tree<T>::Tree()
 , mUserActiveState(false)
 , mTemporary(false)
 , mFolder(false)
+, mUnsaved(true)
 {
 }
 
@@ -128,6 +144,7 @@ Tree<T>::Tree( T * pParent )
 , mUserActiveState(false)
 , mTemporary(false)
 , mFolder(false)
+, mUnsaved(true)
 {
     if (pParent) {
         pParent->addChild(static_cast<T*>(this));
@@ -155,6 +172,9 @@ Tree<T>::~Tree()
 
 template <class T>
 void Tree<T>::setTemporary(const bool state) {
+    if (state != mTemporary) {
+        setUnsaved();
+    }
     mTemporary = state;
 }
 
@@ -185,6 +205,9 @@ bool Tree<T>::shouldBeActive() const
 template <class T>
 void Tree<T>::setShouldBeActive(bool b)
 {
+    if (b != mUserActiveState) {
+        setUnsaved();
+    }
     mUserActiveState = b;
 }
 
@@ -256,6 +279,7 @@ void Tree<T>::disableFamily()
 template <class T>
 void Tree<T>::addChild(T* newChild, int parentPosition, int childPosition)
 {
+    setUnsaved();
     if ((parentPosition == -1) || (childPosition >= static_cast<int>(mpMyChildrenList->size()))) {
         mpMyChildrenList->push_back(newChild);
     } else {
@@ -283,6 +307,7 @@ bool Tree<T>::popChild(T* pChild)
     for (auto it = mpMyChildrenList->begin(); it != mpMyChildrenList->end(); it++) {
         if (*it == pChild) {
             mpMyChildrenList->remove(pChild);
+            setUnsaved();
             return true;
         }
     }
@@ -319,4 +344,24 @@ void Tree<T>::setError(QString error)
     mErrorMessage = error;
 }
 
+template <class T>
+void Tree<T>::setUnsaved()
+{
+    // The ancestors are flagged as well so that a save only has to look at
+    // the top level items to find the ones that need writing out again:
+    if (mpParent) {
+        mpParent->setUnsaved();
+    }
+    mUnsaved = true;
+}
+
+template <class T>
+void Tree<T>::setSaved()
+{
+    mUnsaved = false;
+    for (auto pChild : *mpMyChildrenList) {
+        pChild->setSaved();
+    }
+}
+
 #endif // MUDLET_TREE_H
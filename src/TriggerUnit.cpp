@@ -95,6 +95,7 @@ void TriggerUnit::addTriggerRootNode(TTrigger* pT, int parentPosition, int child
     if (!moveTrigger) {
         mTriggerMap.insert(pT->getID(), pT);
     }
+    markPrefilterDirty();
 }
 
 void TriggerUnit::reParentTrigger(int childID, int oldParentID, int newParentID, int parentPosition, int childPosition)
@@ -109,6 +110,7 @@ void TriggerUnit::reParentTrigger(int childID, int oldParentID, int newParentID,
         pOldParent->popChild(pChild);
     } else {
         mTriggerRootNodeList.remove(pChild);
+        markPrefilterDirty();
     }
     if (pNewParent) {
         pNewParent->addChild(pChild, parentPosition, childPosition);
@@ -131,6 +133,7 @@ void TriggerUnit::removeTriggerRootNode(TTrigger* pT)
     }
     mTriggerMap.remove(pT->getID());
     mTriggerRootNodeList.remove(pT);
+    markPrefilterDirty();
 }
 
 TTrigger* TriggerUnit::getTrigger(int id)
@@ -237,17 +240,35 @@ void TriggerUnit::processDataStream(const QString& data, int line)
         return;
     }
 
-#if defined(Q_OS_WIN32)
-    // strndup(3) - a safe strdup(3) does not seem to be available on mingw32 with GCC-4.9.2
-    char* subject = static_cast<char*>(malloc(strlen(data.toUtf8().data()) + 1));
-    strcpy(subject, data.toUtf8().data());
-#else
-    char* subject = strndup(data.toUtf8().constData(), strlen(data.toUtf8().constData()));
-#endif
+    if (mMatchContexts.size() <= mMatchDepth) {
+        mMatchContexts.emplace_back();
+    }
+    TMatchContext& context = mMatchContexts[mMatchDepth++];
+    context.setText(data);
+
+    if (mPrefilterDirty) {
+        rebuildPrefilter();
+    }
+    const quint64 serial = ++mPrefilterSerial;
+    const quint64 rebuildCount = mPrefilterRebuildCount;
+    mPrefilter.scan(context.utf8(), context.utf8Length(), [this, serial](const int id) {
+        mPrefilterOwners[id]->mPrefilterHitSerial = serial;
+        return true;
+    });
+
     for (auto trigger : mTriggerRootNodeList) {
-        trigger->match(subject, data, line);
+        // If a script run by an earlier trigger has changed the triggers, or
+        // has fed another line through here (which marks the hits for that
+        // line instead and may have rebuilt the prefilter), then what the
+        // prefilter found is no longer reliable, so evaluate all the rest for
+        // this line:
+        const bool isPrefilterValid = !mPrefilterDirty && mPrefilterSerial == serial && mPrefilterRebuildCount == rebuildCount;
+        if (isPrefilterValid && trigger->canSkipForPrefilter(serial)) {
+            continue;
+        }
+        trigger->match(context, line);
     }
-    free(subject);
+    --mMatchDepth;
 
     for (auto& trigger : mCleanupList) {
         delete trigger;
@@ -255,6 +276,25 @@ void TriggerUnit::processDataStream(const QString& data, int line)
     mCleanupList.clear();
 }
 
+void TriggerUnit::rebuildPrefilter()
+{
+    mPrefilter.clear();
+    mPrefilterOwners.clear();
+    for (auto trigger : mTriggerRootNodeList) {
+        if (!trigger->mCanPrefilter) {
+            continue;
+        }
+        const int id = static_cast<int>(mPrefilterOwners.size());
+        mPrefilterOwners.push_back(trigger);
+        for (const auto& literal : std::as_const(trigger->mPrefilterLiterals)) {
+            mPrefilter.addPattern(literal, id);
+        }
+    }
+    mPrefilter.build();
+    mPrefilterDirty = false;
+    ++mPrefilterRebuildCount;
+}
+
 void TriggerUnit::compileAll()
 {
     for (auto trigger : mTriggerRootNodeList) {
@@ -264,6 +304,28 @@ void TriggerUnit::compileAll()
     }
 }
 
+// For when the JIT setting changes - only the Perl regexes depend on that so
+// just they are compiled again, for every trigger whether it is active or not,
+// spread over the global thread pool as when a profile is loaded:
+void TriggerUnit::compileRegexes()
+{
+    QList<QByteArray> regexes;
+    for (auto trigger : std::as_const(mTriggerMap)) {
+        const QStringList& patterns = trigger->getPatternsList();
+        const QList<int> patternKinds = trigger->getRegexCodePropertyList();
+        for (int i = 0, total = qMin(patterns.size(), patternKinds.size()); i < total; ++i) {
+            if (patternKinds.at(i) == REGEX_PERL) {
+                regexes.append(patterns.at(i).toUtf8());
+            }
+        }
+    }
+
+    const auto precompiled = TRegex::compileAll(regexes, mpHost->mUsePcreJit);
+    for (auto trigger : std::as_const(mTriggerMap)) {
+        trigger->compileRegexes(precompiled);
+    }
+}
+
 void TriggerUnit::stopAllTriggers()
 {
     for (auto trigger : mTriggerRootNodeList) {
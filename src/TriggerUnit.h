@@ -23,13 +23,18 @@
  ***************************************************************************/
 
 
+#include "TAhoCorasick.h"
+#include "TMatchContext.h"
+
 #include "pre_guard.h"
 #include <QMultiMap>
 #include <QPointer>
 #include <QString>
 #include "post_guard.h"
 
+#include <deque>
 #include <list>
+#include <vector>
 
 class Host;
 class TTrigger;
@@ -66,6 +71,7 @@ public:
     void reParentTrigger(int childID, int oldParentID, int newParentID, int parentPosition = -1, int childPosition = -1);
     void processDataStream(const QString&, int);
     void compileAll();
+    void compileRegexes();
     void setTriggerStayOpen(const QString&, int);
     void stopAllTriggers();
     void reenableAllTriggers();
@@ -74,6 +80,7 @@ public:
     int getNewID();
     QMultiMap<QString, TTrigger*> mLookupTable;
     void markCleanup(TTrigger* pT);
+    void markPrefilterDirty() { mPrefilterDirty = true; }
     void doCleanup();
     void uninstall(const QString&);
     void _uninstall(TTrigger* pChild, const QString& packageName);
@@ -88,6 +95,7 @@ private:
     void addTrigger(TTrigger* pT);
     void removeTriggerRootNode(TTrigger* pT);
     void removeTrigger(TTrigger*);
+    void rebuildPrefilter();
 
     QPointer<Host> mpHost;
     QMap<int, TTrigger*> mTriggerMap;
@@ -99,6 +107,27 @@ private:
     int statsActiveItems = 0;
     int statsPatternsTotal = 0;
     int statsPatternsActive = 0;
+
+    // Finds, in one pass over each line, which of the root triggers can
+    // possibly match it so that only those need to be evaluated - the ids it
+    // reports are indexes into mPrefilterOwners. It is rebuilt lazily, on the
+    // next line to be processed, after any change to the set of root triggers
+    // or to their patterns:
+    TAhoCorasick mPrefilter;
+    std::vector<TTrigger*> mPrefilterOwners;
+    bool mPrefilterDirty = true;
+    // Bumped for each line scanned and each rebuild, so that a line whose
+    // matching has been interrupted by another one, fed in by a trigger
+    // script, can tell that its prefilter results are no longer there:
+    quint64 mPrefilterSerial = 0;
+    quint64 mPrefilterRebuildCount = 0;
+
+    // The per line state shared by all the triggers evaluated for a line,
+    // kept so that its buffers are reused - there is one for each level that
+    // a trigger script has called back into processDataStream(...), e.g. via
+    // feedTriggers(...), as the outer lines are still being matched:
+    std::deque<TMatchContext> mMatchContexts;
+    size_t mMatchDepth = 0;
 };
 
 #endif // MUDLET_TRIGGERUNIT_H
@@ -119,6 +119,16 @@ XMLexport::XMLexport( TKey * pT )
 {
 }
 
+void XMLexportCache::clear()
+{
+    mTriggers.clear();
+    mTimers.clear();
+    mAliases.clear();
+    mActions.clear();
+    mScripts.clear();
+    mKeys.clear();
+}
+
 void XMLexport::writeModuleXML(const QString& moduleName, const QString& fileName, bool async)
 {
     auto pHost = mpHost;
@@ -211,7 +221,9 @@ void XMLexport::writeModuleXML(const QString& moduleName, const QString& fileNam
 void XMLexport::exportHost(const QString& filename_pugi_xml)
 {
     auto mudletPackage = writeXmlHeader();
+    mpCache = &mpHost->mSaveCache;
     writeHost(mpHost, mudletPackage);
+    mpCache = nullptr;
     auto future = QtConcurrent::run([&, filename_pugi_xml]() { return saveXml(filename_pugi_xml); });
 
     auto watcher = new QFutureWatcher<bool>;
@@ -422,6 +434,7 @@ void XMLexport::writeHost(Host* pHost, pugi::xml_node mudletPackage)
     host.append_attribute("mAcceptServerMedia") = pHost->mAcceptServerMedia ? "yes" : "no";
     host.append_attribute("mMapperUseAntiAlias") = pHost->mMapperUseAntiAlias ? "yes" : "no";
     host.append_attribute("mMapperShowRoomBorders") = pHost->mMapperShowRoomBorders ? "yes" : "no";
+    host.append_attribute("mMapperAreaRouting") = pHost->mMapperAreaRouting ? "yes" : "no";
     host.append_attribute("mFORCE_MXP_NEGOTIATION_OFF") = pHost->mFORCE_MXP_NEGOTIATION_OFF ? "yes" : "no";
     host.append_attribute("mFORCE_CHARSET_NEGOTIATION_OFF") = pHost->mFORCE_CHARSET_NEGOTIATION_OFF ? "yes" : "no";
     host.append_attribute("forceNewEnvironNegotiationOff") = pHost->mForceNewEnvironNegotiationOff ? "yes" : "no";
@@ -480,6 +493,7 @@ void XMLexport::writeHost(Host* pHost, pugi::xml_node mudletPackage)
     host.append_attribute("DebugShowAllProblemCodepoints") = pHost->debugShowAllProblemCodepoints() ? "yes" : "no";
     host.append_attribute("announceIncomingText") = pHost->mAnnounceIncomingText ? "yes" : "no";
     host.append_attribute("advertiseScreenReader") = pHost->mAdvertiseScreenReader ? "yes" : "no";
+    host.append_attribute("usePcreJit") = pHost->mUsePcreJit ? "yes" : "no";
     host.append_attribute("caretShortcut") = QMetaEnum::fromType<Host::CaretShortcut>().valueToKey(
             static_cast<int>(pHost->mCaretShortcut));
     host.append_attribute("blankLineBehaviour") = QMetaEnum::fromType<Host::BlankLineBehaviour>().valueToKey(
@@ -674,76 +688,143 @@ void XMLexport::writeVariablePackage(Host* pHost, pugi::xml_node& mudletPackage)
     }
 }
 
+// Copies the XML for the item, and everything below it, from the last save
+// unless it has changed since, in which case it is written out again. Every
+// fragment used is put into stillUsed which should then replace fragments so
+// that those for items that have since been removed are dropped:
+template <class T>
+void XMLexport::writeCachedItem(T* pT, XMLexportCache::Fragments& fragments, XMLexportCache::Fragments& stillUsed, void (XMLexport::*writeItem)(T*, pugi::xml_node), pugi::xml_node xmlParent)
+{
+    auto fragment = fragments.value(pT->getID());
+    if (!fragment || pT->isUnsaved()) {
+        fragment = std::make_shared<pugi::xml_document>();
+        (this->*writeItem)(pT, *fragment);
+        pT->setSaved();
+    }
+    for (auto node : fragment->children()) {
+        xmlParent.append_copy(node);
+    }
+    stillUsed.insert(pT->getID(), fragment);
+}
+
 void XMLexport::writeKeyPackage(const Host* pHost, pugi::xml_node& mudletPackage, bool skipModuleMembers)
 {
     auto keyPackage = mudletPackage.append_child("KeyPackage");
+    XMLexportCache::Fragments stillUsed;
     for (auto it : pHost->mKeyUnit.mKeyRootNodeList) {
         if (!it || it->isTemporary() || (skipModuleMembers && it->mModuleMember)) {
             continue;
         }
-        writeKey(it, keyPackage);
+        if (mpCache) {
+            writeCachedItem(it, mpCache->mKeys, stillUsed, &XMLexport::writeKey, keyPackage);
+        } else {
+            writeKey(it, keyPackage);
+        }
+    }
+    if (mpCache) {
+        mpCache->mKeys.swap(stillUsed);
     }
 }
 
 void XMLexport::writeScriptPackage(const Host* pHost, pugi::xml_node& mudletPackage, bool skipModuleMembers)
 {
     auto scriptPackage = mudletPackage.append_child("ScriptPackage");
+    XMLexportCache::Fragments stillUsed;
     for (auto it : pHost->mScriptUnit.mScriptRootNodeList) {
         if (!it || (skipModuleMembers && it->mModuleMember)) {
             continue;
         }
-        writeScript(it, scriptPackage);
+        if (mpCache) {
+            writeCachedItem(it, mpCache->mScripts, stillUsed, &XMLexport::writeScript, scriptPackage);
+        } else {
+            writeScript(it, scriptPackage);
+        }
+    }
+    if (mpCache) {
+        mpCache->mScripts.swap(stillUsed);
     }
 }
 
 void XMLexport::writeActionPackage(const Host* pHost, pugi::xml_node& mudletPackage, bool skipModuleMembers)
 {
     auto actionPackage = mudletPackage.append_child("ActionPackage");
+    XMLexportCache::Fragments stillUsed;
     for (auto it : pHost->mActionUnit.mActionRootNodeList) {
         if (!it || (skipModuleMembers && it->mModuleMember)) {
             continue;
         }
-        writeAction(it, actionPackage);
+        if (mpCache) {
+            writeCachedItem(it, mpCache->mActions, stillUsed, &XMLexport::writeAction, actionPackage);
+        } else {
+            writeAction(it, actionPackage);
+        }
+    }
+    if (mpCache) {
+        mpCache->mActions.swap(stillUsed);
     }
 }
 
 void XMLexport::writeAliasPackage(const Host* pHost, pugi::xml_node& mudletPackage, bool skipModuleMembers)
 {
     auto aliasPackage = mudletPackage.append_child("AliasPackage");
+    XMLexportCache::Fragments stillUsed;
     for (auto it : pHost->mAliasUnit.mAliasRootNodeList) {
         if (!it || (skipModuleMembers && it->mModuleMember)) {
             continue;
         }
         if (!it->isTemporary()) {
-            writeAlias(it, aliasPackage);
+            if (mpCache) {
+                writeCachedItem(it, mpCache->mAliases, stillUsed, &XMLexport::writeAlias, aliasPackage);
+            } else {
+                writeAlias(it, aliasPackage);
+            }
         }
     }
+    if (mpCache) {
+        mpCache->mAliases.swap(stillUsed);
+    }
 }
 
 void XMLexport::writeTimerPackage(const Host* pHost, pugi::xml_node& mudletPackage, bool skipModuleMembers)
 {
     auto timerPackage = mudletPackage.append_child("TimerPackage");
+    XMLexportCache::Fragments stillUsed;
     for (auto it : pHost->mTimerUnit.mTimerRootNodeList) {
         if (!it || (skipModuleMembers && it->mModuleMember)) {
             continue;
         }
         if (!it->isTemporary()) {
-            writeTimer(it, timerPackage);
+            if (mpCache) {
+                writeCachedItem(it, mpCache->mTimers, stillUsed, &XMLexport::writeTimer, timerPackage);
+            } else {
+                writeTimer(it, timerPackage);
+            }
         }
     }
+    if (mpCache) {
+        mpCache->mTimers.swap(stillUsed);
+    }
 }
 
 void XMLexport::writeTriggerPackage(const Host* pHost, pugi::xml_node& mudletPackage, bool ignoreModuleMembers)
 {
     auto triggerPackage = mudletPackage.append_child("TriggerPackage");
+    XMLexportCache::Fragments stillUsed;
     for (auto it : pHost->mTriggerUnit.mTriggerRootNodeList) {
         if (!it || (ignoreModuleMembers && it->mModuleMember)) {
             continue;
         }
         if (!it->isTemporary()) {
-            writeTrigger(it, triggerPackage);
+            if (mpCache) {
+                writeCachedItem(it, mpCache->mTriggers, stillUsed, &XMLexport::writeTrigger, triggerPackage);
+            } else {
+                writeTrigger(it, triggerPackage);
+            }
         }
     }
+    if (mpCache) {
+        mpCache->mTriggers.swap(stillUsed);
+    }
 }
 
 void XMLexport::writeVariable(TVar* pVar, LuaInterface* pLuaInterface, VarUnit* pVariableUnit, pugi::xml_node xmlParent)
@@ -28,11 +28,14 @@
 #include "pre_guard.h"
 #include <QClipboard>
 #include <QFuture>
+#include <QHash>
 #include <QPointer>
 #include <QSaveFile>
 #include <pugixml.hpp>
 #include "post_guard.h"
 
+#include <memory>
+
 class QFile;
 class Host;
 class LuaInterface;
@@ -46,6 +49,30 @@ class TVar;
 class VarUnit;
 
 
+// The XML written for each top level item (and so everything below it) that
+// is not part of a module the last time the profile was saved, keyed by the
+// item's id. A profile save only writes the items that have changed since
+// then, see Tree<T>::isUnsaved(), and copies the rest from here. Each document
+// can hold any number of nodes as an item that is not exported itself may
+// still have children that are:
+class XMLexportCache
+{
+    friend class XMLexport;
+
+public:
+    void clear();
+
+private:
+    using Fragments = QHash<int, std::shared_ptr<pugi::xml_document>>;
+
+    Fragments mTriggers;
+    Fragments mTimers;
+    Fragments mAliases;
+    Fragments mActions;
+    Fragments mScripts;
+    Fragments mKeys;
+};
+
 class XMLexport : public QObject
 {
     Q_OBJECT
@@ -100,6 +127,11 @@ private:
     TScript* mpScript;
     TKey* mpKey;
     pugi::xml_document mExportDoc;
+    // Only used for saving the profile, see exportHost(...):
+    XMLexportCache* mpCache = nullptr;
+
+    template <class T>
+    void writeCachedItem(T*, XMLexportCache::Fragments& fragments, XMLexportCache::Fragments& stillUsed, void (XMLexport::*writeItem)(T*, pugi::xml_node), pugi::xml_node xmlParent);
 
     void writeTriggerPackage(const Host* pHost, pugi::xml_node& mMudletPackage, bool skipModuleMembers);
     void writeTimerPackage(const Host* pHost, pugi::xml_node& mMudletPackage, bool skipModuleMembers);
@@ -647,9 +647,51 @@ std::pair<dlgTriggerEditor::EditorViewType, int> XMLimport::readPackage()
             }
         }
     }
+    compilePendingPatterns();
     return {objectType, rootItemID};
 }
 
+// The PCRE compilation (and JIT compilation, where available) of the regexes
+// is the slow part of loading large packages and, unlike the Lua code which
+// has to go through the one lua_State, it can be done on other threads. The
+// results are then handed to the items here on the main thread in the order
+// they were read, so any errors are reported just as they would have been:
+void XMLimport::compilePendingPatterns()
+{
+    QList<QByteArray> regexes;
+    for (auto pT : std::as_const(mPendingTriggers)) {
+        for (int i = 0, total = qMin(pT->mPatterns.size(), pT->mPatternKinds.size()); i < total; ++i) {
+            if (pT->mPatternKinds.at(i) == REGEX_PERL) {
+                QString pattern = pT->mPatterns.at(i);
+                pattern.remove(QChar::LineFeed);
+                if (!pattern.isEmpty()) {
+                    regexes.append(pattern.toUtf8());
+                }
+            }
+        }
+    }
+    for (const auto& pendingAlias : std::as_const(mPendingAliasRegexes)) {
+        if (!pendingAlias.second.isEmpty()) {
+            regexes.append(pendingAlias.second.toUtf8());
+        }
+    }
+
+    const auto precompiled = TRegex::compileAll(regexes, mpHost->mUsePcreJit);
+
+    for (auto pT : std::as_const(mPendingTriggers)) {
+        if (!pT->setRegexCodeList(pT->mPatterns, pT->mPatternKinds, precompiled)) {
+            qDebug().nospace() << "XMLimport::readTrigger(...): ERROR: can not "
+                                  "initialize pattern list for trigger: "
+                               << pT->getName();
+        }
+    }
+    for (const auto& pendingAlias : std::as_const(mPendingAliasRegexes)) {
+        pendingAlias.first->setRegexCode(pendingAlias.second, precompiled);
+    }
+    mPendingTriggers.clear();
+    mPendingAliasRegexes.clear();
+}
+
 void XMLimport::readHelpPackage()
 {
     while (!atEnd()) {
@@ -725,6 +767,7 @@ void XMLimport::readHost(Host* pHost)
 
     setBoolAttributeWithDefault(qsl("announceIncomingText"), pHost->mAnnounceIncomingText, true);
     setBoolAttributeWithDefault(qsl("advertiseScreenReader"), pHost->mAdvertiseScreenReader, false);
+    setBoolAttributeWithDefault(qsl("usePcreJit"), pHost->mUsePcreJit, true);
     setBoolAttributeWithDefault(qsl("mEnableMTTS"), pHost->mEnableMTTS, true);
     setBoolAttributeWithDefault(qsl("mEnableMNES"), pHost->mEnableMNES, false);
     setBoolAttributeWithDefault(qsl("forceNewEnvironNegotiationOff"), pHost->mForceNewEnvironNegotiationOff, false);
@@ -784,6 +827,7 @@ void XMLimport::readHost(Host* pHost)
     const bool useSharedDictionary = attributes().value(qsl("mUseSharedDictionary")) == YES;
     pHost->setUserDictionaryOptions(enableUserDictionary, useSharedDictionary);
     pHost->mMapperShowRoomBorders = readDefaultTrueBool(qsl("mMapperShowRoomBorders"));
+    setBoolAttributeWithDefault(qsl("mMapperAreaRouting"), pHost->mMapperAreaRouting, false);
     pHost->mEditorTheme = attributes().value(QLatin1String("mEditorTheme")).toString();
     pHost->mEditorThemeFile = attributes().value(QLatin1String("mEditorThemeFile")).toString();
     pHost->mThemePreviewItemID = attributes().value(QLatin1String("mThemePreviewItemID")).toInt();
@@ -1413,11 +1457,8 @@ int XMLimport::readTrigger(TTrigger* pParent)
         }
     }
 
-    if (!pT->setRegexCodeList(pT->mPatterns, pT->mPatternKinds)) {
-        qDebug().nospace() << "XMLimport::readTrigger(...): ERROR: can not "
-                              "initialize pattern list for trigger: "
-                           << pT->getName();
-    }
+    // The patterns are set (and compiled) by compilePendingPatterns():
+    mPendingTriggers.append(pT);
 
     return pT->getID();
 }
@@ -1548,7 +1589,8 @@ int XMLimport::readAlias(TAlias* pParent)
             } else if (name() == qsl("command")) {
                 pT->mCommand = readElementText();
             } else if (name() == qsl("regex")) {
-                pT->setRegexCode(readElementText());
+                // Compiled later by compilePendingPatterns():
+                mPendingAliasRegexes.append(qMakePair(pT, readElementText()));
             } else if (name() == qsl("AliasGroup") || name() == qsl("Alias")) {
                 readAlias(pT);
             } else {
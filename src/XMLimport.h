@@ -32,6 +32,7 @@
 #include <QFile>
 #include <QMap>
 #include <QMultiHash>
+#include <QPair>
 #include <QPointer>
 #include <QXmlStreamReader>
 #include <QClipboard>
@@ -107,6 +108,7 @@ private:
     void remapColorsToAnsiNumber(QStringList&, const QList<int>&);
 
     bool readDefaultTrueBool(QString name);
+    void compilePendingPatterns();
 
     QPointer<Host> mpHost;
     QString mPackageName;
@@ -127,6 +129,11 @@ private:
     int mMaxRoomId;
     quint8 mVersionMajor;
     quint16 mVersionMinor; // Cannot be a quint8 as that only allows x.255 for the decimal
+    // The triggers and aliases read in so far whose Perl regexes still need
+    // compiling, in document order - they are all compiled together, spread
+    // over the available cores, once the whole package has been read:
+    QList<TTrigger*> mPendingTriggers;
+    QList<QPair<TAlias*, QString>> mPendingAliasRegexes;
 };
 
 #endif // MUDLET_XMLEXPORT_H
@@ -34,6 +34,7 @@
 #include "TBuffer.h"
 #include "TConsole.h"
 #include "TEvent.h"
+#include "TLuaJsonDecoder.h"
 #include "TMainConsole.h"
 #include "TMap.h"
 #include "TMedia.h"
@@ -112,6 +113,12 @@ cTelnet::cTelnet(Host* pH, const QString& profileName)
     });
 
 
+    mpReceiver = new TTelnetReceiver();
+    mpReceiver->moveToThread(&mReceiveThread);
+    connect(mpReceiver, &TTelnetReceiver::signal_eventsReady, this, &cTelnet::slot_processReceivedEvents, Qt::QueuedConnection);
+    mReceiveThread.setObjectName(qsl("receiver for %1").arg(profileName));
+    mReceiveThread.start();
+
     // initialize telnet session
     reset();
 
@@ -148,11 +155,18 @@ void cTelnet::reset()
     mGA_Driver = false;
     command = "";
     mMudData = "";
+    mpReceiver->postReset();
+    mLoopbackReceiver.reset();
+    mReceivedText.clear();
 }
 
 
 cTelnet::~cTelnet()
 {
+    mReceiveThread.quit();
+    mReceiveThread.wait();
+    delete mpReceiver;
+
     if (loadingReplay) {
         // If we are doing a replay we had better abort it so that if we are
         // NOT the "last profile standing" the replay system gets reset for
@@ -491,6 +505,13 @@ void cTelnet::slot_socketDisconnected()
 
     postData();
 
+    // What the game sent just before it closed the connection - often its
+    // farewell message - may not have come back from the receiver yet, it
+    // has to be shown before the disconnection is reported as the reset()
+    // below would otherwise drop it:
+    mpReceiver->waitForInput();
+    processReceivedEvents(*mpReceiver);
+
     emit signal_disconnected(mpHost);
 
     event.mArgumentList.append(qsl("sysDisconnectionEvent"));
@@ -506,7 +527,6 @@ void cTelnet::slot_socketDisconnected()
                                 modification for some locales, e.g. France, Spain.
                                 */
                                .toString(tr("hh:mm:ss.zzz")));
-    mNeedDecompression = false;
     reset();
 
     if (!mpHost->isClosingDown()) {
@@ -1850,9 +1870,9 @@ void cTelnet::processTelnetCommand(const std::string& telnetCommand)
                         hisOptionState[idxOption] = false;
                         qDebug() << "Rejecting MCCP v1, because v2 has already been negotiated.";
                     } else {
-                        sendTelnetOption(TN_DO, option);
-                        hisOptionState[idxOption] = true;
-                        //inform MCCP object about the change
+                        //inform MCCP object about the change - before agreeing
+                        //to it, as the game can start compressing as soon as
+                        //it gets our reply:
                         if (option == OPT_COMPRESS) {
                             mMCCP_version_1 = true;
                             qDebug() << "MCCP v1 negotiated.";
@@ -1860,6 +1880,9 @@ void cTelnet::processTelnetCommand(const std::string& telnetCommand)
                             mMCCP_version_2 = true;
                             qDebug() << "MCCP v2 negotiated!";
                         }
+                        setCompressionAllowed();
+                        sendTelnetOption(TN_DO, option);
+                        hisOptionState[idxOption] = true;
                     }
                 } else if (supportedTelnetOptions.contains(option)) {
                     sendTelnetOption(TN_DO, option);
@@ -1957,6 +1980,9 @@ void cTelnet::processTelnetCommand(const std::string& telnetCommand)
                     mMCCP_version_2 = false;
                     qDebug() << "MCCP v2 disabled !";
                 }
+                if (option == OPT_COMPRESS || option == OPT_COMPRESS2) {
+                    setCompressionAllowed();
+                }
             }
             heAnnouncedState[idxOption] = true;
         }
@@ -2746,26 +2772,15 @@ void cTelnet::handleGUIPackageInstallationAndUpgrade(QJsonDocument document) {
 
 void cTelnet::setGMCPVariables(const QByteArray& msg)
 {
-    // JSON (and thus the GMCP data) is always utf8
-    QString transcodedMsg(msg);
+    // JSON (and thus the GMCP data) is always utf8 - so the data is kept as
+    // the bytes that arrived, to hand straight to the Lua JSON decoder, and is
+    // only converted to a QString for the few packages handled here:
+    QByteArray packageBytes;
+    QByteArray data;
+    TLuaJsonDecoder::splitGmcpMessage(msg, packageBytes, data);
+    QString packageMessage = QString::fromUtf8(packageBytes);
 
-    QString packageMessage;
-    QString data;
-
-    int firstNewline = transcodedMsg.indexOf(QChar::LineFeed);
-    int firstSpace = transcodedMsg.indexOf(QChar::Space);
-
-    // if we see a space before a newline, or no newlines at all,
-    // then that's the separator for message and data
-    if (Q_LIKELY((firstSpace != -1 && firstSpace < firstNewline) || firstNewline == -1)) {
-        packageMessage = transcodedMsg.section(QChar::Space, 0, 0);
-        data = transcodedMsg.section(QChar::Space, 1);
-    } else {
-        packageMessage = transcodedMsg.section(QChar::LineFeed, 0, 0);
-        data = transcodedMsg.section(QChar::LineFeed, 1);
-    }
-
-    if (transcodedMsg.startsWith(qsl("Client.GUI"), Qt::CaseInsensitive)) {
+    if (packageMessage.startsWith(qsl("Client.GUI"), Qt::CaseInsensitive)) {
         if (!mpHost->mAcceptServerGUI) {
             return;
         }
@@ -2779,10 +2794,11 @@ void cTelnet::setGMCPVariables(const QByteArray& msg)
         // If the data does not parse as JSON, we'll try Raw telnet.
 
         bool rawTelnet = false;
-        auto document = QJsonDocument::fromJson(data.toUtf8());
+        auto document = QJsonDocument::fromJson(data);
 
         if (!document.isObject()) {
             // This is raw telnet, not JSON
+            const QString transcodedMsg = QString::fromUtf8(msg);
             QString version = transcodedMsg.section(QChar::LineFeed, 0);
 
             version.remove(QLatin1String("Client.GUI "), Qt::CaseInsensitive);
@@ -2803,27 +2819,27 @@ void cTelnet::setGMCPVariables(const QByteArray& msg)
         if (rawTelnet) {
             return; // Do not add to the GMCP table
         }
-    } else if (transcodedMsg.startsWith(QLatin1String("Client.Map"), Qt::CaseInsensitive)) {
-        mpHost->setMmpMapLocation(data);
+    } else if (packageMessage.startsWith(QLatin1String("Client.Map"), Qt::CaseInsensitive)) {
+        mpHost->setMmpMapLocation(QString::fromUtf8(data));
     }
-    data.remove(QChar::LineFeed);
+    data.replace('\n', QByteArray());
     // replace ANSI escape character with escaped version, to handle improperly passed ANSI codes
-    // trying a different way of specifying the escape character
-    data.replace(QLatin1String("\u001B"), QLatin1String("\\u001B"));
+    data.replace("\x1B", "\\u001B");
     // remove \r's from the data, as yajl doesn't like it
-    data.remove(QChar::CarriageReturn);
+    data.replace('\r', QByteArray());
 
     if (packageMessage.startsWith(QLatin1String("External.Discord.Status"), Qt::CaseInsensitive)
         || packageMessage.startsWith(QLatin1String("External.Discord.Info"), Qt::CaseInsensitive)) {
-        mpHost->processDiscordGMCP(packageMessage, data);
+        mpHost->processDiscordGMCP(packageMessage, QString::fromUtf8(data));
     }
 
     if (mpHost->mAcceptServerMedia && packageMessage.startsWith(qsl("Client.Media"), Qt::CaseInsensitive)) {
-        mpHost->mpMedia->parseGMCP(packageMessage, data);
+        QString dataString = QString::fromUtf8(data);
+        mpHost->mpMedia->parseGMCP(packageMessage, dataString);
     }
 
     if (packageMessage.startsWith(qsl("Char.Login"), Qt::CaseInsensitive)) {
-        mpHost->mpAuth->handleAuthGMCP(packageMessage, data);
+        mpHost->mpAuth->handleAuthGMCP(packageMessage, QString::fromUtf8(data));
     }
 
     mpHost->mLuaInterpreter.setGMCPTable(packageMessage, data);
@@ -3339,53 +3355,6 @@ void cTelnet::postData()
     }
 }
 
-void cTelnet::initStreamDecompressor()
-{
-    mZstream.zalloc = Z_NULL;
-    mZstream.zfree = Z_NULL;
-    mZstream.opaque = Z_NULL;
-    mZstream.avail_in = 0;
-    mZstream.next_in = Z_NULL;
-
-    inflateInit(&mZstream);
-}
-
-int cTelnet::decompressBuffer(char*& in_buffer, int& length, char* out_buffer)
-{
-    mZstream.avail_in = length;
-    mZstream.next_in = (Bytef*)in_buffer;
-
-    mZstream.avail_out = BUFFER_SIZE;
-    mZstream.next_out = (Bytef*)out_buffer;
-
-    int zval = inflate(&mZstream, Z_SYNC_FLUSH);
-    int outSize = BUFFER_SIZE - mZstream.avail_out;
-
-    length = mZstream.avail_in;
-    in_buffer = (char*)mZstream.next_in;
-
-    if (zval == Z_STREAM_END) {
-        inflateEnd(&mZstream);
-        qDebug() << "recv Z_STREAM_END, ending compression";
-        this->mNeedDecompression = false;
-
-        hisOptionState[static_cast<int>(OPT_COMPRESS)] = false;
-        hisOptionState[static_cast<int>(OPT_COMPRESS2)] = false;
-
-        // zval should always be NULL on inflateEnd.  No need for an else block. MCCP Rev. 3 -MH //
-        initStreamDecompressor();
-        qDebug() << "Listening for new compression sequences";
-
-        // We shouldn't return -1 or an error here, as that prevents any text
-        // or any telnet negotiation strings from being properly interpreted
-        // by Mudlet, and shown to the user.
-        // Returning outSize ensures anything sent before the Z_STREAM_END is
-        // shown to the user.
-    }
-    return outSize;
-}
-
-
 void cTelnet::recordReplay()
 {
     mRecordLastChunkMSecTimeOffset = 0;
@@ -3457,29 +3426,43 @@ bool cTelnet::loadReplay(const QString& name, QString* pErrMsg)
     return true;
 }
 
-// TODO: https://github.com/Mudlet/Mudlet/issues/5779 - consider enhancing replay system, possibly using the QTimeLine class
-void cTelnet::loadReplayChunk()
+// Reads the next chunk of the replay into loadBuffer, with the delay (in
+// milliseconds) to wait before processing it; returns false at the end:
+bool cTelnet::readReplayChunk(qint32& offset)
 {
-    if (!replayStream.atEnd()) {
-        qint32 amount = 0;
-        qint32 offset = 0;
-        if (mReplayHasFaultyFormat) {
-            qint64 temp = 0;
-            replayStream >> temp;
-            // 2^30 milliseconds is over 12 days so that sort of delay between
-            // steps is not likely - and only using a 32 bit integer type is
-            // going to be okay:
-            offset = static_cast<qint32>(temp);
-        } else {
-            replayStream >> offset;
-        }
+    if (replayStream.atEnd()) {
+        return false;
+    }
+
+    qint32 amount = 0;
+    if (mReplayHasFaultyFormat) {
+        qint64 temp = 0;
+        replayStream >> temp;
+        // 2^30 milliseconds is over 12 days so that sort of delay between
+        // steps is not likely - and only using a 32 bit integer type is
+        // going to be okay:
+        offset = static_cast<qint32>(temp);
+    } else {
+        replayStream >> offset;
+    }
 
-        replayStream >> amount;
+    replayStream >> amount;
+
+    loadedBytes = replayStream.readRawData(loadBuffer, amount);
+    if (loadedBytes < 0) {
+        loadedBytes = 0;
+    }
+    // Previous use of loadedBytes + 1 caused a spurious character at end of
+    // string display by a qDebug of the loadBuffer contents
+    loadBuffer[loadedBytes] = '\0';
+    return true;
+}
 
-        loadedBytes = replayStream.readRawData(loadBuffer, amount);
-        // Previous use of loadedBytes + 1 caused a spurious character at end of
-        // string display by a qDebug of the loadBuffer contents
-        loadBuffer[loadedBytes] = '\0';
+// TODO: https://github.com/Mudlet/Mudlet/issues/5779 - consider enhancing replay system, possibly using the QTimeLine class
+void cTelnet::loadReplayChunk()
+{
+    qint32 offset = 0;
+    if (readReplayChunk(offset)) {
         mudlet::self()->mReplayTime = mudlet::self()->mReplayTime.addMSecs(offset);
         QTimer::singleShot(offset / mudlet::self()->mReplaySpeed, this, &cTelnet::slot_processReplayChunk);
     } else {
@@ -3492,8 +3475,53 @@ void cTelnet::loadReplayChunk()
     }
 }
 
+// Pushes a whole replay through the same processing as a live session, as
+// fast as possible and without the delays between the chunks, and reports
+// how long each stage of it took - for the --replay-benchmark command line
+// option:
+bool cTelnet::runReplayBenchmark(const QString& fileName, QString& report)
+{
+    if (loadingReplay) {
+        report = qsl("Cannot run a replay benchmark while a replay is in progress.");
+        return false;
+    }
+
+    replayFile.setFileName(fileName);
+    if (!replayFile.open(QIODevice::ReadOnly)) {
+        report = qsl("Cannot read file \"%1\", error message was: \"%2\".").arg(fileName, replayFile.errorString());
+        return false;
+    }
+
+    replayStream.setDevice(&replayFile);
+    if (QVersionNumber::fromString(QString(qVersion())) >= QVersionNumber(5, 13, 0)) {
+        replayStream.setVersion(mudlet::scmQDataStreamFormat_5_12);
+    }
+    auto [ok, modifiedFormat] = testReadReplayFile();
+    if (!ok) {
+        replayFile.close();
+        report = qsl("Cannot replay file \"%1\", it seems to be corrupt.").arg(fileName);
+        return false;
+    }
+
+    mReplayHasFaultyFormat = modifiedFormat;
+    TInboundStats& stats = mpHost->mInboundStats;
+    stats.start();
+    qint32 offset = 0;
+    while (readReplayChunk(offset)) {
+        stats.addBytes(loadedBytes);
+        slot_processReplayChunk();
+    }
+    // Flush out any incomplete last line rather than waiting for the timer:
+    slot_timerPosting();
+    stats.stop();
+    replayFile.close();
+    report = qsl("Replay benchmark of \"%1\":\n%2").arg(fileName, stats.report());
+    return true;
+}
+
 void cTelnet::slot_processReplayChunk()
 {
+    const TInboundStats::Scope timeTelnet(mpHost->mInboundStats, TInboundStats::Telnet);
     int datalen = loadedBytes;
     std::string cleandata = "";
     recvdGA = false;
@@ -3591,186 +3619,50 @@ void cTelnet::slot_socketReadyToBeRead()
         mWaitingForResponse = false;
     }
 
-    // TODO: https://github.com/Mudlet/Mudlet/issues/5780 (2 of 7) - investigate switching from using `char[]` to `std::array<char>`
-    char in_buffer[BUFFER_SIZE + 10];
-
-    int amount = socket.read(in_buffer, BUFFER_SIZE);
-    processSocketData(in_buffer, amount);
+    // Everything else is done on the receiver's thread and then handed back to
+    // slot_processReceivedEvents():
+    mpReceiver->post(socket.readAll());
 }
 
-void cTelnet::processSocketData(char* in_buffer, int amount, const bool loopbackTesting)
+void cTelnet::slot_processReceivedEvents()
 {
-    // TODO: https://github.com/Mudlet/Mudlet/issues/5780 (3 of 7) - investigate switching from using `char[]` to `std::array<char>`
-    char out_buffer[BUFFER_SIZE + 10];
-
-    in_buffer[amount + 1] = '\0';
-    if (amount == -1) {
-        return;
-    }
-    if (amount == 0) {
-        return;
-    }
-
-    std::string cleandata = "";
-    qint32 datalen = 0;
-    do {
-        datalen = amount;
-        char* buffer = in_buffer;
-        if (mNeedDecompression) {
-            datalen = decompressBuffer(in_buffer, amount, out_buffer);
-            buffer = out_buffer;
-        }
-        // TODO: https://github.com/Mudlet/Mudlet/issues/5780 (4 of 7) - investigate switching from using `char[]` to `std::array<char>`
-        buffer[static_cast<size_t>(datalen)] = '\0';
-        if (!loopbackTesting && mpHost->mpConsole->mRecordReplay) {
-            ++mRecordingChunkCount;
-            // QElapsedTimer::elapsed() returns a qint64, it replaces a
-            // previous QTime::elapsed() which returns a int (effectively a
-            // qint32):
-            qint32 recordingChunkInterval = static_cast<qint32>(mRecordingChunkTimer.elapsed()) - mRecordLastChunkMSecTimeOffset;
-            mpHost->mpConsole->mReplayStream << recordingChunkInterval; // 4 bytes
-            mpHost->mpConsole->mReplayStream << datalen;                // 4 bytes
-            mpHost->mpConsole->mReplayStream.writeRawData(buffer, datalen);
-#if defined(DEBUG_RECORDING)
-            qDebug().noquote().nospace() << "cTelnet::processSocketData(...) INFO - recording chunk: " << mRecordingChunkCount << " is " << datalen
-                                         << " bytes and has an interval of: " << recordingChunkInterval << " mSecond since the previous chunk.";
-#endif
-        }
-
-        recvdGA = false;
-        for (int i = 0; i < datalen; ++i) {
-            char ch = buffer[i];
+    processReceivedEvents(*mpReceiver);
+}
 
-            if (iac || iac2 || insb || (ch == TN_IAC)) {
-                if (!(iac || iac2 || insb) && (ch == TN_IAC)) {
-                    iac = true;
-                    command += ch;
-                } else if (iac && (ch == TN_IAC) && (!insb)) {
-                    //2. seq. of two IACs
-                    iac = false;
-                    cleandata += ch;
-                    command = "";
-                } else if (iac && (!insb) && ((ch == TN_WILL) || (ch == TN_WONT) || (ch == TN_DO) || (ch == TN_DONT))) {
-                    //3. IAC DO/DONT/WILL/WONT
-                    iac = false;
-                    iac2 = true;
-                    command += ch;
-                } else if (iac2) {
-                    //4. IAC DO/DONT/WILL/WONT <command code>
-                    iac2 = false;
-                    command += ch;
-                    processTelnetCommand(command);
-                    command = "";
-                } else if (iac && (!insb) && (ch == TN_SB)) {
-                    //5. IAC SB
-                    iac = false;
-                    insb = true;
-                    command += ch;
-                } else if (iac && (!insb) && (ch == TN_SE)) {
-                    //6. IAC SE without IAC SB - error - ignored
-                    command = "";
-                    iac = false;
-                } else if (insb) {
-                    // IAC SB COMPRESS WILL SE for MCCP v1 (unterminated invalid telnet sequence)
-                    // IAC SB COMPRESS2 IAC SE for MCCP v2
-                    if ((mMCCP_version_1 || mMCCP_version_2) && (!mNeedDecompression)) {
-                        // TODO this code looks ahead instead of using the state machine.
-                        // This is not a good idea.
-                        char _ch = buffer[i];
-                        if ((_ch == OPT_COMPRESS) || (_ch == OPT_COMPRESS2)) {
-                            bool _compress = false;
-                            if ((i > 1) && (i + 2 < datalen)) {
-                                if ((buffer[i - 2] == TN_IAC) && (buffer[i - 1] == TN_SB) && (buffer[i + 1] == TN_WILL) && (buffer[i + 2] == TN_SE)) {
-                                    qDebug() << "MCCP version 1 starting sequence";
-                                    _compress = true;
-                                }
-                                if ((buffer[i - 2] == TN_IAC) && (buffer[i - 1] == TN_SB) && (buffer[i + 1] == TN_IAC) && (buffer[i + 2] == TN_SE)) {
-                                    qDebug() << "MCCP version 2 starting sequence";
-                                    _compress = true;
-                                }
-                            }
-                            if (_compress) {
-                                mNeedDecompression = true;
-                                // from this position in stream onwards, data will be compressed by zlib
-                                gotRest(cleandata);
-                                cleandata = "";
-                                initStreamDecompressor();
-                                buffer += i + 3; //bugfix: BenH
-                                int restLength = datalen - i - 3;
-                                if (restLength > 0) {
-                                    datalen = decompressBuffer(buffer, restLength, out_buffer);
-                                    buffer = out_buffer;
-                                    i = -1; // start processing buffer from the beginning.
-                                } else {
-                                    datalen = 0;
-                                    i = -1; // end the loop, this will make i and datalen the same.
-                                }
-                                // compressed data starts in clean state
-                                iac = false;
-                                insb = false;
-                                command = "";
-                                goto MAIN_LOOP_END;
-                            }
-                        }
-                    }
-                    //7. inside IAC SB
-
-                    command += ch;
-                    if (iac && (ch == TN_SE)) { //IAC SE - end of subcommand
-                        processTelnetCommand(command);
-                        command = "";
-                        iac = false;
-                        insb = false;
-                    } else if (iac && (ch == TN_IAC)) { // escaped TN_IAC
-                        command.pop_back();
-                        iac = false;
-                    } else if (iac) {
-                        // Telnet options within a subcommand are not supported.
-                        // We assume that the SE went missing, possibly due to a
-                        // server bug, and try to recover.
-                        // Cf. https://github.com/Mudlet/Mudlet/issues/4385
-                        command.pop_back();
-                        command += TN_SE;
-                        processTelnetCommand(command);
-                        if (!mIncompleteSB) {
-                            mIncompleteSB = true;
-                            qWarning(R"("TELNET: the server did not properly complete a subnegotiation (code %02x).
-Some data loss is likely - please mention this problem to the game admins.)", command[2]);
-                        }
+void cTelnet::loopbackTest(QByteArray& data)
+{
+    mLoopbackReceiver.receive(data.constData(), data.size());
+    processReceivedEvents(mLoopbackReceiver, true);
+}
 
+void cTelnet::setCompressionAllowed()
+{
+    mpReceiver->setCompressionAllowed(mMCCP_version_1, mMCCP_version_2);
+    mLoopbackReceiver.setCompressionAllowed(mMCCP_version_1, mMCCP_version_2);
+}
 
-                        // Re-enter the state machine.
-                        command = TN_IAC;
-                        iac = true;
-                        insb = false;
-                        i -= 1;
-                    } else if (ch == TN_IAC) {
-                        iac = true;
-                    }
-                } else
-                //8. IAC fol. by something else than IAC, SB, SE, DO, DONT, WILL, WONT
-                {
-                    iac = false;
-                    command += ch;
-                    processTelnetCommand(command);
-                    //this could have set receivedGA to true; we'll handle that later
-                    command = "";
-                }
-            } else {
-                if (ch == TN_BELL) {
-                    // Flash taskbar for 3 seconds on the telnet bell, note
-                    // by processing it here rather than in the TTextEdit class
-                    // it is not possible to fake/test it with a Lua
-                    // feedTriggers(...) call - OTOH doing it there would make
-                    // a beep every time the screen was refreshed!
-                    // TODO: https://github.com/Mudlet/Mudlet/issues/5836 - provide option to actually make a (void) QApplication::beep() or a user-selected sound (different for each profile) and/or instead of the visual alert
-                    QApplication::alert(mudlet::self(), 3000);
-                }
-                if (ch != '\r' && ch != '\0') {
-                    cleandata += ch;
-                }
+void cTelnet::processReceivedEvents(TTelnetReceiver& receiver, const bool loopbackTesting)
+{
+    const TInboundStats::Scope timeTelnet(mpHost->mInboundStats, TInboundStats::Telnet);
+    TTelnetEvent event;
+    while (receiver.takeEvent(event)) {
+        switch (event.mType) {
+        case TTelnetEvent::Text:
+            if (event.mData.find(TN_BELL) != std::string::npos) {
+                // Flash taskbar for 3 seconds on the telnet bell, note
+                // by processing it here rather than in the TTextEdit class
+                // it is not possible to fake/test it with a Lua
+                // feedTriggers(...) call - OTOH doing it there would make
+                // a beep every time the screen was refreshed!
+                // TODO: https://github.com/Mudlet/Mudlet/issues/5836 - provide option to actually make a (void) QApplication::beep() or a user-selected sound (different for each profile) and/or instead of the visual alert
+                QApplication::alert(mudlet::self(), 3000);
             }
-        MAIN_LOOP_END:;
+            mReceivedText += event.mData;
+            break;
+
+        case TTelnetEvent::Command:
+            recvdGA = false;
+            processTelnetCommand(event.mData);
             if (recvdGA) {
                 if (!mFORCE_GA_OFF) //FIXME: isn't initialized correctly
                 {
@@ -3781,22 +3673,54 @@ Some data loss is likely - please mention this problem to the game admins.)", co
                             mCommands = 0;
                         }
                     }
-                    cleandata.push_back('\xff');
+                    mReceivedText.push_back('\xff');
                     recvdGA = false;
-                    gotPrompt(cleandata);
-                    cleandata = "";
+                    gotPrompt(mReceivedText);
+                    mReceivedText.clear();
                 } else {
-                    cleandata.push_back('\n');
+                    mReceivedText.push_back('\n');
                 }
             }
-        } //for
-    } while (datalen == BUFFER_SIZE);
+            break;
 
-    if (!cleandata.empty()) {
-        gotRest(cleandata);
+        case TTelnetEvent::CompressionStarted:
+            if (!mReceivedText.empty()) {
+                gotRest(mReceivedText);
+                mReceivedText.clear();
+            }
+            break;
+
+        case TTelnetEvent::CompressionEnded:
+            hisOptionState[static_cast<int>(OPT_COMPRESS)] = false;
+            hisOptionState[static_cast<int>(OPT_COMPRESS2)] = false;
+            qDebug() << "Listening for new compression sequences";
+            break;
+
+        case TTelnetEvent::Chunk:
+            if (!loopbackTesting && mpHost->mpConsole->mRecordReplay) {
+                ++mRecordingChunkCount;
+                // QElapsedTimer::elapsed() returns a qint64, it replaces a
+                // previous QTime::elapsed() which returns a int (effectively a
+                // qint32):
+                qint32 recordingChunkInterval = static_cast<qint32>(mRecordingChunkTimer.elapsed()) - mRecordLastChunkMSecTimeOffset;
+                const auto datalen = static_cast<qint32>(event.mData.size());
+                mpHost->mpConsole->mReplayStream << recordingChunkInterval; // 4 bytes
+                mpHost->mpConsole->mReplayStream << datalen;                // 4 bytes
+                mpHost->mpConsole->mReplayStream.writeRawData(event.mData.data(), datalen);
+#if defined(DEBUG_RECORDING)
+                qDebug().noquote().nospace() << "cTelnet::processReceivedEvents(...) INFO - recording chunk: " << mRecordingChunkCount << " is " << datalen
+                                             << " bytes and has an interval of: " << recordingChunkInterval << " mSecond since the previous chunk.";
+#endif
+            }
+            if (!mReceivedText.empty()) {
+                gotRest(mReceivedText);
+                mReceivedText.clear();
+            }
+            mpHost->mpConsole->finalize();
+            mRecordLastChunkMSecTimeOffset = mRecordingChunkTimer.elapsed();
+            break;
+        }
     }
-    mpHost->mpConsole->finalize();
-    mRecordLastChunkMSecTimeOffset = mRecordingChunkTimer.elapsed();
 }
 
 void cTelnet::raiseProtocolEvent(const QString& name, const QString& protocol)
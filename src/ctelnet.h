@@ -32,12 +32,15 @@
 #include <winsock2.h>
 #endif
 
+#include "TTelnetReceiver.h"
+
 #include "pre_guard.h"
 #include <QElapsedTimer>
 #include <QHostAddress>
 #include <QHostInfo>
 #include <QPointer>
 #include <QStringList>
+#include <QThread>
 #if defined(QT_NO_SSL)
 #include <QTcpSocket>
 #else
@@ -46,8 +49,6 @@
 #include <QTime>
 #include "post_guard.h"
 
-#include <zlib.h>
-
 #include <iostream>
 #include <queue>
 #include <string>
@@ -198,6 +199,7 @@ public:
     void recordReplay();
     bool loadReplay(const QString&, QString* pErrMsg = nullptr);
     void loadReplayChunk();
+    bool runReplayBenchmark(const QString&, QString& report);
     bool isReplaying() { return loadingReplay; }
     void setChannel102Variables(const QString&);
     bool socketOutRaw(std::string& data);
@@ -227,7 +229,7 @@ public:
     std::tuple<QString, int, bool> getConnectionInfo() const;
     void setPostingTimeout(const int);
     int getPostingTimeout() const { return mTimeOut; }
-    void loopbackTest(QByteArray& data) { processSocketData(data.data(), data.size(), true); }
+    void loopbackTest(QByteArray& data);
     void cancelLoginTimers();
 
 
@@ -253,6 +255,7 @@ public slots:
     void slot_socketConnected();
     void slot_socketDisconnected();
     void slot_socketReadyToBeRead();
+    void slot_processReceivedEvents();
 // Not used    void slot_socketError();
 #if !defined(QT_NO_SSL)
     void slot_socketSslError(const QList<QSslError>&);
@@ -273,9 +276,8 @@ private:
 
     // loopbackTesting is for internal testing whilst OFF-LINE using the
     // feedTelnet(...) Lua function.
-    void processSocketData(char *data, int size, const bool loopbackTesting = false);
-    void initStreamDecompressor();
-    int decompressBuffer(char*& in_buffer, int& length, char* out_buffer);
+    void processReceivedEvents(TTelnetReceiver&, const bool loopbackTesting = false);
+    void setCompressionAllowed();
     void reset();
     void sendLoginAndPass();
 
@@ -324,6 +326,7 @@ private:
     void handleGUIPackageInstallationAndUpgrade(QJsonDocument document);
 
     static std::pair<bool, bool> testReadReplayFile();
+    bool readReplayChunk(qint32& offset);
 
 
     QPointer<Host> mpHost;
@@ -343,9 +346,18 @@ private:
     bool mWaitingForResponse = false;
     std::queue<int> mCommandQueue;
 
-    z_stream mZstream = {};
-
-    bool mNeedDecompression = false;
+    // The data read from the socket is decompressed and split into text and
+    // telnet commands by mpReceiver on mReceiveThread, so that it does not
+    // hold up the reading of the socket when the GUI is busy - what comes
+    // back is then processed here, in the same order:
+    QThread mReceiveThread;
+    TTelnetReceiver* mpReceiver = nullptr;
+    // For feedTelnet(...), which is processed immediately:
+    TTelnetReceiver mLoopbackReceiver;
+    // Game text received since the last prompt or the end of the last chunk:
+    std::string mReceivedText;
+
+    // The state of the telnet parser for replays:
     std::string command;
     bool iac = false;
     bool iac2 = false;
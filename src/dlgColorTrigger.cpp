@@ -305,6 +305,7 @@ void dlgColorTrigger::slot_basicColorClicked(int ansiColor)
         mpTrigger->mColorTriggerFgAnsi = ansiColor;
         mpTrigger->mColorTriggerFgColor = choosenColor;
     }
+    mpTrigger->setUnsaved();
 
     close();
 }
@@ -319,6 +320,7 @@ void dlgColorTrigger::slot_rgbColorClicked()
         mpTrigger->mColorTriggerFgAnsi = mRgbAnsiColorNumber;
         mpTrigger->mColorTriggerFgColor = mRgbAnsiColor;
     }
+    mpTrigger->setUnsaved();
 
     close();
 }
@@ -333,6 +335,7 @@ void dlgColorTrigger::slot_grayColorClicked()
         mpTrigger->mColorTriggerFgAnsi = mGrayAnsiColorNumber;
         mpTrigger->mColorTriggerFgColor = mGrayAnsiColor;
     }
+    mpTrigger->setUnsaved();
 
     close();
 }
@@ -349,6 +352,7 @@ void dlgColorTrigger::slot_resetColorClicked()
 
     // Reset mColorTrigger if NEITHER this one OR the other are set
     mpTrigger->mColorTrigger = (mpTrigger->mColorTriggerFgAnsi != TTrigger::scmIgnored || mpTrigger->mColorTriggerBgAnsi != TTrigger::scmIgnored);
+    mpTrigger->setUnsaved();
 
     close();
 }
@@ -362,6 +366,7 @@ void dlgColorTrigger::slot_defaultColorClicked()
         mpTrigger->mColorTriggerFgAnsi = TTrigger::scmDefault;
         mpTrigger->mColorTriggerFgColor = QColor();
     }
+    mpTrigger->setUnsaved();
 
     close();
 }
@@ -471,11 +471,12 @@ void dlgRoomExits::slot_addSpecialExit()
 
 void dlgRoomExits::save()
 {
-    mpHost->mpMap->mMapGraphNeedsUpdate = true;
     if (!pR) {
         return;
     }
 
+    mpHost->mpMap->markRoomExitsChanged(pR->getId());
+
     QList<QString> originalExitCmdsList{pR->getSpecialExits().keys()};
     QSet<QString> originalExitCmds{originalExitCmdsList.begin(), originalExitCmdsList.end()};
 
@@ -292,6 +292,9 @@ int main(int argc, char* argv[])
     const QCommandLineOption steamMode(QStringList() << qsl("steammode"), qsl("Adjusts Mudlet settings to match Steam's requirements."));
     parser.addOption(steamMode);
 
+    const QCommandLineOption replayBenchmark(QStringList() << qsl("replay-benchmark"), qsl("Run the replay through the profile as fast as possible, report the timings and exit."), qsl("replay_file"));
+    parser.addOption(replayBenchmark);
+
     parser.addPositionalArgument("package", "Path to .mpackage file");
 
     const bool parsedCommandLineOk = parser.parse(app->arguments());
@@ -328,6 +331,12 @@ int main(int argc, char* argv[])
                                                                   "                                    predefined game, may be repeated."));
         texts << appendLF.arg(QCoreApplication::translate("main", "       --steammode                  adjusts Mudlet settings to match\n"
                                                                   "                                    Steam's requirements."));
+        texts << appendLF.arg(QCoreApplication::translate("main", "       --replay-benchmark=<file>    load the (first) profile given with\n"
+                                                                  "                                    --profile without connecting, run the\n"
+                                                                  "                                    replay file through it as fast as\n"
+                                                                  "                                    possible, report how long each stage\n"
+                                                                  "                                    took and exit; add \"-platform offscreen\"\n"
+                                                                  "                                    to run it without a display."));
         texts << appendLF.arg(QCoreApplication::translate("main", "There are other inherited options that arise from the Qt Libraries which are\n"
                                                                   "less likely to be useful for normal use of this application:"));
         // From documentation and from http://qt-project.org/doc/qt-5/qapplication.html:
@@ -457,6 +466,7 @@ int main(int argc, char* argv[])
 
     const QStringList cliProfiles = parser.values(profileToOpen);
     const QStringList onlyProfiles = parser.values(onlyPredefinedProfileToShow);
+    const QString replayBenchmarkFile = parser.value(replayBenchmark);
     
     const bool showSplash = parser.isSet(showSplashscreen);
     QImage splashImage = mudlet::getSplashScreen(releaseVersion, publicTestVersion);
@@ -687,6 +697,17 @@ int main(int argc, char* argv[])
     if (!onlyProfiles.isEmpty()) {
         mudlet::self()->onlyShowProfiles(onlyProfiles);
     }
+    if (!replayBenchmarkFile.isEmpty()) {
+        // Nothing needs to be seen for this, which also keeps the time spent
+        // drawing the consoles out of the figures:
+        QTimer::singleShot(0, qApp, [cliProfiles, replayBenchmarkFile]() {
+            const bool succeeded = mudlet::self()->runReplayBenchmark(cliProfiles.value(0), replayBenchmarkFile);
+            qApp->exit(succeeded ? 0 : 1);
+        });
+        app->restoreOverrideCursor();
+        return app->exec();
+    }
+
     mudlet::self()->show();
 
     QTimer::singleShot(0, qApp, [cliProfiles]() {
@@ -1251,6 +1251,7 @@ function getConfig(...)
       "forceNewEnvironNegotiationOff",
       "inputLineStrictUnixEndings",
       "logInHTML",
+      "mapAreaRouting",
       "mapExitSize",
       "mapperPanelVisible",
       "mapRoomSize",
@@ -1263,6 +1264,7 @@ function getConfig(...)
       "specialForceCharsetNegotiationOff",
       "specialForceGAOff",
       "specialForceMxpNegotiationOff",
+      "usePcreJit",
     }
     for _,v in ipairs(list) do
       result[v] = oldgetConfig(v)
@@ -668,6 +668,16 @@ describe("Tests the GUI utilities as far as possible without mudlet", function()
       selectCurrentLine("mybuffer")
       assert.are.equal("Hello, world!", getSelection("mybuffer"))
     end)
+
+    it("should give lines split off by inserted line feeds a continued time, or none if empty", function()
+      echo("mybuffer", "one\ntwo\nthree")
+      moveCursor("mybuffer", 0, 1)
+      insertText("mybuffer", "x\n\ny\n")
+      -- line 1 is now "x", then "", "y", "two" and "three"
+      assert.are.equal("", getTimestamp("mybuffer", 2))
+      assert.are.equal("------------ ", getTimestamp("mybuffer", 3))
+      assert.are.equal("------------ ", getTimestamp("mybuffer", 4))
+    end)
   
   end)
 
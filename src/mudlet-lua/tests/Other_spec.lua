@@ -397,6 +397,28 @@ describe("Tests Other.lua functions", function()
     end)
   end)
 
+  describe("Tests triggers fed another line from a trigger script", function()
+    it("Should still run the later triggers that match the outer line", function()
+      local fired = {}
+      local triggerIds = {}
+      triggerIds[1] = tempTrigger("reentrant outer line", function()
+        fired[#fired + 1] = "first"
+        feedTriggers("reentrant inner line\n")
+      end)
+      triggerIds[2] = tempTrigger("reentrant inner line", function()
+        fired[#fired + 1] = "inner"
+      end)
+      triggerIds[3] = tempTrigger("reentrant outer line", function()
+        fired[#fired + 1] = "second"
+      end)
+      feedTriggers("reentrant outer line\n")
+      for _, id in ipairs(triggerIds) do
+        killTrigger(id)
+      end
+      assert.are.same({ "first", "inner", "second" }, fired)
+    end)
+  end)
+
     --[[ 
     TODO:
       remember()
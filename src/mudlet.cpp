@@ -85,6 +85,7 @@
 #include <QToolTip>
 #include <QVariantHash>
 #include <QRandomGenerator>
+#include <iostream>
 #include <memory>
 #include <zip.h>
 #include <QStyle>
@@ -1641,50 +1642,6 @@ void mudlet::addConsoleForNewHost(Host* pH)
 }
 
 
-void mudlet::slot_timerFires()
-{
-    QTimer* pQT = qobject_cast<QTimer*>(sender());
-    if (Q_UNLIKELY(!pQT)) {
-        return;
-    }
-
-    // Pull the Host name and TTimer::id from the properties:
-    const QString hostName(pQT->property(TTimer::scmProperty_HostName).toString());
-    if (Q_UNLIKELY(hostName.isEmpty())) {
-        qWarning().nospace().noquote() << "mudlet::slot_timerFires() INFO - Host name is empty - so TTimer has probably been deleted.";
-        pQT->deleteLater();
-        return;
-    }
-
-    Host* pHost = mHostManager.getHost(hostName);
-    Q_ASSERT_X(pHost, "mudlet::slot_timerFires()", "Unable to deduce Host pointer from data in QTimer");
-    const int id = pQT->property(TTimer::scmProperty_TTimerId).toInt();
-    if (Q_UNLIKELY(!id)) {
-        qWarning().nospace().noquote() << "mudlet::slot_timerFires() INFO - TTimer ID is zero - so TTimer has probably been deleted.";
-        pQT->deleteLater();
-        return;
-    }
-    TTimer* pTT = pHost->getTimerUnit()->getTimer(id);
-    if (Q_LIKELY(pTT)) {
-// commented out as it will be spammy in normal situations but saved as useful
-// during timer debugging... 8-)
-//        qDebug().nospace().noquote() << "mudlet::slot_timerFires() INFO - Host: \"" << hostName << "\" QTimer firing for TTimer Id:" << id;
-//        qDebug().nospace().noquote() << "    (objectName:\"" << pQT->objectName() << "\")";
-        pTT->execute();
-        if (pTT->checkRestart()) {
-            pTT->start();
-        }
-
-        // Okay now we've found it we are done:
-        return;
-    }
-
-    qWarning().nospace().noquote() << "mudlet::slot_timerFires() ERROR - Timer not registered, it seems to have been called: \"" << pQT->objectName() << "\" - automatically deleting it!";
-    // Clean up any bogus ones:
-    pQT->stop();
-    pQT->deleteLater();
-}
-
 void mudlet::disableToolbarButtons()
 {
     mpActionTriggers->setEnabled(false);
@@ -2913,6 +2870,29 @@ void mudlet::doAutoLogin(const QString& profile_name)
     enableToolbarButtons();
 }
 
+// Loads the profile, without connecting to the game server, and runs the
+// replay through it as fast as possible, printing how long each stage of the
+// processing took - for the --replay-benchmark command line option:
+bool mudlet::runReplayBenchmark(const QString& profile_name, const QString& replayFileName)
+{
+    if (profile_name.isEmpty()) {
+        std::cout << "A profile to load must be given with --profile for a replay benchmark." << std::endl;
+        return false;
+    }
+
+    Host* pHost = loadProfile(profile_name, false);
+    if (!pHost) {
+        std::cout << "Unable to load the \"" << profile_name.toStdString() << "\" profile for a replay benchmark." << std::endl;
+        return false;
+    }
+
+    slot_connectionDialogueFinished(profile_name, false);
+    QString report;
+    const bool result = pHost->mTelnet.runReplayBenchmark(replayFileName, report);
+    std::cout << report.toStdString() << std::endl;
+    return result;
+}
+
 void mudlet::processEventLoopHack()
 {
     QTimer::singleShot(1ms, this, &mudlet::slot_processEventLoopHackTimerRun);
@@ -357,6 +357,7 @@ public:
     bool migratePasswordsToProfileStorage();
     bool migratePasswordsToSecureStorage();
     void onlyShowProfiles(const QStringList&);
+    bool runReplayBenchmark(const QString& profile_name, const QString& replayFileName);
     bool openWebPage(const QString&);
     // Both of these revises the contents of the .aff file and handle a .dic
     // file that has been updated externally/manually (to add or remove words)
@@ -542,7 +543,6 @@ public slots:
     void slot_showHelpDialogIrc();
     void slot_showHelpDialogVideo();
     void slot_tabChanged(int);
-    void slot_timerFires();
     void slot_toggleFullScreenView();
     void slot_toggleMultiView();
 
@@ -666,9 +666,11 @@ SOURCES += \
     T2DMap.cpp \
     TAccessibleTextEdit.cpp \
     TAction.cpp \
+    TAhoCorasick.cpp \
     TAlias.cpp \
     TArea.cpp \
     TBuffer.cpp \
+    TChar.cpp \
     TCommandLine.cpp \
     TConsole.cpp \
     TDebug.cpp \
@@ -680,6 +682,7 @@ SOURCES += \
     TFlipButton.cpp \
     TForkedProcess.cpp \
     TimerUnit.cpp \
+    TInboundStats.cpp \
     TKey.cpp \
     TLabel.cpp \
     TScrollBox.cpp \
@@ -691,9 +694,13 @@ SOURCES += \
     TLuaInterpreterMudletObjects.cpp \
     TLuaInterpreterNetworking.cpp \
     TLuaInterpreterUI.cpp \
+    TLuaJsonDecoder.cpp \
     TMainConsole.cpp \
     TMap.cpp \
+    TMapChunkedFile.cpp \
+    TMapGraph.cpp \
     TMapLabel.cpp \
+    TMatchContext.cpp \
     TMedia.cpp \
     TMediaPlaylist.cpp \
     TMxpBRTagHandler.cpp \
@@ -718,6 +725,8 @@ SOURCES += \
     TMxpTagProcessor.cpp \
     TMxpVersionTagHandler.cpp \
     TMxpVarTagHandler.cpp \
+    TProfiler.cpp \
+    TRegex.cpp \
     TriggerUnit.cpp \
     TRoom.cpp \
     TRoomDB.cpp \
@@ -726,13 +735,17 @@ SOURCES += \
     TSplitterHandle.cpp \
     TStringUtils.cpp \
     TTabBar.cpp \
+    TTelnetReceiver.cpp \
     TTextCodec.cpp \
     TTextEdit.cpp \
     TTimer.cpp \
+    TTimerScheduler.cpp \
     TToolBar.cpp \
     TTreeWidget.cpp \
     TTrigger.cpp \
+    TTrigramIndex.cpp \
     TVar.cpp \
+    TWordIndex.cpp \
     VarUnit.cpp \
     XMLexport.cpp \
     XMLimport.cpp
@@ -796,10 +809,12 @@ HEADERS += \
     TAccessibleConsole.h \
     TAccessibleTextEdit.h \
     TAction.h \
+    TAhoCorasick.h \
     TAlias.h \
     TArea.h \
     TAstar.h \
     TBuffer.h \
+    TChar.h \
     TCommandLine.h \
     TConsole.h \
     TDebug.h \
@@ -814,13 +829,18 @@ HEADERS += \
     TForkedProcess.h \
     TGameDetails.h \
     TimerUnit.h \
+    TInboundStats.h \
     TKey.h \
     TLabel.h \
     TLinkStore.h \
     TLuaInterpreter.h \
+    TLuaJsonDecoder.h \
     TMainConsole.h \
     TMap.h \
+    TMapChunkedFile.h \
+    TMapGraph.h \
     TMapLabel.h \
+    TMatchContext.h \
     TMatchState.h \
     TMedia.h \
     TMediaData.h \
@@ -848,7 +868,9 @@ HEADERS += \
     TMxpSupportTagHandler.h \
     TMxpVarTagHandler.h \
     TMxpVersionTagHandler.h \
+    TProfiler.h \
     Tree.h \
+    TRegex.h \
     TriggerUnit.h \
     TRoom.h \
     TRoomDB.h \
@@ -856,15 +878,20 @@ HEADERS += \
     TScrollBox.h \
     TSplitter.h \
     TSplitterHandle.h \
+    TSpscQueue.h \
     TStringUtils.h \
     TTabBar.h \
+    TTelnetReceiver.h \
     TTextCodec.h \
     TTextEdit.h \
     TTimer.h \
+    TTimerScheduler.h \
     TToolBar.h \
     TTreeWidget.h \
     TTrigger.h \
+    TTrigramIndex.h \
     TVar.h \
+    TWordIndex.h \
     VarUnit.h \
     utils.h \
     XMLexport.h \
@@ -1715,10 +1742,17 @@ OTHER_FILES += \
     ../docker/Dockerfile \
     ../test/CMakeLists.txt \
     ../test/GUIConsoleTests.mpackage \
+    ../test/TAhoCorasickTest.cpp \
+    ../test/TCharTest.cpp \
     ../test/TEntityHandlerTest.cpp \
     ../test/TEntityResolverTest.cpp \
+    ../test/TInboundStatsTest.cpp \
     ../test/TLinkStoreTest.cpp \
     ../test/TLuaInterfaceTest.cpp \
+    ../test/TLuaJsonDecoderTest.cpp \
+    ../test/TMapChunkedFileTest.cpp \
+    ../test/TMapGraphTest.cpp \
+    ../test/TMatchContextTest.cpp \
     ../test/TMxpCustomElementTagHandlerTest.cpp \
     ../test/TMxpEntityTagHandlerTest.cpp \
     ../test/TMxpFormattingTagsTest.cpp \
@@ -1726,6 +1760,14 @@ OTHER_FILES += \
     ../test/TMxpStubClient.h \
     ../test/TMxpTagParserTest.cpp \
     ../test/TMxpVersionTagTest.cpp \
+    ../test/TProfilerTest.cpp \
+    ../test/TRegexTest.cpp \
+    ../test/TStringUtilsTest.cpp \
+    ../test/TTelnetReceiverTest.cpp \
+    ../test/TTimerSchedulerTest.cpp \
+    ../test/TTrigramIndexTest.cpp \
+    ../test/TWordIndexTest.cpp \
+    ../test/TreeTest.cpp \
     mac-deploy.sh \
     mudlet-lua/genDoc.sh \
     mudlet-lua/lua/ldoc.css
@@ -0,0 +1,100 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <TAhoCorasick.h>
+#include <QtTest/QtTest>
+
+class TAhoCorasickTest : public QObject {
+Q_OBJECT
+
+private:
+    static QList<int> scanAll(const TAhoCorasick& automaton, const QByteArray& text)
+    {
+        QList<int> found;
+        automaton.scan(text.constData(), text.size(), [&found](const int id) {
+            found.append(id);
+            return true;
+        });
+        std::sort(found.begin(), found.end());
+        return found;
+    }
+
+private slots:
+
+    void testEmpty()
+    {
+        TAhoCorasick automaton;
+        automaton.addPattern(QByteArray(), 1);
+        automaton.build();
+        QVERIFY(automaton.isEmpty());
+        QCOMPARE(scanAll(automaton, QByteArrayLiteral("anything")), QList<int>());
+    }
+
+    void testOverlappingPatterns()
+    {
+        TAhoCorasick automaton;
+        automaton.addPattern(QByteArrayLiteral("he"), 1);
+        automaton.addPattern(QByteArrayLiteral("she"), 2);
+        automaton.addPattern(QByteArrayLiteral("his"), 3);
+        automaton.addPattern(QByteArrayLiteral("hers"), 4);
+        automaton.build();
+        QCOMPARE(automaton.patternCount(), 4);
+
+        QCOMPARE(scanAll(automaton, QByteArrayLiteral("ushers")), (QList<int>{1, 2, 4}));
+        QCOMPARE(scanAll(automaton, QByteArrayLiteral("this")), (QList<int>{3}));
+        QCOMPARE(scanAll(automaton, QByteArrayLiteral("nothing here")), (QList<int>{1}));
+    }
+
+    void testSharedIdAndUtf8()
+    {
+        TAhoCorasick automaton;
+        automaton.addPattern(QStringLiteral("Straße").toUtf8(), 7);
+        automaton.addPattern(QByteArrayLiteral("gold"), 7);
+        automaton.build();
+        QCOMPARE(scanAll(automaton, QStringLiteral("Die Straße ist aus gold").toUtf8()), (QList<int>{7, 7}));
+        QCOMPARE(scanAll(automaton, QStringLiteral("Strasse").toUtf8()), QList<int>());
+    }
+
+    void testEarlyStop()
+    {
+        TAhoCorasick automaton;
+        automaton.addPattern(QByteArrayLiteral("a"), 1);
+        automaton.build();
+        int calls = 0;
+        const QByteArray text = QByteArrayLiteral("aaaa");
+        automaton.scan(text.constData(), text.size(), [&calls](const int) {
+            ++calls;
+            return false;
+        });
+        QCOMPARE(calls, 1);
+    }
+
+    void testNeedsBuild()
+    {
+        TAhoCorasick automaton;
+        automaton.addPattern(QByteArrayLiteral("abc"), 1);
+        QVERIFY(!automaton.isBuilt());
+        QCOMPARE(scanAll(automaton, QByteArrayLiteral("abc")), QList<int>());
+        automaton.build();
+        QCOMPARE(scanAll(automaton, QByteArrayLiteral("abc")), (QList<int>{1}));
+    }
+};
+
+#include "TAhoCorasickTest.moc"
+QTEST_MAIN(TAhoCorasickTest)
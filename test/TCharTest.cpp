@@ -0,0 +1,244 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <TChar.h>
+#include <QtTest/QtTest>
+
+#include <deque>
+
+// The layout TChar had when it held its own pair of QColors, kept here only
+// so that the memory benchmark has something to compare against:
+struct LegacyTChar
+{
+    QColor mFgColor;
+    QColor mBgColor;
+    TChar::AttributeFlags mFlags = TChar::None;
+    bool mIsSelected = false;
+    int mLinkIndex = 0;
+};
+
+class TCharTest : public QObject {
+Q_OBJECT
+
+private:
+    // The line limit and batch size that TBuffer uses by default, and a
+    // typical line width, for the memory benchmark:
+    static const int scmLinesLimit = 10000;
+    static const int scmBatchDeleteSize = 1000;
+    static const int scmColumns = 80;
+    // Characters in a run of the same colours:
+    static const int scmRunLength = 8;
+    // Every this many lines is one in 24-bit colours, each run in a pair not
+    // seen before - as a prompt or a gauge might be drawn:
+    static const int scmTrueColorLineSpacing = 10;
+
+    QVector<QColor> mAnsiColors;
+
+    // Adds lines to a buffer the way the ANSI processing and TBuffer do -
+    // mostly runs of characters in one of the sixteen ANSI colours - with the
+    // oldest lines deleted in a batch whenever there are more than the limit:
+    template <typename T, typename Make>
+    void addLines(std::deque<std::deque<T>>& buffer, const int firstLine, const int count, Make&& make) const
+    {
+        for (int line = firstLine; line < firstLine + count; ++line) {
+            std::deque<T> newLine;
+            for (int column = 0; column < scmColumns; ++column) {
+                const int run = column / scmRunLength;
+                if (line % scmTrueColorLineSpacing) {
+                    newLine.push_back(make(mAnsiColors.at((line + run) % mAnsiColors.size()), QColorConstants::Black));
+                } else {
+                    newLine.push_back(make(QColor(line % 256, (line / 256) % 256, run), QColor(0, 0, 32)));
+                }
+            }
+            buffer.push_back(newLine);
+            if (static_cast<int>(buffer.size()) > scmLinesLimit) {
+                buffer.erase(buffer.begin(), buffer.begin() + scmBatchDeleteSize);
+            }
+        }
+    }
+
+    static int distinctColorPairs(const std::deque<std::deque<TChar>>& buffer)
+    {
+        QSet<quint32> indexes;
+        for (const auto& line : buffer) {
+            for (const auto& c : line) {
+                indexes.insert(c.colorIndex());
+            }
+        }
+        return indexes.size();
+    }
+
+private slots:
+
+    void initTestCase()
+    {
+        mAnsiColors << QColor(0, 0, 0) << QColor(128, 0, 0) << QColor(0, 179, 0) << QColor(128, 128, 0)
+                    << QColor(0, 0, 128) << QColor(128, 0, 128) << QColor(0, 128, 128) << QColor(192, 192, 192)
+                    << QColor(128, 128, 128) << QColor(255, 0, 0) << QColor(0, 255, 0) << QColor(255, 255, 0)
+                    << QColor(0, 0, 255) << QColor(255, 0, 255) << QColor(0, 255, 255) << QColor(255, 255, 255);
+    }
+
+    void testDefaultColors()
+    {
+        const TChar c;
+        QCOMPARE(c.foreground(), QColor(QColorConstants::White));
+        QCOMPARE(c.background(), QColor(QColorConstants::Black));
+        QCOMPARE(c.colorIndex(), 0u);
+    }
+
+    void testSameColorsShareAnEntry()
+    {
+        const TChar a(QColor(255, 0, 0), QColor(0, 0, 64), TChar::Bold);
+        const TChar b(QColor(255, 0, 0), QColor(0, 0, 64), TChar::Italic, 3);
+        const TChar c(QColor(0, 255, 0), QColor(0, 0, 64));
+        QCOMPARE(a.colorIndex(), b.colorIndex());
+        QVERIFY(a.colorIndex() != c.colorIndex());
+        QCOMPARE(b.foreground(), QColor(255, 0, 0));
+        QCOMPARE(b.background(), QColor(0, 0, 64));
+        QCOMPARE(b.linkIndex(), 3);
+        QVERIFY(b.isItalic());
+        QVERIFY(!b.isBold());
+    }
+
+    void testColorSpecsKeptApart()
+    {
+        // These compare unequal as QColors so must not end up sharing an
+        // entry even though they convert to the same RGBA value:
+        const QColor rgb(255, 0, 0);
+        const QColor hsv = QColor::fromHsv(0, 255, 255);
+        const TChar a(rgb, QColorConstants::Black);
+        const TChar b(hsv, QColorConstants::Black);
+        QVERIFY(a.colorIndex() != b.colorIndex());
+        QCOMPARE(a.foreground().spec(), QColor::Rgb);
+        QCOMPARE(b.foreground().spec(), QColor::Hsv);
+    }
+
+    void testSettersKeepTheOtherColor()
+    {
+        TChar c(QColor(10, 20, 30), QColor(40, 50, 60));
+        c.setForeground(QColor(70, 80, 90));
+        QCOMPARE(c.foreground(), QColor(70, 80, 90));
+        QCOMPARE(c.background(), QColor(40, 50, 60));
+        c.setBackground(QColor(100, 110, 120));
+        QCOMPARE(c.foreground(), QColor(70, 80, 90));
+        QCOMPARE(c.background(), QColor(100, 110, 120));
+        c.setColors(QColor(10, 20, 30), QColor(40, 50, 60));
+        QCOMPARE(c.colorIndex(), TChar(QColor(10, 20, 30), QColor(40, 50, 60)).colorIndex());
+    }
+
+    void testEqualityAndCopy()
+    {
+        TChar a(QColor(1, 2, 3), QColor(4, 5, 6), TChar::Underline, 7);
+        a.select();
+        const TChar b(a);
+        // The copy constructor does not carry over the selection:
+        QVERIFY(!b.isSelected());
+        QVERIFY(!(a == b));
+        a.deselect();
+        QVERIFY(a == b);
+        a.setForeground(QColor(1, 2, 4));
+        QVERIFY(!(a == b));
+    }
+
+    void testAssignmentKeepsColors()
+    {
+        TChar a(QColor(21, 22, 23), QColor(24, 25, 26));
+        {
+            const TChar b(QColor(27, 28, 29), QColor(30, 31, 32));
+            a = b;
+        }
+        // a is now the only user of b's entry so it must not have been reused:
+        const TChar c(QColor(33, 34, 35), QColor(36, 37, 38));
+        QCOMPARE(a.foreground(), QColor(27, 28, 29));
+        QCOMPARE(a.background(), QColor(30, 31, 32));
+        QVERIFY(a.colorIndex() != c.colorIndex());
+    }
+
+    void testUnusedEntriesAreReused()
+    {
+        const TChar kept(QColor(41, 42, 43), QColor(44, 45, 46));
+        const int entriesBefore = TCharColorTable::size();
+        for (int i = 0; i < 1000; ++i) {
+            const TChar transient(QColor(i % 256, i / 256, 47), QColor(48, 49, 50));
+            QCOMPARE(transient.foreground(), QColor(i % 256, i / 256, 47));
+        }
+        // At most one more entry was needed however many different pairs
+        // came and went:
+        QVERIFY(TCharColorTable::size() <= entriesBefore + 1);
+        QCOMPARE(kept.foreground(), QColor(41, 42, 43));
+        QCOMPARE(kept.background(), QColor(44, 45, 46));
+        // And one that was reused can be looked up again afterwards:
+        QCOMPARE(TChar(QColor(3, 0, 47), QColor(48, 49, 50)).foreground(), QColor(3, 0, 47));
+    }
+
+    void benchmarkBufferMemory()
+    {
+        const int entriesBefore = TCharColorTable::size();
+        std::deque<std::deque<TChar>> buffer;
+        addLines(buffer, 0, scmLinesLimit, [](const QColor& foreground, const QColor& background) { return TChar(foreground, background); });
+        QCOMPARE(static_cast<int>(buffer.size()), scmLinesLimit);
+        const int entriesWhenFull = TCharColorTable::size();
+        // No more than one entry for each pair in use:
+        QVERIFY(entriesWhenFull <= entriesBefore + distinctColorPairs(buffer));
+
+        // Another buffer's worth of lines, all the 24-bit colour pairs in them
+        // are new ones but as many old ones go with the lines deleted to make
+        // room. Without the entries being reused the table would grow by one
+        // for each new pair, as it is it can only grow by at most the pairs in
+        // a batch of lines (before the batch is deleted):
+        const int pairsPerTrueColorLine = scmColumns / scmRunLength;
+        const int newPairs = scmLinesLimit / scmTrueColorLineSpacing * pairsPerTrueColorLine;
+        addLines(buffer, scmLinesLimit, scmLinesLimit, [](const QColor& foreground, const QColor& background) { return TChar(foreground, background); });
+        QVERIFY(static_cast<int>(buffer.size()) <= scmLinesLimit);
+        const int entriesAfterScrolling = TCharColorTable::size();
+        QVERIFY(entriesAfterScrolling <= entriesWhenFull + scmBatchDeleteSize / scmTrueColorLineSpacing * pairsPerTrueColorLine);
+        QVERIFY(entriesAfterScrolling < entriesWhenFull + newPairs);
+
+        // What the buffer takes: the TChars themselves plus the table entries
+        // they use, against a pair of QColors in every TChar as it used to be:
+        const qint64 charCount = static_cast<qint64>(buffer.size()) * scmColumns;
+        const qint64 bytes = charCount * static_cast<qint64>(sizeof(TChar)) + entriesAfterScrolling * static_cast<qint64>(2 * sizeof(QColor) + 2 * sizeof(quint32));
+        const qint64 legacyBytes = charCount * static_cast<qint64>(sizeof(LegacyTChar));
+        QVERIFY(bytes * 2 < legacyBytes);
+
+        // Once the buffer has gone every entry it used is free again, so a new
+        // pair does not need another one:
+        buffer.clear();
+        const TChar newPair(QColor(1, 255, 254), QColor(253, 252, 2));
+        QCOMPARE(TCharColorTable::size(), entriesAfterScrolling);
+        QCOMPARE(newPair.foreground(), QColor(1, 255, 254));
+
+        QTest::setBenchmarkResult(static_cast<qreal>(bytes) / scmLinesLimit, QTest::BytesAllocated);
+    }
+
+    void benchmarkBufferFill()
+    {
+        QBENCHMARK {
+            std::deque<std::deque<TChar>> buffer;
+            addLines(buffer, 0, scmLinesLimit, [](const QColor& foreground, const QColor& background) { return TChar(foreground, background); });
+        }
+    }
+
+    void cleanupTestCase()
+    {
+    }
+};
+
+#include "TCharTest.moc"
+QTEST_MAIN(TCharTest)
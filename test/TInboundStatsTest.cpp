@@ -0,0 +1,130 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <TInboundStats.h>
+#include <QtTest/QtTest>
+
+class TInboundStatsTest : public QObject {
+Q_OBJECT
+
+private:
+    // Something for the clock to measure:
+    static void work()
+    {
+        QElapsedTimer timer;
+        timer.start();
+        while (timer.nsecsElapsed() < 2000000) {
+        }
+    }
+
+private slots:
+
+    void testInactiveRecordsNothing()
+    {
+        TInboundStats stats;
+        {
+            const TInboundStats::Scope scope(stats, TInboundStats::Telnet);
+            work();
+        }
+        QVERIFY(!stats.isActive());
+        QCOMPARE(stats.stageNanoseconds(TInboundStats::Telnet), qint64(0));
+        QCOMPARE(stats.totalNanoseconds(), qint64(0));
+    }
+
+    void testNestedStagesAreExclusive()
+    {
+        TInboundStats stats;
+        stats.start();
+        {
+            const TInboundStats::Scope telnet(stats, TInboundStats::Telnet);
+            work();
+            {
+                const TInboundStats::Scope translate(stats, TInboundStats::Translate);
+                work();
+                {
+                    const TInboundStats::Scope triggers(stats, TInboundStats::Triggers);
+                    {
+                        const TInboundStats::Scope lua(stats, TInboundStats::Lua);
+                        work();
+                    }
+                }
+            }
+            // Back in the outer stage again:
+            work();
+        }
+        stats.stop();
+
+        const qint64 telnet = stats.stageNanoseconds(TInboundStats::Telnet);
+        const qint64 translate = stats.stageNanoseconds(TInboundStats::Translate);
+        const qint64 triggers = stats.stageNanoseconds(TInboundStats::Triggers);
+        const qint64 lua = stats.stageNanoseconds(TInboundStats::Lua);
+        QVERIFY(telnet >= 4000000);
+        QVERIFY(translate >= 2000000);
+        QVERIFY(lua >= 2000000);
+        // Only the time for entering and leaving the inner stage:
+        QVERIFY(triggers < lua);
+        QVERIFY(telnet + translate + triggers + lua <= stats.totalNanoseconds());
+        // And stopping freezes the total:
+        const qint64 total = stats.totalNanoseconds();
+        work();
+        QCOMPARE(stats.totalNanoseconds(), total);
+    }
+
+    void testRestartClears()
+    {
+        TInboundStats stats;
+        stats.start();
+        stats.addBytes(100);
+        stats.addLines(3);
+        {
+            const TInboundStats::Scope scope(stats, TInboundStats::Lua);
+            work();
+        }
+        stats.stop();
+        QVERIFY(stats.stageNanoseconds(TInboundStats::Lua) > 0);
+
+        stats.start();
+        QCOMPARE(stats.bytes(), qint64(0));
+        QCOMPARE(stats.lines(), qint64(0));
+        QCOMPARE(stats.stageNanoseconds(TInboundStats::Lua), qint64(0));
+    }
+
+    void testReport()
+    {
+        TInboundStats stats;
+        stats.start();
+        stats.addBytes(1024);
+        stats.addLines(10);
+        {
+            const TInboundStats::Scope scope(stats, TInboundStats::Triggers);
+            work();
+        }
+        stats.stop();
+        const QString report = stats.report();
+        QVERIFY(report.startsWith(QStringLiteral("1024 bytes and 10 lines in ")));
+        QVERIFY(report.contains(QStringLiteral("bytes/s")));
+        QVERIFY(report.contains(QStringLiteral("lines/s")));
+        for (const auto& name : {"telnet", "translate", "triggers", "lua", "other"}) {
+            QVERIFY2(report.contains(QLatin1String(name)), name);
+        }
+    }
+};
+
+#include "TInboundStatsTest.moc"
+QTEST_MAIN(TInboundStatsTest)
@@ -0,0 +1,194 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <TLuaJsonDecoder.h>
+#include <QtTest/QtTest>
+
+#define qsl(s) QStringLiteral(s)
+
+extern "C" {
+    #include <lauxlib.h>
+    #include <lua.h>
+    #include <lualib.h>
+}
+
+class TLuaJsonDecoderTest : public QObject {
+Q_OBJECT
+
+private:
+    lua_State* L = nullptr;
+    // Stack index of the value that JSON null is decoded to:
+    int mNullIndex = 0;
+
+    bool decode(const QByteArray& json, QString& error)
+    {
+        return TLuaJsonDecoder::decode(L, json.constData(), json.size(), mNullIndex, error);
+    }
+
+    // Runs the Lua expression with the decoded value available as "v" and
+    // returns the result as a string:
+    QString evaluate(const char* expression)
+    {
+        lua_setglobal(L, "v");
+        const QByteArray chunk = QByteArray("return tostring(") + expression + ")";
+        if (luaL_dostring(L, chunk.constData())) {
+            const QString error = QString::fromUtf8(lua_tostring(L, -1));
+            lua_pop(L, 1);
+            return error;
+        }
+        const QString result = QString::fromUtf8(lua_tostring(L, -1));
+        lua_pop(L, 1);
+        return result;
+    }
+
+private slots:
+
+    void init()
+    {
+        L = luaL_newstate();
+        luaL_openlibs(L);
+        lua_pushlightuserdata(L, nullptr);
+        lua_pushvalue(L, -1);
+        lua_setglobal(L, "null");
+        mNullIndex = lua_gettop(L);
+    }
+
+    void cleanup()
+    {
+        lua_close(L);
+        L = nullptr;
+    }
+
+    void testValues_data()
+    {
+        QTest::addColumn<QByteArray>("json");
+        QTest::addColumn<QByteArray>("expression");
+        QTest::addColumn<QString>("expected");
+        QTest::newRow("integer") << QByteArray("42") << QByteArray("v") << qsl("42");
+        QTest::newRow("negative") << QByteArray("-17") << QByteArray("v") << qsl("-17");
+        QTest::newRow("fraction") << QByteArray("2.5") << QByteArray("v") << qsl("2.5");
+        QTest::newRow("exponent") << QByteArray("1e3") << QByteArray("v") << qsl("1000");
+        QTest::newRow("big integer") << QByteArray("12345678901234567890") << QByteArray("v") << qsl("1.2345678901235e+19");
+        QTest::newRow("true") << QByteArray("true") << QByteArray("v") << qsl("true");
+        QTest::newRow("false") << QByteArray(" false ") << QByteArray("v") << qsl("false");
+        QTest::newRow("null") << QByteArray("null") << QByteArray("v == null") << qsl("true");
+        QTest::newRow("string") << QByteArray(R"("plain")") << QByteArray("v") << qsl("plain");
+        QTest::newRow("escapes") << QByteArray(R"("a\"b\\c\/d\ne\tf")") << QByteArray("v") << qsl("a\"b\\c/d\ne\tf");
+        QTest::newRow("unicode") << QByteArray(R"("caf\u00e9 \u263A")") << QByteArray("v") << QString::fromUtf8("caf\xc3\xa9 \xe2\x98\xba");
+        QTest::newRow("surrogate pair") << QByteArray(R"("\ud83d\ude00")") << QByteArray("v") << QString::fromUtf8("\xf0\x9f\x98\x80");
+        QTest::newRow("lone surrogate") << QByteArray(R"("x\ud83dy")") << QByteArray("v") << qsl("x?y");
+        QTest::newRow("raw utf-8") << QByteArray("\"Stra\xc3\x9f" "e\"") << QByteArray("v") << QString::fromUtf8("Stra\xc3\x9f" "e");
+        QTest::newRow("object") << QByteArray(R"({"hp": "1200", "maxhp": 1500})") << QByteArray("v.hp .. '/' .. v.maxhp") << qsl("1200/1500");
+        QTest::newRow("array") << QByteArray(R"([10, "b", [true]])") << QByteArray("#v .. v[1] .. v[2] .. tostring(v[3][1])") << qsl("310btrue");
+        QTest::newRow("empty containers") << QByteArray(R"({"a": {}, "b": []})") << QByteArray("next(v.a) == nil and next(v.b) == nil") << qsl("true");
+        QTest::newRow("nested") << QByteArray(R"({"room": {"exits": {"n": 101, "s": 102}}})") << QByteArray("v.room.exits.s") << qsl("102");
+    }
+
+    void testValues()
+    {
+        QFETCH(QByteArray, json);
+        QFETCH(QByteArray, expression);
+        QFETCH(QString, expected);
+        QString error;
+        const int top = lua_gettop(L);
+        QVERIFY2(decode(json, error), qPrintable(error));
+        QCOMPARE(lua_gettop(L), top + 1);
+        QCOMPARE(evaluate(expression.constData()), expected);
+    }
+
+    void testInvalid_data()
+    {
+        QTest::addColumn<QByteArray>("json");
+        QTest::newRow("empty") << QByteArray();
+        QTest::newRow("whitespace") << QByteArray("  ");
+        QTest::newRow("unterminated string") << QByteArray(R"({"a": "b)");
+        QTest::newRow("unterminated object") << QByteArray(R"({"a": 1)");
+        QTest::newRow("trailing comma") << QByteArray(R"([1, 2,])");
+        QTest::newRow("bare word") << QByteArray("nope");
+        QTest::newRow("trailing garbage") << QByteArray("{} x");
+        QTest::newRow("leading zero fraction") << QByteArray("1.");
+        QTest::newRow("bad escape") << QByteArray(R"("\q")");
+        QTest::newRow("control character") << QByteArray("\"a\tb\"");
+        QTest::newRow("too deep") << QByteArray(200, '[');
+    }
+
+    void testInvalid()
+    {
+        QFETCH(QByteArray, json);
+        QString error;
+        const int top = lua_gettop(L);
+        QVERIFY(!decode(json, error));
+        QVERIFY(!error.isEmpty());
+        // Nothing must be left behind on the stack:
+        QCOMPARE(lua_gettop(L), top);
+    }
+
+    void testMergeInto()
+    {
+        QString error;
+        QVERIFY(decode(QByteArrayLiteral(R"({"hp": 100, "mp": 50, "status": "fine"})"), error));
+        const int target = lua_gettop(L);
+        QVERIFY(decode(QByteArrayLiteral(R"({"hp": 90, "xp": 7})"), error));
+        TLuaJsonDecoder::mergeInto(L, target);
+        QCOMPARE(lua_gettop(L), target);
+        QCOMPARE(evaluate("v.hp .. ',' .. v.mp .. ',' .. v.status .. ',' .. v.xp"), qsl("90,50,fine,7"));
+    }
+
+    void testSplitGmcpMessage_data()
+    {
+        QTest::addColumn<QByteArray>("message");
+        QTest::addColumn<QByteArray>("packageMessage");
+        QTest::addColumn<QByteArray>("data");
+
+        QTest::newRow("with data") << QByteArrayLiteral(R"(Char.Vitals {"hp": "100"})") << QByteArrayLiteral("Char.Vitals") << QByteArrayLiteral(R"({"hp": "100"})");
+        // Messages with no payload must keep their name:
+        QTest::newRow("no data") << QByteArrayLiteral("Core.Ping") << QByteArrayLiteral("Core.Ping") << QByteArray();
+        QTest::newRow("line feed first") << QByteArrayLiteral("Client.GUI\n39 https://example.com") << QByteArrayLiteral("Client.GUI") << QByteArrayLiteral("39 https://example.com");
+        QTest::newRow("space first") << QByteArrayLiteral("Client.GUI 39\nhttps://example.com") << QByteArrayLiteral("Client.GUI") << QByteArrayLiteral("39\nhttps://example.com");
+    }
+
+    void testSplitGmcpMessage()
+    {
+        QFETCH(QByteArray, message);
+        QFETCH(QByteArray, packageMessage);
+        QFETCH(QByteArray, data);
+
+        QByteArray actualPackageMessage;
+        QByteArray actualData;
+        TLuaJsonDecoder::splitGmcpMessage(message, actualPackageMessage, actualData);
+        QCOMPARE(actualPackageMessage, packageMessage);
+        QCOMPARE(actualData, data);
+    }
+
+    void benchmarkCharVitals()
+    {
+        const QByteArray vitals = QByteArrayLiteral(R"({"hp": "4520", "maxhp": "4800", "mp": "3975", "maxmp": "4100", "ep": "19450", "maxep": "20000", )"
+                                                    R"("wp": "16250", "maxwp": "16600", "nl": "31", "bal": "1", "eq": "1", "string": "H:4520/4800 M:3975/4100 E:19450/20000 W:16250/16600 NL:31/100",)"
+                                                    R"("charstats": ["Bleed: 0", "Rage: 12", "Spec: Sword and Shield", "Stance: None"]})");
+        QString error;
+        QBENCHMARK {
+            decode(vitals, error);
+            lua_pop(L, 1);
+        }
+        QVERIFY(error.isEmpty());
+    }
+};
+
+#include "TLuaJsonDecoderTest.moc"
+QTEST_MAIN(TLuaJsonDecoderTest)
@@ -0,0 +1,234 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <TMapChunkedFile.h>
+#include <QtTest/QtTest>
+#include "utils.h"
+
+// Writes and reads map files in the version 22 layout in the same way that
+// TMap does, with made up data standing in for the areas and rooms that TMap
+// would put in the chunks:
+class TMapChunkedFileTest : public QObject {
+Q_OBJECT
+
+private:
+    static const int scmVersion = 22;
+
+    static QByteArray areaData(const int areaId, const int roomCount)
+    {
+        QByteArray data;
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream << areaId;
+        for (int roomId = 1; roomId <= roomCount; ++roomId) {
+            stream << areaId * 1000 + roomId << qsl("Room %1 in area %2").arg(roomId).arg(areaId);
+        }
+        return data;
+    }
+
+    static inline const QHash<int, int> scmRoomCounts{{-1, 5}, {1, 0}, {7, 20}};
+
+    static QList<std::pair<int, QByteArray>> mapData()
+    {
+        QList<std::pair<int, QByteArray>> areas;
+        for (const int areaId : {-1, 1, 7}) {
+            areas.append({areaId, areaData(areaId, scmRoomCounts.value(areaId))});
+        }
+        return areas;
+    }
+
+    static QByteArray writeMapFile(const QList<std::pair<int, QByteArray>>& areas, TMapChunkedFile& chunkedFile, TMapChunkedFile::Header& header)
+    {
+        header = TMapChunkedFile::Header();
+        header.mAreaCount = areas.size();
+        header.mRoomIdHash.insert(qsl("Profile A"), 7005);
+        header.mRoomIdHash.insert(qsl("Profile B"), 3);
+        for (const auto& area : areas) {
+            TMapChunkedFile::Chunk chunk;
+            chunk.mAreaId = area.first;
+            chunk.mRoomCount = scmRoomCounts.value(area.first);
+            header.mRoomCount += chunk.mRoomCount;
+            header.mChunks.append(chunk);
+        }
+
+        QByteArray file;
+        QDataStream ofs(&file, QIODevice::WriteOnly);
+        ofs << scmVersion;
+        const bool isOk = TMapChunkedFile::write(ofs, header, qCompress(QByteArray("global data")), chunkedFile.compressAreaChunks(areas));
+        return isOk ? file : QByteArray();
+    }
+
+private slots:
+
+    void testRoundTrip()
+    {
+        TMapChunkedFile chunkedFile;
+        TMapChunkedFile::Header written;
+        QByteArray file = writeMapFile(mapData(), chunkedFile, written);
+        QVERIFY(!file.isEmpty());
+
+        QBuffer buffer(&file);
+        QVERIFY(buffer.open(QIODevice::ReadOnly));
+        QDataStream ifs(&buffer);
+        int version = 0;
+        ifs >> version;
+        QCOMPARE(version, scmVersion);
+        TMapChunkedFile::Header header;
+        QVERIFY(TMapChunkedFile::readHeader(ifs, header));
+        QCOMPARE(header.mAreaCount, written.mAreaCount);
+        QCOMPARE(header.mRoomCount, written.mRoomCount);
+        QCOMPARE(header.mRoomIdHash, written.mRoomIdHash);
+        QCOMPARE(header.mGlobalLength, written.mGlobalLength);
+        QCOMPARE(header.mChunks.size(), 3);
+        for (int i = 0; i < header.mChunks.size(); ++i) {
+            QCOMPARE(header.mChunks.at(i).mAreaId, written.mChunks.at(i).mAreaId);
+            QCOMPARE(header.mChunks.at(i).mRoomCount, written.mChunks.at(i).mRoomCount);
+            QCOMPARE(header.mChunks.at(i).mOffset, written.mChunks.at(i).mOffset);
+            QCOMPARE(header.mChunks.at(i).mLength, written.mChunks.at(i).mLength);
+        }
+        QVERIFY(TMapChunkedFile::fitsIn(header, buffer.size() - buffer.pos()));
+
+        QByteArray globalChunk;
+        QList<QByteArray> compressedChunks;
+        QVERIFY(TMapChunkedFile::readChunks(&buffer, header, globalChunk, compressedChunks));
+        QCOMPARE(qUncompress(globalChunk), QByteArray("global data"));
+        const QList<QByteArray> chunkData = TMapChunkedFile::uncompressChunks(compressedChunks);
+        const auto areas = mapData();
+        QCOMPARE(chunkData.size(), areas.size());
+        for (int i = 0; i < areas.size(); ++i) {
+            QCOMPARE(chunkData.at(i), areas.at(i).second);
+        }
+    }
+
+    // What TMap::retrieveMapFileStats(...) relies on - everything it wants is
+    // in the header, so that is all that has to be read:
+    void testHeaderOnly()
+    {
+        TMapChunkedFile chunkedFile;
+        TMapChunkedFile::Header written;
+        const QByteArray file = writeMapFile(mapData(), chunkedFile, written);
+        const qint64 chunksLength = written.mChunks.constLast().mOffset + written.mChunks.constLast().mLength;
+        QByteArray headerOnly = file.left(file.size() - chunksLength);
+
+        QBuffer buffer(&headerOnly);
+        QVERIFY(buffer.open(QIODevice::ReadOnly));
+        QDataStream ifs(&buffer);
+        int version = 0;
+        ifs >> version;
+        TMapChunkedFile::Header header;
+        QVERIFY(TMapChunkedFile::readHeader(ifs, header));
+        QVERIFY(buffer.atEnd());
+        QCOMPARE(header.mAreaCount, 3);
+        QCOMPARE(header.mRoomCount, 25);
+        QCOMPARE(header.mRoomIdHash.value(qsl("Profile A")), 7005);
+        // But TMap::validatePotentialMapFile(...) will not accept it:
+        QVERIFY(!TMapChunkedFile::fitsIn(header, buffer.size() - buffer.pos()));
+    }
+
+    void testTruncatedFileIsRejected()
+    {
+        TMapChunkedFile chunkedFile;
+        TMapChunkedFile::Header written;
+        const QByteArray file = writeMapFile(mapData(), chunkedFile, written);
+
+        // Part way through the last chunk:
+        QByteArray truncated = file.left(file.size() - 4);
+        QBuffer buffer(&truncated);
+        QVERIFY(buffer.open(QIODevice::ReadOnly));
+        QDataStream ifs(&buffer);
+        int version = 0;
+        ifs >> version;
+        TMapChunkedFile::Header header;
+        QVERIFY(TMapChunkedFile::readHeader(ifs, header));
+        QVERIFY(!TMapChunkedFile::fitsIn(header, buffer.size() - buffer.pos()));
+        QByteArray globalChunk;
+        QList<QByteArray> compressedChunks;
+        QVERIFY(!TMapChunkedFile::readChunks(&buffer, header, globalChunk, compressedChunks));
+
+        // Part way through the header:
+        QByteArray noIndex = file.left(12);
+        QBuffer headerBuffer(&noIndex);
+        QVERIFY(headerBuffer.open(QIODevice::ReadOnly));
+        QDataStream headerStream(&headerBuffer);
+        headerStream >> version;
+        QVERIFY(!TMapChunkedFile::readHeader(headerStream, header));
+    }
+
+    // TMap::restoreChunked(...) gives up on the whole map if any of the area
+    // chunks comes out empty here:
+    void testCorruptChunkIsDetected()
+    {
+        TMapChunkedFile chunkedFile;
+        TMapChunkedFile::Header written;
+        QByteArray file = writeMapFile(mapData(), chunkedFile, written);
+        const qint64 chunksStart = file.size() - (written.mChunks.constLast().mOffset + written.mChunks.constLast().mLength);
+        const auto& damagedChunk = written.mChunks.at(2);
+        for (qint64 i = damagedChunk.mOffset + damagedChunk.mLength / 2, end = damagedChunk.mOffset + damagedChunk.mLength; i < end; ++i) {
+            file[chunksStart + i] = static_cast<char>(~file.at(chunksStart + i));
+        }
+
+        QBuffer buffer(&file);
+        QVERIFY(buffer.open(QIODevice::ReadOnly));
+        QDataStream ifs(&buffer);
+        int version = 0;
+        ifs >> version;
+        TMapChunkedFile::Header header;
+        QVERIFY(TMapChunkedFile::readHeader(ifs, header));
+        // The index is still fine:
+        QVERIFY(TMapChunkedFile::fitsIn(header, buffer.size() - buffer.pos()));
+        QByteArray globalChunk;
+        QList<QByteArray> compressedChunks;
+        QVERIFY(TMapChunkedFile::readChunks(&buffer, header, globalChunk, compressedChunks));
+        const QList<QByteArray> chunkData = TMapChunkedFile::uncompressChunks(compressedChunks);
+        QCOMPARE(chunkData.size(), 3);
+        QCOMPARE(chunkData.at(0), mapData().at(0).second);
+        QCOMPARE(chunkData.at(1), mapData().at(1).second);
+        QVERIFY(chunkData.at(2).isEmpty());
+    }
+
+    void testOnlyChangedAreasAreCompressedAgain()
+    {
+        TMapChunkedFile chunkedFile;
+        auto areas = mapData();
+        const QList<QByteArray> first = chunkedFile.compressAreaChunks(areas);
+        QCOMPARE(chunkedFile.lastCompressedCount(), 3);
+        for (int i = 0; i < areas.size(); ++i) {
+            QCOMPARE(qUncompress(first.at(i)), areas.at(i).second);
+        }
+
+        QCOMPARE(chunkedFile.compressAreaChunks(areas), first);
+        QCOMPARE(chunkedFile.lastCompressedCount(), 0);
+
+        areas[1].second = areaData(1, 3);
+        const QList<QByteArray> second = chunkedFile.compressAreaChunks(areas);
+        QCOMPARE(chunkedFile.lastCompressedCount(), 1);
+        QCOMPARE(second.at(0), first.at(0));
+        QCOMPARE(qUncompress(second.at(1)), areas.at(1).second);
+        QCOMPARE(second.at(2), first.at(2));
+
+        // An area that is left out is forgotten, so it is compressed again
+        // when it comes back:
+        chunkedFile.compressAreaChunks({areas.at(0), areas.at(1)});
+        QCOMPARE(chunkedFile.lastCompressedCount(), 0);
+        chunkedFile.compressAreaChunks(areas);
+        QCOMPARE(chunkedFile.lastCompressedCount(), 1);
+    }
+};
+
+#include "TMapChunkedFileTest.moc"
+QTEST_MAIN(TMapChunkedFileTest)
@@ -0,0 +1,415 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <TMapGraph.h>
+#include <QtTest/QtTest>
+
+#include <boost/graph/dijkstra_shortest_paths.hpp>
+
+// Builds the graph for a synthetic map - a square grid of rooms each with
+// exits to the (up to) four rooms next to it, divided into square areas that,
+// like most MUD maps, are only joined to each other at a few places (the
+// middle of each of their sides) - in the same way that TMap does it, either all at once as TMap::initGraph() does or a room at a time as
+// TMap::updateGraph() does after the map has been edited:
+class TMapGraphTest : public QObject {
+Q_OBJECT
+
+private:
+    static const int scmWidth = 300;
+    static const int scmRoomCount = scmWidth * scmWidth;
+    // The map is divided into square areas of this many rooms across:
+    static const int scmAreaWidth = 30;
+
+    QSet<int> mLockedRooms;
+    // Key is the source room, stands in for a room's exit weights:
+    QHash<int, int> mExitWeights;
+
+    static int areaOf(const int roomId)
+    {
+        const int row = (roomId - 1) / scmWidth;
+        const int column = (roomId - 1) % scmWidth;
+        return 1 + (row / scmAreaWidth) * (scmWidth / scmAreaWidth) + column / scmAreaWidth;
+    }
+
+    static bool isGateway(const int roomId)
+    {
+        return ((roomId - 1) / scmWidth) % scmAreaWidth == scmAreaWidth / 2 || ((roomId - 1) % scmWidth) % scmAreaWidth == scmAreaWidth / 2;
+    }
+
+    bool isUsable(const int roomId) const { return roomId >= 1 && roomId <= scmRoomCount && !mLockedRooms.contains(roomId); }
+
+    QList<int> neighbours(const int roomId) const
+    {
+        QList<int> result;
+        const int column = (roomId - 1) % scmWidth;
+        if (column > 0) {
+            result << roomId - 1;
+        }
+        if (column < scmWidth - 1) {
+            result << roomId + 1;
+        }
+        if (roomId > scmWidth) {
+            result << roomId - scmWidth;
+        }
+        if (roomId + scmWidth <= scmRoomCount) {
+            result << roomId + scmWidth;
+        }
+        return result;
+    }
+
+    QHash<int, route> routesFrom(const int roomId) const
+    {
+        QHash<int, route> result;
+        for (const int target : neighbours(roomId)) {
+            if (!isUsable(target) || (areaOf(target) != areaOf(roomId) && !isGateway(roomId))) {
+                continue;
+            }
+            route r;
+            r.cost = mExitWeights.value(roomId, 1 + target % 3);
+            r.direction = 0;
+            result.insert(target, r);
+        }
+        return result;
+    }
+
+    void rebuild(TMapGraph& graph) const
+    {
+        graph.clear();
+        for (int roomId = 1; roomId <= scmRoomCount; ++roomId) {
+            if (isUsable(roomId)) {
+                graph.addRoom(roomId, nullptr, areaOf(roomId));
+            }
+        }
+        for (const auto& l : graph.locations()) {
+            graph.setRoutes(l.id, routesFrom(l.id));
+        }
+    }
+
+    // What TMap::updateGraph() does for a room that has been (un)locked:
+    void updateRoom(TMapGraph& graph, const int roomId) const
+    {
+        QSet<int> dirtyExits{roomId};
+        for (const int source : graph.entrances(roomId)) {
+            dirtyExits.insert(source);
+        }
+        // Stands in for the TRoomDB entrance map:
+        for (const int source : neighbours(roomId)) {
+            dirtyExits.insert(source);
+        }
+        if (isUsable(roomId)) {
+            graph.addRoom(roomId, nullptr, areaOf(roomId));
+        } else {
+            graph.removeRoom(roomId);
+        }
+        for (const int source : std::as_const(dirtyExits)) {
+            if (graph.contains(source)) {
+                graph.setRoutes(source, routesFrom(source));
+            }
+        }
+    }
+
+    void toggleLock(const int roomId)
+    {
+        if (mLockedRooms.contains(roomId)) {
+            mLockedRooms.remove(roomId);
+        } else {
+            mLockedRooms.insert(roomId);
+        }
+    }
+
+    void compare(const TMapGraph& incremental, const TMapGraph& rebuilt)
+    {
+        QCOMPARE(incremental.roomCount(), rebuilt.roomCount());
+        QCOMPARE(incremental.edgeCount(), rebuilt.edgeCount());
+        QCOMPARE(static_cast<int>(boost::num_edges(incremental.graph())), incremental.edgeCount());
+        for (const auto& l : rebuilt.locations()) {
+            QVERIFY(incremental.contains(l.id));
+            const auto routes = routesFrom(l.id);
+            for (auto it = routes.cbegin(); it != routes.cend(); ++it) {
+                QCOMPARE(incremental.routeBetween(l.id, it.key()).cost, rebuilt.routeBetween(l.id, it.key()).cost);
+            }
+        }
+    }
+
+private slots:
+
+    void init()
+    {
+        mLockedRooms.clear();
+        mExitWeights.clear();
+    }
+
+    void testRemoveRoomDropsEdges()
+    {
+        TMapGraph graph;
+        rebuild(graph);
+        const int roomId = scmWidth + 2;
+        QCOMPARE(graph.entrances(roomId).size(), 4);
+        const int edgesBefore = graph.edgeCount();
+        mLockedRooms.insert(roomId);
+        updateRoom(graph, roomId);
+        QVERIFY(!graph.contains(roomId));
+        QVERIFY(graph.entrances(roomId).isEmpty());
+        QCOMPARE(graph.edgeCount(), edgesBefore - 8);
+        QCOMPARE(graph.freeVertexCount(), 1);
+        QCOMPARE(graph.routeBetween(roomId - 1, roomId).cost, 0.0f);
+
+        // The freed vertex is reused:
+        mLockedRooms.remove(roomId);
+        updateRoom(graph, roomId);
+        QCOMPARE(graph.freeVertexCount(), 0);
+        QCOMPARE(graph.edgeCount(), edgesBefore);
+    }
+
+    void testIncrementalMatchesRebuild()
+    {
+        TMapGraph incremental;
+        rebuild(incremental);
+        QRandomGenerator random(42);
+        for (int i = 0; i < 2000; ++i) {
+            const int roomId = 1 + random.bounded(scmRoomCount);
+            if (i % 4) {
+                toggleLock(roomId);
+                updateRoom(incremental, roomId);
+            } else {
+                // An exit weight change only needs the edges out of the room:
+                mExitWeights.insert(roomId, 1 + random.bounded(10));
+                if (incremental.contains(roomId)) {
+                    incremental.setRoutes(roomId, routesFrom(roomId));
+                }
+            }
+        }
+
+        TMapGraph rebuilt;
+        rebuild(rebuilt);
+        compare(incremental, rebuilt);
+    }
+
+    void testSearchFrom()
+    {
+        TMapGraph graph;
+        mLockedRooms << scmWidth + 1 << scmWidth + 2 << scmWidth + 3;
+        rebuild(graph);
+
+        // Check the distances against boost's own implementation:
+        const auto& g = graph.graph();
+        const TMapGraph::vertex source = graph.vertexOf(1);
+        std::vector<cost> expected(boost::num_vertices(g));
+        boost::dijkstra_shortest_paths(g, source, boost::distance_map(&expected[0]));
+
+        graph.searchFrom(1);
+        const QHash<int, cost> reached = graph.reachedRooms();
+        QCOMPARE(reached.size(), graph.roomCount());
+        for (auto it = reached.cbegin(); it != reached.cend(); ++it) {
+            QCOMPARE(it.value(), expected[graph.vertexOf(it.key())]);
+        }
+        QCOMPARE(graph.distanceTo(1), 0.0f);
+        QVERIFY(graph.pathTo(1).isEmpty());
+        QCOMPARE(graph.distanceTo(scmWidth + 2), -1.0f);
+
+        // A path is made of edges in the graph and adds up to the distance:
+        const int target = scmRoomCount / 2 + 17;
+        const QList<int> path = graph.pathTo(target);
+        QCOMPARE(path.last(), target);
+        int previous = 1;
+        cost total = 0;
+        for (const int roomId : path) {
+            const route r = graph.routeBetween(previous, roomId);
+            QVERIFY(r.cost > 0);
+            total += r.cost;
+            previous = roomId;
+        }
+        QCOMPARE(total, graph.distanceTo(target));
+
+        // Searching for just some targets gives the same answers for them:
+        const QList<int> targets{target, 2 * scmWidth + 2, 10 * scmWidth};
+        graph.searchFrom(1, targets);
+        for (const int roomId : targets) {
+            QCOMPARE(graph.distanceTo(roomId), expected[graph.vertexOf(roomId)]);
+        }
+        QVERIFY(graph.reachedRooms().size() < graph.roomCount());
+
+        // Changing the graph invalidates the results:
+        graph.setRoutes(target, routesFrom(target));
+        QCOMPARE(graph.distanceTo(target), -1.0f);
+    }
+
+    void testAreaRouteMatchesFlatSearch()
+    {
+        TMapGraph graph;
+        QRandomGenerator random(7);
+        // Some locked rooms, including a wall along most of one area's edge,
+        // so that the best routes are not just the obvious ones:
+        for (int i = 0; i < scmRoomCount / 20; ++i) {
+            mLockedRooms.insert(1 + random.bounded(scmRoomCount));
+        }
+        for (int row = 0; row < scmWidth - 3; ++row) {
+            if (row != scmAreaWidth / 2) {
+                mLockedRooms.insert(row * scmWidth + scmAreaWidth + 1);
+            }
+        }
+        rebuild(graph);
+        // The portals are only worked out when they are first needed:
+        QCOMPARE(graph.portalCount(), 0);
+
+        for (int i = 0; i < 200; ++i) {
+            const int from = 1 + random.bounded(scmRoomCount);
+            // Every fourth one is kept inside the same area:
+            const int to = (i % 4) ? 1 + random.bounded(scmRoomCount) : qMin(from + random.bounded(3) * scmWidth + random.bounded(3), scmRoomCount);
+            QList<int> path;
+            cost total = -1;
+            const bool found = graph.findAreaRoute(from, to, path, total);
+            graph.searchFrom(from, {to});
+            const cost expected = graph.distanceTo(to);
+            QCOMPARE(found, expected >= 0);
+            if (!found) {
+                continue;
+            }
+
+            QCOMPARE(total, expected);
+            int previous = from;
+            cost pathCost = 0;
+            for (const int roomId : std::as_const(path)) {
+                const route r = graph.routeBetween(previous, roomId);
+                QVERIFY(r.cost > 0);
+                pathCost += r.cost;
+                previous = roomId;
+            }
+            QCOMPARE(previous, to);
+            QCOMPARE(pathCost, total);
+        }
+        QVERIFY(graph.portalCount() > 0);
+
+        // Editing the map is reflected in the next area route:
+        const int from = 1;
+        const int to = scmRoomCount;
+        QList<int> path;
+        cost before = 0;
+        QVERIFY(graph.findAreaRoute(from, to, path, before));
+        for (const int roomId : path.mid(path.size() / 2, 1)) {
+            toggleLock(roomId);
+            updateRoom(graph, roomId);
+        }
+        cost after = 0;
+        const bool found = graph.findAreaRoute(from, to, path, after);
+        graph.searchFrom(from, {to});
+        QVERIFY(found);
+        QCOMPARE(after, graph.distanceTo(to));
+        QVERIFY(after >= before);
+    }
+
+    void benchmarkFullRebuild()
+    {
+        TMapGraph graph;
+        QBENCHMARK {
+            rebuild(graph);
+        }
+        QCOMPARE(graph.roomCount(), scmRoomCount);
+    }
+
+    void benchmarkIncrementalUpdate()
+    {
+        TMapGraph graph;
+        rebuild(graph);
+        int roomId = 1;
+        QBENCHMARK {
+            // Locking then unlocking a room, as a script might do to keep the
+            // speedwalk away from it, both as individual map edits:
+            roomId = 1 + (roomId * 7919) % scmRoomCount;
+            toggleLock(roomId);
+            updateRoom(graph, roomId);
+            toggleLock(roomId);
+            updateRoom(graph, roomId);
+        }
+        QCOMPARE(graph.roomCount(), scmRoomCount);
+    }
+
+    void benchmarkNearestOf_data()
+    {
+        QTest::addColumn<bool>("batched");
+        QTest::newRow("one search per target") << false;
+        QTest::newRow("one search for all targets") << true;
+    }
+
+    // Finding the closest of a number of rooms (shops, banks, trainers...)
+    // scattered across the map:
+    void benchmarkNearestOf()
+    {
+        QFETCH(bool, batched);
+        TMapGraph graph;
+        rebuild(graph);
+        QList<int> targets;
+        for (int i = 1; i <= 20; ++i) {
+            targets << 1 + (i * 104729) % scmRoomCount;
+        }
+        const int source = scmRoomCount / 2 + scmWidth / 2;
+        int nearest = 0;
+        QBENCHMARK {
+            cost best = -1;
+            if (batched) {
+                graph.searchFrom(source, targets);
+            }
+            for (const int target : std::as_const(targets)) {
+                if (!batched) {
+                    graph.searchFrom(source, {target});
+                }
+                const cost distance = graph.distanceTo(target);
+                if (distance >= 0 && (best < 0 || distance < best)) {
+                    best = distance;
+                    nearest = target;
+                }
+            }
+        }
+        QVERIFY(nearest);
+    }
+
+    void benchmarkLongRoute_data()
+    {
+        QTest::addColumn<bool>("byArea");
+        QTest::newRow("search over every room") << false;
+        QTest::newRow("search over area portals") << true;
+    }
+
+    // Corner to corner across the whole map, the portals of each area are
+    // worked out on the first pass and then reused by the rest:
+    void benchmarkLongRoute()
+    {
+        QFETCH(bool, byArea);
+        TMapGraph graph;
+        rebuild(graph);
+        QList<int> path;
+        cost total = 0;
+        QBENCHMARK {
+            if (byArea) {
+                graph.findAreaRoute(1, scmRoomCount, path, total);
+            } else {
+                graph.searchFrom(1, {scmRoomCount});
+                path = graph.pathTo(scmRoomCount);
+            }
+        }
+        QVERIFY(!path.isEmpty());
+    }
+
+    void cleanupTestCase()
+    {
+    }
+};
+
+#include "TMapGraphTest.moc"
+QTEST_MAIN(TMapGraphTest)
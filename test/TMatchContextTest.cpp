@@ -0,0 +1,90 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <TMatchContext.h>
+#include <QtTest/QtTest>
+
+class TMatchContextTest : public QObject {
+Q_OBJECT
+
+private slots:
+
+    void testEncodingMatchesQt_data()
+    {
+        QTest::addColumn<QString>("text");
+        QTest::newRow("empty") << QString();
+        QTest::newRow("ascii") << QStringLiteral("You hit the goblin.");
+        QTest::newRow("latin") << QStringLiteral("Überall Straße");
+        QTest::newRow("cjk") << QStringLiteral("你好，世界");
+        QTest::newRow("astral") << QStringLiteral("a\U0001F600b\U0001F4A9");
+    }
+
+    void testEncodingMatchesQt()
+    {
+        QFETCH(QString, text);
+        const TMatchContext context(text);
+        const QByteArray expected = text.toUtf8();
+        QCOMPARE(context.utf8Length(), expected.size());
+        QCOMPARE(QByteArray(context.utf8()), expected);
+        QCOMPARE(context.utf16Position(context.utf8Length()), text.size());
+    }
+
+    void testPositions()
+    {
+        const QString text = QStringLiteral("Ü\U0001F600x");
+        const TMatchContext context(text);
+        // Ü is two bytes, the emoji four bytes but two UTF-16 code units:
+        QCOMPARE(context.utf16Position(0), 0);
+        QCOMPARE(context.utf16Position(1), 0);
+        QCOMPARE(context.utf16Position(2), 1);
+        QCOMPARE(context.utf16Position(5), 1);
+        QCOMPARE(context.utf16Position(6), 3);
+        QCOMPARE(context.utf16Position(7), 4);
+        QCOMPARE(context.utf16Position(8), -1);
+        QCOMPARE(context.utf16Position(-1), -1);
+    }
+
+    void testLoneSurrogate()
+    {
+        const QString text = QString(QChar(0xD800)) + QLatin1Char('a');
+        const TMatchContext context(text);
+        QCOMPARE(QByteArray(context.utf8()), QByteArray("\xEF\xBF\xBD" "a"));
+        QCOMPARE(context.utf16Position(3), 1);
+    }
+
+    void testReuse()
+    {
+        TMatchContext context;
+        const QString longer = QStringLiteral("A much longer line of text with ümlauts in it.");
+        const QString shorter = QStringLiteral("short");
+        context.setText(longer);
+        QCOMPARE(context.utf16Position(4), 4);
+        const char* pBuffer = context.utf8();
+
+        context.setText(shorter);
+        // The buffer from the longer line is big enough, so is kept:
+        QCOMPARE(context.utf8(), pBuffer);
+        QCOMPARE(QByteArray(context.utf8()), QByteArrayLiteral("short"));
+        QCOMPARE(context.text(), shorter);
+        QCOMPARE(context.utf16Position(5), 5);
+    }
+};
+
+#include "TMatchContextTest.moc"
+QTEST_MAIN(TMatchContextTest)
@@ -0,0 +1,124 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <TProfiler.h>
+#include <QtTest/QtTest>
+
+class TProfilerTest : public QObject {
+Q_OBJECT
+
+private:
+    // Something for the clock to measure:
+    static void work()
+    {
+        QElapsedTimer timer;
+        timer.start();
+        while (timer.nsecsElapsed() < 2000000) {
+        }
+    }
+
+private slots:
+
+    void testDisabledRecordsNothing()
+    {
+        TProfiler profiler;
+        {
+            const TProfiler::Scope scope(profiler, TProfiler::TriggerMatch, 1, QStringLiteral("trigger"));
+            work();
+        }
+        QVERIFY(!profiler.isEnabled());
+        QVERIFY(profiler.entries().isEmpty());
+    }
+
+    void testNestedItemsAreExclusive()
+    {
+        TProfiler profiler;
+        profiler.setEnabled(true);
+        {
+            const TProfiler::Scope match(profiler, TProfiler::TriggerMatch, 1, QStringLiteral("parent"));
+            work();
+            {
+                const TProfiler::Scope script(profiler, TProfiler::TriggerScript, 1, QStringLiteral("parent"));
+                work();
+                work();
+                {
+                    const TProfiler::Scope handler(profiler, QStringLiteral("onEvent"));
+                    work();
+                    work();
+                    work();
+                }
+            }
+        }
+        const auto entries = profiler.entries();
+        QCOMPARE(entries.size(), 3);
+        // Sorted by the time given to each, the longest first:
+        QCOMPARE(entries.at(0).mKind, TProfiler::EventHandler);
+        QCOMPARE(entries.at(0).mName, QStringLiteral("onEvent"));
+        QCOMPARE(entries.at(1).mKind, TProfiler::TriggerScript);
+        QCOMPARE(entries.at(2).mKind, TProfiler::TriggerMatch);
+        for (const auto& entry : entries) {
+            QCOMPARE(entry.mCalls, quint64(1));
+            QCOMPARE(entry.mMaxNanoseconds, entry.mTotalNanoseconds);
+        }
+        QVERIFY(entries.at(2).mTotalNanoseconds >= 2000000);
+        QVERIFY(entries.at(2).mTotalNanoseconds < entries.at(0).mTotalNanoseconds);
+    }
+
+    void testCallsAndMaximum()
+    {
+        TProfiler profiler;
+        profiler.setEnabled(true);
+        for (int i = 1; i <= 3; ++i) {
+            const TProfiler::Scope scope(profiler, TProfiler::TimerScript, 7, QStringLiteral("timer"));
+            for (int j = 0; j < i; ++j) {
+                work();
+            }
+        }
+        const auto entries = profiler.entries();
+        QCOMPARE(entries.size(), 1);
+        QCOMPARE(entries.at(0).mId, 7);
+        QCOMPARE(entries.at(0).mCalls, quint64(3));
+        QVERIFY(entries.at(0).mMaxNanoseconds >= 6000000);
+        QVERIFY(entries.at(0).mMaxNanoseconds < entries.at(0).mTotalNanoseconds);
+
+        profiler.reset();
+        QVERIFY(profiler.entries().isEmpty());
+        QVERIFY(profiler.isEnabled());
+    }
+
+    void testStoppingKeepsTheFigures()
+    {
+        TProfiler profiler;
+        profiler.setEnabled(true);
+        {
+            const TProfiler::Scope scope(profiler, TProfiler::AliasMatch, 2, QStringLiteral("alias"));
+            // Still recorded as it started while the profiler was running:
+            profiler.setEnabled(false);
+        }
+        {
+            const TProfiler::Scope scope(profiler, TProfiler::AliasMatch, 2, QStringLiteral("alias"));
+        }
+        QCOMPARE(profiler.entries().size(), 1);
+        QCOMPARE(profiler.entries().at(0).mCalls, quint64(1));
+        QVERIFY(profiler.report(10).contains(QStringLiteral("alias match: alias (id: 2)")));
+    }
+};
+
+#include "TProfilerTest.moc"
+QTEST_MAIN(TProfilerTest)
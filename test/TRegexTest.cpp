@@ -0,0 +1,212 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <TRegex.h>
+#include <QtTest/QtTest>
+
+#define qsl(s) QStringLiteral(s)
+
+// Run with "-datatags" to see the variants and give the path to a plain text
+// log of a recorded session (one line per game line) in the environment
+// variable MUDLET_BENCHMARK_SESSION to replay that instead of the built-in
+// sample in the benchmark:
+class TRegexTest : public QObject {
+Q_OBJECT
+
+private:
+    QList<QByteArray> mSessionLines;
+    QList<QByteArray> mPatterns;
+
+    static int countMatches(const QList<QSharedPointer<TRegex>>& regexes, const QList<QByteArray>& lines)
+    {
+        int ovector[33 * 3];
+        int matches = 0;
+        for (const auto& line : lines) {
+            for (const auto& regex : regexes) {
+                if (regex->exec(line.constData(), line.size(), 0, 0, ovector, 33 * 3) >= 0) {
+                    ++matches;
+                }
+            }
+        }
+        return matches;
+    }
+
+    QList<QSharedPointer<TRegex>> compileAll(const bool useJit) const
+    {
+        QList<QSharedPointer<TRegex>> result;
+        for (const auto& pattern : mPatterns) {
+            QString error;
+            int errorOffset = 0;
+            result.append(TRegex::compile(pattern, useJit, error, errorOffset));
+        }
+        return result;
+    }
+
+private slots:
+
+    void initTestCase()
+    {
+        mPatterns << QByteArrayLiteral("^You hit (\\w+) for (\\d+) damage\\.$")
+                  << QByteArrayLiteral("^(\\w+) (?:slashes|stabs|bites) you(?: viciously)?\\.$")
+                  << QByteArrayLiteral("^H:(\\d+)/(\\d+) M:(\\d+)/(\\d+)")
+                  << QByteArrayLiteral("(?<who>\\w+) tells you, \"(?<what>.*)\"$")
+                  << QByteArrayLiteral("^You (?:feel|are) (?:less )?(?:stunned|paralysed|confused)\\.$")
+                  << QByteArrayLiteral("\\bgold\\b.*\\bcoins?\\b")
+                  << QByteArrayLiteral("^[A-Z][a-z]+ has (?:arrived|left)\\.$")
+                  << QByteArrayLiteral("^Ü+ber (\\p{L}+)$");
+
+        const QByteArray sessionFile = qgetenv("MUDLET_BENCHMARK_SESSION");
+        if (!sessionFile.isEmpty()) {
+            QFile file(QString::fromLocal8Bit(sessionFile));
+            if (file.open(QIODevice::ReadOnly)) {
+                while (!file.atEnd()) {
+                    mSessionLines.append(file.readLine().trimmed());
+                }
+            }
+        }
+
+        if (mSessionLines.isEmpty()) {
+            const QList<QByteArray> sample{QByteArrayLiteral("You hit goblin for 42 damage."),
+                                           QByteArrayLiteral("Goblin slashes you viciously."),
+                                           QByteArrayLiteral("H:1234/2000 M:800/1500 [eb]"),
+                                           QByteArrayLiteral("Bob tells you, \"Meet me at the fountain.\""),
+                                           QByteArrayLiteral("You feel less stunned."),
+                                           QByteArrayLiteral("A heavy sack bulging with gold coins lies here."),
+                                           QByteArrayLiteral("Alice has arrived."),
+                                           QByteArrayLiteral("The wind howls through the empty streets of the city."),
+                                           QByteArrayLiteral("Überall Straße")};
+            for (int i = 0; i < 2000; ++i) {
+                mSessionLines.append(sample);
+            }
+        }
+    }
+
+    void testCompileError()
+    {
+        QString error;
+        int errorOffset = -1;
+        auto regex = TRegex::compile(QByteArrayLiteral("^(unbalanced"), true, error, errorOffset);
+        QVERIFY(regex.isNull());
+        QVERIFY(!error.isEmpty());
+        QVERIFY(errorOffset >= 0);
+    }
+
+    void testCompileAll()
+    {
+        QList<QByteArray> patterns = mPatterns;
+        patterns << mPatterns.first() << QByteArrayLiteral("^(unbalanced");
+        const auto compiled = TRegex::compileAll(patterns, true);
+        // The duplicate is only compiled once and the bad pattern is left out:
+        QCOMPARE(compiled.size(), mPatterns.size());
+        QVERIFY(!compiled.contains(QByteArrayLiteral("^(unbalanced")));
+
+        const auto serial = compileAll(true);
+        for (int i = 0, total = mPatterns.size(); i < total; ++i) {
+            QVERIFY(compiled.contains(mPatterns.at(i)));
+            QCOMPARE(compiled.value(mPatterns.at(i))->captureCount(), serial.at(i)->captureCount());
+        }
+    }
+
+    void testJitFlag()
+    {
+        QString error;
+        int errorOffset = 0;
+        auto jitted = TRegex::compile(QByteArrayLiteral("^You hit (\\w+)"), true, error, errorOffset);
+        QVERIFY(!jitted.isNull());
+        QCOMPARE(jitted->isJitCompiled(), TRegex::jitAvailable());
+
+        auto interpreted = TRegex::compile(QByteArrayLiteral("^You hit (\\w+)"), false, error, errorOffset);
+        QVERIFY(!interpreted.isNull());
+        QVERIFY(!interpreted->isJitCompiled());
+        QCOMPARE(interpreted->captureCount(), 1);
+    }
+
+    void testJitMatchesInterpreter()
+    {
+        const auto jitted = compileAll(true);
+        const auto interpreted = compileAll(false);
+        QCOMPARE(jitted.size(), mPatterns.size());
+
+        int jitOvector[33 * 3];
+        int interpretedOvector[33 * 3];
+        for (const auto& line : std::as_const(mSessionLines)) {
+            for (int i = 0; i < mPatterns.size(); ++i) {
+                QVERIFY(!jitted.at(i).isNull());
+                const int jitResult = jitted.at(i)->exec(line.constData(), line.size(), 0, 0, jitOvector, 33 * 3);
+                const int interpretedResult = interpreted.at(i)->exec(line.constData(), line.size(), 0, 0, interpretedOvector, 33 * 3);
+                QCOMPARE(jitResult, interpretedResult);
+                for (int j = 0; j < 2 * jitResult; ++j) {
+                    QCOMPARE(jitOvector[j], interpretedOvector[j]);
+                }
+            }
+        }
+    }
+
+    void testRequiredLiteral_data()
+    {
+        QTest::addColumn<QString>("pattern");
+        QTest::addColumn<QString>("literal");
+        QTest::newRow("plain") << qsl("^You hit (\\w+) for (\\d+) damage\\.$") << qsl("You hit ");
+        QTest::newRow("optional char") << qsl("^colou?red sword") << qsl("red sword");
+        QTest::newRow("zero repeats") << qsl("abcx{0,2}de") << qsl("abc");
+        QTest::newRow("one or more") << qsl("xyzzy+ plugh") << qsl(" plugh");
+        QTest::newRow("alternation") << qsl("^foo|bar$") << QString();
+        QTest::newRow("grouped alternation") << qsl("^(?:north|south)ern gate opens") << qsl("ern gate opens");
+        QTest::newRow("caseless") << qsl("(?i)You are stunned") << QString();
+        QTest::newRow("scoped caseless") << qsl("(?i:you) are stunned") << qsl(" are stunned");
+        QTest::newRow("class") << qsl("H:[0-9]+ M:") << qsl(" M:");
+        QTest::newRow("hex escape") << qsl("\\x41bcd and more") << qsl("bcd and more");
+        QTest::newRow("property") << qsl("\\p{Lu}pper") << qsl("pper");
+        QTest::newRow("quoted") << qsl("ab\\Q.*\\Ecdef") << qsl("cdef");
+        QTest::newRow("nothing") << qsl("^\\d+$") << QString();
+        QTest::newRow("unbalanced") << qsl("abc)") << QString();
+    }
+
+    void testRequiredLiteral()
+    {
+        QFETCH(QString, pattern);
+        QFETCH(QString, literal);
+        QCOMPARE(TRegex::requiredLiteral(pattern), literal);
+    }
+
+    void benchmarkSessionReplay_data()
+    {
+        QTest::addColumn<bool>("useJit");
+        QTest::newRow("interpreter") << false;
+        QTest::newRow("jit") << true;
+    }
+
+    void benchmarkSessionReplay()
+    {
+        QFETCH(bool, useJit);
+        const auto regexes = compileAll(useJit);
+        int matches = 0;
+        QBENCHMARK {
+            matches = countMatches(regexes, mSessionLines);
+        }
+        QVERIFY(matches > 0);
+    }
+
+    void cleanupTestCase()
+    {
+    }
+};
+
+#include "TRegexTest.moc"
+QTEST_MAIN(TRegexTest)
@@ -0,0 +1,122 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <TStringUtils.h>
+#include <QtTest/QtTest>
+#include "utils.h"
+
+#include <iterator>
+#include <string>
+
+class TStringUtilsTest : public QObject {
+Q_OBJECT
+
+private:
+    // Something like what a game sends - coloured text with the odd non-ASCII
+    // (UTF-8) character in it:
+    std::string mReplay;
+
+    // The straight-forward way of finding the same thing, for comparison:
+    static size_t bytewiseRunLength(const char* data, const size_t length)
+    {
+        size_t position = 0;
+        while (position < length && static_cast<unsigned char>(data[position]) >= 0x20 && static_cast<unsigned char>(data[position]) <= 0x7E) {
+            ++position;
+        }
+        return position;
+    }
+
+    // Goes through the whole of the data a run (or a single other byte) at a
+    // time, as TBuffer::translateToPlainText(...) does:
+    template <typename Scanner>
+    static size_t countRuns(const std::string& data, Scanner scanner)
+    {
+        size_t runs = 0;
+        for (size_t position = 0, length = data.size(); position < length;) {
+            const size_t runLength = scanner(data.data() + position, length - position);
+            if (runLength) {
+                position += runLength;
+                ++runs;
+            } else {
+                ++position;
+            }
+        }
+        return runs;
+    }
+
+private slots:
+
+    void initTestCase()
+    {
+        const std::string words[] = {"the", "goblin", "swings", "at", "you", "and", "misses", "caf\xC3\xA9", "Exits:", "north", "south", "[HP 1234/1500]"};
+        for (int line = 0; line < 20000; ++line) {
+            mReplay += "\033[0;3" + std::to_string(line % 8) + "m";
+            for (int word = 0; word < 10; ++word) {
+                mReplay += words[(line * 7 + word * 3) % std::size(words)];
+                mReplay += (word == 4) ? "\033[1m " : " ";
+            }
+            mReplay += "\033[0m\r\n";
+        }
+    }
+
+    void testPlainTextRunLength()
+    {
+        QCOMPARE(TStringUtils::plainTextRunLength("", 0), size_t(0));
+        QCOMPARE(TStringUtils::plainTextRunLength("\033[0m", 4), size_t(0));
+        QCOMPARE(TStringUtils::plainTextRunLength("Hello, world!\r\n", 15), size_t(13));
+        // Long enough to need more than one SIMD register's worth:
+        const std::string longLine = std::string(100, 'x') + "\tand a tab";
+        QCOMPARE(TStringUtils::plainTextRunLength(longLine.data(), longLine.size()), size_t(100));
+        const std::string highBit = std::string(40, '~') + "caf\xC3\xA9";
+        QCOMPARE(TStringUtils::plainTextRunLength(highBit.data(), highBit.size()), size_t(43));
+        const std::string deleteCharacter = std::string(17, ' ') + "\x7F";
+        QCOMPARE(TStringUtils::plainTextRunLength(deleteCharacter.data(), deleteCharacter.size()), size_t(17));
+        // Must not look past the length it is given:
+        QCOMPARE(TStringUtils::plainTextRunLength(longLine.data(), 37), size_t(37));
+    }
+
+    void testPlainTextRunLengthMatchesBytewise()
+    {
+        QCOMPARE(countRuns(mReplay, TStringUtils::plainTextRunLength), countRuns(mReplay, bytewiseRunLength));
+        for (size_t start = 0; start < 300; ++start) {
+            QCOMPARE(TStringUtils::plainTextRunLength(mReplay.data() + start, mReplay.size() - start), bytewiseRunLength(mReplay.data() + start, mReplay.size() - start));
+        }
+    }
+
+    void benchmarkBytewiseRunLength()
+    {
+        size_t runs = 0;
+        QBENCHMARK {
+            runs = countRuns(mReplay, bytewiseRunLength);
+        }
+        QVERIFY(runs > 0);
+    }
+
+    void benchmarkPlainTextRunLength()
+    {
+        size_t runs = 0;
+        QBENCHMARK {
+            runs = countRuns(mReplay, TStringUtils::plainTextRunLength);
+        }
+        QVERIFY(runs > 0);
+    }
+};
+
+#include "TStringUtilsTest.moc"
+QTEST_MAIN(TStringUtilsTest)
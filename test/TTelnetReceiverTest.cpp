@@ -0,0 +1,187 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <TTelnetReceiver.h>
+#include <QtTest/QtTest>
+
+#include <zlib.h>
+
+#include <thread>
+
+class TTelnetReceiverTest : public QObject {
+Q_OBJECT
+
+private:
+    static QList<TTelnetEvent> takeAll(TTelnetReceiver& receiver)
+    {
+        QList<TTelnetEvent> result;
+        TTelnetEvent event;
+        while (receiver.takeEvent(event)) {
+            result.append(event);
+        }
+        return result;
+    }
+
+    // A complete zlib stream holding the given data:
+    static QByteArray compress(const QByteArray& data)
+    {
+        QByteArray result(static_cast<int>(compressBound(static_cast<uLong>(data.size()))), '\0');
+        auto size = static_cast<uLongf>(result.size());
+        ::compress(reinterpret_cast<Bytef*>(result.data()), &size, reinterpret_cast<const Bytef*>(data.constData()), static_cast<uLong>(data.size()));
+        result.resize(static_cast<int>(size));
+        return result;
+    }
+
+private slots:
+
+    void testTextAndCommands()
+    {
+        TTelnetReceiver receiver;
+        const QByteArray data = QByteArrayLiteral("Hello\r\n\xff\xff world\xff\xf9" "after\xff\xfa\xc9" "Core.Ping\xff\xf0");
+        receiver.receive(data.constData(), data.size());
+        const auto events = takeAll(receiver);
+        QCOMPARE(events.size(), 5);
+        QCOMPARE(events.at(0).mType, TTelnetEvent::Text);
+        QCOMPARE(events.at(0).mData, std::string("Hello\n\xff world"));
+        QCOMPARE(events.at(1).mType, TTelnetEvent::Command);
+        QCOMPARE(events.at(1).mData, std::string("\xff\xf9"));
+        QCOMPARE(events.at(2).mData, std::string("after"));
+        QCOMPARE(events.at(3).mType, TTelnetEvent::Command);
+        QCOMPARE(events.at(3).mData, std::string("\xff\xfa\xc9" "Core.Ping\xff\xf0"));
+        QCOMPARE(events.at(4).mType, TTelnetEvent::Chunk);
+        QCOMPARE(events.at(4).mData, std::string(data.constData(), data.size()));
+    }
+
+    void testCommandSplitBetweenReads()
+    {
+        TTelnetReceiver receiver;
+        receiver.receive("abc\xff\xfb", 5);
+        receiver.receive("\x01" "def", 4);
+        const auto events = takeAll(receiver);
+        QCOMPARE(events.size(), 5);
+        QCOMPARE(events.at(0).mData, std::string("abc"));
+        QCOMPARE(events.at(1).mType, TTelnetEvent::Chunk);
+        QCOMPARE(events.at(2).mType, TTelnetEvent::Command);
+        QCOMPARE(events.at(2).mData, std::string("\xff\xfb\x01"));
+        QCOMPARE(events.at(3).mData, std::string("def"));
+    }
+
+    void testCompressionNeedsNegotiating()
+    {
+        const QByteArray start = QByteArrayLiteral("\xff\xfa\x56\xff\xf0");
+        TTelnetReceiver receiver;
+        receiver.receive(start.constData(), start.size());
+        const auto events = takeAll(receiver);
+        // Not negotiated, so it is just an ordinary subnegotiation:
+        QCOMPARE(events.size(), 2);
+        QCOMPARE(events.at(0).mType, TTelnetEvent::Command);
+    }
+
+    void testCompression()
+    {
+        TTelnetReceiver receiver;
+        receiver.setCompressionAllowed(false, true);
+        const QByteArray compressed = compress(QByteArrayLiteral("Compressed text\xff\xf9"));
+        const QByteArray data = QByteArrayLiteral("plain\xff\xfa\x56\xff\xf0") + compressed + QByteArrayLiteral("plain again");
+        // Split part way through the compressed data:
+        const int split = data.indexOf('\xf0') + 4;
+        receiver.receive(data.constData(), split);
+        receiver.receive(data.constData() + split, data.size() - split);
+
+        QList<TTelnetEvent> events;
+        for (const auto& event : takeAll(receiver)) {
+            if (event.mType != TTelnetEvent::Chunk) {
+                events.append(event);
+            }
+        }
+        QCOMPARE(events.size(), 6);
+        QCOMPARE(events.at(0).mData, std::string("plain"));
+        QCOMPARE(events.at(1).mType, TTelnetEvent::CompressionStarted);
+        QCOMPARE(events.at(2).mData, std::string("Compressed text"));
+        QCOMPARE(events.at(3).mType, TTelnetEvent::Command);
+        QCOMPARE(events.at(4).mType, TTelnetEvent::CompressionEnded);
+        QCOMPARE(events.at(5).mData, std::string("plain again"));
+    }
+
+    void testResetDropsStaleEvents()
+    {
+        TTelnetReceiver receiver;
+        // Processed before the reset was asked for but not yet taken:
+        receiver.post(QByteArrayLiteral("first connection"));
+        QCoreApplication::processEvents();
+        // Posted before the reset but only processed after it was asked for:
+        receiver.post(QByteArrayLiteral("still the first"));
+        receiver.postReset();
+        receiver.post(QByteArrayLiteral("second connection"));
+        QCoreApplication::processEvents();
+
+        const auto events = takeAll(receiver);
+        QCOMPARE(events.size(), 2);
+        QCOMPARE(events.at(0).mType, TTelnetEvent::Text);
+        QCOMPARE(events.at(0).mData, std::string("second connection"));
+        QCOMPARE(events.at(1).mType, TTelnetEvent::Chunk);
+    }
+
+    void testDataThenDisconnect()
+    {
+        QThread thread;
+        TTelnetReceiver receiver;
+        receiver.moveToThread(&thread);
+        thread.start();
+        receiver.post(QByteArrayLiteral("Goodbye!\r\n"));
+        // As done when the game closes the connection:
+        receiver.waitForInput();
+        const auto events = takeAll(receiver);
+        receiver.postReset();
+        thread.quit();
+        thread.wait();
+
+        QCOMPARE(events.size(), 2);
+        QCOMPARE(events.at(0).mType, TTelnetEvent::Text);
+        QCOMPARE(events.at(0).mData, std::string("Goodbye!\n"));
+        QCOMPARE(events.at(1).mType, TTelnetEvent::Chunk);
+        QVERIFY(takeAll(receiver).isEmpty());
+    }
+
+    void testQueueAcrossThreads()
+    {
+        TSpscQueue<int> queue;
+        constexpr int total = 100000;
+        std::thread producer([&queue]() {
+            for (int i = 0; i < total; ++i) {
+                queue.push(i);
+            }
+        });
+        int expected = 0;
+        int value = -1;
+        bool inOrder = true;
+        while (expected < total) {
+            if (queue.pop(value)) {
+                inOrder = inOrder && value == expected;
+                ++expected;
+            }
+        }
+        producer.join();
+        QVERIFY(inOrder);
+        QVERIFY(queue.isEmpty());
+    }
+};
+
+#include "TTelnetReceiverTest.moc"
+QTEST_MAIN(TTelnetReceiverTest)
@@ -0,0 +1,138 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <TTimerScheduler.h>
+#include <QtTest/QtTest>
+
+#include <array>
+
+class TTimerSchedulerTest : public QObject {
+Q_OBJECT
+
+private:
+    // The scheduler never looks inside a TTimer so anything will do to give
+    // it some distinct pointers:
+    std::array<char, 8> mTimers{};
+    TTimer* timer(const int index) { return reinterpret_cast<TTimer*>(&mTimers.at(index)); }
+    int indexOf(TTimer* pTimer) const { return static_cast<int>(reinterpret_cast<char*>(pTimer) - mTimers.data()); }
+
+private slots:
+
+    void testFiresInDeadlineOrder()
+    {
+        QList<int> fired;
+        TTimerScheduler scheduler([&](TTimer* pTimer) { fired.append(indexOf(pTimer)); });
+        scheduler.start(timer(0), 60, true);
+        scheduler.start(timer(1), 20, true);
+        scheduler.start(timer(2), 40, true);
+        QCOMPARE(scheduler.activeCount(), 3);
+        QTRY_COMPARE(fired.size(), 3);
+        QCOMPARE(fired, QList<int>({1, 2, 0}));
+        QCOMPARE(scheduler.activeCount(), 0);
+        QVERIFY(!scheduler.isActive(timer(0)));
+    }
+
+    void testStopAndRestart()
+    {
+        QList<int> fired;
+        TTimerScheduler scheduler([&](TTimer* pTimer) { fired.append(indexOf(pTimer)); });
+        scheduler.start(timer(0), 10, true);
+        scheduler.stop(timer(0));
+        QVERIFY(!scheduler.isActive(timer(0)));
+        QCOMPARE(scheduler.remainingTime(timer(0)), -1);
+        // Restarting pushes the deadline back and it still only fires once:
+        scheduler.start(timer(1), 10, true);
+        scheduler.start(timer(1), 30, true);
+        scheduler.start(timer(2), 60, true);
+        QTRY_COMPARE(fired.size(), 2);
+        QCOMPARE(fired, QList<int>({1, 2}));
+    }
+
+    void testRemainingTime()
+    {
+        TTimerScheduler scheduler([](TTimer*) {});
+        scheduler.start(timer(0), 10000, true);
+        QVERIFY(scheduler.isActive(timer(0)));
+        const int remaining = scheduler.remainingTime(timer(0));
+        QVERIFY(remaining > 9000);
+        QVERIFY(remaining <= 10000);
+        scheduler.clear();
+        QCOMPARE(scheduler.remainingTime(timer(0)), -1);
+    }
+
+    void testRepeatingTimer()
+    {
+        int count = 0;
+        TTimerScheduler scheduler([&](TTimer*) { ++count; });
+        scheduler.start(timer(0), 10, false);
+        QTRY_VERIFY(count >= 3);
+        // Already set up for the next run:
+        QVERIFY(scheduler.isActive(timer(0)));
+        scheduler.stop(timer(0));
+        const int stoppedAt = count;
+        QTest::qWait(50);
+        QCOMPARE(count, stoppedAt);
+    }
+
+    void testDueTimersAreCoalesced()
+    {
+        QList<int> fired;
+        TTimerScheduler scheduler([&](TTimer* pTimer) { fired.append(indexOf(pTimer)); });
+        scheduler.start(timer(0), 10, true);
+        scheduler.start(timer(1), 12, true);
+        scheduler.start(timer(2), 14, true);
+        // By the time the event loop gets going again they are all due:
+        QThread::msleep(50);
+        QTRY_COMPARE(fired.size(), 3);
+        QCOMPARE(fired, QList<int>({0, 1, 2}));
+        QCOMPARE(scheduler.dispatchCount(), quint64(1));
+    }
+
+    void testTimerStoppedByOneBeforeIt()
+    {
+        QList<int> fired;
+        TTimerScheduler* pScheduler = nullptr;
+        TTimerScheduler scheduler([&](TTimer* pTimer) {
+            fired.append(indexOf(pTimer));
+            if (pTimer == timer(0)) {
+                pScheduler->stop(timer(1));
+            }
+        });
+        pScheduler = &scheduler;
+        scheduler.start(timer(0), 10, true);
+        scheduler.start(timer(1), 10, true);
+        scheduler.start(timer(2), 20, true);
+        QThread::msleep(30);
+        QTRY_COMPARE(fired.size(), 2);
+        QCOMPARE(fired, QList<int>({0, 2}));
+    }
+
+    void testZeroIntervalRepeatingTimerYields()
+    {
+        int count = 0;
+        TTimerScheduler scheduler([&](TTimer*) { ++count; });
+        scheduler.start(timer(0), 0, false);
+        QTRY_VERIFY(count >= 3);
+        // It only ever fires once each time the event loop comes round:
+        QCOMPARE(scheduler.dispatchCount(), quint64(count));
+    }
+};
+
+#include "TTimerSchedulerTest.moc"
+QTEST_MAIN(TTimerSchedulerTest)
@@ -0,0 +1,80 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <TTrigramIndex.h>
+#include <QtTest/QtTest>
+#include "utils.h"
+
+class TTrigramIndexTest : public QObject {
+Q_OBJECT
+
+private slots:
+
+    void testFindsCandidatesIgnoringCase()
+    {
+        TTrigramIndex index;
+        const QStringList lines{qsl("You see a Dragon."), qsl("ab"), QString(), qsl("the dragon breathes"), qsl("nothing here")};
+        index.update(lines);
+        // Lines too short to hold a trigram are not indexed:
+        QCOMPARE(index.lineCount(), 3);
+        QCOMPARE(index.candidateLines(qsl("DRAGON")), QList<int>({0, 3}));
+        QCOMPARE(index.candidateLines(qsl("here")), QList<int>({4}));
+        QCOMPARE(index.candidateLines(qsl("xyz")), QList<int>());
+    }
+
+    void testChangedAndCopiedLines()
+    {
+        TTrigramIndex index;
+        QStringList lines{qsl("a goblin"), qsl("an orc")};
+        index.update(lines);
+        lines[1].append(qsl(" and a goblin"));
+        // The same data twice:
+        lines.append(lines.at(0));
+        index.update(lines);
+        QCOMPARE(index.lineCount(), 2);
+        QCOMPARE(index.candidateLines(qsl("goblin")), QList<int>({0, 1, 2}));
+        QCOMPARE(index.candidateLines(qsl("orc")), QList<int>({1}));
+    }
+
+    void testRemovedLinesAreForgotten()
+    {
+        TTrigramIndex index;
+        QStringList lines;
+        for (int i = 0; i < 100; ++i) {
+            lines.append(qsl("line %1 of text").arg(i));
+        }
+        index.update(lines);
+        for (int i = 0; i < 60; ++i) {
+            index.removeLine(lines.at(i));
+        }
+        lines.erase(lines.begin(), lines.begin() + 60);
+        index.update(lines);
+        QCOMPARE(index.lineCount(), 40);
+        QCOMPARE(index.candidateLines(qsl("line 5")).size(), 0);
+        QCOMPARE(index.candidateLines(qsl("line 65")), QList<int>({5}));
+        QCOMPARE(index.candidateLines(qsl("TEXT")).size(), 40);
+
+        index.clear();
+        QCOMPARE(index.lineCount(), 0);
+        QCOMPARE(index.candidateLines(qsl("text")), QList<int>());
+    }
+};
+
+#include "TTrigramIndexTest.moc"
+QTEST_MAIN(TTrigramIndexTest)
@@ -0,0 +1,94 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <TWordIndex.h>
+#include <QtTest/QtTest>
+#include "utils.h"
+
+class TWordIndexTest : public QObject {
+Q_OBJECT
+
+private slots:
+
+    void testMostRecentFirst()
+    {
+        TWordIndex index;
+        const QStringList lines{qsl("hello world"), qsl("Help me"), QString(), qsl("helmet hello")};
+        index.update(lines, 0, lines.size());
+        QCOMPARE(index.lineCount(), 3);
+        QCOMPARE(index.wordCount(), 5);
+        QCOMPARE(index.wordsStartingWith(qsl("he"), {}), QStringList({qsl("hello"), qsl("helmet"), qsl("Help")}));
+        // Only words longer than the prefix:
+        QCOMPARE(index.wordsStartingWith(qsl("help"), {}), QStringList());
+        QCOMPARE(index.wordsStartingWith(qsl("x"), {}), QStringList());
+    }
+
+    void testIgnoresCaseAndAppliesBlacklist()
+    {
+        TWordIndex index;
+        const QStringList lines{qsl("Hello, hello; HELLO! Helmet")};
+        index.update(lines, 0, lines.size());
+        QCOMPARE(index.wordsStartingWith(qsl("HEL"), {}), QStringList({qsl("Helmet"), qsl("HELLO"), qsl("hello"), qsl("Hello")}));
+        const QSet<QString> blacklist{TWordIndex::fold(qsl("HeLLo"))};
+        QCOMPARE(index.wordsStartingWith(qsl("hel"), blacklist), QStringList({qsl("Helmet")}));
+    }
+
+    void testChangedLinesAreReindexed()
+    {
+        TWordIndex index;
+        QStringList lines{qsl("apple"), qsl("apricot"), QString()};
+        index.update(lines, 0, 2);
+        lines[0].append(qsl(" avocado"));
+        index.update(lines, 0, 2);
+        QCOMPARE(index.lineCount(), 2);
+        QCOMPARE(index.wordsStartingWith(qsl("a"), {}), QStringList({qsl("apricot"), qsl("avocado"), qsl("apple")}));
+        lines[1] = qsl("banana");
+        index.update(lines, 0, 2);
+        QCOMPARE(index.wordsStartingWith(qsl("ap"), {}), QStringList({qsl("apple")}));
+    }
+
+    void testLinesLeavingTheRangeAreForgotten()
+    {
+        TWordIndex index;
+        QStringList lines;
+        for (int i = 0; i < 100; ++i) {
+            lines.append(qsl("word%1 common").arg(i));
+        }
+        index.update(lines, 0, 50);
+        QCOMPARE(index.wordCount(), 51);
+        index.update(lines, 50, 100);
+        QCOMPARE(index.lineCount(), 50);
+        QCOMPARE(index.wordCount(), 51);
+        QVERIFY(!index.wordsStartingWith(qsl("word"), {}).contains(qsl("word49")));
+        QCOMPARE(index.wordsStartingWith(qsl("word"), {}).first(), qsl("word99"));
+
+        index.removeLine(lines.at(99));
+        lines.removeLast();
+        QVERIFY(!index.wordsStartingWith(qsl("word"), {}).contains(qsl("word99")));
+        QCOMPARE(index.wordsStartingWith(qsl("comm"), {}), QStringList({qsl("common")}));
+
+        index.clear();
+        QCOMPARE(index.lineCount(), 0);
+        QCOMPARE(index.wordCount(), 0);
+        QCOMPARE(index.wordsStartingWith(qsl("word"), {}), QStringList());
+    }
+};
+
+#include "TWordIndexTest.moc"
+QTEST_MAIN(TWordIndexTest)
@@ -0,0 +1,95 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Stephen Lyons - slysven@virginmedia.com         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <Tree.h>
+#include <QtTest/QtTest>
+
+// The smallest possible item to hang on a Tree:
+class TNode : public Tree<TNode>
+{
+public:
+    explicit TNode(TNode* pParent = nullptr) : Tree<TNode>(pParent) {}
+};
+
+class TreeTest : public QObject {
+Q_OBJECT
+
+private slots:
+
+    void testNewItemsAreUnsaved()
+    {
+        TNode root;
+        QVERIFY(root.isUnsaved());
+        auto pChild = new TNode(&root);
+        QVERIFY(pChild->isUnsaved());
+
+        root.setSaved();
+        QVERIFY(!root.isUnsaved());
+        QVERIFY(!pChild->isUnsaved());
+    }
+
+    void testChangePropagatesToRoot()
+    {
+        TNode root;
+        auto pFolder = new TNode(&root);
+        auto pLeaf = new TNode(pFolder);
+        auto pSibling = new TNode(&root);
+        root.setSaved();
+
+        pLeaf->setShouldBeActive(true);
+        QVERIFY(pLeaf->isUnsaved());
+        QVERIFY(pFolder->isUnsaved());
+        QVERIFY(root.isUnsaved());
+        QVERIFY(!pSibling->isUnsaved());
+    }
+
+    void testUnchangedSettersLeaveItSaved()
+    {
+        TNode root;
+        root.setIsFolder(true);
+        root.setShouldBeActive(true);
+        root.setSaved();
+
+        root.setIsFolder(true);
+        root.setShouldBeActive(true);
+        root.setTemporary(false);
+        QVERIFY(!root.isUnsaved());
+
+        root.setTemporary(true);
+        QVERIFY(root.isUnsaved());
+    }
+
+    void testAddingAndRemovingChildren()
+    {
+        TNode root;
+        auto pChild = new TNode(&root);
+        root.setSaved();
+
+        delete pChild;
+        QVERIFY(root.isUnsaved());
+
+        root.setSaved();
+        auto pNewChild = new TNode(&root);
+        QVERIFY(root.isUnsaved());
+        QVERIFY(pNewChild->isUnsaved());
+    }
+};
+
+#include "TreeTest.moc"
+QTEST_MAIN(TreeTest)